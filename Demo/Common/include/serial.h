@@ -117,6 +117,12 @@ xComPortHandle xSerialPortInit( eCOMPort ePort, eBaud eWantedBaud, eParity eWant
 void vSerialPutString( xComPortHandle pxPort, const signed char * const pcString, unsigned short usStringLength );
 signed portBASE_TYPE xSerialGetChar( xComPortHandle pxPort, signed char *pcRxedChar, portTickType xBlockTime );
 signed portBASE_TYPE xSerialPutChar( xComPortHandle pxPort, signed char cOutChar, portTickType xBlockTime );
+
+/* Move a whole buffer to or from the port, blocking for no more than
+xBlockTime ticks in total.  Both return the number of bytes moved, which is
+less than uxLength if the time ran out first. */
+signed portBASE_TYPE xSerialWrite( xComPortHandle pxPort, const void *pvBuffer, unsigned portBASE_TYPE uxLength, portTickType xBlockTime );
+signed portBASE_TYPE xSerialRead( xComPortHandle pxPort, void *pvBuffer, unsigned portBASE_TYPE uxLength, portTickType xBlockTime );
 portBASE_TYPE xSerialWaitForSemaphore( xComPortHandle xPort );
 void vSerialClose( xComPortHandle xPort );
 
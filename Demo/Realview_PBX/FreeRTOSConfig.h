@@ -70,7 +70,29 @@
 #define configUSE_TICK_HOOK				1
 #define configTICK_RATE_HZ				( 1000 ) /* In this non-real time simulated environment the tick frequency has to be at least a multiple of the Win32 tick frequency, and therefore very slow. */
 #define configMINIMAL_STACK_SIZE		( ( unsigned portSHORT ) 256 * 4 )
-#define configTOTAL_HEAP_SIZE			( ( size_t ) 12 * 1024 * 1024 ) /* This parameter has no effect when heap_3.c is included in the project. */
+#define configTOTAL_HEAP_SIZE			( ( size_t ) 12 * 1024 * 1024 ) /* This parameter has no effect when heap_3.c or heap_5.c is included in the project. */
+#define configUSE_TASK_ARENAS			1
+
+/* The heap_n.c linked in, which the makefile sets from "make HEAP=n".  The
+instrumentation and the slabs are only provided by heap_5.c. */
+#ifndef configHEAP_IMPLEMENTATION
+	#define configHEAP_IMPLEMENTATION	5
+#endif
+
+#if ( configHEAP_IMPLEMENTATION == 5 )
+	#define configUSE_HEAP_INSTRUMENTATION	1
+	#define configUSE_HEAP_SLABS			1
+	#define configHEAP_SLAB_ZONE_SIZE		( 1024 * 1024 )
+#endif
+
+/* 1 to give each task its own newlib reentrancy structure and, with heap_3.c,
+to serialise newlib's malloc() with a mutex.  The makefile sets it from "make
+NEWLIB_REENTRANT=n". */
+#ifndef configUSE_NEWLIB_REENTRANT
+	#define configUSE_NEWLIB_REENTRANT	0
+#endif
+#define configSTACK_ALIGNMENT			32	/* The Cortex-A9 cache line size. */
+#define configTCB_ALIGNMENT				32
 #define configMAX_TASK_NAME_LEN			( 12 )
 #define configUSE_TRACE_FACILITY		1
 #define configUSE_16_BIT_TICKS			0
@@ -88,8 +110,17 @@
 
 #define configUSE_TIMERS				1
 #define configTIMER_TASK_PRIORITY		2
-#define configTIMER_QUEUE_LENGTH		20
+#define configTIMER_QUEUE_LENGTH		32
 #define configTIMER_TASK_STACK_DEPTH	( configMINIMAL_STACK_SIZE * 2 )
+#define configGENERATE_TIMER_STATS		1
+
+/* Set the count to 2 to give urgent timers a service of their own at the top
+priority.  Nothing in the demo binds a timer to it unless mainTIMER_BENCHMARK
+is set in main.c, so the default is a single service. */
+#define configTIMER_SERVICE_COUNT		1
+#if ( configTIMER_SERVICE_COUNT > 1 )
+	#define configTIMER_SERVICE_PRIORITIES	{ configTIMER_TASK_PRIORITY, ( configMAX_PRIORITIES - 1 ) }
+#endif
 
 #define configMAX_PRIORITIES			( ( unsigned portBASE_TYPE ) 7 )
 #define configMAX_CO_ROUTINE_PRIORITIES ( 2 )
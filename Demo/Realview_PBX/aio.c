@@ -0,0 +1,303 @@
+/*
+    FreeRTOS V7.0.1 - Copyright (C) 2011 Real Time Engineers Ltd.
+
+
+	FreeRTOS supports many tools and architectures. V7.0.0 is sponsored by:
+	Atollic AB - Atollic provides professional embedded systems development
+	tools for C/C++ development, code analysis and test automation.
+	See http://www.atollic.com
+
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS tutorial books are available in pdf and paperback.        *
+     *    Complete, revised, and edited pdf reference manuals are also       *
+     *    available.                                                         *
+     *                                                                       *
+     *    Purchasing FreeRTOS documentation will not only help you, by       *
+     *    ensuring you get running as quickly as possible and with an        *
+     *    in-depth knowledge of how to use FreeRTOS, it will also help       *
+     *    the FreeRTOS project to continue with its mission of providing     *
+     *    professional grade, cross platform, de facto standard solutions    *
+     *    for microcontrollers - completely free of charge!                  *
+     *                                                                       *
+     *    >>> See http://www.FreeRTOS.org/Documentation for details. <<<     *
+     *                                                                       *
+     *    Thank you for using FreeRTOS, and thank you for your support!      *
+     *                                                                       *
+    ***************************************************************************
+
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation AND MODIFIED BY the FreeRTOS exception.
+    >>>NOTE<<< The modification to the GPL is included to allow you to
+    distribute a combined work that includes FreeRTOS without being obliged to
+    provide the source code for proprietary components outside of the FreeRTOS
+    kernel.  FreeRTOS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details. You should have received a copy of the GNU General Public
+    License and the FreeRTOS license exception along with FreeRTOS; if not it
+    can be viewed here: http://www.freertos.org/a00114.html and also obtained
+    by writing to Richard Barry, contact details for whom are available on the
+    FreeRTOS WEB site.
+
+    1 tab == 4 spaces!
+
+    http://www.FreeRTOS.org - Documentation, latest information, license and
+    contact details.
+
+    http://www.SafeRTOS.com - A version that is certified for use in safety
+    critical systems.
+
+    http://www.OpenRTOS.com - Commercial support, development, porting,
+    licensing and training services.
+*/
+
+
+/* Asynchronous I/O Requests and Completions. */
+
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+#include "aio.h"
+/*----------------------------------------------------------------------------*/
+
+#if ( INCLUDE_xTaskGetSchedulerState != 1 )
+	#error aio.c needs INCLUDE_xTaskGetSchedulerState set to 1.
+#endif
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Mark a request, already unlinked, complete and tell the submitter.  Called
+ * with the interrupts masked.
+ */
+static void prvAIONotify( xAIODevice *pxDevice, xAIORequest *pxRequest, portBASE_TYPE xStatus, portBASE_TYPE *pxHigherPriorityTaskWoken );
+
+/*
+ * Yield to a task woken while the interrupts were masked, if the scheduler is
+ * running.
+ */
+static void prvAIOYield( portBASE_TYPE xHigherPriorityTaskWoken );
+/*----------------------------------------------------------------------------*/
+
+void vAIODeviceInitialise( xAIODevice *pxDevice, pdAIO_START pxStart, pdAIO_STOP pxStop, void *pvDriver )
+{
+	pxDevice->pxStart = pxStart;
+	pxDevice->pxStop = pxStop;
+	pxDevice->pvDriver = pvDriver;
+	pxDevice->pxHead = NULL;
+	pxDevice->pxTail = NULL;
+	memset( &( pxDevice->xStats ), 0, sizeof( pxDevice->xStats ) );
+}
+/*----------------------------------------------------------------------------*/
+
+portBASE_TYPE xAIOSubmit( xAIODevice *pxDevice, xAIORequest *pxRequest )
+{
+	return xAIOSubmitBatch( pxDevice, &pxRequest, 1U );
+}
+/*----------------------------------------------------------------------------*/
+
+portBASE_TYPE xAIOSubmitBatch( xAIODevice *pxDevice, xAIORequest * const *ppxRequests, unsigned portBASE_TYPE uxCount )
+{
+unsigned long ulMask;
+unsigned portBASE_TYPE ux;
+portBASE_TYPE xWoken = pdFALSE;
+
+	if( ( NULL == pxDevice ) || ( 0U == uxCount ) )
+	{
+		return pdFAIL;
+	}
+
+	/* Chain the batch together first, so the device takes it in one go. */
+	for( ux = 0U; ux < uxCount; ux++ )
+	{
+		ppxRequests[ ux ]->ulDone = 0UL;
+		ppxRequests[ ux ]->xStatus = aioPENDING;
+		ppxRequests[ ux ]->pxNext = ( ux + 1U < uxCount ) ? ppxRequests[ ux + 1U ] : NULL;
+	}
+
+	ulMask = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		pxDevice->xStats.ulSubmitted += uxCount;
+
+		if( NULL != pxDevice->pxHead )
+		{
+			pxDevice->pxTail->pxNext = ppxRequests[ 0 ];
+			pxDevice->pxTail = ppxRequests[ uxCount - 1U ];
+		}
+		else
+		{
+			pxDevice->pxHead = ppxRequests[ 0 ];
+			pxDevice->pxTail = ppxRequests[ uxCount - 1U ];
+
+			if( NULL != pxDevice->pxStart )
+			{
+				pxDevice->pxStart( pxDevice, pxDevice->pxHead, &xWoken );
+			}
+		}
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( ulMask );
+
+	prvAIOYield( xWoken );
+
+	return pdPASS;
+}
+/*----------------------------------------------------------------------------*/
+
+portBASE_TYPE xAIOCancel( xAIODevice *pxDevice, xAIORequest *pxRequest )
+{
+xAIORequest **ppxLink, *pxPrevious = NULL;
+unsigned long ulMask;
+portBASE_TYPE xResult = pdFAIL, xWoken = pdFALSE;
+
+	ulMask = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		for( ppxLink = &( pxDevice->pxHead ); NULL != *ppxLink; ppxLink = &( ( *ppxLink )->pxNext ) )
+		{
+			if( *ppxLink == pxRequest )
+			{
+				break;
+			}
+			pxPrevious = *ppxLink;
+		}
+
+		if( NULL != *ppxLink )
+		{
+			if( pxDevice->pxHead == pxRequest )
+			{
+				/* The device is working on it, so stop it and move on to
+				the next, as its interrupt would have. */
+				if( NULL != pxDevice->pxStop )
+				{
+					pxDevice->pxStop( pxDevice, pxRequest );
+				}
+
+				if( ( NULL != pxAIOComplete( pxDevice, aioCANCELLED, &xWoken ) ) && ( NULL != pxDevice->pxStart ) )
+				{
+					pxDevice->pxStart( pxDevice, pxDevice->pxHead, &xWoken );
+				}
+			}
+			else
+			{
+				*ppxLink = pxRequest->pxNext;
+				if( pxDevice->pxTail == pxRequest )
+				{
+					pxDevice->pxTail = pxPrevious;
+				}
+
+				prvAIONotify( pxDevice, pxRequest, aioCANCELLED, &xWoken );
+			}
+
+			xResult = pdPASS;
+		}
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( ulMask );
+
+	prvAIOYield( xWoken );
+
+	return xResult;
+}
+/*----------------------------------------------------------------------------*/
+
+xAIORequest *pxAIOWait( xQueueHandle xCompletions, portTickType xDelay )
+{
+xAIORequest *pxRequest;
+
+	if( pdTRUE != xQueueReceive( xCompletions, &pxRequest, xDelay ) )
+	{
+		return NULL;
+	}
+
+	return pxRequest;
+}
+/*----------------------------------------------------------------------------*/
+
+void vAIOGetStats( xAIODevice *pxDevice, xAIOStats *pxStats )
+{
+unsigned long ulMask;
+
+	/* Take a consistent copy of the counters. */
+	ulMask = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		*pxStats = pxDevice->xStats;
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( ulMask );
+}
+/*----------------------------------------------------------------------------*/
+
+xAIORequest *pxAIOActive( xAIODevice *pxDevice )
+{
+	return pxDevice->pxHead;
+}
+/*----------------------------------------------------------------------------*/
+
+xAIORequest *pxAIOComplete( xAIODevice *pxDevice, portBASE_TYPE xStatus, portBASE_TYPE *pxHigherPriorityTaskWoken )
+{
+xAIORequest *pxRequest = pxDevice->pxHead;
+
+	if( NULL != pxRequest )
+	{
+		pxDevice->pxHead = pxRequest->pxNext;
+		if( NULL == pxDevice->pxHead )
+		{
+			pxDevice->pxTail = NULL;
+		}
+
+		prvAIONotify( pxDevice, pxRequest, xStatus, pxHigherPriorityTaskWoken );
+	}
+
+	return pxDevice->pxHead;
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvAIONotify( xAIODevice *pxDevice, xAIORequest *pxRequest, portBASE_TYPE xStatus, portBASE_TYPE *pxHigherPriorityTaskWoken )
+{
+pdAIO_CALLBACK pxCallback = pxRequest->pxCallback;
+xQueueHandle xCompletions = pxRequest->xCompletions;
+
+	pxRequest->pxNext = NULL;
+
+	if( aioCANCELLED == xStatus )
+	{
+		pxDevice->xStats.ulCancelled++;
+	}
+	else
+	{
+		pxDevice->xStats.ulCompleted++;
+		if( aioERROR == xStatus )
+		{
+			pxDevice->xStats.ulErrors++;
+		}
+	}
+
+	/* A task polling the status may take the request back as soon as it is
+	set, so the request is not read after this. */
+	pxRequest->xStatus = xStatus;
+
+	if( NULL != pxCallback )
+	{
+		pxCallback( pxRequest, pxHigherPriorityTaskWoken );
+	}
+
+	if( ( NULL != xCompletions ) && ( pdTRUE != xQueueSendFromISR( xCompletions, &pxRequest, pxHigherPriorityTaskWoken ) ) )
+	{
+		pxDevice->xStats.ulCompletionsLost++;
+	}
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvAIOYield( portBASE_TYPE xHigherPriorityTaskWoken )
+{
+	if( ( pdFALSE != xHigherPriorityTaskWoken ) && ( taskSCHEDULER_RUNNING == xTaskGetSchedulerState() ) )
+	{
+		taskYIELD();
+	}
+}
+/*----------------------------------------------------------------------------*/
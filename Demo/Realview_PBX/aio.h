@@ -0,0 +1,178 @@
+/*
+    FreeRTOS V7.0.1 - Copyright (C) 2011 Real Time Engineers Ltd.
+
+
+	FreeRTOS supports many tools and architectures. V7.0.0 is sponsored by:
+	Atollic AB - Atollic provides professional embedded systems development
+	tools for C/C++ development, code analysis and test automation.
+	See http://www.atollic.com
+
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS tutorial books are available in pdf and paperback.        *
+     *    Complete, revised, and edited pdf reference manuals are also       *
+     *    available.                                                         *
+     *                                                                       *
+     *    Purchasing FreeRTOS documentation will not only help you, by       *
+     *    ensuring you get running as quickly as possible and with an        *
+     *    in-depth knowledge of how to use FreeRTOS, it will also help       *
+     *    the FreeRTOS project to continue with its mission of providing     *
+     *    professional grade, cross platform, de facto standard solutions    *
+     *    for microcontrollers - completely free of charge!                  *
+     *                                                                       *
+     *    >>> See http://www.FreeRTOS.org/Documentation for details. <<<     *
+     *                                                                       *
+     *    Thank you for using FreeRTOS, and thank you for your support!      *
+     *                                                                       *
+    ***************************************************************************
+
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation AND MODIFIED BY the FreeRTOS exception.
+    >>>NOTE<<< The modification to the GPL is included to allow you to
+    distribute a combined work that includes FreeRTOS without being obliged to
+    provide the source code for proprietary components outside of the FreeRTOS
+    kernel.  FreeRTOS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details. You should have received a copy of the GNU General Public
+    License and the FreeRTOS license exception along with FreeRTOS; if not it
+    can be viewed here: http://www.freertos.org/a00114.html and also obtained
+    by writing to Richard Barry, contact details for whom are available on the
+    FreeRTOS WEB site.
+
+    1 tab == 4 spaces!
+
+    http://www.FreeRTOS.org - Documentation, latest information, license and
+    contact details.
+
+    http://www.SafeRTOS.com - A version that is certified for use in safety
+    critical systems.
+
+    http://www.OpenRTOS.com - Commercial support, development, porting,
+    licensing and training services.
+*/
+
+
+#ifndef AIO_H
+#define AIO_H
+
+/* Asynchronous I/O shared by the drivers.  A driver keeps an xAIODevice for
+each part of its hardware that works on its own, such as the transmitter of a
+UART or a timer.  Tasks fill in xAIORequest structures, submit them to the
+device and carry on.  Each device works through its requests in the order they
+were submitted, and its interrupt completes them one by one.
+
+A completed request is handed to its callback, from the interrupt, and posted
+to its completion queue, a queue of xAIORequest pointers.  A task that gives
+the same queue to requests on several devices keeps them all busy at once and
+waits for whichever finishes first.
+
+A request belongs to the device from when it is submitted until it completes,
+and must not be changed or reused in between. */
+
+#include "queue.h"
+
+/* xStatus of a request. */
+#define aioPENDING					( 0 )	/* Submitted, and not yet complete. */
+#define aioDONE						( 1 )
+#define aioERROR					( 2 )
+#define aioCANCELLED				( 3 )
+
+/* ulFlags of a request. */
+#define aioFLAG_PARTIAL				( 1UL )	/* May complete with fewer bytes than asked for, when the device has no more for now. */
+
+typedef struct AIO_REQUEST xAIORequest;
+typedef struct AIO_DEVICE xAIODevice;
+
+/* Called from the interrupt when a request completes, or from the task
+cancelling it, with the interrupts masked either way. */
+typedef void ( *pdAIO_CALLBACK )( xAIORequest *pxRequest, portBASE_TYPE *pxHigherPriorityTaskWoken );
+
+struct AIO_REQUEST
+{
+	/* Set by the submitter.  What the buffer and length mean is up to the
+	device: bytes for a UART, and a time for a timer. */
+	unsigned char *pucBuffer;
+	unsigned long ulLength;
+	unsigned long ulFlags;
+	pdAIO_CALLBACK pxCallback;			/* Either of these may be NULL. */
+	xQueueHandle xCompletions;
+	void *pvContext;					/* Not used by the device. */
+
+	/* Set by the device. */
+	unsigned long ulDone;				/* How much of ulLength has been moved. */
+	volatile portBASE_TYPE xStatus;
+	xAIORequest *pxNext;
+};
+
+/* Called with the interrupts masked to start the request at the head of an
+idle device, and to stop the one at the head when it is cancelled. */
+typedef void ( *pdAIO_START )( xAIODevice *pxDevice, xAIORequest *pxRequest, portBASE_TYPE *pxHigherPriorityTaskWoken );
+typedef void ( *pdAIO_STOP )( xAIODevice *pxDevice, xAIORequest *pxRequest );
+
+/* Counters kept per device. */
+typedef struct AIO_STATISTICS
+{
+	unsigned long ulSubmitted;
+	unsigned long ulCompleted;			/* Done or failed. */
+	unsigned long ulErrors;
+	unsigned long ulCancelled;
+	unsigned long ulCompletionsLost;	/* Posts to a full completion queue. */
+} xAIOStats;
+
+struct AIO_DEVICE
+{
+	pdAIO_START pxStart;				/* NULL if the device needs no start. */
+	pdAIO_STOP pxStop;					/* NULL if it needs no stop. */
+	void *pvDriver;						/* For the driver. */
+	xAIORequest *pxHead;				/* The request being worked on, */
+	xAIORequest *pxTail;				/* and the last submitted. */
+	xAIOStats xStats;
+};
+
+/*
+ * Set up a device for its driver.
+ */
+void vAIODeviceInitialise( xAIODevice *pxDevice, pdAIO_START pxStart, pdAIO_STOP pxStop, void *pvDriver );
+
+/*
+ * Queue a request, or uxCount of them in one go, and start the device if it
+ * was idle.  May be called before the scheduler starts, but not from an
+ * interrupt.
+ */
+portBASE_TYPE xAIOSubmit( xAIODevice *pxDevice, xAIORequest *pxRequest );
+portBASE_TYPE xAIOSubmitBatch( xAIODevice *pxDevice, xAIORequest * const *ppxRequests, unsigned portBASE_TYPE uxCount );
+
+/*
+ * Take back a request that has not completed, stopping the device if it was
+ * working on it.  The request completes with aioCANCELLED, with whatever was
+ * moved in ulDone.  Returns pdFAIL if it had already completed.
+ */
+portBASE_TYPE xAIOCancel( xAIODevice *pxDevice, xAIORequest *pxRequest );
+
+/*
+ * Wait up to xDelay ticks for a request to be posted to xCompletions, and
+ * return it, or NULL.
+ */
+xAIORequest *pxAIOWait( xQueueHandle xCompletions, portTickType xDelay );
+
+/*
+ * Copy the counters of a device into *pxStats.
+ */
+void vAIOGetStats( xAIODevice *pxDevice, xAIOStats *pxStats );
+
+/*
+ * For drivers, from their interrupt or with the interrupts masked.  The first
+ * returns the request being worked on, or NULL if the device is idle.  The
+ * second completes it with xStatus and returns the next, which the driver
+ * goes on to work on.
+ */
+xAIORequest *pxAIOActive( xAIODevice *pxDevice );
+xAIORequest *pxAIOComplete( xAIODevice *pxDevice, portBASE_TYPE xStatus, portBASE_TYPE *pxHigherPriorityTaskWoken );
+
+#endif /* AIO_H */
@@ -55,6 +55,8 @@ extern void vUARTInitialise( unsigned long ulUARTPeripheral, unsigned long ulBau
 #define PRIOR_FIX_FREQ_PERIODIC          ( 3 )
 #define PRIOR_PRINT_GATEKEEPR            ( 1 )
 #define PRIOR_RECEIVER                   ( 1 )
+#define PRIOR_NETWORK                    ( 5 )
+#define PRIOR_BLOCK_IO                   ( 4 )
 
 
 /* Settings for print.c */
@@ -0,0 +1,779 @@
+/*
+    FreeRTOS V7.0.1 - Copyright (C) 2011 Real Time Engineers Ltd.
+
+
+	FreeRTOS supports many tools and architectures. V7.0.0 is sponsored by:
+	Atollic AB - Atollic provides professional embedded systems development
+	tools for C/C++ development, code analysis and test automation.
+	See http://www.atollic.com
+
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS tutorial books are available in pdf and paperback.        *
+     *    Complete, revised, and edited pdf reference manuals are also       *
+     *    available.                                                         *
+     *                                                                       *
+     *    Purchasing FreeRTOS documentation will not only help you, by       *
+     *    ensuring you get running as quickly as possible and with an        *
+     *    in-depth knowledge of how to use FreeRTOS, it will also help       *
+     *    the FreeRTOS project to continue with its mission of providing     *
+     *    professional grade, cross platform, de facto standard solutions    *
+     *    for microcontrollers - completely free of charge!                  *
+     *                                                                       *
+     *    >>> See http://www.FreeRTOS.org/Documentation for details. <<<     *
+     *                                                                       *
+     *    Thank you for using FreeRTOS, and thank you for your support!      *
+     *                                                                       *
+    ***************************************************************************
+
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation AND MODIFIED BY the FreeRTOS exception.
+    >>>NOTE<<< The modification to the GPL is included to allow you to
+    distribute a combined work that includes FreeRTOS without being obliged to
+    provide the source code for proprietary components outside of the FreeRTOS
+    kernel.  FreeRTOS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details. You should have received a copy of the GNU General Public
+    License and the FreeRTOS license exception along with FreeRTOS; if not it
+    can be viewed here: http://www.freertos.org/a00114.html and also obtained
+    by writing to Richard Barry, contact details for whom are available on the
+    FreeRTOS WEB site.
+
+    1 tab == 4 spaces!
+
+    http://www.FreeRTOS.org - Documentation, latest information, license and
+    contact details.
+
+    http://www.SafeRTOS.com - A version that is certified for use in safety
+    critical systems.
+
+    http://www.OpenRTOS.com - Commercial support, development, porting,
+    licensing and training services.
+*/
+
+
+/* Write-back block cache over the SD card driver. */
+
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#include "pl181_mmci.h"
+#include "blockcache.h"
+/*----------------------------------------------------------------------------*/
+
+#define cacheBUCKETS				( cacheENTRIES )
+#define cacheBUCKET( ulBlock )		( ( ulBlock ) % cacheBUCKETS )
+/*----------------------------------------------------------------------------*/
+
+typedef struct CACHE_ENTRY
+{
+	unsigned long ulBlock;
+	unsigned char *pucData;
+	unsigned portBASE_TYPE uxHolders;	/* Not evicted while any task holds it. */
+	portBASE_TYPE xValid;
+	portBASE_TYPE xDirty;
+	portBASE_TYPE xBusy;				/* Being read or written by the card, so left alone until that ends. */
+	struct CACHE_ENTRY *pxNewer;		/* Least recently used order. */
+	struct CACHE_ENTRY *pxOlder;
+	struct CACHE_ENTRY *pxNextInBucket;	/* Valid entries only. */
+} xCacheEntry;
+/*----------------------------------------------------------------------------*/
+
+static xCacheEntry xCacheEntries[ cacheENTRIES ];
+static xCacheEntry *pxCacheBuckets[ cacheBUCKETS ];
+static xCacheEntry *pxCacheNewest = NULL;
+static xCacheEntry *pxCacheOldest = NULL;
+
+/* The data of all the entries, in order. */
+static unsigned char *pucCacheData = NULL;
+
+static xSemaphoreHandle xCacheMutex = NULL;
+
+/* The mutex is not held while the card is read or written, so several tasks
+can have requests queued at the driver at once.  The entries involved are
+busy meanwhile, and a task that needs one waits on xCacheIODone, which is
+given once for every waiting task whenever a transfer ends. */
+static xSemaphoreHandle xCacheIODone = NULL;
+static unsigned portBASE_TYPE uxCacheWaiters = 0U;
+
+/* The blocks being written by xBlockCacheWriteThrough(), which must not be
+read into the cache until the write ends. */
+static unsigned long ulCacheThroughBlock = 0UL;
+static unsigned long ulCacheThroughCount = 0UL;
+
+/* Blocks on the card, 0 until the first access. */
+static unsigned long ulCacheBlockCount = 0UL;
+
+/* The block after the last one read, to spot a sequential read. */
+static unsigned long ulCacheNextBlock = 0UL;
+
+static xBlockCacheStats xCacheStats;
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Find block ulBlock in the cache, or read it and those that follow, and hold
+ * it.  ulWanted is how many blocks the caller is going to read from ulBlock
+ * on.  Called with the mutex held, as are all those below.  Those that go to
+ * the card release it while they wait, so the cache may have changed when
+ * they return.
+ */
+static xCacheEntry *prvCacheGet( unsigned long ulBlock, portBASE_TYPE xOverwrite, unsigned long ulWanted );
+
+static xCacheEntry *prvCacheFind( unsigned long ulBlock );
+
+/*
+ * pdTRUE if a block from ulBlock to ulBlock + ulCount - 1 is being written
+ * through, or is in the cache and busy.
+ */
+static portBASE_TYPE prvCacheRangeBusy( unsigned long ulBlock, unsigned long ulCount );
+
+/*
+ * The oldest entry no task holds, emptied, or NULL if there is none or it was
+ * dirty and could not be written back.  If xWait is set and the only entries
+ * left are busy, wait for them rather than return NULL.  Only a caller that
+ * has no busy entries of its own may wait.
+ */
+static xCacheEntry *prvCacheEvict( portBASE_TYPE xWait );
+
+/*
+ * Write the dirty pxEntry, and the dirty blocks either side of it, with one
+ * command.  The blocks are busy, and clean, while the command runs, so a
+ * block changed meanwhile is dirty again afterwards.
+ */
+static portBASE_TYPE prvCacheWriteBack( xCacheEntry *pxEntry );
+
+/*
+ * Release the mutex until a transfer ends, and wake the tasks waiting for one
+ * when it does.
+ */
+static void prvCacheWaitForIO( void );
+static void prvCacheIODone( void );
+
+static void prvCacheMakeNewest( xCacheEntry *pxEntry );
+static void prvCacheMakeOldest( xCacheEntry *pxEntry );
+static void prvCacheUnlink( xCacheEntry *pxEntry );
+static void prvCacheRemoveFromBucket( xCacheEntry *pxEntry );
+/*----------------------------------------------------------------------------*/
+
+portBASE_TYPE xBlockCacheInitialise( void )
+{
+unsigned portBASE_TYPE ux;
+
+	if( NULL != xCacheMutex )
+	{
+		return pdPASS;
+	}
+
+	xCacheMutex = xSemaphoreCreateMutex();
+	xCacheIODone = xSemaphoreCreateCounting( ( unsigned portBASE_TYPE ) ~0U, 0U );
+	pucCacheData = ( unsigned char * ) pvPortMalloc( cacheENTRIES * cacheBLOCK_SIZE );
+	if( ( NULL == xCacheMutex ) || ( NULL == xCacheIODone ) || ( NULL == pucCacheData ) )
+	{
+		return pdFAIL;
+	}
+
+	for( ux = 0U; ux < cacheENTRIES; ux++ )
+	{
+		xCacheEntries[ ux ].pucData = pucCacheData + ux * cacheBLOCK_SIZE;
+		prvCacheMakeNewest( &xCacheEntries[ ux ] );
+	}
+
+	return pdPASS;
+}
+/*----------------------------------------------------------------------------*/
+
+portBASE_TYPE xBlockCacheRead( unsigned long ulBlock, unsigned long ulCount, void *pvBuffer )
+{
+unsigned char *pucBuffer = ( unsigned char * ) pvBuffer;
+xCacheEntry *pxEntry;
+unsigned long ul;
+portBASE_TYPE xResult = pdPASS;
+
+	( void ) xSemaphoreTake( xCacheMutex, portMAX_DELAY );
+
+	for( ul = 0UL; ul < ulCount; ul++ )
+	{
+		pxEntry = prvCacheGet( ulBlock + ul, pdFALSE, ulCount - ul );
+		if( NULL == pxEntry )
+		{
+			xResult = pdFAIL;
+			break;
+		}
+
+		memcpy( pucBuffer + ul * cacheBLOCK_SIZE, pxEntry->pucData, cacheBLOCK_SIZE );
+		pxEntry->uxHolders--;
+	}
+
+	( void ) xSemaphoreGive( xCacheMutex );
+
+	return xResult;
+}
+/*----------------------------------------------------------------------------*/
+
+portBASE_TYPE xBlockCacheWrite( unsigned long ulBlock, unsigned long ulCount, const void *pvBuffer )
+{
+const unsigned char *pucBuffer = ( const unsigned char * ) pvBuffer;
+xCacheEntry *pxEntry;
+unsigned long ul;
+portBASE_TYPE xResult = pdPASS;
+
+	( void ) xSemaphoreTake( xCacheMutex, portMAX_DELAY );
+
+	for( ul = 0UL; ul < ulCount; ul++ )
+	{
+		pxEntry = prvCacheGet( ulBlock + ul, pdTRUE, 1UL );
+		if( NULL == pxEntry )
+		{
+			xResult = pdFAIL;
+			break;
+		}
+
+		memcpy( pxEntry->pucData, pucBuffer + ul * cacheBLOCK_SIZE, cacheBLOCK_SIZE );
+		pxEntry->xDirty = pdTRUE;
+		pxEntry->uxHolders--;
+	}
+
+	( void ) xSemaphoreGive( xCacheMutex );
+
+	return xResult;
+}
+/*----------------------------------------------------------------------------*/
+
+portBASE_TYPE xBlockCacheWriteThrough( unsigned long ulBlock, unsigned long ulCount, const void *pvBuffer )
+{
+const unsigned char *pucBuffer = ( const unsigned char * ) pvBuffer;
+xCacheEntry *pxEntry;
+unsigned long ul;
+portBASE_TYPE xResult;
+
+	( void ) xSemaphoreTake( xCacheMutex, portMAX_DELAY );
+
+	/* One write through at a time, and none while a copy of one of the blocks
+	is busy. */
+	while( ( 0UL != ulCacheThroughCount ) || ( pdFALSE != prvCacheRangeBusy( ulBlock, ulCount ) ) )
+	{
+		prvCacheWaitForIO();
+	}
+
+	/* The copies are busy until the write ends, and dirty again if it
+	fails.  Blocks that are not in the cache are not read in meanwhile. */
+	ulCacheThroughBlock = ulBlock;
+	ulCacheThroughCount = ulCount;
+	for( ul = 0UL; ul < ulCount; ul++ )
+	{
+		pxEntry = prvCacheFind( ulBlock + ul );
+		if( NULL != pxEntry )
+		{
+			memcpy( pxEntry->pucData, pucBuffer + ul * cacheBLOCK_SIZE, cacheBLOCK_SIZE );
+			pxEntry->xDirty = pdFALSE;
+			pxEntry->xBusy = pdTRUE;
+		}
+	}
+
+	( void ) xSemaphoreGive( xCacheMutex );
+	xResult = xMMCIWrite( ulBlock, ulCount, pvBuffer );
+	( void ) xSemaphoreTake( xCacheMutex, portMAX_DELAY );
+
+	for( ul = 0UL; ul < ulCount; ul++ )
+	{
+		pxEntry = prvCacheFind( ulBlock + ul );
+		if( NULL != pxEntry )
+		{
+			pxEntry->xBusy = pdFALSE;
+			if( pdPASS != xResult )
+			{
+				pxEntry->xDirty = pdTRUE;
+			}
+		}
+	}
+	ulCacheThroughCount = 0UL;
+	prvCacheIODone();
+
+	( void ) xSemaphoreGive( xCacheMutex );
+
+	return xResult;
+}
+/*----------------------------------------------------------------------------*/
+
+unsigned char *pucBlockCacheGet( unsigned long ulBlock, portBASE_TYPE xOverwrite )
+{
+xCacheEntry *pxEntry;
+
+	( void ) xSemaphoreTake( xCacheMutex, portMAX_DELAY );
+	pxEntry = prvCacheGet( ulBlock, xOverwrite, 1UL );
+	( void ) xSemaphoreGive( xCacheMutex );
+
+	return ( NULL != pxEntry ) ? pxEntry->pucData : NULL;
+}
+/*----------------------------------------------------------------------------*/
+
+void vBlockCacheRelease( unsigned char *pucBlock, portBASE_TYPE xDirty )
+{
+xCacheEntry *pxEntry = &xCacheEntries[ ( unsigned long ) ( pucBlock - pucCacheData ) / cacheBLOCK_SIZE ];
+
+	( void ) xSemaphoreTake( xCacheMutex, portMAX_DELAY );
+
+	configASSERT( pxEntry->uxHolders > 0U );
+	pxEntry->uxHolders--;
+	if( pdFALSE != xDirty )
+	{
+		pxEntry->xDirty = pdTRUE;
+	}
+
+	( void ) xSemaphoreGive( xCacheMutex );
+}
+/*----------------------------------------------------------------------------*/
+
+portBASE_TYPE xBlockCacheFlush( void )
+{
+unsigned portBASE_TYPE ux;
+portBASE_TYPE xResult = pdPASS;
+
+	( void ) xSemaphoreTake( xCacheMutex, portMAX_DELAY );
+
+	for( ux = 0U; ux < cacheENTRIES; ux++ )
+	{
+		/* A busy entry may be being written back by another task, which has
+		to have finished before the block counts as flushed. */
+		while( pdFALSE != xCacheEntries[ ux ].xBusy )
+		{
+			prvCacheWaitForIO();
+		}
+
+		if( ( pdFALSE != xCacheEntries[ ux ].xValid ) && ( pdFALSE != xCacheEntries[ ux ].xDirty ) &&
+			( pdFAIL == prvCacheWriteBack( &xCacheEntries[ ux ] ) ) )
+		{
+			xResult = pdFAIL;
+		}
+	}
+
+	( void ) xSemaphoreGive( xCacheMutex );
+
+	return xResult;
+}
+/*----------------------------------------------------------------------------*/
+
+portBASE_TYPE xBlockCacheInvalidate( void )
+{
+xCacheEntry *pxEntry;
+unsigned portBASE_TYPE ux;
+portBASE_TYPE xResult = xBlockCacheFlush();
+
+	( void ) xSemaphoreTake( xCacheMutex, portMAX_DELAY );
+
+	for( ux = 0U; ux < cacheENTRIES; ux++ )
+	{
+		pxEntry = &xCacheEntries[ ux ];
+		if( ( pdFALSE != pxEntry->xValid ) && ( pdFALSE == pxEntry->xDirty ) && ( 0U == pxEntry->uxHolders ) && ( pdFALSE == pxEntry->xBusy ) )
+		{
+			prvCacheRemoveFromBucket( pxEntry );
+			pxEntry->xValid = pdFALSE;
+			prvCacheMakeOldest( pxEntry );
+		}
+	}
+	ulCacheNextBlock = 0UL;
+
+	( void ) xSemaphoreGive( xCacheMutex );
+
+	return xResult;
+}
+/*----------------------------------------------------------------------------*/
+
+void vBlockCacheGetStats( xBlockCacheStats *pxStats )
+{
+	( void ) xSemaphoreTake( xCacheMutex, portMAX_DELAY );
+	*pxStats = xCacheStats;
+	( void ) xSemaphoreGive( xCacheMutex );
+}
+/*----------------------------------------------------------------------------*/
+
+static xCacheEntry *prvCacheGet( unsigned long ulBlock, portBASE_TYPE xOverwrite, unsigned long ulWanted )
+{
+xCacheEntry *pxEntries[ cacheREAD_AHEAD ];
+unsigned char *pucBlocks[ cacheREAD_AHEAD ];
+xCacheEntry *pxEntry;
+unsigned long ulCount, ulMost, ul;
+portBASE_TYPE xResult;
+
+	if( 0UL == ulCacheBlockCount )
+	{
+		ulCacheBlockCount = ulMMCIGetBlockCount();
+	}
+
+	if( ulBlock >= ulCacheBlockCount )
+	{
+		return NULL;
+	}
+
+	/* Wait for a copy that is busy, or for a write through of the block, to
+	finish. */
+	while( pdFALSE != prvCacheRangeBusy( ulBlock, 1UL ) )
+	{
+		prvCacheWaitForIO();
+	}
+	pxEntry = prvCacheFind( ulBlock );
+
+	if( NULL != pxEntry )
+	{
+		xCacheStats.ulHits++;
+	}
+	else
+	{
+		xCacheStats.ulMisses++;
+
+		/* Read ahead if the reads are sequential, or the caller is about to
+		read on anyway. */
+		ulMost = 1UL;
+		if( pdFALSE == xOverwrite )
+		{
+			ulMost = ( ulBlock == ulCacheNextBlock ) ? cacheREAD_AHEAD : ulWanted;
+			if( ulMost > cacheREAD_AHEAD )
+			{
+				ulMost = cacheREAD_AHEAD;
+			}
+		}
+
+		/* Stop at the end of the card and at a block already in the cache.
+		Each entry taken goes into its bucket straight away, busy, so no
+		other task reads the same block into a second one.  Making room may
+		have meant a write back, during which another task may have brought
+		the block in itself. */
+		for( ulCount = 0UL; ulCount < ulMost; ulCount++ )
+		{
+			if( ( ulCount > 0UL ) && ( ( ulBlock + ulCount >= ulCacheBlockCount ) || ( NULL != prvCacheFind( ulBlock + ulCount ) ) ||
+									   ( pdFALSE != prvCacheRangeBusy( ulBlock + ulCount, 1UL ) ) ) )
+			{
+				break;
+			}
+
+			pxEntry = prvCacheEvict( ( 0UL == ulCount ) ? pdTRUE : pdFALSE );
+			if( NULL == pxEntry )
+			{
+				break;
+			}
+
+			if( ( NULL != prvCacheFind( ulBlock + ulCount ) ) || ( pdFALSE != prvCacheRangeBusy( ulBlock + ulCount, 1UL ) ) )
+			{
+				prvCacheMakeOldest( pxEntry );
+				break;
+			}
+
+			pxEntry->ulBlock = ulBlock + ulCount;
+			pxEntry->xValid = pdTRUE;
+			pxEntry->xDirty = pdFALSE;
+			pxEntry->xBusy = pdTRUE;
+			pxEntry->pxNextInBucket = pxCacheBuckets[ cacheBUCKET( pxEntry->ulBlock ) ];
+			pxCacheBuckets[ cacheBUCKET( pxEntry->ulBlock ) ] = pxEntry;
+
+			pxEntries[ ulCount ] = pxEntry;
+			pucBlocks[ ulCount ] = pxEntry->pucData;
+		}
+
+		if( 0UL == ulCount )
+		{
+			/* Either there was no room, or the block came in meanwhile. */
+			if( ( NULL != prvCacheFind( ulBlock ) ) || ( pdFALSE != prvCacheRangeBusy( ulBlock, 1UL ) ) )
+			{
+				return prvCacheGet( ulBlock, xOverwrite, ulWanted );
+			}
+			return NULL;
+		}
+
+		xResult = pdPASS;
+		if( pdFALSE == xOverwrite )
+		{
+			( void ) xSemaphoreGive( xCacheMutex );
+			xResult = xMMCIReadBlocks( ulBlock, ulCount, pucBlocks );
+			( void ) xSemaphoreTake( xCacheMutex, portMAX_DELAY );
+		}
+
+		/* Newest last, so the block asked for goes ahead of those read after
+		it. */
+		for( ul = ulCount; ul-- > 0UL; )
+		{
+			pxEntry = pxEntries[ ul ];
+			pxEntry->xBusy = pdFALSE;
+
+			if( pdPASS == xResult )
+			{
+				prvCacheMakeNewest( pxEntry );
+			}
+			else
+			{
+				prvCacheRemoveFromBucket( pxEntry );
+				pxEntry->xValid = pdFALSE;
+				prvCacheMakeOldest( pxEntry );
+			}
+		}
+
+		prvCacheIODone();
+
+		if( pdPASS != xResult )
+		{
+			return NULL;
+		}
+
+		xCacheStats.ulReadAhead += ulCount - 1UL;
+	}
+
+	prvCacheMakeNewest( pxEntry );
+	pxEntry->uxHolders++;
+
+	if( pdFALSE == xOverwrite )
+	{
+		ulCacheNextBlock = ulBlock + 1UL;
+	}
+
+	return pxEntry;
+}
+/*----------------------------------------------------------------------------*/
+
+static xCacheEntry *prvCacheFind( unsigned long ulBlock )
+{
+xCacheEntry *pxEntry;
+
+	for( pxEntry = pxCacheBuckets[ cacheBUCKET( ulBlock ) ]; NULL != pxEntry; pxEntry = pxEntry->pxNextInBucket )
+	{
+		if( ulBlock == pxEntry->ulBlock )
+		{
+			break;
+		}
+	}
+
+	return pxEntry;
+}
+/*----------------------------------------------------------------------------*/
+
+static xCacheEntry *prvCacheEvict( portBASE_TYPE xWait )
+{
+xCacheEntry *pxEntry = pxCacheOldest;
+portBASE_TYPE xSawBusy = pdFALSE;
+
+	while( NULL != pxEntry )
+	{
+		if( pdFALSE != pxEntry->xBusy )
+		{
+			xSawBusy = pdTRUE;
+		}
+		else if( 0U == pxEntry->uxHolders )
+		{
+			if( ( pdFALSE != pxEntry->xValid ) && ( pdFALSE != pxEntry->xDirty ) )
+			{
+				/* The write back releases the mutex, so the order may have
+				changed by the time it ends. */
+				if( pdFAIL == prvCacheWriteBack( pxEntry ) )
+				{
+					return NULL;
+				}
+
+				pxEntry = pxCacheOldest;
+				xSawBusy = pdFALSE;
+				continue;
+			}
+
+			if( pdFALSE != pxEntry->xValid )
+			{
+				prvCacheRemoveFromBucket( pxEntry );
+				pxEntry->xValid = pdFALSE;
+			}
+
+			return pxEntry;
+		}
+
+		pxEntry = pxEntry->pxNewer;
+
+		if( ( NULL == pxEntry ) && ( pdFALSE != xWait ) && ( pdFALSE != xSawBusy ) )
+		{
+			prvCacheWaitForIO();
+			pxEntry = pxCacheOldest;
+			xSawBusy = pdFALSE;
+		}
+	}
+
+	return NULL;
+}
+/*----------------------------------------------------------------------------*/
+
+static portBASE_TYPE prvCacheWriteBack( xCacheEntry *pxEntry )
+{
+xCacheEntry *pxRun[ cacheWRITE_BACK ];
+unsigned char *pucBlocks[ cacheWRITE_BACK ];
+xCacheEntry *pxOther;
+unsigned long ulFirst = pxEntry->ulBlock;
+unsigned long ulCount, ul;
+
+portBASE_TYPE xResult;
+
+	/* Back to the first dirty block of the run, keeping pxEntry in reach. */
+	while( ( ulFirst > 0UL ) && ( pxEntry->ulBlock - ulFirst < cacheWRITE_BACK - 1UL ) )
+	{
+		pxOther = prvCacheFind( ulFirst - 1UL );
+		if( ( NULL == pxOther ) || ( pdFALSE == pxOther->xDirty ) || ( pdFALSE != pxOther->xBusy ) )
+		{
+			break;
+		}
+		ulFirst--;
+	}
+
+	for( ulCount = 0UL; ulCount < cacheWRITE_BACK; ulCount++ )
+	{
+		pxOther = prvCacheFind( ulFirst + ulCount );
+		if( ( NULL == pxOther ) || ( pdFALSE == pxOther->xDirty ) || ( pdFALSE != pxOther->xBusy ) )
+		{
+			break;
+		}
+		pxRun[ ulCount ] = pxOther;
+		pucBlocks[ ulCount ] = pxOther->pucData;
+		pxOther->xDirty = pdFALSE;
+		pxOther->xBusy = pdTRUE;
+	}
+
+	( void ) xSemaphoreGive( xCacheMutex );
+	xResult = xMMCIWriteBlocks( ulFirst, ulCount, pucBlocks );
+	( void ) xSemaphoreTake( xCacheMutex, portMAX_DELAY );
+
+	for( ul = 0UL; ul < ulCount; ul++ )
+	{
+		pxRun[ ul ]->xBusy = pdFALSE;
+		if( pdPASS != xResult )
+		{
+			pxRun[ ul ]->xDirty = pdTRUE;
+		}
+	}
+
+	prvCacheIODone();
+
+	if( pdPASS != xResult )
+	{
+		return pdFAIL;
+	}
+
+	xCacheStats.ulWriteBacks++;
+	xCacheStats.ulBlocksWritten += ulCount;
+
+	return pdPASS;
+}
+/*----------------------------------------------------------------------------*/
+
+static portBASE_TYPE prvCacheRangeBusy( unsigned long ulBlock, unsigned long ulCount )
+{
+xCacheEntry *pxEntry;
+unsigned long ul;
+
+	if( ( 0UL != ulCacheThroughCount ) && ( ulBlock < ulCacheThroughBlock + ulCacheThroughCount ) && ( ulCacheThroughBlock < ulBlock + ulCount ) )
+	{
+		return pdTRUE;
+	}
+
+	for( ul = 0UL; ul < ulCount; ul++ )
+	{
+		pxEntry = prvCacheFind( ulBlock + ul );
+		if( ( NULL != pxEntry ) && ( pdFALSE != pxEntry->xBusy ) )
+		{
+			return pdTRUE;
+		}
+	}
+
+	return pdFALSE;
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvCacheWaitForIO( void )
+{
+	uxCacheWaiters++;
+	( void ) xSemaphoreGive( xCacheMutex );
+	( void ) xSemaphoreTake( xCacheIODone, portMAX_DELAY );
+	( void ) xSemaphoreTake( xCacheMutex, portMAX_DELAY );
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvCacheIODone( void )
+{
+	while( uxCacheWaiters > 0U )
+	{
+		( void ) xSemaphoreGive( xCacheIODone );
+		uxCacheWaiters--;
+	}
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvCacheUnlink( xCacheEntry *pxEntry )
+{
+	if( NULL != pxEntry->pxNewer )
+	{
+		pxEntry->pxNewer->pxOlder = pxEntry->pxOlder;
+	}
+	else if( pxCacheNewest == pxEntry )
+	{
+		pxCacheNewest = pxEntry->pxOlder;
+	}
+
+	if( NULL != pxEntry->pxOlder )
+	{
+		pxEntry->pxOlder->pxNewer = pxEntry->pxNewer;
+	}
+	else if( pxCacheOldest == pxEntry )
+	{
+		pxCacheOldest = pxEntry->pxNewer;
+	}
+
+	pxEntry->pxNewer = NULL;
+	pxEntry->pxOlder = NULL;
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvCacheMakeNewest( xCacheEntry *pxEntry )
+{
+	prvCacheUnlink( pxEntry );
+
+	pxEntry->pxOlder = pxCacheNewest;
+	if( NULL != pxCacheNewest )
+	{
+		pxCacheNewest->pxNewer = pxEntry;
+	}
+	else
+	{
+		pxCacheOldest = pxEntry;
+	}
+	pxCacheNewest = pxEntry;
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvCacheMakeOldest( xCacheEntry *pxEntry )
+{
+	prvCacheUnlink( pxEntry );
+
+	pxEntry->pxNewer = pxCacheOldest;
+	if( NULL != pxCacheOldest )
+	{
+		pxCacheOldest->pxOlder = pxEntry;
+	}
+	else
+	{
+		pxCacheNewest = pxEntry;
+	}
+	pxCacheOldest = pxEntry;
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvCacheRemoveFromBucket( xCacheEntry *pxEntry )
+{
+xCacheEntry **ppxLink = &pxCacheBuckets[ cacheBUCKET( pxEntry->ulBlock ) ];
+
+	while( pxEntry != *ppxLink )
+	{
+		ppxLink = &( *ppxLink )->pxNextInBucket;
+	}
+	*ppxLink = pxEntry->pxNextInBucket;
+	pxEntry->pxNextInBucket = NULL;
+}
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,150 @@
+/*
+    FreeRTOS V7.0.1 - Copyright (C) 2011 Real Time Engineers Ltd.
+
+
+	FreeRTOS supports many tools and architectures. V7.0.0 is sponsored by:
+	Atollic AB - Atollic provides professional embedded systems development
+	tools for C/C++ development, code analysis and test automation.
+	See http://www.atollic.com
+
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS tutorial books are available in pdf and paperback.        *
+     *    Complete, revised, and edited pdf reference manuals are also       *
+     *    available.                                                         *
+     *                                                                       *
+     *    Purchasing FreeRTOS documentation will not only help you, by       *
+     *    ensuring you get running as quickly as possible and with an        *
+     *    in-depth knowledge of how to use FreeRTOS, it will also help       *
+     *    the FreeRTOS project to continue with its mission of providing     *
+     *    professional grade, cross platform, de facto standard solutions    *
+     *    for microcontrollers - completely free of charge!                  *
+     *                                                                       *
+     *    >>> See http://www.FreeRTOS.org/Documentation for details. <<<     *
+     *                                                                       *
+     *    Thank you for using FreeRTOS, and thank you for your support!      *
+     *                                                                       *
+    ***************************************************************************
+
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation AND MODIFIED BY the FreeRTOS exception.
+    >>>NOTE<<< The modification to the GPL is included to allow you to
+    distribute a combined work that includes FreeRTOS without being obliged to
+    provide the source code for proprietary components outside of the FreeRTOS
+    kernel.  FreeRTOS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details. You should have received a copy of the GNU General Public
+    License and the FreeRTOS license exception along with FreeRTOS; if not it
+    can be viewed here: http://www.freertos.org/a00114.html and also obtained
+    by writing to Richard Barry, contact details for whom are available on the
+    FreeRTOS WEB site.
+
+    1 tab == 4 spaces!
+
+    http://www.FreeRTOS.org - Documentation, latest information, license and
+    contact details.
+
+    http://www.SafeRTOS.com - A version that is certified for use in safety
+    critical systems.
+
+    http://www.OpenRTOS.com - Commercial support, development, porting,
+    licensing and training services.
+*/
+
+
+#ifndef BLOCKCACHE_H
+#define BLOCKCACHE_H
+
+/* A write-back cache of SD card blocks, shared by all tasks.
+
+Blocks are kept in least recently used order, and the oldest that no task
+holds makes room for a new one.  A written block is only marked dirty, and
+goes to the card when it is evicted or flushed, together with the dirty blocks
+around it in one multiple block write.  A miss that carries on from the block
+read before it, or that starts a read of several blocks, also reads the
+blocks after it with the same command, so a file read a block at a time costs
+one command every cacheREAD_AHEAD blocks.
+
+A mutex guards the cache.  It is released while the card is read or written,
+so other tasks can use the rest of the cache and queue their own requests at
+the driver meanwhile; the blocks being transferred are busy until it ends, and
+a task that needs one of them waits. */
+
+#include "pl181_mmci.h"
+
+#define cacheBLOCK_SIZE				( mmciBLOCK_SIZE )
+
+#ifndef cacheENTRIES
+	#define cacheENTRIES			( 32 )
+#endif
+
+/* Most blocks read by one miss, counting the one asked for. */
+#ifndef cacheREAD_AHEAD
+	#define cacheREAD_AHEAD			( 8 )
+#endif
+
+/* Most blocks written back by one command. */
+#ifndef cacheWRITE_BACK
+	#define cacheWRITE_BACK			( 16 )
+#endif
+
+typedef struct BLOCK_CACHE_STATISTICS
+{
+	unsigned long ulHits;
+	unsigned long ulMisses;
+	unsigned long ulReadAhead;		/* Blocks read before they were asked for. */
+	unsigned long ulWriteBacks;		/* Write commands, */
+	unsigned long ulBlocksWritten;	/* and the blocks they wrote. */
+} xBlockCacheStats;
+
+/*
+ * Allocate the cache.  The card is not touched until the first access.
+ */
+portBASE_TYPE xBlockCacheInitialise( void );
+
+/*
+ * Copy ulCount blocks, starting at block ulBlock, out of or into the cache,
+ * reading from the card those that are not in it.  Written blocks are only
+ * marked dirty.
+ */
+portBASE_TYPE xBlockCacheRead( unsigned long ulBlock, unsigned long ulCount, void *pvBuffer );
+portBASE_TYPE xBlockCacheWrite( unsigned long ulBlock, unsigned long ulCount, const void *pvBuffer );
+
+/*
+ * Write ulCount blocks straight to the card with one command, for data that is
+ * written once and not read back soon.  Copies of the blocks that are in the
+ * cache are updated, but no others are brought in.
+ */
+portBASE_TYPE xBlockCacheWriteThrough( unsigned long ulBlock, unsigned long ulCount, const void *pvBuffer );
+
+/*
+ * Hold block ulBlock in the cache and return its cacheBLOCK_SIZE bytes, or
+ * NULL if it could not be read.  The block is read and changed in place, and
+ * stays in the cache until it is given back to vBlockCacheRelease(), with
+ * xDirty set if it was changed.  Tasks holding the same block share it.  If
+ * xOverwrite is set the caller is going to fill the whole block, so it is not
+ * read from the card.
+ */
+unsigned char *pucBlockCacheGet( unsigned long ulBlock, portBASE_TYPE xOverwrite );
+void vBlockCacheRelease( unsigned char *pucBlock, portBASE_TYPE xDirty );
+
+/*
+ * Write all the dirty blocks to the card.
+ */
+portBASE_TYPE xBlockCacheFlush( void );
+
+/*
+ * Flush, then forget every block no task holds, for when the card has been
+ * written around the cache.
+ */
+portBASE_TYPE xBlockCacheInvalidate( void );
+
+void vBlockCacheGetStats( xBlockCacheStats *pxStats );
+
+#endif /* BLOCKCACHE_H */
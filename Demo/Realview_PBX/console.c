@@ -0,0 +1,211 @@
+/*
+    FreeRTOS V7.0.1 - Copyright (C) 2011 Real Time Engineers Ltd.
+
+
+	FreeRTOS supports many tools and architectures. V7.0.0 is sponsored by:
+	Atollic AB - Atollic provides professional embedded systems development
+	tools for C/C++ development, code analysis and test automation.
+	See http://www.atollic.com
+
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS tutorial books are available in pdf and paperback.        *
+     *    Complete, revised, and edited pdf reference manuals are also       *
+     *    available.                                                         *
+     *                                                                       *
+     *    Purchasing FreeRTOS documentation will not only help you, by       *
+     *    ensuring you get running as quickly as possible and with an        *
+     *    in-depth knowledge of how to use FreeRTOS, it will also help       *
+     *    the FreeRTOS project to continue with its mission of providing     *
+     *    professional grade, cross platform, de facto standard solutions    *
+     *    for microcontrollers - completely free of charge!                  *
+     *                                                                       *
+     *    >>> See http://www.FreeRTOS.org/Documentation for details. <<<     *
+     *                                                                       *
+     *    Thank you for using FreeRTOS, and thank you for your support!      *
+     *                                                                       *
+    ***************************************************************************
+
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation AND MODIFIED BY the FreeRTOS exception.
+    >>>NOTE<<< The modification to the GPL is included to allow you to
+    distribute a combined work that includes FreeRTOS without being obliged to
+    provide the source code for proprietary components outside of the FreeRTOS
+    kernel.  FreeRTOS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details. You should have received a copy of the GNU General Public
+    License and the FreeRTOS license exception along with FreeRTOS; if not it
+    can be viewed here: http://www.freertos.org/a00114.html and also obtained
+    by writing to Richard Barry, contact details for whom are available on the
+    FreeRTOS WEB site.
+
+    1 tab == 4 spaces!
+
+    http://www.FreeRTOS.org - Documentation, latest information, license and
+    contact details.
+
+    http://www.SafeRTOS.com - A version that is certified for use in safety
+    critical systems.
+
+    http://www.OpenRTOS.com - Commercial support, development, porting,
+    licensing and training services.
+*/
+
+/* Console line discipline, run from the UART receive interrupt. */
+
+#include "FreeRTOS.h"
+#include "queue.h"
+
+#include "pl011.h"
+#include "console.h"
+/*----------------------------------------------------------------------------*/
+
+#define consoleBACKSPACE			( 0x08 )
+#define consoleDELETE				( 0x7F )
+#define consoleKILL_LINE			( 0x15 )		/* Ctrl-U */
+#define consoleBELL					( 0x07 )
+
+/* Echo is gathered here and written to the UART once per interrupt. */
+#define consoleECHO_BUFFER_SIZE		( 64UL )
+/*----------------------------------------------------------------------------*/
+
+typedef struct CONSOLE
+{
+	unsigned long ulUARTPeripheral;
+	xQueueHandle xLines;
+	char cLine[ consoleLINE_LENGTH ];
+	unsigned long ulLength;
+	unsigned char ucLast;				/* To treat CR LF as one end of line. */
+	unsigned char ucEcho[ consoleECHO_BUFFER_SIZE ];
+	unsigned long ulEcho;
+	volatile unsigned long ulDroppedLines;
+} xConsole;
+
+/* Only touched by the UART interrupt once initialised. */
+static xConsole xConsoleState;
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Edit the line with the bytes received by the UART interrupt.
+ */
+static void prvConsoleReceive( void *pvContext, const unsigned char *pucBytes, unsigned long ulLength, portBASE_TYPE *pxHigherPriorityTaskWoken );
+
+/*
+ * Queue echo for the terminal, writing out what is queued when it is full.
+ */
+static void prvConsoleEcho( xConsole *pxConsole, const char *pcText, unsigned long ulLength );
+static void prvConsoleFlushEcho( xConsole *pxConsole );
+/*----------------------------------------------------------------------------*/
+
+void vConsoleInitialise( unsigned long ulUARTPeripheral )
+{
+	xConsoleState.ulUARTPeripheral = ulUARTPeripheral;
+	xConsoleState.xLines = xQueueCreate( consoleLINE_QUEUE_LENGTH, consoleLINE_LENGTH );
+	configASSERT( xConsoleState.xLines );
+
+	vUARTSetReceiveHook( ulUARTPeripheral, prvConsoleReceive, &xConsoleState );
+}
+/*----------------------------------------------------------------------------*/
+
+portBASE_TYPE xConsoleReadLine( char *pcLine, portTickType xDelay )
+{
+	return ( pdTRUE == xQueueReceive( xConsoleState.xLines, pcLine, xDelay ) ) ? pdTRUE : pdFALSE;
+}
+/*----------------------------------------------------------------------------*/
+
+unsigned long ulConsoleDroppedLines( void )
+{
+	return xConsoleState.ulDroppedLines;
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvConsoleEcho( xConsole *pxConsole, const char *pcText, unsigned long ulLength )
+{
+	while( ulLength-- > 0UL )
+	{
+		if( pxConsole->ulEcho == consoleECHO_BUFFER_SIZE )
+		{
+			prvConsoleFlushEcho( pxConsole );
+		}
+		pxConsole->ucEcho[ pxConsole->ulEcho++ ] = ( unsigned char ) *pcText++;
+	}
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvConsoleFlushEcho( xConsole *pxConsole )
+{
+	/* A delay of 0 never blocks, which is all an interrupt may do. */
+	( void ) ulUARTWrite( pxConsole->ulUARTPeripheral, pxConsole->ucEcho, pxConsole->ulEcho, 0 );
+	pxConsole->ulEcho = 0UL;
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvConsoleReceive( void *pvContext, const unsigned char *pucBytes, unsigned long ulLength, portBASE_TYPE *pxHigherPriorityTaskWoken )
+{
+xConsole *pxConsole = ( xConsole * ) pvContext;
+unsigned long ulByte;
+unsigned char ucByte;
+char cChar;
+
+	for( ulByte = 0UL; ulByte < ulLength; ulByte++ )
+	{
+		ucByte = pucBytes[ ulByte ];
+
+		if( ( '\r' == ucByte ) || ( '\n' == ucByte ) )
+		{
+			/* Either ends the line, but not both in turn. */
+			if( !( ( '\n' == ucByte ) && ( '\r' == pxConsole->ucLast ) ) )
+			{
+				prvConsoleEcho( pxConsole, "\r\n", 2UL );
+				pxConsole->cLine[ pxConsole->ulLength ] = '\0';
+
+				if( pdTRUE != xQueueSendFromISR( pxConsole->xLines, pxConsole->cLine, pxHigherPriorityTaskWoken ) )
+				{
+					pxConsole->ulDroppedLines++;
+				}
+				pxConsole->ulLength = 0UL;
+			}
+		}
+		else if( ( consoleBACKSPACE == ucByte ) || ( consoleDELETE == ucByte ) )
+		{
+			if( pxConsole->ulLength > 0UL )
+			{
+				pxConsole->ulLength--;
+				prvConsoleEcho( pxConsole, "\b \b", 3UL );
+			}
+		}
+		else if( consoleKILL_LINE == ucByte )
+		{
+			while( pxConsole->ulLength > 0UL )
+			{
+				pxConsole->ulLength--;
+				prvConsoleEcho( pxConsole, "\b \b", 3UL );
+			}
+		}
+		else if( ( ucByte >= ' ' ) && ( ucByte < consoleDELETE ) )
+		{
+			if( pxConsole->ulLength < ( consoleLINE_LENGTH - 1 ) )
+			{
+				cChar = ( char ) ucByte;
+				pxConsole->cLine[ pxConsole->ulLength++ ] = cChar;
+				prvConsoleEcho( pxConsole, &cChar, 1UL );
+			}
+			else
+			{
+				cChar = consoleBELL;
+				prvConsoleEcho( pxConsole, &cChar, 1UL );
+			}
+		}
+
+		/* Other control characters are ignored. */
+		pxConsole->ucLast = ucByte;
+	}
+
+	prvConsoleFlushEcho( pxConsole );
+}
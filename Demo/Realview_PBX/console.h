@@ -0,0 +1,96 @@
+/*
+    FreeRTOS V7.0.1 - Copyright (C) 2011 Real Time Engineers Ltd.
+
+
+	FreeRTOS supports many tools and architectures. V7.0.0 is sponsored by:
+	Atollic AB - Atollic provides professional embedded systems development
+	tools for C/C++ development, code analysis and test automation.
+	See http://www.atollic.com
+
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS tutorial books are available in pdf and paperback.        *
+     *    Complete, revised, and edited pdf reference manuals are also       *
+     *    available.                                                         *
+     *                                                                       *
+     *    Purchasing FreeRTOS documentation will not only help you, by       *
+     *    ensuring you get running as quickly as possible and with an        *
+     *    in-depth knowledge of how to use FreeRTOS, it will also help       *
+     *    the FreeRTOS project to continue with its mission of providing     *
+     *    professional grade, cross platform, de facto standard solutions    *
+     *    for microcontrollers - completely free of charge!                  *
+     *                                                                       *
+     *    >>> See http://www.FreeRTOS.org/Documentation for details. <<<     *
+     *                                                                       *
+     *    Thank you for using FreeRTOS, and thank you for your support!      *
+     *                                                                       *
+    ***************************************************************************
+
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation AND MODIFIED BY the FreeRTOS exception.
+    >>>NOTE<<< The modification to the GPL is included to allow you to
+    distribute a combined work that includes FreeRTOS without being obliged to
+    provide the source code for proprietary components outside of the FreeRTOS
+    kernel.  FreeRTOS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details. You should have received a copy of the GNU General Public
+    License and the FreeRTOS license exception along with FreeRTOS; if not it
+    can be viewed here: http://www.freertos.org/a00114.html and also obtained
+    by writing to Richard Barry, contact details for whom are available on the
+    FreeRTOS WEB site.
+
+    1 tab == 4 spaces!
+
+    http://www.FreeRTOS.org - Documentation, latest information, license and
+    contact details.
+
+    http://www.SafeRTOS.com - A version that is certified for use in safety
+    critical systems.
+
+    http://www.OpenRTOS.com - Commercial support, development, porting,
+    licensing and training services.
+*/
+
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+/* Line discipline for the console UART.  The UART interrupt echoes what is
+typed, handles backspace and assembles the line, and the task reading the
+console is only woken once a whole line has been entered. */
+
+/* The longest line kept, including the terminating null.  Characters typed
+beyond it are refused with a bell. */
+#ifndef consoleLINE_LENGTH
+	#define consoleLINE_LENGTH			( 80 )
+#endif
+
+/* Complete lines waiting to be read.  Lines entered while it is full are
+dropped. */
+#ifndef consoleLINE_QUEUE_LENGTH
+	#define consoleLINE_QUEUE_LENGTH	( 2 )
+#endif
+
+/*
+ * Take over the receive side of a UART that vUARTInitialise() has set up.
+ */
+void vConsoleInitialise( unsigned long ulUARTPeripheral );
+
+/*
+ * Wait up to xDelay ticks for a line, and copy it, null terminated and without
+ * its end of line, into pcLine, which must hold consoleLINE_LENGTH characters.
+ * Returns pdFALSE if no line was entered in time.
+ */
+portBASE_TYPE xConsoleReadLine( char *pcLine, portTickType xDelay );
+
+/*
+ * The number of lines dropped because nobody was reading them.
+ */
+unsigned long ulConsoleDroppedLines( void );
+
+#endif /* CONSOLE_H */
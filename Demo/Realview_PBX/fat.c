@@ -0,0 +1,1610 @@
+/*
+    FreeRTOS V7.0.1 - Copyright (C) 2011 Real Time Engineers Ltd.
+
+
+	FreeRTOS supports many tools and architectures. V7.0.0 is sponsored by:
+	Atollic AB - Atollic provides professional embedded systems development
+	tools for C/C++ development, code analysis and test automation.
+	See http://www.atollic.com
+
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS tutorial books are available in pdf and paperback.        *
+     *    Complete, revised, and edited pdf reference manuals are also       *
+     *    available.                                                         *
+     *                                                                       *
+     *    Purchasing FreeRTOS documentation will not only help you, by       *
+     *    ensuring you get running as quickly as possible and with an        *
+     *    in-depth knowledge of how to use FreeRTOS, it will also help       *
+     *    the FreeRTOS project to continue with its mission of providing     *
+     *    professional grade, cross platform, de facto standard solutions    *
+     *    for microcontrollers - completely free of charge!                  *
+     *                                                                       *
+     *    >>> See http://www.FreeRTOS.org/Documentation for details. <<<     *
+     *                                                                       *
+     *    Thank you for using FreeRTOS, and thank you for your support!      *
+     *                                                                       *
+    ***************************************************************************
+
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation AND MODIFIED BY the FreeRTOS exception.
+    >>>NOTE<<< The modification to the GPL is included to allow you to
+    distribute a combined work that includes FreeRTOS without being obliged to
+    provide the source code for proprietary components outside of the FreeRTOS
+    kernel.  FreeRTOS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details. You should have received a copy of the GNU General Public
+    License and the FreeRTOS license exception along with FreeRTOS; if not it
+    can be viewed here: http://www.freertos.org/a00114.html and also obtained
+    by writing to Richard Barry, contact details for whom are available on the
+    FreeRTOS WEB site.
+
+    1 tab == 4 spaces!
+
+    http://www.FreeRTOS.org - Documentation, latest information, license and
+    contact details.
+
+    http://www.SafeRTOS.com - A version that is certified for use in safety
+    critical systems.
+
+    http://www.OpenRTOS.com - Commercial support, development, porting,
+    licensing and training services.
+*/
+
+
+/* FAT16 and FAT32 File System over the Block Cache. */
+
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#include "blockcache.h"
+#include "fat.h"
+/*----------------------------------------------------------------------------*/
+
+#define fatSECTOR_SIZE				( cacheBLOCK_SIZE )
+#define fatENTRY_SIZE				( 32UL )
+#define fatNAME_SIZE				( 11UL )
+
+/* Boot sector fields. */
+#define fatBS_JUMP					( 0 )
+#define fatBS_BYTES_PER_SECTOR		( 11 )
+#define fatBS_SECTORS_PER_CLUSTER	( 13 )
+#define fatBS_RESERVED_SECTORS		( 14 )
+#define fatBS_FAT_COUNT				( 16 )
+#define fatBS_ROOT_ENTRIES			( 17 )
+#define fatBS_TOTAL_SECTORS_16		( 19 )
+#define fatBS_FAT_SECTORS_16		( 22 )
+#define fatBS_TOTAL_SECTORS_32		( 32 )
+#define fatBS_FAT_SECTORS_32		( 36 )
+#define fatBS_ROOT_CLUSTER			( 44 )
+#define fatBS_FSINFO_SECTOR			( 48 )
+#define fatBS_FAT16_TYPE			( 54 )		/* "FAT" in the boot sector of either, */
+#define fatBS_FAT32_TYPE			( 82 )		/* after the longer FAT32 BPB. */
+#define fatBS_SIGNATURE				( 510 )
+
+#define fatSIGNATURE				( 0xAA55UL )
+
+/* The partition table of a master boot record. */
+#define fatMBR_PARTITIONS			( 446 )
+#define fatMBR_PARTITION_COUNT		( 4 )
+#define fatMBR_PARTITION_SIZE		( 16 )
+#define fatMBR_TYPE					( 4 )
+#define fatMBR_FIRST_SECTOR			( 8 )
+
+/* The FAT32 FSInfo sector.  The free cluster count is not kept up to date, so
+it is marked unknown. */
+#define fatFSINFO_SIGNATURE			( 0x41615252UL )
+#define fatFSINFO_FREE_COUNT		( 488 )
+#define fatFSINFO_NEXT_FREE			( 492 )
+#define fatFSINFO_UNKNOWN			( 0xFFFFFFFFUL )
+
+/* Fewer clusters make a FAT12 volume, which is not supported, and as many as
+the second make a FAT32 one. */
+#define fatMIN_FAT16_CLUSTERS		( 4085UL )
+#define fatMIN_FAT32_CLUSTERS		( 65525UL )
+
+#define fatFIRST_CLUSTER			( 2UL )
+#define fatFREE_CLUSTER				( 0UL )
+#define fatEND_OF_CHAIN				( 0x0FFFFFFFUL )
+#define fatFAT32_MASK				( 0x0FFFFFFFUL )
+
+/* From prvFATNext(), at the end of a chain or a broken one. */
+#define fatNO_CLUSTER				( 0xFFFFFFFFUL )
+
+#define fatATTR_READ_ONLY			( 0x01U )
+#define fatATTR_VOLUME_ID			( 0x08U )	/* Also set in long name entries. */
+#define fatATTR_DIRECTORY			( 0x10U )
+#define fatATTR_ARCHIVE				( 0x20U )
+
+#define fatNAME_END					( 0x00U )	/* This entry and all after it are free. */
+#define fatNAME_DELETED				( 0xE5U )
+
+/* From prvFATLookup() and prvFATFind(). */
+#define fatFOUND					( 1 )
+#define fatNOT_FOUND				( 0 )
+#define fatERROR					( -1 )
+
+/* Counters are bumped by the tasks using the files. */
+#define fatCOUNT( xField, ulCount )	( void ) __atomic_fetch_add( &( xFATStatistics.xField ), ( ulCount ), __ATOMIC_RELAXED )
+/*----------------------------------------------------------------------------*/
+
+typedef struct FAT_DIRECTORY_ENTRY
+{
+	unsigned char ucName[ fatNAME_SIZE ];
+	unsigned char ucAttributes;
+	unsigned char ucReserved;
+	unsigned char ucCreateTenths;
+	unsigned short usCreateTime;
+	unsigned short usCreateDate;
+	unsigned short usAccessDate;
+	unsigned short usClusterHigh;
+	unsigned short usWriteTime;
+	unsigned short usWriteDate;
+	unsigned short usClusterLow;
+	unsigned long ulSize;
+} xFATDirectoryEntry;
+
+/* A run of contiguous clusters in the chain of a file. */
+typedef struct FAT_RUN
+{
+	unsigned long ulIndex;				/* Of its first cluster in the file, */
+	unsigned long ulCluster;			/* and on the volume. */
+	unsigned long ulCount;
+} xFATRun;
+
+struct FAT_FILE
+{
+	portBASE_TYPE xOpen;
+	unsigned long ulMode;
+	xSemaphoreHandle xMutex;			/* Guards the rest. */
+	unsigned long ulEntrySector;		/* Where the directory entry is. */
+	unsigned long ulEntryOffset;
+	unsigned long ulFirstCluster;		/* 0 while the file has none. */
+	unsigned long ulSize;
+	unsigned long ulPosition;
+	portBASE_TYPE xEntryDirty;			/* The size or first cluster has changed. */
+	xFATRun xRuns[ fatCHAIN_RUNS ];		/* Cover the chain from its start. */
+	unsigned long ulRuns;
+	unsigned long ulCursorIndex;		/* The last cluster found past the runs, */
+	unsigned long ulCursorCluster;		/* or 0. */
+	unsigned char *pucTail;				/* The last cluster of a file open for writing, */
+	unsigned long ulTailIndex;			/* which cluster of the file it is, */
+	portBASE_TYPE xTailValid;			/* whether pucTail holds it, */
+	portBASE_TYPE xTailDirty;			/* and whether it holds bytes not yet written. */
+};
+
+typedef struct FAT_VOLUME
+{
+	unsigned long ulFATSector;			/* The first sector of the first FAT. */
+	unsigned long ulFATSectors;			/* Sectors in each FAT. */
+	unsigned long ulFATCount;
+	unsigned long ulRootSector;			/* The FAT16 root directory. */
+	unsigned long ulRootSectors;
+	unsigned long ulRootCluster;		/* The FAT32 one. */
+	unsigned long ulDataSector;			/* The first sector of cluster 2. */
+	unsigned long ulClusterEnd;			/* One past the last cluster. */
+	unsigned long ulSectorsPerCluster;
+	unsigned long ulClusterSize;		/* In bytes. */
+	unsigned long ulNextFree;			/* Where the search for a free cluster starts. */
+	unsigned long ulFSInfoSector;		/* FAT32 only, 0 if there is none. */
+	portBASE_TYPE xFAT32;
+} xFATVolume;
+
+/* Where a name was, or could go, in a directory. */
+typedef struct FAT_LOCATION
+{
+	unsigned char ucName[ fatNAME_SIZE ];
+	unsigned long ulDirectory;			/* First cluster of the directory, or 0 for the FAT16 root. */
+	unsigned long ulSector;				/* The entry, or a free one; 0 if there is none free. */
+	unsigned long ulOffset;
+	unsigned long ulLastCluster;		/* The last of the directory, to grow it. */
+	xFATDirectoryEntry xEntry;
+} xFATLocation;
+
+/* Walks the sectors of a directory. */
+typedef struct FAT_WALK
+{
+	unsigned long ulCluster;			/* 0 in the FAT16 root directory. */
+	unsigned long ulSector;
+	unsigned long ulLeft;				/* Sectors after this one in the cluster or root. */
+} xFATWalk;
+
+/* The FAT is read and written in place in the cached sectors. */
+typedef unsigned long __attribute__ ( ( may_alias ) ) xFATAliasedWord;
+typedef unsigned short __attribute__ ( ( may_alias ) ) xFATAliasedHalfword;
+/*----------------------------------------------------------------------------*/
+
+static xFATVolume xFATVol;
+static portBASE_TYPE xFATMounted = pdFALSE;
+
+/* Guards the allocation of clusters, the directories, and the opening and
+closing of files. */
+static xSemaphoreHandle xFATVolumeMutex = NULL;
+
+static struct FAT_FILE xFATFiles[ fatMAX_OPEN_FILES ];
+
+static xFATStats xFATStatistics;
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Find the volume in the boot sector at sector ulFirst.
+ */
+static portBASE_TYPE prvFATReadBootSector( const unsigned char *pucSector, unsigned long ulFirst );
+static portBASE_TYPE prvFATIsBootSector( const unsigned char *pucSector );
+
+/*
+ * Little endian fields at any alignment.
+ */
+static unsigned long prvFATRead16( const unsigned char *pucField );
+static unsigned long prvFATRead32( const unsigned char *pucField );
+
+static unsigned long prvFATClusterSector( unsigned long ulCluster );
+
+/*
+ * The FAT entry of ulCluster, or fatNO_CLUSTER if it could not be read.
+ */
+static unsigned long prvFATEntry( unsigned long ulCluster );
+
+/*
+ * The cluster after ulCluster, or fatNO_CLUSTER at the end of the chain.
+ */
+static unsigned long prvFATNext( unsigned long ulCluster );
+
+/*
+ * Set the FAT entry of ulCluster, in every copy of the FAT.
+ */
+static portBASE_TYPE prvFATSetEntry( unsigned long ulCluster, unsigned long ulValue );
+
+/*
+ * Take a free cluster and link it after ulPrevious, if that is not 0.
+ * Returns 0 if the volume is full.  Called with the volume mutex held, as are
+ * prvFATFreeChain(), prvFATLookup() and prvFATCreate().
+ */
+static unsigned long prvFATAllocate( unsigned long ulPrevious );
+static void prvFATFreeChain( unsigned long ulCluster );
+
+/*
+ * Find pcPath.  Returns fatFOUND with the entry and where it is, fatNOT_FOUND
+ * with where it could go, or fatERROR if the path is not valid or the card
+ * could not be read.
+ */
+static portBASE_TYPE prvFATLookup( const char *pcPath, xFATLocation *pxLocation );
+
+/*
+ * Look for pxLocation->ucName in the directory pxLocation->ulDirectory.
+ */
+static portBASE_TYPE prvFATFind( xFATLocation *pxLocation );
+
+/*
+ * Make an entry for an empty file where prvFATLookup() did not find one,
+ * growing the directory if it is full.
+ */
+static portBASE_TYPE prvFATCreate( xFATLocation *pxLocation );
+
+/*
+ * Turn the next name of *ppcPath into its 8.3 directory form, and move past
+ * it and the separators after it.
+ */
+static portBASE_TYPE prvFATName( const char **ppcPath, unsigned char *pucName );
+
+static void prvFATWalkStart( xFATWalk *pxWalk, unsigned long ulDirectory );
+static portBASE_TYPE prvFATWalkNext( xFATWalk *pxWalk );
+
+/*
+ * The volume cluster of cluster ulIndex of the file, or 0 if the chain is
+ * shorter.  The runs remembered are used first, and the FAT is only walked
+ * past the last of them, or past the cluster found last time if that is
+ * nearer.  Called with the file's mutex held, as are those below.
+ */
+static unsigned long prvFATFileCluster( struct FAT_FILE *pxFile, unsigned long ulIndex );
+
+/*
+ * As prvFATFileCluster(), but add a cluster to the end of the chain if
+ * ulIndex is one past it.
+ */
+static unsigned long prvFATGrow( struct FAT_FILE *pxFile, unsigned long ulIndex );
+
+/*
+ * Remember that cluster ulIndex of the file is ulCluster, the one after the
+ * last remembered.
+ */
+static void prvFATRemember( struct FAT_FILE *pxFile, unsigned long ulIndex, unsigned long ulCluster );
+
+/*
+ * Copy ulLength bytes between pucData and the cluster starting at sector
+ * ulSector, from ulOffset into it, through the block cache.
+ */
+static portBASE_TYPE prvFATCopy( unsigned long ulSector, unsigned long ulOffset, unsigned char *pucData, unsigned long ulLength, portBASE_TYPE xWrite );
+
+/*
+ * Fill pucTail with cluster ulIndex, the last of the file, reading whatever of
+ * it is already written.
+ */
+static portBASE_TYPE prvFATLoadTail( struct FAT_FILE *pxFile, unsigned long ulIndex );
+
+/*
+ * Write pucTail if it holds anything new: a full cluster goes straight to the
+ * card in one command, and the sectors of one that is not full through the
+ * block cache, as they will be written again.
+ */
+static portBASE_TYPE prvFATWriteTail( struct FAT_FILE *pxFile );
+
+/*
+ * Write the size and first cluster to the directory entry.  Takes the volume
+ * mutex.
+ */
+static portBASE_TYPE prvFATWriteEntry( struct FAT_FILE *pxFile );
+
+static portBASE_TYPE prvFATFlush( struct FAT_FILE *pxFile );
+/*----------------------------------------------------------------------------*/
+
+portBASE_TYPE xFATMount( void )
+{
+unsigned char *pucSector;
+unsigned long ulFirst = 0UL;
+unsigned long ulPartition, ulNext;
+const unsigned char *pucPartition;
+unsigned portBASE_TYPE ux;
+portBASE_TYPE xResult = pdFAIL, xDirty;
+
+	if( NULL == xFATVolumeMutex )
+	{
+		xFATVolumeMutex = xSemaphoreCreateMutex();
+		if( NULL == xFATVolumeMutex )
+		{
+			return pdFAIL;
+		}
+
+		for( ux = 0U; ux < fatMAX_OPEN_FILES; ux++ )
+		{
+			xFATFiles[ ux ].xMutex = xSemaphoreCreateMutex();
+			if( NULL == xFATFiles[ ux ].xMutex )
+			{
+				return pdFAIL;
+			}
+		}
+	}
+
+	( void ) xSemaphoreTake( xFATVolumeMutex, portMAX_DELAY );
+
+	if( pdFALSE != xFATMounted )
+	{
+		( void ) xSemaphoreGive( xFATVolumeMutex );
+		return pdPASS;
+	}
+
+	/* Sector 0 is either the boot sector, or a master boot record. */
+	pucSector = pucBlockCacheGet( 0UL, pdFALSE );
+	if( NULL != pucSector )
+	{
+		if( ( pdFALSE == prvFATIsBootSector( pucSector ) ) && ( fatSIGNATURE == prvFATRead16( pucSector + fatBS_SIGNATURE ) ) )
+		{
+			for( ulPartition = 0UL; ulPartition < fatMBR_PARTITION_COUNT; ulPartition++ )
+			{
+				pucPartition = pucSector + fatMBR_PARTITIONS + ulPartition * fatMBR_PARTITION_SIZE;
+				switch( pucPartition[ fatMBR_TYPE ] )
+				{
+					case 0x04:	/* FAT16 under 32 MB, */
+					case 0x06:	/* FAT16, */
+					case 0x0E:	/* FAT16 addressed by LBA, */
+					case 0x0B:	/* FAT32, */
+					case 0x0C:	/* FAT32 addressed by LBA. */
+						ulFirst = prvFATRead32( pucPartition + fatMBR_FIRST_SECTOR );
+						break;
+					default:
+						break;
+				}
+
+				if( 0UL != ulFirst )
+				{
+					break;
+				}
+			}
+		}
+		vBlockCacheRelease( pucSector, pdFALSE );
+
+		pucSector = pucBlockCacheGet( ulFirst, pdFALSE );
+	}
+
+	if( NULL != pucSector )
+	{
+		xResult = prvFATReadBootSector( pucSector, ulFirst );
+		vBlockCacheRelease( pucSector, pdFALSE );
+	}
+
+	/* Carry on allocating where the last writer stopped, and mark the free
+	count unknown. */
+	if( ( pdPASS == xResult ) && ( 0UL != xFATVol.ulFSInfoSector ) )
+	{
+		pucSector = pucBlockCacheGet( xFATVol.ulFSInfoSector, pdFALSE );
+		if( NULL != pucSector )
+		{
+			xDirty = pdFALSE;
+			if( fatFSINFO_SIGNATURE == prvFATRead32( pucSector ) )
+			{
+				ulNext = prvFATRead32( pucSector + fatFSINFO_NEXT_FREE );
+				if( ( ulNext >= fatFIRST_CLUSTER ) && ( ulNext < xFATVol.ulClusterEnd ) )
+				{
+					xFATVol.ulNextFree = ulNext;
+				}
+
+				if( fatFSINFO_UNKNOWN != prvFATRead32( pucSector + fatFSINFO_FREE_COUNT ) )
+				{
+					*( xFATAliasedWord * ) ( pucSector + fatFSINFO_FREE_COUNT ) = fatFSINFO_UNKNOWN;
+					xDirty = pdTRUE;
+				}
+			}
+			vBlockCacheRelease( pucSector, xDirty );
+		}
+	}
+
+	xFATMounted = xResult;
+	( void ) xSemaphoreGive( xFATVolumeMutex );
+
+	return xResult;
+}
+/*----------------------------------------------------------------------------*/
+
+xFATFileHandle xFATOpen( const char *pcPath, unsigned long ulMode )
+{
+xFATLocation xLocation;
+struct FAT_FILE *pxFile = NULL;
+unsigned portBASE_TYPE ux;
+portBASE_TYPE xFound;
+
+	if( ( pdFALSE == xFATMounted ) || ( 0UL == ( ulMode & ( fatREAD | fatWRITE ) ) ) )
+	{
+		return NULL;
+	}
+
+	if( ( 0UL != ( ulMode & ( fatCREATE | fatTRUNCATE | fatAPPEND ) ) ) && ( 0UL == ( ulMode & fatWRITE ) ) )
+	{
+		return NULL;
+	}
+
+	( void ) xSemaphoreTake( xFATVolumeMutex, portMAX_DELAY );
+
+	xFound = prvFATLookup( pcPath, &xLocation );
+	if( ( fatNOT_FOUND == xFound ) && ( 0UL != ( ulMode & fatCREATE ) ) && ( pdPASS == prvFATCreate( &xLocation ) ) )
+	{
+		xFound = fatFOUND;
+	}
+
+	if( ( fatFOUND == xFound ) && ( 0U == ( xLocation.xEntry.ucAttributes & fatATTR_DIRECTORY ) ) &&
+		( ( 0UL == ( ulMode & fatWRITE ) ) || ( 0U == ( xLocation.xEntry.ucAttributes & fatATTR_READ_ONLY ) ) ) )
+	{
+		/* Any number may read a file, but one that is written is only open
+		once. */
+		for( ux = 0U; ux < fatMAX_OPEN_FILES; ux++ )
+		{
+			if( pdFALSE == xFATFiles[ ux ].xOpen )
+			{
+				if( NULL == pxFile )
+				{
+					pxFile = &xFATFiles[ ux ];
+				}
+			}
+			else if( ( xFATFiles[ ux ].ulEntrySector == xLocation.ulSector ) && ( xFATFiles[ ux ].ulEntryOffset == xLocation.ulOffset ) &&
+					 ( 0UL != ( ( xFATFiles[ ux ].ulMode | ulMode ) & fatWRITE ) ) )
+			{
+				pxFile = NULL;
+				break;
+			}
+		}
+	}
+
+	if( NULL != pxFile )
+	{
+		pxFile->xOpen = pdTRUE;
+		pxFile->ulMode = ulMode;
+		pxFile->ulEntrySector = xLocation.ulSector;
+		pxFile->ulEntryOffset = xLocation.ulOffset;
+		pxFile->ulFirstCluster = xLocation.xEntry.usClusterLow;
+		if( pdFALSE != xFATVol.xFAT32 )
+		{
+			pxFile->ulFirstCluster |= ( unsigned long ) xLocation.xEntry.usClusterHigh << 16;
+		}
+		pxFile->ulSize = xLocation.xEntry.ulSize;
+		pxFile->ulPosition = 0UL;
+		pxFile->xEntryDirty = pdFALSE;
+		pxFile->ulRuns = 0UL;
+		pxFile->ulCursorCluster = 0UL;
+		pxFile->pucTail = NULL;
+		pxFile->xTailValid = pdFALSE;
+		pxFile->xTailDirty = pdFALSE;
+
+		if( ( 0UL != ( ulMode & fatTRUNCATE ) ) && ( 0UL != pxFile->ulFirstCluster ) )
+		{
+			prvFATFreeChain( pxFile->ulFirstCluster );
+			pxFile->ulFirstCluster = 0UL;
+			pxFile->ulSize = 0UL;
+			pxFile->xEntryDirty = pdTRUE;
+		}
+	}
+
+	( void ) xSemaphoreGive( xFATVolumeMutex );
+
+	if( NULL == pxFile )
+	{
+		return NULL;
+	}
+
+	if( 0UL != ( ulMode & fatWRITE ) )
+	{
+		pxFile->pucTail = ( unsigned char * ) pvPortMalloc( xFATVol.ulClusterSize );
+		if( ( NULL == pxFile->pucTail ) || ( ( pdFALSE != pxFile->xEntryDirty ) && ( pdFAIL == prvFATWriteEntry( pxFile ) ) ) )
+		{
+			vPortFree( pxFile->pucTail );
+			pxFile->pucTail = NULL;
+
+			( void ) xSemaphoreTake( xFATVolumeMutex, portMAX_DELAY );
+			pxFile->xOpen = pdFALSE;
+			( void ) xSemaphoreGive( xFATVolumeMutex );
+
+			return NULL;
+		}
+	}
+
+	if( 0UL != ( ulMode & fatAPPEND ) )
+	{
+		pxFile->ulPosition = pxFile->ulSize;
+	}
+
+	return pxFile;
+}
+/*----------------------------------------------------------------------------*/
+
+unsigned long ulFATRead( xFATFileHandle xFile, void *pvBuffer, unsigned long ulLength )
+{
+struct FAT_FILE *pxFile = xFile;
+unsigned char *pucBuffer = ( unsigned char * ) pvBuffer;
+unsigned long ulDone = 0UL, ulIndex, ulOffset, ulCount, ulCluster;
+
+	if( 0UL == ( pxFile->ulMode & fatREAD ) )
+	{
+		return 0UL;
+	}
+
+	( void ) xSemaphoreTake( pxFile->xMutex, portMAX_DELAY );
+
+	while( ( ulDone < ulLength ) && ( pxFile->ulPosition < pxFile->ulSize ) )
+	{
+		ulIndex = pxFile->ulPosition / xFATVol.ulClusterSize;
+		ulOffset = pxFile->ulPosition % xFATVol.ulClusterSize;
+		ulCount = xFATVol.ulClusterSize - ulOffset;
+		if( ulCount > ulLength - ulDone )
+		{
+			ulCount = ulLength - ulDone;
+		}
+		if( ulCount > pxFile->ulSize - pxFile->ulPosition )
+		{
+			ulCount = pxFile->ulSize - pxFile->ulPosition;
+		}
+
+		if( ( pdFALSE != pxFile->xTailValid ) && ( ulIndex == pxFile->ulTailIndex ) )
+		{
+			memcpy( pucBuffer + ulDone, pxFile->pucTail + ulOffset, ulCount );
+		}
+		else
+		{
+			ulCluster = prvFATFileCluster( pxFile, ulIndex );
+			if( ( 0UL == ulCluster ) || ( pdFAIL == prvFATCopy( prvFATClusterSector( ulCluster ), ulOffset, pucBuffer + ulDone, ulCount, pdFALSE ) ) )
+			{
+				break;
+			}
+		}
+
+		pxFile->ulPosition += ulCount;
+		ulDone += ulCount;
+	}
+
+	( void ) xSemaphoreGive( pxFile->xMutex );
+
+	return ulDone;
+}
+/*----------------------------------------------------------------------------*/
+
+unsigned long ulFATWrite( xFATFileHandle xFile, const void *pvBuffer, unsigned long ulLength )
+{
+struct FAT_FILE *pxFile = xFile;
+unsigned char *pucBuffer = ( unsigned char * ) pvBuffer;
+unsigned long ulDone = 0UL, ulIndex, ulOffset, ulCount, ulCluster;
+
+	if( 0UL == ( pxFile->ulMode & fatWRITE ) )
+	{
+		return 0UL;
+	}
+
+	( void ) xSemaphoreTake( pxFile->xMutex, portMAX_DELAY );
+
+	while( ulDone < ulLength )
+	{
+		ulIndex = pxFile->ulPosition / xFATVol.ulClusterSize;
+		ulOffset = pxFile->ulPosition % xFATVol.ulClusterSize;
+		ulCount = xFATVol.ulClusterSize - ulOffset;
+		if( ulCount > ulLength - ulDone )
+		{
+			ulCount = ulLength - ulDone;
+		}
+
+		if( ( pxFile->ulPosition == pxFile->ulSize ) || ( ( pdFALSE != pxFile->xTailValid ) && ( ulIndex == pxFile->ulTailIndex ) ) )
+		{
+			/* Appends, and writes to the last cluster, gather in pucTail
+			until it is full. */
+			if( ( pdFALSE == pxFile->xTailValid ) || ( ulIndex != pxFile->ulTailIndex ) )
+			{
+				if( ( pdFAIL == prvFATWriteTail( pxFile ) ) || ( pdFAIL == prvFATLoadTail( pxFile, ulIndex ) ) )
+				{
+					break;
+				}
+			}
+
+			memcpy( pxFile->pucTail + ulOffset, pucBuffer + ulDone, ulCount );
+			pxFile->xTailDirty = pdTRUE;
+			pxFile->ulPosition += ulCount;
+			if( pxFile->ulPosition > pxFile->ulSize )
+			{
+				pxFile->ulSize = pxFile->ulPosition;
+				pxFile->xEntryDirty = pdTRUE;
+			}
+
+			if( pxFile->ulSize - ulIndex * xFATVol.ulClusterSize == xFATVol.ulClusterSize )
+			{
+				if( pdFAIL == prvFATWriteTail( pxFile ) )
+				{
+					/* The bytes are counted, as they stay in pucTail, but
+					the write stops here. */
+					ulDone += ulCount;
+					break;
+				}
+				pxFile->xTailValid = pdFALSE;
+			}
+		}
+		else
+		{
+			/* Overwrites before the last cluster go through the cache, up to
+			the end of the file, where the above takes over. */
+			if( ulCount > pxFile->ulSize - pxFile->ulPosition )
+			{
+				ulCount = pxFile->ulSize - pxFile->ulPosition;
+			}
+
+			ulCluster = prvFATFileCluster( pxFile, ulIndex );
+			if( ( 0UL == ulCluster ) || ( pdFAIL == prvFATCopy( prvFATClusterSector( ulCluster ), ulOffset, pucBuffer + ulDone, ulCount, pdTRUE ) ) )
+			{
+				break;
+			}
+			pxFile->ulPosition += ulCount;
+		}
+
+		ulDone += ulCount;
+	}
+
+	( void ) xSemaphoreGive( pxFile->xMutex );
+
+	return ulDone;
+}
+/*----------------------------------------------------------------------------*/
+
+portBASE_TYPE xFATSeek( xFATFileHandle xFile, long lOffset, portBASE_TYPE xWhence )
+{
+struct FAT_FILE *pxFile = xFile;
+unsigned long ulBase, ulMove;
+portBASE_TYPE xResult = pdFAIL;
+
+	( void ) xSemaphoreTake( pxFile->xMutex, portMAX_DELAY );
+
+	switch( xWhence )
+	{
+		case fatSEEK_SET:	ulBase = 0UL;					break;
+		case fatSEEK_CUR:	ulBase = pxFile->ulPosition;	break;
+		default:			ulBase = pxFile->ulSize;		break;
+	}
+
+	/* Only to where the file already has bytes. */
+	ulMove = ( lOffset < 0L ) ? 0UL - ( unsigned long ) lOffset : ( unsigned long ) lOffset;
+	if( lOffset < 0L )
+	{
+		if( ulMove <= ulBase )
+		{
+			pxFile->ulPosition = ulBase - ulMove;
+			xResult = pdPASS;
+		}
+	}
+	else if( ulMove <= pxFile->ulSize - ulBase )
+	{
+		pxFile->ulPosition = ulBase + ulMove;
+		xResult = pdPASS;
+	}
+
+	( void ) xSemaphoreGive( pxFile->xMutex );
+
+	return xResult;
+}
+/*----------------------------------------------------------------------------*/
+
+unsigned long ulFATTell( xFATFileHandle xFile )
+{
+	return xFile->ulPosition;
+}
+/*----------------------------------------------------------------------------*/
+
+unsigned long ulFATSize( xFATFileHandle xFile )
+{
+	return xFile->ulSize;
+}
+/*----------------------------------------------------------------------------*/
+
+portBASE_TYPE xFATFlush( xFATFileHandle xFile )
+{
+portBASE_TYPE xResult = pdPASS;
+
+	if( 0UL != ( xFile->ulMode & fatWRITE ) )
+	{
+		( void ) xSemaphoreTake( xFile->xMutex, portMAX_DELAY );
+		xResult = prvFATFlush( xFile );
+		( void ) xSemaphoreGive( xFile->xMutex );
+	}
+
+	return xResult;
+}
+/*----------------------------------------------------------------------------*/
+
+portBASE_TYPE xFATClose( xFATFileHandle xFile )
+{
+portBASE_TYPE xResult;
+
+	xResult = xFATFlush( xFile );
+
+	( void ) xSemaphoreTake( xFile->xMutex, portMAX_DELAY );
+	vPortFree( xFile->pucTail );
+	xFile->pucTail = NULL;
+	xFile->xTailValid = pdFALSE;
+	( void ) xSemaphoreGive( xFile->xMutex );
+
+	( void ) xSemaphoreTake( xFATVolumeMutex, portMAX_DELAY );
+	xFile->xOpen = pdFALSE;
+	( void ) xSemaphoreGive( xFATVolumeMutex );
+
+	return xResult;
+}
+/*----------------------------------------------------------------------------*/
+
+void vFATGetStats( xFATStats *pxStats )
+{
+	pxStats->ulRunHits = __atomic_load_n( &xFATStatistics.ulRunHits, __ATOMIC_RELAXED );
+	pxStats->ulFATReads = __atomic_load_n( &xFATStatistics.ulFATReads, __ATOMIC_RELAXED );
+	pxStats->ulClusterWrites = __atomic_load_n( &xFATStatistics.ulClusterWrites, __ATOMIC_RELAXED );
+	pxStats->ulTailWrites = __atomic_load_n( &xFATStatistics.ulTailWrites, __ATOMIC_RELAXED );
+}
+/*----------------------------------------------------------------------------*/
+
+static portBASE_TYPE prvFATIsBootSector( const unsigned char *pucSector )
+{
+	if( ( 0xEBU != pucSector[ fatBS_JUMP ] ) && ( 0xE9U != pucSector[ fatBS_JUMP ] ) )
+	{
+		return pdFALSE;
+	}
+
+	return ( 0 == memcmp( pucSector + fatBS_FAT16_TYPE, "FAT", 3 ) ) || ( 0 == memcmp( pucSector + fatBS_FAT32_TYPE, "FAT", 3 ) );
+}
+/*----------------------------------------------------------------------------*/
+
+static portBASE_TYPE prvFATReadBootSector( const unsigned char *pucSector, unsigned long ulFirst )
+{
+unsigned long ulTotal, ulClusters, ulRootEntries;
+
+	if( ( fatSIGNATURE != prvFATRead16( pucSector + fatBS_SIGNATURE ) ) || ( fatSECTOR_SIZE != prvFATRead16( pucSector + fatBS_BYTES_PER_SECTOR ) ) )
+	{
+		return pdFAIL;
+	}
+
+	xFATVol.ulSectorsPerCluster = pucSector[ fatBS_SECTORS_PER_CLUSTER ];
+	if( ( 0UL == xFATVol.ulSectorsPerCluster ) || ( 0UL != ( xFATVol.ulSectorsPerCluster & ( xFATVol.ulSectorsPerCluster - 1UL ) ) ) )
+	{
+		return pdFAIL;
+	}
+	xFATVol.ulClusterSize = xFATVol.ulSectorsPerCluster * fatSECTOR_SIZE;
+
+	ulTotal = prvFATRead16( pucSector + fatBS_TOTAL_SECTORS_16 );
+	if( 0UL == ulTotal )
+	{
+		ulTotal = prvFATRead32( pucSector + fatBS_TOTAL_SECTORS_32 );
+	}
+
+	xFATVol.ulFATSectors = prvFATRead16( pucSector + fatBS_FAT_SECTORS_16 );
+	if( 0UL == xFATVol.ulFATSectors )
+	{
+		xFATVol.ulFATSectors = prvFATRead32( pucSector + fatBS_FAT_SECTORS_32 );
+	}
+
+	ulRootEntries = prvFATRead16( pucSector + fatBS_ROOT_ENTRIES );
+	xFATVol.ulFATCount = pucSector[ fatBS_FAT_COUNT ];
+	xFATVol.ulFATSector = ulFirst + prvFATRead16( pucSector + fatBS_RESERVED_SECTORS );
+	xFATVol.ulRootSector = xFATVol.ulFATSector + xFATVol.ulFATCount * xFATVol.ulFATSectors;
+	xFATVol.ulRootSectors = ( ulRootEntries * fatENTRY_SIZE + fatSECTOR_SIZE - 1UL ) / fatSECTOR_SIZE;
+	xFATVol.ulDataSector = xFATVol.ulRootSector + xFATVol.ulRootSectors;
+
+	if( ( 0UL == xFATVol.ulFATCount ) || ( 0UL == xFATVol.ulFATSectors ) || ( ulFirst + ulTotal <= xFATVol.ulDataSector ) )
+	{
+		return pdFAIL;
+	}
+
+	/* The type goes by the number of clusters alone. */
+	ulClusters = ( ulFirst + ulTotal - xFATVol.ulDataSector ) / xFATVol.ulSectorsPerCluster;
+	if( ulClusters < fatMIN_FAT16_CLUSTERS )
+	{
+		return pdFAIL;
+	}
+
+	xFATVol.xFAT32 = ( ulClusters >= fatMIN_FAT32_CLUSTERS );
+	xFATVol.ulClusterEnd = fatFIRST_CLUSTER + ulClusters;
+	xFATVol.ulNextFree = fatFIRST_CLUSTER;
+	xFATVol.ulRootCluster = 0UL;
+	xFATVol.ulFSInfoSector = 0UL;
+
+	if( pdFALSE != xFATVol.xFAT32 )
+	{
+		if( 0UL != ulRootEntries )
+		{
+			return pdFAIL;
+		}
+
+		xFATVol.ulRootCluster = prvFATRead32( pucSector + fatBS_ROOT_CLUSTER );
+		if( ( xFATVol.ulRootCluster < fatFIRST_CLUSTER ) || ( xFATVol.ulRootCluster >= xFATVol.ulClusterEnd ) )
+		{
+			return pdFAIL;
+		}
+
+		if( 0UL != prvFATRead16( pucSector + fatBS_FSINFO_SECTOR ) )
+		{
+			xFATVol.ulFSInfoSector = ulFirst + prvFATRead16( pucSector + fatBS_FSINFO_SECTOR );
+		}
+	}
+	else if( 0UL == ulRootEntries )
+	{
+		return pdFAIL;
+	}
+
+	return pdPASS;
+}
+/*----------------------------------------------------------------------------*/
+
+static unsigned long prvFATRead16( const unsigned char *pucField )
+{
+	return ( unsigned long ) pucField[ 0 ] | ( ( unsigned long ) pucField[ 1 ] << 8 );
+}
+/*----------------------------------------------------------------------------*/
+
+static unsigned long prvFATRead32( const unsigned char *pucField )
+{
+	return prvFATRead16( pucField ) | ( prvFATRead16( pucField + 2 ) << 16 );
+}
+/*----------------------------------------------------------------------------*/
+
+static unsigned long prvFATClusterSector( unsigned long ulCluster )
+{
+	return xFATVol.ulDataSector + ( ulCluster - fatFIRST_CLUSTER ) * xFATVol.ulSectorsPerCluster;
+}
+/*----------------------------------------------------------------------------*/
+
+static unsigned long prvFATEntry( unsigned long ulCluster )
+{
+unsigned long ulOffset = ulCluster * ( ( pdFALSE != xFATVol.xFAT32 ) ? 4UL : 2UL );
+unsigned char *pucSector;
+unsigned long ulValue;
+
+	pucSector = pucBlockCacheGet( xFATVol.ulFATSector + ulOffset / fatSECTOR_SIZE, pdFALSE );
+	if( NULL == pucSector )
+	{
+		return fatNO_CLUSTER;
+	}
+
+	ulOffset %= fatSECTOR_SIZE;
+	if( pdFALSE != xFATVol.xFAT32 )
+	{
+		ulValue = *( xFATAliasedWord * ) ( pucSector + ulOffset ) & fatFAT32_MASK;
+	}
+	else
+	{
+		ulValue = *( xFATAliasedHalfword * ) ( pucSector + ulOffset );
+	}
+	vBlockCacheRelease( pucSector, pdFALSE );
+
+	fatCOUNT( ulFATReads, 1UL );
+
+	return ulValue;
+}
+/*----------------------------------------------------------------------------*/
+
+static unsigned long prvFATNext( unsigned long ulCluster )
+{
+unsigned long ulNext = prvFATEntry( ulCluster );
+
+	/* Free, bad and end of chain markers all end up here. */
+	if( ( ulNext < fatFIRST_CLUSTER ) || ( ulNext >= xFATVol.ulClusterEnd ) )
+	{
+		return fatNO_CLUSTER;
+	}
+
+	return ulNext;
+}
+/*----------------------------------------------------------------------------*/
+
+static portBASE_TYPE prvFATSetEntry( unsigned long ulCluster, unsigned long ulValue )
+{
+unsigned long ulOffset = ulCluster * ( ( pdFALSE != xFATVol.xFAT32 ) ? 4UL : 2UL );
+unsigned long ulSector = xFATVol.ulFATSector + ulOffset / fatSECTOR_SIZE;
+unsigned long ulCopy;
+unsigned char *pucSector;
+xFATAliasedWord *pulEntry;
+
+	ulOffset %= fatSECTOR_SIZE;
+
+	for( ulCopy = 0UL; ulCopy < xFATVol.ulFATCount; ulCopy++ )
+	{
+		pucSector = pucBlockCacheGet( ulSector + ulCopy * xFATVol.ulFATSectors, pdFALSE );
+		if( NULL == pucSector )
+		{
+			return pdFAIL;
+		}
+
+		if( pdFALSE != xFATVol.xFAT32 )
+		{
+			/* The top four bits are reserved, and kept. */
+			pulEntry = ( xFATAliasedWord * ) ( pucSector + ulOffset );
+			*pulEntry = ( *pulEntry & ~fatFAT32_MASK ) | ( ulValue & fatFAT32_MASK );
+		}
+		else
+		{
+			*( xFATAliasedHalfword * ) ( pucSector + ulOffset ) = ( unsigned short ) ulValue;
+		}
+		vBlockCacheRelease( pucSector, pdTRUE );
+	}
+
+	return pdPASS;
+}
+/*----------------------------------------------------------------------------*/
+
+static unsigned long prvFATAllocate( unsigned long ulPrevious )
+{
+unsigned long ulCluster, ulLeft;
+
+	/* Right after the previous cluster if that is free, so that files stay
+	contiguous, and otherwise from where the last search stopped. */
+	ulCluster = ulPrevious + 1UL;
+	if( ( 0UL == ulPrevious ) || ( ulCluster >= xFATVol.ulClusterEnd ) || ( fatFREE_CLUSTER != prvFATEntry( ulCluster ) ) )
+	{
+		ulCluster = xFATVol.ulNextFree;
+	}
+
+	for( ulLeft = xFATVol.ulClusterEnd - fatFIRST_CLUSTER; ulLeft > 0UL; ulLeft-- )
+	{
+		if( ulCluster >= xFATVol.ulClusterEnd )
+		{
+			ulCluster = fatFIRST_CLUSTER;
+		}
+
+		if( fatFREE_CLUSTER == prvFATEntry( ulCluster ) )
+		{
+			break;
+		}
+		ulCluster++;
+	}
+
+	if( ( 0UL == ulLeft ) || ( pdFAIL == prvFATSetEntry( ulCluster, fatEND_OF_CHAIN ) ) )
+	{
+		return 0UL;
+	}
+
+	if( ( 0UL != ulPrevious ) && ( pdFAIL == prvFATSetEntry( ulPrevious, ulCluster ) ) )
+	{
+		( void ) prvFATSetEntry( ulCluster, fatFREE_CLUSTER );
+		return 0UL;
+	}
+
+	if( ulCluster >= xFATVol.ulNextFree )
+	{
+		xFATVol.ulNextFree = ulCluster + 1UL;
+	}
+
+	return ulCluster;
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvFATFreeChain( unsigned long ulCluster )
+{
+unsigned long ulNext, ulLeft;
+
+	/* Bounded, in case the chain loops. */
+	for( ulLeft = xFATVol.ulClusterEnd - fatFIRST_CLUSTER; ( ulLeft > 0UL ) && ( fatNO_CLUSTER != ulCluster ); ulLeft-- )
+	{
+		ulNext = prvFATNext( ulCluster );
+		if( pdFAIL == prvFATSetEntry( ulCluster, fatFREE_CLUSTER ) )
+		{
+			break;
+		}
+
+		if( ulCluster < xFATVol.ulNextFree )
+		{
+			xFATVol.ulNextFree = ulCluster;
+		}
+		ulCluster = ulNext;
+	}
+}
+/*----------------------------------------------------------------------------*/
+
+static portBASE_TYPE prvFATLookup( const char *pcPath, xFATLocation *pxLocation )
+{
+portBASE_TYPE xResult;
+
+	pxLocation->ulDirectory = ( pdFALSE != xFATVol.xFAT32 ) ? xFATVol.ulRootCluster : 0UL;
+
+	while( '/' == *pcPath )
+	{
+		pcPath++;
+	}
+
+	for( ;; )
+	{
+		if( pdFAIL == prvFATName( &pcPath, pxLocation->ucName ) )
+		{
+			return fatERROR;
+		}
+
+		xResult = prvFATFind( pxLocation );
+		if( '\0' == *pcPath )
+		{
+			return xResult;
+		}
+
+		if( ( fatFOUND != xResult ) || ( 0U == ( pxLocation->xEntry.ucAttributes & fatATTR_DIRECTORY ) ) )
+		{
+			return fatERROR;
+		}
+
+		pxLocation->ulDirectory = pxLocation->xEntry.usClusterLow;
+		if( pdFALSE != xFATVol.xFAT32 )
+		{
+			pxLocation->ulDirectory |= ( unsigned long ) pxLocation->xEntry.usClusterHigh << 16;
+			if( 0UL == pxLocation->ulDirectory )
+			{
+				pxLocation->ulDirectory = xFATVol.ulRootCluster;
+			}
+		}
+	}
+}
+/*----------------------------------------------------------------------------*/
+
+static portBASE_TYPE prvFATFind( xFATLocation *pxLocation )
+{
+xFATWalk xWalk;
+unsigned char *pucSector;
+const xFATDirectoryEntry *pxEntry;
+unsigned long ulOffset;
+portBASE_TYPE xResult = fatNOT_FOUND, xEnd = pdFALSE;
+
+	/* Sector 0 is the boot sector, so never holds a free entry. */
+	pxLocation->ulSector = 0UL;
+
+	prvFATWalkStart( &xWalk, pxLocation->ulDirectory );
+	do
+	{
+		pucSector = pucBlockCacheGet( xWalk.ulSector, pdFALSE );
+		if( NULL == pucSector )
+		{
+			return fatERROR;
+		}
+
+		for( ulOffset = 0UL; ulOffset < fatSECTOR_SIZE; ulOffset += fatENTRY_SIZE )
+		{
+			pxEntry = ( const xFATDirectoryEntry * ) ( pucSector + ulOffset );
+
+			if( ( fatNAME_END == pxEntry->ucName[ 0 ] ) || ( fatNAME_DELETED == pxEntry->ucName[ 0 ] ) )
+			{
+				if( 0UL == pxLocation->ulSector )
+				{
+					pxLocation->ulSector = xWalk.ulSector;
+					pxLocation->ulOffset = ulOffset;
+				}
+
+				if( fatNAME_END == pxEntry->ucName[ 0 ] )
+				{
+					xEnd = pdTRUE;
+					break;
+				}
+			}
+			else if( ( 0U == ( pxEntry->ucAttributes & fatATTR_VOLUME_ID ) ) && ( 0 == memcmp( pxEntry->ucName, pxLocation->ucName, fatNAME_SIZE ) ) )
+			{
+				pxLocation->xEntry = *pxEntry;
+				pxLocation->ulSector = xWalk.ulSector;
+				pxLocation->ulOffset = ulOffset;
+				xResult = fatFOUND;
+				xEnd = pdTRUE;
+				break;
+			}
+		}
+
+		vBlockCacheRelease( pucSector, pdFALSE );
+	} while( ( pdFALSE == xEnd ) && ( pdPASS == prvFATWalkNext( &xWalk ) ) );
+
+	pxLocation->ulLastCluster = xWalk.ulCluster;
+
+	return xResult;
+}
+/*----------------------------------------------------------------------------*/
+
+static portBASE_TYPE prvFATCreate( xFATLocation *pxLocation )
+{
+unsigned char *pucSector;
+unsigned long ulCluster, ulSector;
+unsigned long ulStamp = fatTIMESTAMP();
+
+	if( 0UL == pxLocation->ulSector )
+	{
+		/* The directory is full.  The FAT16 root directory cannot grow, but
+		others get a cleared cluster. */
+		if( 0UL == pxLocation->ulDirectory )
+		{
+			return pdFAIL;
+		}
+
+		ulCluster = prvFATAllocate( pxLocation->ulLastCluster );
+		if( 0UL == ulCluster )
+		{
+			return pdFAIL;
+		}
+
+		for( ulSector = prvFATClusterSector( ulCluster ); ulSector < prvFATClusterSector( ulCluster + 1UL ); ulSector++ )
+		{
+			pucSector = pucBlockCacheGet( ulSector, pdTRUE );
+			if( NULL == pucSector )
+			{
+				return pdFAIL;
+			}
+			memset( pucSector, 0, fatSECTOR_SIZE );
+			vBlockCacheRelease( pucSector, pdTRUE );
+		}
+
+		pxLocation->ulSector = prvFATClusterSector( ulCluster );
+		pxLocation->ulOffset = 0UL;
+	}
+
+	memset( &pxLocation->xEntry, 0, sizeof( pxLocation->xEntry ) );
+	memcpy( pxLocation->xEntry.ucName, pxLocation->ucName, fatNAME_SIZE );
+	pxLocation->xEntry.ucAttributes = fatATTR_ARCHIVE;
+	pxLocation->xEntry.usCreateDate = ( unsigned short ) ( ulStamp >> 16 );
+	pxLocation->xEntry.usCreateTime = ( unsigned short ) ulStamp;
+	pxLocation->xEntry.usAccessDate = pxLocation->xEntry.usCreateDate;
+	pxLocation->xEntry.usWriteDate = pxLocation->xEntry.usCreateDate;
+	pxLocation->xEntry.usWriteTime = pxLocation->xEntry.usCreateTime;
+
+	pucSector = pucBlockCacheGet( pxLocation->ulSector, pdFALSE );
+	if( NULL == pucSector )
+	{
+		return pdFAIL;
+	}
+	memcpy( pucSector + pxLocation->ulOffset, &pxLocation->xEntry, fatENTRY_SIZE );
+	vBlockCacheRelease( pucSector, pdTRUE );
+
+	return pdPASS;
+}
+/*----------------------------------------------------------------------------*/
+
+static portBASE_TYPE prvFATName( const char **ppcPath, unsigned char *pucName )
+{
+const char *pcPath = *ppcPath;
+unsigned long ulAt = 0UL, ulEnd = 8UL;
+char c;
+
+	memset( pucName, ' ', fatNAME_SIZE );
+
+	for( c = *pcPath; ( '\0' != c ) && ( '/' != c ); c = *++pcPath )
+	{
+		if( '.' == c )
+		{
+			/* One dot, after a name, starts the extension. */
+			if( ( 0UL == ulAt ) || ( ulEnd == fatNAME_SIZE ) )
+			{
+				return pdFAIL;
+			}
+			ulAt = 8UL;
+			ulEnd = fatNAME_SIZE;
+			continue;
+		}
+
+		if( ( c >= 'a' ) && ( c <= 'z' ) )
+		{
+			c -= 'a' - 'A';
+		}
+
+		if( ( ulAt == ulEnd ) || ( ( unsigned char ) c <= ' ' ) || ( NULL != strchr( "\"*+,:;<=>?[\\]|", c ) ) )
+		{
+			return pdFAIL;
+		}
+		pucName[ ulAt++ ] = ( unsigned char ) c;
+	}
+
+	if( 0UL == ulAt )
+	{
+		return pdFAIL;
+	}
+
+	/* A first byte of 0xE5 is stored as 0x05. */
+	if( fatNAME_DELETED == pucName[ 0 ] )
+	{
+		pucName[ 0 ] = 0x05U;
+	}
+
+	while( '/' == *pcPath )
+	{
+		pcPath++;
+	}
+	*ppcPath = pcPath;
+
+	return pdPASS;
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvFATWalkStart( xFATWalk *pxWalk, unsigned long ulDirectory )
+{
+	pxWalk->ulCluster = ulDirectory;
+	if( 0UL == ulDirectory )
+	{
+		pxWalk->ulSector = xFATVol.ulRootSector;
+		pxWalk->ulLeft = xFATVol.ulRootSectors - 1UL;
+	}
+	else
+	{
+		pxWalk->ulSector = prvFATClusterSector( ulDirectory );
+		pxWalk->ulLeft = xFATVol.ulSectorsPerCluster - 1UL;
+	}
+}
+/*----------------------------------------------------------------------------*/
+
+static portBASE_TYPE prvFATWalkNext( xFATWalk *pxWalk )
+{
+unsigned long ulNext;
+
+	if( pxWalk->ulLeft > 0UL )
+	{
+		pxWalk->ulSector++;
+		pxWalk->ulLeft--;
+		return pdPASS;
+	}
+
+	if( 0UL == pxWalk->ulCluster )
+	{
+		return pdFAIL;
+	}
+
+	/* At the end ulCluster stays the last, for prvFATCreate(). */
+	ulNext = prvFATNext( pxWalk->ulCluster );
+	if( fatNO_CLUSTER == ulNext )
+	{
+		return pdFAIL;
+	}
+
+	prvFATWalkStart( pxWalk, ulNext );
+
+	return pdPASS;
+}
+/*----------------------------------------------------------------------------*/
+
+static unsigned long prvFATFileCluster( struct FAT_FILE *pxFile, unsigned long ulIndex )
+{
+const xFATRun *pxRun;
+unsigned long ulRun, ulAt, ulCluster;
+
+	for( ulRun = 0UL; ulRun < pxFile->ulRuns; ulRun++ )
+	{
+		pxRun = &pxFile->xRuns[ ulRun ];
+		if( ulIndex - pxRun->ulIndex < pxRun->ulCount )
+		{
+			fatCOUNT( ulRunHits, 1UL );
+			return pxRun->ulCluster + ( ulIndex - pxRun->ulIndex );
+		}
+	}
+
+	/* Carry on from the end of the last run. */
+	if( 0UL == pxFile->ulRuns )
+	{
+		if( 0UL == pxFile->ulFirstCluster )
+		{
+			return 0UL;
+		}
+
+		ulAt = 0UL;
+		ulCluster = pxFile->ulFirstCluster;
+		prvFATRemember( pxFile, 0UL, ulCluster );
+	}
+	else
+	{
+		pxRun = &pxFile->xRuns[ pxFile->ulRuns - 1UL ];
+		ulAt = pxRun->ulIndex + pxRun->ulCount - 1UL;
+		ulCluster = pxRun->ulCluster + pxRun->ulCount - 1UL;
+	}
+
+	if( ( 0UL != pxFile->ulCursorCluster ) && ( pxFile->ulCursorIndex > ulAt ) && ( pxFile->ulCursorIndex <= ulIndex ) )
+	{
+		ulAt = pxFile->ulCursorIndex;
+		ulCluster = pxFile->ulCursorCluster;
+	}
+
+	while( ulAt < ulIndex )
+	{
+		ulCluster = prvFATNext( ulCluster );
+		if( fatNO_CLUSTER == ulCluster )
+		{
+			return 0UL;
+		}
+
+		ulAt++;
+		prvFATRemember( pxFile, ulAt, ulCluster );
+	}
+
+	pxFile->ulCursorIndex = ulIndex;
+	pxFile->ulCursorCluster = ulCluster;
+
+	return ulCluster;
+}
+/*----------------------------------------------------------------------------*/
+
+static unsigned long prvFATGrow( struct FAT_FILE *pxFile, unsigned long ulIndex )
+{
+unsigned long ulCluster, ulPrevious = 0UL;
+
+	ulCluster = prvFATFileCluster( pxFile, ulIndex );
+	if( 0UL != ulCluster )
+	{
+		return ulCluster;
+	}
+
+	if( ulIndex > 0UL )
+	{
+		ulPrevious = prvFATFileCluster( pxFile, ulIndex - 1UL );
+		if( 0UL == ulPrevious )
+		{
+			return 0UL;
+		}
+	}
+
+	( void ) xSemaphoreTake( xFATVolumeMutex, portMAX_DELAY );
+	ulCluster = prvFATAllocate( ulPrevious );
+	( void ) xSemaphoreGive( xFATVolumeMutex );
+
+	if( 0UL != ulCluster )
+	{
+		if( 0UL == ulIndex )
+		{
+			pxFile->ulFirstCluster = ulCluster;
+			pxFile->xEntryDirty = pdTRUE;
+		}
+		prvFATRemember( pxFile, ulIndex, ulCluster );
+
+		pxFile->ulCursorIndex = ulIndex;
+		pxFile->ulCursorCluster = ulCluster;
+	}
+
+	return ulCluster;
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvFATRemember( struct FAT_FILE *pxFile, unsigned long ulIndex, unsigned long ulCluster )
+{
+xFATRun *pxRun;
+
+	if( 0UL != pxFile->ulRuns )
+	{
+		pxRun = &pxFile->xRuns[ pxFile->ulRuns - 1UL ];
+		if( ulIndex != pxRun->ulIndex + pxRun->ulCount )
+		{
+			return;
+		}
+
+		if( ulCluster == pxRun->ulCluster + pxRun->ulCount )
+		{
+			pxRun->ulCount++;
+			return;
+		}
+	}
+
+	/* Once the runs are used up the rest of the chain is walked each time. */
+	if( pxFile->ulRuns < fatCHAIN_RUNS )
+	{
+		pxRun = &pxFile->xRuns[ pxFile->ulRuns++ ];
+		pxRun->ulIndex = ulIndex;
+		pxRun->ulCluster = ulCluster;
+		pxRun->ulCount = 1UL;
+	}
+}
+/*----------------------------------------------------------------------------*/
+
+static portBASE_TYPE prvFATCopy( unsigned long ulSector, unsigned long ulOffset, unsigned char *pucData, unsigned long ulLength, portBASE_TYPE xWrite )
+{
+unsigned char *pucSector;
+unsigned long ulIn, ulCount;
+portBASE_TYPE xResult;
+
+	ulSector += ulOffset / fatSECTOR_SIZE;
+	ulIn = ulOffset % fatSECTOR_SIZE;
+
+	while( ulLength > 0UL )
+	{
+		if( ( 0UL == ulIn ) && ( ulLength >= fatSECTOR_SIZE ) )
+		{
+			/* Whole sectors in one go. */
+			ulCount = ulLength / fatSECTOR_SIZE;
+			if( pdFALSE != xWrite )
+			{
+				xResult = xBlockCacheWrite( ulSector, ulCount, pucData );
+			}
+			else
+			{
+				xResult = xBlockCacheRead( ulSector, ulCount, pucData );
+			}
+
+			if( pdFAIL == xResult )
+			{
+				return pdFAIL;
+			}
+
+			ulSector += ulCount;
+			ulCount *= fatSECTOR_SIZE;
+		}
+		else
+		{
+			ulCount = fatSECTOR_SIZE - ulIn;
+			if( ulCount > ulLength )
+			{
+				ulCount = ulLength;
+			}
+
+			pucSector = pucBlockCacheGet( ulSector, pdFALSE );
+			if( NULL == pucSector )
+			{
+				return pdFAIL;
+			}
+
+			if( pdFALSE != xWrite )
+			{
+				memcpy( pucSector + ulIn, pucData, ulCount );
+			}
+			else
+			{
+				memcpy( pucData, pucSector + ulIn, ulCount );
+			}
+			vBlockCacheRelease( pucSector, xWrite );
+
+			ulSector++;
+			ulIn = 0UL;
+		}
+
+		pucData += ulCount;
+		ulLength -= ulCount;
+	}
+
+	return pdPASS;
+}
+/*----------------------------------------------------------------------------*/
+
+static portBASE_TYPE prvFATLoadTail( struct FAT_FILE *pxFile, unsigned long ulIndex )
+{
+unsigned long ulUsed = pxFile->ulSize - ulIndex * xFATVol.ulClusterSize;
+unsigned long ulCluster;
+
+	if( 0UL != ulUsed )
+	{
+		ulCluster = prvFATFileCluster( pxFile, ulIndex );
+		if( ( 0UL == ulCluster ) ||
+			( pdFAIL == xBlockCacheRead( prvFATClusterSector( ulCluster ), ( ulUsed + fatSECTOR_SIZE - 1UL ) / fatSECTOR_SIZE, pxFile->pucTail ) ) )
+		{
+			return pdFAIL;
+		}
+	}
+
+	pxFile->ulTailIndex = ulIndex;
+	pxFile->xTailValid = pdTRUE;
+	pxFile->xTailDirty = pdFALSE;
+
+	return pdPASS;
+}
+/*----------------------------------------------------------------------------*/
+
+static portBASE_TYPE prvFATWriteTail( struct FAT_FILE *pxFile )
+{
+unsigned long ulUsed, ulSectors, ulCluster;
+portBASE_TYPE xResult;
+
+	if( ( pdFALSE == pxFile->xTailValid ) || ( pdFALSE == pxFile->xTailDirty ) )
+	{
+		return pdPASS;
+	}
+
+	ulCluster = prvFATGrow( pxFile, pxFile->ulTailIndex );
+	if( 0UL == ulCluster )
+	{
+		return pdFAIL;
+	}
+
+	ulUsed = pxFile->ulSize - pxFile->ulTailIndex * xFATVol.ulClusterSize;
+	if( ulUsed == xFATVol.ulClusterSize )
+	{
+		xResult = xBlockCacheWriteThrough( prvFATClusterSector( ulCluster ), xFATVol.ulSectorsPerCluster, pxFile->pucTail );
+		fatCOUNT( ulClusterWrites, 1UL );
+	}
+	else
+	{
+		/* The rest of the last sector is cleared. */
+		ulSectors = ( ulUsed + fatSECTOR_SIZE - 1UL ) / fatSECTOR_SIZE;
+		memset( pxFile->pucTail + ulUsed, 0, ulSectors * fatSECTOR_SIZE - ulUsed );
+		xResult = xBlockCacheWrite( prvFATClusterSector( ulCluster ), ulSectors, pxFile->pucTail );
+		fatCOUNT( ulTailWrites, 1UL );
+	}
+
+	if( pdPASS == xResult )
+	{
+		pxFile->xTailDirty = pdFALSE;
+	}
+
+	return xResult;
+}
+/*----------------------------------------------------------------------------*/
+
+static portBASE_TYPE prvFATWriteEntry( struct FAT_FILE *pxFile )
+{
+unsigned char *pucSector;
+xFATDirectoryEntry *pxEntry;
+unsigned long ulStamp = fatTIMESTAMP();
+
+	( void ) xSemaphoreTake( xFATVolumeMutex, portMAX_DELAY );
+
+	pucSector = pucBlockCacheGet( pxFile->ulEntrySector, pdFALSE );
+	if( NULL != pucSector )
+	{
+		pxEntry = ( xFATDirectoryEntry * ) ( pucSector + pxFile->ulEntryOffset );
+		pxEntry->ulSize = pxFile->ulSize;
+		pxEntry->usClusterLow = ( unsigned short ) pxFile->ulFirstCluster;
+		pxEntry->usClusterHigh = ( unsigned short ) ( pxFile->ulFirstCluster >> 16 );
+		pxEntry->usWriteDate = ( unsigned short ) ( ulStamp >> 16 );
+		pxEntry->usWriteTime = ( unsigned short ) ulStamp;
+		pxEntry->ucAttributes |= fatATTR_ARCHIVE;
+		vBlockCacheRelease( pucSector, pdTRUE );
+
+		pxFile->xEntryDirty = pdFALSE;
+	}
+
+	( void ) xSemaphoreGive( xFATVolumeMutex );
+
+	return ( NULL != pucSector ) ? pdPASS : pdFAIL;
+}
+/*----------------------------------------------------------------------------*/
+
+static portBASE_TYPE prvFATFlush( struct FAT_FILE *pxFile )
+{
+portBASE_TYPE xResult;
+
+	xResult = prvFATWriteTail( pxFile );
+
+	if( ( pdPASS == xResult ) && ( pdFALSE != pxFile->xEntryDirty ) )
+	{
+		xResult = prvFATWriteEntry( pxFile );
+	}
+
+	if( pdPASS == xResult )
+	{
+		xResult = xBlockCacheFlush();
+	}
+
+	return xResult;
+}
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,166 @@
+/*
+    FreeRTOS V7.0.1 - Copyright (C) 2011 Real Time Engineers Ltd.
+
+
+	FreeRTOS supports many tools and architectures. V7.0.0 is sponsored by:
+	Atollic AB - Atollic provides professional embedded systems development
+	tools for C/C++ development, code analysis and test automation.
+	See http://www.atollic.com
+
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS tutorial books are available in pdf and paperback.        *
+     *    Complete, revised, and edited pdf reference manuals are also       *
+     *    available.                                                         *
+     *                                                                       *
+     *    Purchasing FreeRTOS documentation will not only help you, by       *
+     *    ensuring you get running as quickly as possible and with an        *
+     *    in-depth knowledge of how to use FreeRTOS, it will also help       *
+     *    the FreeRTOS project to continue with its mission of providing     *
+     *    professional grade, cross platform, de facto standard solutions    *
+     *    for microcontrollers - completely free of charge!                  *
+     *                                                                       *
+     *    >>> See http://www.FreeRTOS.org/Documentation for details. <<<     *
+     *                                                                       *
+     *    Thank you for using FreeRTOS, and thank you for your support!      *
+     *                                                                       *
+    ***************************************************************************
+
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation AND MODIFIED BY the FreeRTOS exception.
+    >>>NOTE<<< The modification to the GPL is included to allow you to
+    distribute a combined work that includes FreeRTOS without being obliged to
+    provide the source code for proprietary components outside of the FreeRTOS
+    kernel.  FreeRTOS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details. You should have received a copy of the GNU General Public
+    License and the FreeRTOS license exception along with FreeRTOS; if not it
+    can be viewed here: http://www.freertos.org/a00114.html and also obtained
+    by writing to Richard Barry, contact details for whom are available on the
+    FreeRTOS WEB site.
+
+    1 tab == 4 spaces!
+
+    http://www.FreeRTOS.org - Documentation, latest information, license and
+    contact details.
+
+    http://www.SafeRTOS.com - A version that is certified for use in safety
+    critical systems.
+
+    http://www.OpenRTOS.com - Commercial support, development, porting,
+    licensing and training services.
+*/
+
+
+#ifndef FAT_H
+#define FAT_H
+
+/* A small FAT16 and FAT32 file system on the SD card, through the block cache,
+so that files written by the target can be read on a PC.
+
+Names are 8.3, in upper case, and paths are separated by '/'.  Files can be
+created in existing directories; directories themselves are not created.
+
+The FAT, the directories and data that is not appended are read and written
+a sector at a time through the block cache.  Each open file remembers the
+runs of contiguous clusters of its chain as it meets them, so a seek does not
+walk the FAT from the start again.  A file open for writing keeps the cluster
+at its end in a buffer: appends fill it, and it goes to the card in one
+command when it is full, or when the file is flushed.
+
+Each open file has its own mutex, so tasks using different files do not wait
+for each other, except briefly while clusters are allocated or a directory
+entry is changed.  The block cache does not hold its lock while the card is
+busy, so their transfers overlap; they only wait for a block both of them
+use, such as a shared sector of the FAT. */
+
+/* Files that can be open at once. */
+#ifndef fatMAX_OPEN_FILES
+	#define fatMAX_OPEN_FILES		( 4 )
+#endif
+
+/* Runs of contiguous clusters remembered for each open file.  A file with
+more runs than this is walked through the FAT past the last of them. */
+#ifndef fatCHAIN_RUNS
+	#define fatCHAIN_RUNS			( 8 )
+#endif
+
+/* The date and time written to directory entries, packed as the FAT wants
+them: the date in the upper halfword and the time in the lower. */
+#ifndef fatTIMESTAMP
+	#define fatTIMESTAMP()			( 0x42210000UL )	/* 1 January 2013, midnight. */
+#endif
+
+/* Modes for xFATOpen(), to be combined. */
+#define fatREAD						( 1UL )
+#define fatWRITE					( 2UL )
+#define fatCREATE					( 4UL )		/* Create the file if it is not there. */
+#define fatTRUNCATE					( 8UL )		/* Empty the file. */
+#define fatAPPEND					( 16UL )	/* Start at the end of the file. */
+
+/* For xFATSeek(). */
+#define fatSEEK_SET					( 0 )
+#define fatSEEK_CUR					( 1 )
+#define fatSEEK_END					( 2 )
+
+typedef struct FAT_FILE *xFATFileHandle;
+
+typedef struct FAT_STATISTICS
+{
+	unsigned long ulRunHits;		/* Clusters found among the remembered runs, */
+	unsigned long ulFATReads;		/* and FAT entries read to find the others. */
+	unsigned long ulClusterWrites;	/* Full clusters written with one command. */
+	unsigned long ulTailWrites;		/* Part full clusters written by a flush. */
+} xFATStats;
+
+/*
+ * Read the boot sector and find the FAT, the root directory and the data.
+ * Sector 0 may hold the boot sector, or a partition table whose first FAT
+ * partition is used.  The block cache must have been initialised.
+ */
+portBASE_TYPE xFATMount( void );
+
+/*
+ * Open the file at pcPath, or return NULL.  A file may be open more than once
+ * for reading, but only once if it is open for writing.
+ */
+xFATFileHandle xFATOpen( const char *pcPath, unsigned long ulMode );
+
+/*
+ * Read or write up to ulLength bytes at the current position and move past
+ * them.  Both return the number of bytes moved, which is less than ulLength
+ * at the end of the file or on an error.  Writing past the end makes the file
+ * longer.
+ */
+unsigned long ulFATRead( xFATFileHandle xFile, void *pvBuffer, unsigned long ulLength );
+unsigned long ulFATWrite( xFATFileHandle xFile, const void *pvBuffer, unsigned long ulLength );
+
+/*
+ * Move to lOffset from the start, the current position, or the end.  The
+ * position cannot be moved past the end.
+ */
+portBASE_TYPE xFATSeek( xFATFileHandle xFile, long lOffset, portBASE_TYPE xWhence );
+
+unsigned long ulFATTell( xFATFileHandle xFile );
+unsigned long ulFATSize( xFATFileHandle xFile );
+
+/*
+ * Put everything written so far on the card, with the directory entry.
+ */
+portBASE_TYPE xFATFlush( xFATFileHandle xFile );
+
+/*
+ * Flush and close the file.  The handle is not valid afterwards, even if the
+ * flush failed.
+ */
+portBASE_TYPE xFATClose( xFATFileHandle xFile );
+
+void vFATGetStats( xFATStats *pxStats );
+
+#endif /* FAT_H */
@@ -0,0 +1,524 @@
+/*
+    FreeRTOS V7.0.1 - Copyright (C) 2011 Real Time Engineers Ltd.
+
+
+	FreeRTOS supports many tools and architectures. V7.0.0 is sponsored by:
+	Atollic AB - Atollic provides professional embedded systems development
+	tools for C/C++ development, code analysis and test automation.
+	See http://www.atollic.com
+
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS tutorial books are available in pdf and paperback.        *
+     *    Complete, revised, and edited pdf reference manuals are also       *
+     *    available.                                                         *
+     *                                                                       *
+     *    Purchasing FreeRTOS documentation will not only help you, by       *
+     *    ensuring you get running as quickly as possible and with an        *
+     *    in-depth knowledge of how to use FreeRTOS, it will also help       *
+     *    the FreeRTOS project to continue with its mission of providing     *
+     *    professional grade, cross platform, de facto standard solutions    *
+     *    for microcontrollers - completely free of charge!                  *
+     *                                                                       *
+     *    >>> See http://www.FreeRTOS.org/Documentation for details. <<<     *
+     *                                                                       *
+     *    Thank you for using FreeRTOS, and thank you for your support!      *
+     *                                                                       *
+    ***************************************************************************
+
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation AND MODIFIED BY the FreeRTOS exception.
+    >>>NOTE<<< The modification to the GPL is included to allow you to
+    distribute a combined work that includes FreeRTOS without being obliged to
+    provide the source code for proprietary components outside of the FreeRTOS
+    kernel.  FreeRTOS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details. You should have received a copy of the GNU General Public
+    License and the FreeRTOS license exception along with FreeRTOS; if not it
+    can be viewed here: http://www.freertos.org/a00114.html and also obtained
+    by writing to Richard Barry, contact details for whom are available on the
+    FreeRTOS WEB site.
+
+    1 tab == 4 spaces!
+
+    http://www.FreeRTOS.org - Documentation, latest information, license and
+    contact details.
+
+    http://www.SafeRTOS.com - A version that is certified for use in safety
+    critical systems.
+
+    http://www.OpenRTOS.com - Commercial support, development, porting,
+    licensing and training services.
+*/
+
+/* Ethernet Driver for the LAN9118 Peripheral. */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#include "net.h"
+#include "lan9118.h"
+/*----------------------------------------------------------------------------*/
+
+#define LAN_BASE				( 0x4E000000UL )		/* Realview PBX Cortex-A9. */
+#define LAN_VECTOR_ID			( 60 )
+
+#define LANRxDataFIFO(x)		( (volatile unsigned long *)( (x) + 0x00UL ) )	/* Receive Data FIFO Port */
+#define LANTxDataFIFO(x)		( (volatile unsigned long *)( (x) + 0x20UL ) )	/* Transmit Data FIFO Port */
+#define LANRxStatusFIFO(x)		( (volatile unsigned long *)( (x) + 0x40UL ) )	/* Receive Status FIFO Port */
+#define LANTxStatusFIFO(x)		( (volatile unsigned long *)( (x) + 0x48UL ) )	/* Transmit Status FIFO Port */
+#define LANIdRev(x)				( (volatile unsigned long *)( (x) + 0x50UL ) )	/* Chip ID and Revision */
+#define LANIrqCfg(x)			( (volatile unsigned long *)( (x) + 0x54UL ) )	/* Interrupt Configuration Register */
+#define LANIntSts(x)			( (volatile unsigned long *)( (x) + 0x58UL ) )	/* Interrupt Status Register */
+#define LANIntEn(x)				( (volatile unsigned long *)( (x) + 0x5CUL ) )	/* Interrupt Enable Register */
+#define LANByteTest(x)			( (volatile unsigned long *)( (x) + 0x64UL ) )	/* Byte Order Test Register */
+#define LANFIFOInt(x)			( (volatile unsigned long *)( (x) + 0x68UL ) )	/* FIFO Level Interrupts */
+#define LANRxCfg(x)				( (volatile unsigned long *)( (x) + 0x6CUL ) )	/* Receive Configuration Register */
+#define LANTxCfg(x)				( (volatile unsigned long *)( (x) + 0x70UL ) )	/* Transmit Configuration Register */
+#define LANHwCfg(x)				( (volatile unsigned long *)( (x) + 0x74UL ) )	/* Hardware Configuration Register */
+#define LANRxDPCtrl(x)			( (volatile unsigned long *)( (x) + 0x78UL ) )	/* Receive Datapath Control Register */
+#define LANRxFIFOInf(x)			( (volatile unsigned long *)( (x) + 0x7CUL ) )	/* Receive FIFO Information Register */
+#define LANTxFIFOInf(x)			( (volatile unsigned long *)( (x) + 0x80UL ) )	/* Transmit FIFO Information Register */
+#define LANPmtCtrl(x)			( (volatile unsigned long *)( (x) + 0x84UL ) )	/* Power Management Control Register */
+#define LANRxDrop(x)			( (volatile unsigned long *)( (x) + 0xA0UL ) )	/* Receiver Dropped Frames Counter */
+#define LANMacCsrCmd(x)			( (volatile unsigned long *)( (x) + 0xA4UL ) )	/* MAC CSR Synchronizer Command Register */
+#define LANMacCsrData(x)		( (volatile unsigned long *)( (x) + 0xA8UL ) )	/* MAC CSR Synchronizer Data Register */
+#define LANAfcCfg(x)			( (volatile unsigned long *)( (x) + 0xACUL ) )	/* Automatic Flow Control Configuration Register */
+
+#define LAN_BYTE_TEST_VALUE		( 0x87654321UL )
+
+#define LAN_IRQ_CFG_TYPE		( 1UL << 0 )		/* Push-pull, */
+#define LAN_IRQ_CFG_POL			( 1UL << 4 )		/* active high, */
+#define LAN_IRQ_CFG_EN			( 1UL << 8 )		/* as the GIC wants it. */
+
+#define LAN_INT_RSFL			( 1UL << 3 )		/* Receive status FIFO above its level. */
+#define LAN_INT_RXDF			( 1UL << 6 )		/* Receiver dropped a frame. */
+#define LAN_INT_TDFA			( 1UL << 9 )		/* Transmit data FIFO has room. */
+
+#define LAN_FIFO_INT_TDAL( x )	( ( ( unsigned long ) ( x ) ) << 24 )	/* Transmit room level, in 64 byte units. */
+#define LAN_FIFO_INT_TDAL_MASK	( 0xFFUL << 24 )
+
+#define LAN_TX_CFG_TX_ON		( 1UL << 1 )
+#define LAN_TX_CFG_TXSAO		( 1UL << 2 )		/* Let the status FIFO overrun. */
+
+#define LAN_HW_CFG_SRST			( 1UL << 0 )
+#define LAN_PMT_CTRL_READY		( 1UL << 0 )
+#define LAN_RX_DP_CTRL_FFWD		( 1UL << 31 )
+
+#define LAN_RX_FIFO_INF_RXSUSED( x )	( ( ( x ) >> 16 ) & 0xFFUL )
+#define LAN_TX_FIFO_INF_TXSUSED( x )	( ( ( x ) >> 16 ) & 0xFFUL )
+#define LAN_TX_FIFO_INF_TDFREE( x )		( ( x ) & 0xFFFFUL )
+
+#define LAN_RX_STATUS_LENGTH( x )	( ( ( x ) >> 16 ) & 0x3FFFUL )
+#define LAN_STATUS_ES			( 1UL << 15 )		/* Error summary of receive and transmit status. */
+
+#define LAN_TX_CMD_A_OFFSET( x )	( ( ( unsigned long ) ( x ) ) << 16 )
+#define LAN_TX_CMD_A_FIRST		( 1UL << 13 )
+#define LAN_TX_CMD_A_LAST		( 1UL << 12 )
+#define LAN_TX_CMD_B_TAG( x )	( ( ( unsigned long ) ( x ) & 0xFFFFUL ) << 16 )
+
+#define LAN_AFC_CFG_DEFAULT		( 0x006E3740UL )	/* Flow control thresholds suggested by SMSC. */
+
+/* MAC registers, reached through the CSR synchronizer. */
+#define LAN_MAC_CR				( 1UL )
+#define LAN_MAC_ADDRH			( 2UL )
+#define LAN_MAC_ADDRL			( 3UL )
+#define LAN_MAC_MII_ACC			( 6UL )
+#define LAN_MAC_MII_DATA		( 7UL )
+
+#define LAN_MAC_CSR_BUSY		( 1UL << 31 )
+#define LAN_MAC_CSR_READ		( 1UL << 30 )
+
+#define LAN_MAC_CR_RXEN			( 1UL << 2 )
+#define LAN_MAC_CR_TXEN			( 1UL << 3 )
+#define LAN_MAC_CR_FDPX			( 1UL << 20 )
+
+#define LAN_MII_ACC_BUSY		( 1UL << 0 )
+#define LAN_MII_ACC_WRITE		( 1UL << 1 )
+#define LAN_MII_ACC_PHY( x )	( ( ( unsigned long ) ( x ) ) << 11 )
+#define LAN_MII_ACC_REG( x )	( ( ( unsigned long ) ( x ) ) << 6 )
+
+/* The internal PHY. */
+#define LAN_PHY_ADDRESS			( 1UL )
+#define LAN_PHY_BMCR			( 0UL )
+#define LAN_PHY_ANAR			( 4UL )
+
+#define LAN_PHY_BMCR_RESET		( 0x8000UL )
+#define LAN_PHY_BMCR_ANEN		( 0x1000UL )
+#define LAN_PHY_BMCR_ANRESTART	( 0x0200UL )
+
+/* Advertise full duplex only, so that the MAC can be set up for full duplex
+without waiting for the outcome. */
+#define LAN_PHY_ANAR_FULL_DUPLEX	( 0x0141UL )	/* 100BASE-TX FD, 10BASE-T FD, 802.3. */
+
+/* How many times a register is read waiting for the controller. */
+#define LAN_POLL_LIMIT			( 100000UL )
+
+/* Frames shorter than four words cannot be skipped with RX_FFWD. */
+#define LAN_FFWD_MIN_WORDS		( 4UL )
+
+/* Used if the EEPROM gives no address: locally administered. */
+static const unsigned char ucLANDefaultMAC[ 6 ] = { 0x02, 0x00, 0x00, 0x91, 0x18, 0x01 };
+/*----------------------------------------------------------------------------*/
+
+/* Serialises the tasks writing to the transmit FIFO. */
+static xSemaphoreHandle xLANTxMutex = NULL;
+
+/* Given by the interrupt when the transmit FIFO has room again. */
+static xSemaphoreHandle xLANTxRoom = NULL;
+
+static xLAN9118Stats xLANStats;
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Reads frames into network buffers, and wakes a task waiting for room in
+ * the transmit FIFO.
+ */
+void vLAN9118InterruptHandler( void *pvParameter );
+
+/*
+ * Poll until ( *pulRegister & ulMask ) == ulValue, giving up after
+ * LAN_POLL_LIMIT reads.
+ */
+static portBASE_TYPE prvLANWaitFor( volatile unsigned long *pulRegister, unsigned long ulMask, unsigned long ulValue );
+
+/*
+ * Access the MAC and PHY registers, which are behind the CSR synchronizer and
+ * the MII.
+ */
+static unsigned long prvLANMACRead( unsigned long ulRegister );
+static void prvLANMACWrite( unsigned long ulRegister, unsigned long ulValue );
+static unsigned long prvLANPHYRead( unsigned long ulRegister );
+static void prvLANPHYWrite( unsigned long ulRegister, unsigned long ulValue );
+
+/*
+ * Skip the ulWords words of a frame in the receive data FIFO.
+ */
+static void prvLANDiscard( unsigned long ulWords );
+
+/*
+ * Count the errors reported by the transmit status FIFO.
+ */
+static void prvLANReapTxStatus( void );
+/*----------------------------------------------------------------------------*/
+
+static portBASE_TYPE prvLANWaitFor( volatile unsigned long *pulRegister, unsigned long ulMask, unsigned long ulValue )
+{
+unsigned long ulPolls;
+
+	for( ulPolls = 0UL; ulPolls < LAN_POLL_LIMIT; ulPolls++ )
+	{
+		if( ( *pulRegister & ulMask ) == ulValue )
+		{
+			return pdPASS;
+		}
+	}
+
+	return pdFAIL;
+}
+/*----------------------------------------------------------------------------*/
+
+static unsigned long prvLANMACRead( unsigned long ulRegister )
+{
+	( void ) prvLANWaitFor( LANMacCsrCmd( LAN_BASE ), LAN_MAC_CSR_BUSY, 0UL );
+	*LANMacCsrCmd( LAN_BASE ) = LAN_MAC_CSR_BUSY | LAN_MAC_CSR_READ | ulRegister;
+	( void ) prvLANWaitFor( LANMacCsrCmd( LAN_BASE ), LAN_MAC_CSR_BUSY, 0UL );
+
+	return *LANMacCsrData( LAN_BASE );
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvLANMACWrite( unsigned long ulRegister, unsigned long ulValue )
+{
+	( void ) prvLANWaitFor( LANMacCsrCmd( LAN_BASE ), LAN_MAC_CSR_BUSY, 0UL );
+	*LANMacCsrData( LAN_BASE ) = ulValue;
+	*LANMacCsrCmd( LAN_BASE ) = LAN_MAC_CSR_BUSY | ulRegister;
+	( void ) prvLANWaitFor( LANMacCsrCmd( LAN_BASE ), LAN_MAC_CSR_BUSY, 0UL );
+}
+/*----------------------------------------------------------------------------*/
+
+static unsigned long prvLANPHYRead( unsigned long ulRegister )
+{
+unsigned long ulPolls;
+
+	prvLANMACWrite( LAN_MAC_MII_ACC, LAN_MII_ACC_PHY( LAN_PHY_ADDRESS ) | LAN_MII_ACC_REG( ulRegister ) | LAN_MII_ACC_BUSY );
+
+	for( ulPolls = 0UL; ( ulPolls < LAN_POLL_LIMIT ) && ( prvLANMACRead( LAN_MAC_MII_ACC ) & LAN_MII_ACC_BUSY ); ulPolls++ )
+	{
+	}
+
+	return prvLANMACRead( LAN_MAC_MII_DATA ) & 0xFFFFUL;
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvLANPHYWrite( unsigned long ulRegister, unsigned long ulValue )
+{
+unsigned long ulPolls;
+
+	prvLANMACWrite( LAN_MAC_MII_DATA, ulValue );
+	prvLANMACWrite( LAN_MAC_MII_ACC, LAN_MII_ACC_PHY( LAN_PHY_ADDRESS ) | LAN_MII_ACC_REG( ulRegister ) | LAN_MII_ACC_WRITE | LAN_MII_ACC_BUSY );
+
+	for( ulPolls = 0UL; ( ulPolls < LAN_POLL_LIMIT ) && ( prvLANMACRead( LAN_MAC_MII_ACC ) & LAN_MII_ACC_BUSY ); ulPolls++ )
+	{
+	}
+}
+/*----------------------------------------------------------------------------*/
+
+portBASE_TYPE xLAN9118Initialise( void )
+{
+extern void vPortInstallInterruptHandler( void (*vHandler)(void *), void *pvParameter, unsigned long ulVector, unsigned char ucEdgeTriggered, unsigned char ucPriority, unsigned char ucProcessorTargets );
+unsigned long ulPolls, ulLow, ulHigh;
+
+	if( LAN_BYTE_TEST_VALUE != *LANByteTest( LAN_BASE ) )
+	{
+		return pdFAIL;
+	}
+
+	*LANHwCfg( LAN_BASE ) = LAN_HW_CFG_SRST;
+	if( ( pdFAIL == prvLANWaitFor( LANHwCfg( LAN_BASE ), LAN_HW_CFG_SRST, 0UL ) ) ||
+		( pdFAIL == prvLANWaitFor( LANPmtCtrl( LAN_BASE ), LAN_PMT_CTRL_READY, LAN_PMT_CTRL_READY ) ) )
+	{
+		return pdFAIL;
+	}
+
+	if( NULL == xLANTxMutex )
+	{
+		xLANTxMutex = xSemaphoreCreateMutex();
+		vSemaphoreCreateBinary( xLANTxRoom );
+		if( ( NULL == xLANTxMutex ) || ( NULL == xLANTxRoom ) )
+		{
+			return pdFAIL;
+		}
+	}
+	( void ) xSemaphoreTake( xLANTxRoom, 0 );
+
+	*LANAfcCfg( LAN_BASE ) = LAN_AFC_CFG_DEFAULT;
+
+	prvLANPHYWrite( LAN_PHY_BMCR, LAN_PHY_BMCR_RESET );
+	for( ulPolls = 0UL; ( ulPolls < LAN_POLL_LIMIT ) && ( prvLANPHYRead( LAN_PHY_BMCR ) & LAN_PHY_BMCR_RESET ); ulPolls++ )
+	{
+	}
+	prvLANPHYWrite( LAN_PHY_ANAR, LAN_PHY_ANAR_FULL_DUPLEX );
+	prvLANPHYWrite( LAN_PHY_BMCR, LAN_PHY_BMCR_ANEN | LAN_PHY_BMCR_ANRESTART );
+
+	/* The address is loaded from the EEPROM on reset, if there is one. */
+	ulLow = prvLANMACRead( LAN_MAC_ADDRL );
+	ulHigh = prvLANMACRead( LAN_MAC_ADDRH ) & 0xFFFFUL;
+	if( ( ( 0UL == ulLow ) && ( 0UL == ulHigh ) ) || ( ( 0xFFFFFFFFUL == ulLow ) && ( 0xFFFFUL == ulHigh ) ) )
+	{
+		prvLANMACWrite( LAN_MAC_ADDRL, ( unsigned long ) ucLANDefaultMAC[ 0 ] | ( ( unsigned long ) ucLANDefaultMAC[ 1 ] << 8 ) |
+						( ( unsigned long ) ucLANDefaultMAC[ 2 ] << 16 ) | ( ( unsigned long ) ucLANDefaultMAC[ 3 ] << 24 ) );
+		prvLANMACWrite( LAN_MAC_ADDRH, ( unsigned long ) ucLANDefaultMAC[ 4 ] | ( ( unsigned long ) ucLANDefaultMAC[ 5 ] << 8 ) );
+	}
+
+	prvLANMACWrite( LAN_MAC_CR, LAN_MAC_CR_RXEN | LAN_MAC_CR_TXEN | LAN_MAC_CR_FDPX );
+	*LANTxCfg( LAN_BASE ) = LAN_TX_CFG_TX_ON | LAN_TX_CFG_TXSAO;
+	*LANRxCfg( LAN_BASE ) = 0UL;
+
+	/* Interrupt as soon as the receive status FIFO holds one status. */
+	*LANFIFOInt( LAN_BASE ) = LAN_FIFO_INT_TDAL( 0xFFUL );
+	*LANIntSts( LAN_BASE ) = 0xFFFFFFFFUL;
+	*LANIntEn( LAN_BASE ) = LAN_INT_RSFL | LAN_INT_RXDF;
+	*LANIrqCfg( LAN_BASE ) = LAN_IRQ_CFG_EN | LAN_IRQ_CFG_POL | LAN_IRQ_CFG_TYPE;
+
+	vPortInstallInterruptHandler( vLAN9118InterruptHandler, NULL, LAN_VECTOR_ID, pdFALSE, configMAX_SYSCALL_INTERRUPT_PRIORITY, 1 << portCORE_ID() );
+
+	return pdPASS;
+}
+/*----------------------------------------------------------------------------*/
+
+void vLAN9118GetMACAddress( unsigned char *pucAddress )
+{
+unsigned long ulLow = prvLANMACRead( LAN_MAC_ADDRL );
+unsigned long ulHigh = prvLANMACRead( LAN_MAC_ADDRH );
+
+	pucAddress[ 0 ] = ( unsigned char ) ulLow;
+	pucAddress[ 1 ] = ( unsigned char ) ( ulLow >> 8 );
+	pucAddress[ 2 ] = ( unsigned char ) ( ulLow >> 16 );
+	pucAddress[ 3 ] = ( unsigned char ) ( ulLow >> 24 );
+	pucAddress[ 4 ] = ( unsigned char ) ulHigh;
+	pucAddress[ 5 ] = ( unsigned char ) ( ulHigh >> 8 );
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvLANDiscard( unsigned long ulWords )
+{
+	if( ulWords >= LAN_FFWD_MIN_WORDS )
+	{
+		*LANRxDPCtrl( LAN_BASE ) = LAN_RX_DP_CTRL_FFWD;
+		( void ) prvLANWaitFor( LANRxDPCtrl( LAN_BASE ), LAN_RX_DP_CTRL_FFWD, 0UL );
+	}
+	else
+	{
+		while( ulWords-- > 0UL )
+		{
+			( void ) *LANRxDataFIFO( LAN_BASE );
+		}
+	}
+}
+/*----------------------------------------------------------------------------*/
+
+void vLAN9118InterruptHandler( void *pvParameter )
+{
+unsigned long ulStatus, ulRxStatus, ulLength, ulWords, ulWord;
+unsigned short *pusData;
+xNetBuffer *pxBuffer;
+portBASE_TYPE xTaskWoken = pdFALSE;
+
+	( void ) pvParameter;
+
+	/* Acknowledge first, so a frame that arrives while the FIFO is drained
+	raises the interrupt again. */
+	ulStatus = *LANIntSts( LAN_BASE ) & *LANIntEn( LAN_BASE );
+	*LANIntSts( LAN_BASE ) = ulStatus;
+	xLANStats.ulInterrupts++;
+
+	if( ulStatus & LAN_INT_RXDF )
+	{
+		xLANStats.ulRxOverruns += *LANRxDrop( LAN_BASE );
+	}
+
+	while( LAN_RX_FIFO_INF_RXSUSED( *LANRxFIFOInf( LAN_BASE ) ) > 0UL )
+	{
+		ulRxStatus = *LANRxStatusFIFO( LAN_BASE );
+		ulLength = LAN_RX_STATUS_LENGTH( ulRxStatus );
+		ulWords = ( ulLength + 3UL ) >> 2;
+		pxBuffer = NULL;
+
+		if( ( ulRxStatus & LAN_STATUS_ES ) || ( ulLength < netETHERNET_HEADER_SIZE + 4UL ) || ( ulLength > netETHERNET_HEADER_SIZE + netMTU + 4UL ) )
+		{
+			xLANStats.ulRxErrors++;
+		}
+		else
+		{
+			pxBuffer = pxNetBufferAllocFromISR();
+			if( NULL == pxBuffer )
+			{
+				xLANStats.ulRxNoBuffer++;
+			}
+		}
+
+		if( NULL == pxBuffer )
+		{
+			prvLANDiscard( ulWords );
+			continue;
+		}
+
+		/* The frame starts at a halfword boundary, so each word read from
+		the FIFO is stored as two halfwords. */
+		pusData = ( unsigned short * ) pxBuffer->pucData;
+		while( ulWords-- > 0UL )
+		{
+			ulWord = *LANRxDataFIFO( LAN_BASE );
+			*pusData++ = ( unsigned short ) ulWord;
+			*pusData++ = ( unsigned short ) ( ulWord >> 16 );
+		}
+
+		/* Without the FCS. */
+		pxBuffer->ulLength = ulLength - 4UL;
+		xLANStats.ulRxFrames++;
+		vNetReceiveFromISR( pxBuffer, &xTaskWoken );
+	}
+
+	if( ulStatus & LAN_INT_TDFA )
+	{
+		/* Enabled again by the next task to find the FIFO full. */
+		*LANIntEn( LAN_BASE ) &= ~LAN_INT_TDFA;
+		( void ) xSemaphoreGiveFromISR( xLANTxRoom, &xTaskWoken );
+	}
+
+	portEND_SWITCHING_ISR( xTaskWoken );
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvLANReapTxStatus( void )
+{
+	while( LAN_TX_FIFO_INF_TXSUSED( *LANTxFIFOInf( LAN_BASE ) ) > 0UL )
+	{
+		if( *LANTxStatusFIFO( LAN_BASE ) & LAN_STATUS_ES )
+		{
+			xLANStats.ulTxErrors++;
+		}
+	}
+}
+/*----------------------------------------------------------------------------*/
+
+portBASE_TYPE xLAN9118Transmit( xNetBuffer *pxBuffer, portTickType xDelay )
+{
+unsigned long ulOffset = ( unsigned long ) pxBuffer->pucData & 3UL;
+unsigned long ulLength = pxBuffer->ulLength;
+unsigned long ulWords = ( ulOffset + ulLength + 3UL ) >> 2;
+unsigned long ulNeeded = ( ulWords + 2UL ) << 2;
+const unsigned long *pulData = ( const unsigned long * ) ( pxBuffer->pucData - ulOffset );
+portBASE_TYPE xReturn = pdFAIL;
+xTimeOutType xTimeOut;
+
+	if( ( ulLength > 0UL ) && ( ulLength <= netETHERNET_HEADER_SIZE + netMTU ) && ( pdTRUE == xSemaphoreTake( xLANTxMutex, xDelay ) ) )
+	{
+		prvLANReapTxStatus();
+		vTaskSetTimeOutState( &xTimeOut );
+		xReturn = pdPASS;
+
+		while( LAN_TX_FIFO_INF_TDFREE( *LANTxFIFOInf( LAN_BASE ) ) < ulNeeded )
+		{
+			if( pdFALSE != xTaskCheckForTimeOut( &xTimeOut, &xDelay ) )
+			{
+				xLANStats.ulTxTimeouts++;
+				xReturn = pdFAIL;
+				break;
+			}
+
+			/* Ask to be told when there is room for this frame.  The FIFO is
+			polled again every tick in case it drained before the interrupt was
+			enabled. */
+			taskENTER_CRITICAL();
+			{
+				*LANFIFOInt( LAN_BASE ) = ( *LANFIFOInt( LAN_BASE ) & ~LAN_FIFO_INT_TDAL_MASK ) | LAN_FIFO_INT_TDAL( ( ulNeeded + 63UL ) >> 6 );
+				*LANIntSts( LAN_BASE ) = LAN_INT_TDFA;
+				*LANIntEn( LAN_BASE ) |= LAN_INT_TDFA;
+			}
+			taskEXIT_CRITICAL();
+
+			( void ) xSemaphoreTake( xLANTxRoom, 1 );
+		}
+
+		if( pdPASS == xReturn )
+		{
+			/* The whole frame in one buffer, starting ulOffset bytes into its
+			first word. */
+			*LANTxDataFIFO( LAN_BASE ) = LAN_TX_CMD_A_OFFSET( ulOffset ) | LAN_TX_CMD_A_FIRST | LAN_TX_CMD_A_LAST | ulLength;
+			*LANTxDataFIFO( LAN_BASE ) = LAN_TX_CMD_B_TAG( xLANStats.ulTxFrames ) | ulLength;
+
+			while( ulWords-- > 0UL )
+			{
+				*LANTxDataFIFO( LAN_BASE ) = *pulData++;
+			}
+
+			xLANStats.ulTxFrames++;
+		}
+
+		( void ) xSemaphoreGive( xLANTxMutex );
+	}
+
+	vNetBufferFree( pxBuffer );
+
+	return xReturn;
+}
+/*----------------------------------------------------------------------------*/
+
+void vLAN9118GetStats( xLAN9118Stats *pxStats )
+{
+	taskENTER_CRITICAL();
+	{
+		*pxStats = xLANStats;
+	}
+	taskEXIT_CRITICAL();
+}
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,103 @@
+/*
+    FreeRTOS V7.0.1 - Copyright (C) 2011 Real Time Engineers Ltd.
+
+
+	FreeRTOS supports many tools and architectures. V7.0.0 is sponsored by:
+	Atollic AB - Atollic provides professional embedded systems development
+	tools for C/C++ development, code analysis and test automation.
+	See http://www.atollic.com
+
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS tutorial books are available in pdf and paperback.        *
+     *    Complete, revised, and edited pdf reference manuals are also       *
+     *    available.                                                         *
+     *                                                                       *
+     *    Purchasing FreeRTOS documentation will not only help you, by       *
+     *    ensuring you get running as quickly as possible and with an        *
+     *    in-depth knowledge of how to use FreeRTOS, it will also help       *
+     *    the FreeRTOS project to continue with its mission of providing     *
+     *    professional grade, cross platform, de facto standard solutions    *
+     *    for microcontrollers - completely free of charge!                  *
+     *                                                                       *
+     *    >>> See http://www.FreeRTOS.org/Documentation for details. <<<     *
+     *                                                                       *
+     *    Thank you for using FreeRTOS, and thank you for your support!      *
+     *                                                                       *
+    ***************************************************************************
+
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation AND MODIFIED BY the FreeRTOS exception.
+    >>>NOTE<<< The modification to the GPL is included to allow you to
+    distribute a combined work that includes FreeRTOS without being obliged to
+    provide the source code for proprietary components outside of the FreeRTOS
+    kernel.  FreeRTOS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details. You should have received a copy of the GNU General Public
+    License and the FreeRTOS license exception along with FreeRTOS; if not it
+    can be viewed here: http://www.freertos.org/a00114.html and also obtained
+    by writing to Richard Barry, contact details for whom are available on the
+    FreeRTOS WEB site.
+
+    1 tab == 4 spaces!
+
+    http://www.FreeRTOS.org - Documentation, latest information, license and
+    contact details.
+
+    http://www.SafeRTOS.com - A version that is certified for use in safety
+    critical systems.
+
+    http://www.OpenRTOS.com - Commercial support, development, porting,
+    licensing and training services.
+*/
+
+#ifndef LAN9118_H
+#define LAN9118_H
+
+/* Driver for the SMSC LAN9118 Ethernet controller of the Realview PBX-A9.
+The interrupt reads each received frame into a network buffer and hands it to
+vNetReceiveFromISR().  Frames are written to the transmit FIFO by the task
+sending them, which only waits if the FIFO has no room. */
+
+#include "net.h"
+
+typedef struct LAN9118_STATISTICS
+{
+	unsigned long ulInterrupts;
+	unsigned long ulRxFrames;
+	unsigned long ulRxErrors;		/* Frames with a bad FCS, or too short or long. */
+	unsigned long ulRxNoBuffer;		/* Frames discarded because the pool was empty. */
+	unsigned long ulRxOverruns;		/* Frames dropped by the controller with its FIFO full. */
+	unsigned long ulTxFrames;
+	unsigned long ulTxErrors;		/* Frames reported as failed by the transmit status. */
+	unsigned long ulTxTimeouts;		/* Frames not sent because the FIFO stayed full. */
+} xLAN9118Stats;
+
+/*
+ * Reset the controller, start autonegotiation, and enable the receiver, the
+ * transmitter and the receive interrupt.  The network buffer pool must exist.
+ * Returns pdFAIL if no LAN9118 answers.
+ */
+portBASE_TYPE xLAN9118Initialise( void );
+
+/*
+ * The six byte MAC address, from the EEPROM if it holds one.
+ */
+void vLAN9118GetMACAddress( unsigned char *pucAddress );
+
+/*
+ * Send the ulLength bytes of frame at pucData, without the FCS, waiting up to
+ * xDelay ticks for room in the transmit FIFO.  The buffer is freed whether or
+ * not it was sent.
+ */
+portBASE_TYPE xLAN9118Transmit( xNetBuffer *pxBuffer, portTickType xDelay );
+
+void vLAN9118GetStats( xLAN9118Stats *pxStats );
+
+#endif /* LAN9118_H */
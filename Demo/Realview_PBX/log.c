@@ -0,0 +1,477 @@
+/*
+    FreeRTOS V7.0.1 - Copyright (C) 2011 Real Time Engineers Ltd.
+
+
+	FreeRTOS supports many tools and architectures. V7.0.0 is sponsored by:
+	Atollic AB - Atollic provides professional embedded systems development
+	tools for C/C++ development, code analysis and test automation.
+	See http://www.atollic.com
+
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS tutorial books are available in pdf and paperback.        *
+     *    Complete, revised, and edited pdf reference manuals are also       *
+     *    available.                                                         *
+     *                                                                       *
+     *    Purchasing FreeRTOS documentation will not only help you, by       *
+     *    ensuring you get running as quickly as possible and with an        *
+     *    in-depth knowledge of how to use FreeRTOS, it will also help       *
+     *    the FreeRTOS project to continue with its mission of providing     *
+     *    professional grade, cross platform, de facto standard solutions    *
+     *    for microcontrollers - completely free of charge!                  *
+     *                                                                       *
+     *    >>> See http://www.FreeRTOS.org/Documentation for details. <<<     *
+     *                                                                       *
+     *    Thank you for using FreeRTOS, and thank you for your support!      *
+     *                                                                       *
+    ***************************************************************************
+
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation AND MODIFIED BY the FreeRTOS exception.
+    >>>NOTE<<< The modification to the GPL is included to allow you to
+    distribute a combined work that includes FreeRTOS without being obliged to
+    provide the source code for proprietary components outside of the FreeRTOS
+    kernel.  FreeRTOS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details. You should have received a copy of the GNU General Public
+    License and the FreeRTOS license exception along with FreeRTOS; if not it
+    can be viewed here: http://www.freertos.org/a00114.html and also obtained
+    by writing to Richard Barry, contact details for whom are available on the
+    FreeRTOS WEB site.
+
+    1 tab == 4 spaces!
+
+    http://www.FreeRTOS.org - Documentation, latest information, license and
+    contact details.
+
+    http://www.SafeRTOS.com - A version that is certified for use in safety
+    critical systems.
+
+    http://www.OpenRTOS.com - Commercial support, development, porting,
+    licensing and training services.
+*/
+
+/* Deferred logging through a lock free ring drained by a task. */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#include "serial.h"
+#include "log.h"
+/*----------------------------------------------------------------------------*/
+
+#if ( logRING_RECORDS & ( logRING_RECORDS - 1 ) ) != 0
+	#error logRING_RECORDS must be a power of two.
+#endif
+
+#if logMAX_MESSAGE_LENGTH > 256
+	#error logMAX_MESSAGE_LENGTH must fit the length byte of a record.
+#endif
+
+/* The longest the drain task blocks between looks at the ring. */
+#define logDRAIN_PERIOD			( ( portTickType ) 100 / portTICK_RATE_MS )
+
+/* Records are gathered into one UART write of up to this many bytes. */
+#define logBATCH_SIZE			( 512 )
+
+#if ( logBINARY_FORMAT == 1 )
+	/* A frame with every argument used. */
+	#define logENCODED_MAX		( 10 + ( 4 * logMAX_ARGUMENTS ) )
+#else
+	/* A message with the "[tick] L " prefix and the end of line around it. */
+	#define logENCODED_MAX		( logMAX_MESSAGE_LENGTH + 16 )
+#endif
+
+#define logDRAIN_STACK_SIZE		( configMINIMAL_STACK_SIZE * 2 )
+/*----------------------------------------------------------------------------*/
+
+/* A slot of the ring.  ulSequence equals the index a producer may claim the
+slot for while it is free, and that index plus one once its record is ready
+for the drain task (Vyukov's bounded queue). */
+typedef struct LOG_RECORD
+{
+	volatile unsigned long ulSequence;
+	portTickType xTime;
+	unsigned char ucLevel;
+	unsigned char ucLength;			/* Characters of text, or arguments in binary mode. */
+#if ( logBINARY_FORMAT == 1 )
+	const char *pcFormat;
+	unsigned long ulArguments[ logMAX_ARGUMENTS ];
+#else
+	char cText[ logMAX_MESSAGE_LENGTH ];
+#endif
+} xLogRecord;
+
+static xLogRecord xLogRing[ logRING_RECORDS ];
+
+/* The next index to claim, shared by every producer. */
+static volatile unsigned long ulLogHead = 0UL;
+
+/* The next index to drain, owned by the drain task. */
+static unsigned long ulLogTail = 0UL;
+
+static volatile unsigned portBASE_TYPE uxLogLevel = logCOMPILE_LEVEL;
+static volatile xLogStats xLogCounters = { 0UL, 0UL, 0UL, 0UL };
+
+/* Set by the drain task before it blocks, so producers only give the
+semaphore when there is someone to wake. */
+static volatile unsigned long ulLogDrainIdle = 0UL;
+static xSemaphoreHandle xLogWake = NULL;
+
+static char cLogBatch[ logBATCH_SIZE ];
+
+#if ( logBINARY_FORMAT == 0 )
+	static const char cLogLevelNames[] = { 'E', 'W', 'I', 'D' };
+#endif
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Claim a free slot, setting *pulIndex to the index it was claimed for.
+ * Returns NULL, having counted the drop, if the ring is full.
+ */
+static xLogRecord *prvLogClaim( unsigned long *pulIndex );
+
+/*
+ * Hand a filled slot to the drain task and wake it if it is waiting.
+ */
+static void prvLogPublish( xLogRecord *pxRecord, unsigned long ulIndex );
+
+/*
+ * Write a record, or the report of ulDropped lost records, to pcBuffer as the
+ * UART should see it.  Return the bytes written, at most logENCODED_MAX.
+ */
+static size_t prvLogEncode( char *pcBuffer, const xLogRecord *pxRecord );
+static size_t prvLogEncodeDropped( char *pcBuffer, unsigned long ulDropped );
+
+#if ( logBINARY_FORMAT == 1 )
+	/*
+	 * Store ulWord little endian at pcBuffer and return the byte after it.
+	 */
+	static char *prvLogPutWord( char *pcBuffer, unsigned long ulWord );
+#endif
+
+/*
+ * Writes the ring out in batches.
+ */
+static void prvLogDrainTask( void *pvParameters );
+/*----------------------------------------------------------------------------*/
+
+void vLogInitialise( unsigned portBASE_TYPE uxPriority )
+{
+unsigned long ulIndex;
+
+	for( ulIndex = 0UL; ulIndex < logRING_RECORDS; ulIndex++ )
+	{
+		xLogRing[ ulIndex ].ulSequence = ulIndex;
+	}
+
+	vSemaphoreCreateBinary( xLogWake );
+	configASSERT( xLogWake );
+
+	xTaskCreate( prvLogDrainTask, ( signed char * ) "log", logDRAIN_STACK_SIZE, NULL, uxPriority, NULL );
+}
+/*----------------------------------------------------------------------------*/
+
+void vLogSetLevel( unsigned portBASE_TYPE uxLevel )
+{
+	uxLogLevel = uxLevel;
+}
+/*----------------------------------------------------------------------------*/
+
+unsigned portBASE_TYPE uxLogGetLevel( void )
+{
+	return uxLogLevel;
+}
+/*----------------------------------------------------------------------------*/
+
+void vLogGetStats( xLogStats *pxStats )
+{
+	pxStats->ulWritten = xLogCounters.ulWritten;
+	pxStats->ulDropped = xLogCounters.ulDropped;
+	pxStats->ulTruncated = xLogCounters.ulTruncated;
+	pxStats->ulFiltered = xLogCounters.ulFiltered;
+}
+/*----------------------------------------------------------------------------*/
+
+static xLogRecord *prvLogClaim( unsigned long *pulIndex )
+{
+unsigned long ulIndex, ulSequence;
+long lDifference;
+xLogRecord *pxRecord;
+
+	ulIndex = __atomic_load_n( &ulLogHead, __ATOMIC_RELAXED );
+
+	for( ;; )
+	{
+		pxRecord = &xLogRing[ ulIndex & ( logRING_RECORDS - 1 ) ];
+		ulSequence = __atomic_load_n( &pxRecord->ulSequence, __ATOMIC_ACQUIRE );
+		lDifference = ( long ) ( ulSequence - ulIndex );
+
+		if( lDifference == 0L )
+		{
+			/* Free.  On failure ulIndex is reloaded with the current head. */
+			if( __atomic_compare_exchange_n( &ulLogHead, &ulIndex, ulIndex + 1UL, pdFALSE, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) )
+			{
+				*pulIndex = ulIndex;
+				return pxRecord;
+			}
+		}
+		else if( lDifference < 0L )
+		{
+			/* Still holds a record from the previous lap. */
+			__atomic_fetch_add( &xLogCounters.ulDropped, 1UL, __ATOMIC_RELAXED );
+			return NULL;
+		}
+		else
+		{
+			/* Another producer got there first. */
+			ulIndex = __atomic_load_n( &ulLogHead, __ATOMIC_RELAXED );
+		}
+	}
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvLogPublish( xLogRecord *pxRecord, unsigned long ulIndex )
+{
+portBASE_TYPE xWoken = pdFALSE;
+
+	__atomic_store_n( &pxRecord->ulSequence, ulIndex + 1UL, __ATOMIC_SEQ_CST );
+
+	/* Ordered after the store above, so either this sees the drain task idle
+	or the drain task sees the record when it looks again before blocking. */
+	if( __atomic_exchange_n( &ulLogDrainIdle, 0UL, __ATOMIC_SEQ_CST ) != 0UL )
+	{
+		/* Safe in any context on this port.  The drain task has a low
+		priority, so there is no need to yield for it. */
+		xSemaphoreGiveFromISR( xLogWake, &xWoken );
+	}
+}
+/*----------------------------------------------------------------------------*/
+
+#if ( logBINARY_FORMAT == 1 )
+
+void vLogBinary( unsigned portBASE_TYPE uxLevel, const char *pcFormat, unsigned portBASE_TYPE uxCount, ... )
+{
+xLogRecord *pxRecord;
+unsigned long ulIndex;
+unsigned portBASE_TYPE uxArgument;
+va_list xArgs;
+
+	if( uxLevel > uxLogLevel )
+	{
+		__atomic_fetch_add( &xLogCounters.ulFiltered, 1UL, __ATOMIC_RELAXED );
+		return;
+	}
+
+	pxRecord = prvLogClaim( &ulIndex );
+	if( pxRecord == NULL )
+	{
+		return;
+	}
+
+	pxRecord->xTime = xTaskGetTickCountFromISR();
+	pxRecord->ucLevel = ( unsigned char ) uxLevel;
+	pxRecord->ucLength = ( unsigned char ) uxCount;
+	pxRecord->pcFormat = pcFormat;
+
+	va_start( xArgs, uxCount );
+	for( uxArgument = 0; uxArgument < uxCount; uxArgument++ )
+	{
+		pxRecord->ulArguments[ uxArgument ] = va_arg( xArgs, unsigned long );
+	}
+	va_end( xArgs );
+
+	prvLogPublish( pxRecord, ulIndex );
+}
+/*----------------------------------------------------------------------------*/
+
+void vLogCheckFormat( const char *pcFormat, ... )
+{
+	( void ) pcFormat;
+}
+/*----------------------------------------------------------------------------*/
+
+static char *prvLogPutWord( char *pcBuffer, unsigned long ulWord )
+{
+	*pcBuffer++ = ( char ) ( ulWord & 0xFFUL );
+	*pcBuffer++ = ( char ) ( ( ulWord >> 8 ) & 0xFFUL );
+	*pcBuffer++ = ( char ) ( ( ulWord >> 16 ) & 0xFFUL );
+	*pcBuffer++ = ( char ) ( ( ulWord >> 24 ) & 0xFFUL );
+	return pcBuffer;
+}
+/*----------------------------------------------------------------------------*/
+
+static size_t prvLogEncode( char *pcBuffer, const xLogRecord *pxRecord )
+{
+char *pcNext = pcBuffer;
+unsigned portBASE_TYPE uxArgument;
+
+	/* The format is identified by its offset in the unloaded .logfmt
+	section, which is its address as the linker script places it at 0. */
+	*pcNext++ = ( char ) logFRAME_START;
+	*pcNext++ = ( char ) ( ( pxRecord->ucLevel << 4 ) | pxRecord->ucLength );
+	pcNext = prvLogPutWord( pcNext, ( unsigned long ) pxRecord->xTime );
+	pcNext = prvLogPutWord( pcNext, ( unsigned long ) pxRecord->pcFormat );
+
+	for( uxArgument = 0; uxArgument < pxRecord->ucLength; uxArgument++ )
+	{
+		pcNext = prvLogPutWord( pcNext, pxRecord->ulArguments[ uxArgument ] );
+	}
+
+	return ( size_t ) ( pcNext - pcBuffer );
+}
+/*----------------------------------------------------------------------------*/
+
+static size_t prvLogEncodeDropped( char *pcBuffer, unsigned long ulDropped )
+{
+char *pcNext = pcBuffer;
+
+	*pcNext++ = ( char ) logFRAME_START;
+	*pcNext++ = ( char ) ( ( logLEVEL_WARN << 4 ) | 1U );
+	pcNext = prvLogPutWord( pcNext, ( unsigned long ) xTaskGetTickCount() );
+	pcNext = prvLogPutWord( pcNext, logFRAME_DROPPED );
+	pcNext = prvLogPutWord( pcNext, ulDropped );
+
+	return ( size_t ) ( pcNext - pcBuffer );
+}
+/*----------------------------------------------------------------------------*/
+
+#else
+
+void vLogPrintf( unsigned portBASE_TYPE uxLevel, const char *pcFormat, ... )
+{
+xLogRecord *pxRecord;
+unsigned long ulIndex;
+va_list xArgs;
+int iLength;
+
+	if( uxLevel > uxLogLevel )
+	{
+		__atomic_fetch_add( &xLogCounters.ulFiltered, 1UL, __ATOMIC_RELAXED );
+		return;
+	}
+
+	pxRecord = prvLogClaim( &ulIndex );
+	if( pxRecord == NULL )
+	{
+		return;
+	}
+
+	pxRecord->xTime = xTaskGetTickCountFromISR();
+	pxRecord->ucLevel = ( unsigned char ) uxLevel;
+
+	va_start( xArgs, pcFormat );
+	iLength = vsnprintf( pxRecord->cText, sizeof( pxRecord->cText ), pcFormat, xArgs );
+	va_end( xArgs );
+
+	if( iLength < 0 )
+	{
+		iLength = 0;
+	}
+	else if( iLength >= ( int ) sizeof( pxRecord->cText ) )
+	{
+		__atomic_fetch_add( &xLogCounters.ulTruncated, 1UL, __ATOMIC_RELAXED );
+		iLength = sizeof( pxRecord->cText ) - 1;
+	}
+
+	while( ( iLength > 0 ) && ( ( pxRecord->cText[ iLength - 1 ] == '\r' ) || ( pxRecord->cText[ iLength - 1 ] == '\n' ) ) )
+	{
+		iLength--;
+	}
+	pxRecord->ucLength = ( unsigned char ) iLength;
+
+	prvLogPublish( pxRecord, ulIndex );
+}
+/*----------------------------------------------------------------------------*/
+
+static size_t prvLogEncode( char *pcBuffer, const xLogRecord *pxRecord )
+{
+size_t xUsed;
+
+	xUsed = sprintf( pcBuffer, "[%lu] %c ", ( unsigned long ) pxRecord->xTime, cLogLevelNames[ pxRecord->ucLevel & 3U ] );
+	memcpy( &pcBuffer[ xUsed ], pxRecord->cText, pxRecord->ucLength );
+	xUsed += pxRecord->ucLength;
+	pcBuffer[ xUsed++ ] = '\r';
+	pcBuffer[ xUsed++ ] = '\n';
+
+	return xUsed;
+}
+/*----------------------------------------------------------------------------*/
+
+static size_t prvLogEncodeDropped( char *pcBuffer, unsigned long ulDropped )
+{
+	return sprintf( pcBuffer, "[%lu] W log: %lu dropped\r\n", ( unsigned long ) xTaskGetTickCount(), ulDropped );
+}
+/*----------------------------------------------------------------------------*/
+
+#endif /* logBINARY_FORMAT */
+
+static void prvLogDrainTask( void *pvParameters )
+{
+xLogRecord *pxRecord;
+unsigned long ulReported = 0UL, ulDropped;
+size_t xUsed;
+
+	( void ) pvParameters;
+
+	for( ;; )
+	{
+		xUsed = 0;
+
+		/* Gather every ready record that fits into one batch. */
+		for( ;; )
+		{
+			pxRecord = &xLogRing[ ulLogTail & ( logRING_RECORDS - 1 ) ];
+			if( __atomic_load_n( &pxRecord->ulSequence, __ATOMIC_ACQUIRE ) != ulLogTail + 1UL )
+			{
+				break;
+			}
+
+			if( xUsed + logENCODED_MAX > sizeof( cLogBatch ) )
+			{
+				break;
+			}
+
+			xUsed += prvLogEncode( &cLogBatch[ xUsed ], pxRecord );
+
+			/* Free the slot for the producer one lap on. */
+			__atomic_store_n( &pxRecord->ulSequence, ulLogTail + logRING_RECORDS, __ATOMIC_RELEASE );
+			ulLogTail++;
+			xLogCounters.ulWritten++;
+		}
+
+		ulDropped = __atomic_load_n( &xLogCounters.ulDropped, __ATOMIC_RELAXED );
+		if( ( ulDropped != ulReported ) && ( xUsed + logENCODED_MAX <= sizeof( cLogBatch ) ) )
+		{
+			xUsed += prvLogEncodeDropped( &cLogBatch[ xUsed ], ulDropped - ulReported );
+			ulReported = ulDropped;
+		}
+
+		if( xUsed > 0 )
+		{
+			( void ) xSerialWrite( ( xComPortHandle ) logUART_PORT, cLogBatch, xUsed, portMAX_DELAY );
+			continue;
+		}
+
+		/* Nothing ready.  Say so before looking once more, so a record
+		published in between either is seen here or gives the semaphore. */
+		__atomic_store_n( &ulLogDrainIdle, 1UL, __ATOMIC_SEQ_CST );
+		pxRecord = &xLogRing[ ulLogTail & ( logRING_RECORDS - 1 ) ];
+		if( __atomic_load_n( &pxRecord->ulSequence, __ATOMIC_SEQ_CST ) != ulLogTail + 1UL )
+		{
+			( void ) xSemaphoreTake( xLogWake, logDRAIN_PERIOD );
+		}
+		__atomic_store_n( &ulLogDrainIdle, 0UL, __ATOMIC_RELAXED );
+	}
+}
@@ -0,0 +1,247 @@
+/*
+    FreeRTOS V7.0.1 - Copyright (C) 2011 Real Time Engineers Ltd.
+
+
+	FreeRTOS supports many tools and architectures. V7.0.0 is sponsored by:
+	Atollic AB - Atollic provides professional embedded systems development
+	tools for C/C++ development, code analysis and test automation.
+	See http://www.atollic.com
+
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS tutorial books are available in pdf and paperback.        *
+     *    Complete, revised, and edited pdf reference manuals are also       *
+     *    available.                                                         *
+     *                                                                       *
+     *    Purchasing FreeRTOS documentation will not only help you, by       *
+     *    ensuring you get running as quickly as possible and with an        *
+     *    in-depth knowledge of how to use FreeRTOS, it will also help       *
+     *    the FreeRTOS project to continue with its mission of providing     *
+     *    professional grade, cross platform, de facto standard solutions    *
+     *    for microcontrollers - completely free of charge!                  *
+     *                                                                       *
+     *    >>> See http://www.FreeRTOS.org/Documentation for details. <<<     *
+     *                                                                       *
+     *    Thank you for using FreeRTOS, and thank you for your support!      *
+     *                                                                       *
+    ***************************************************************************
+
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation AND MODIFIED BY the FreeRTOS exception.
+    >>>NOTE<<< The modification to the GPL is included to allow you to
+    distribute a combined work that includes FreeRTOS without being obliged to
+    provide the source code for proprietary components outside of the FreeRTOS
+    kernel.  FreeRTOS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details. You should have received a copy of the GNU General Public
+    License and the FreeRTOS license exception along with FreeRTOS; if not it
+    can be viewed here: http://www.freertos.org/a00114.html and also obtained
+    by writing to Richard Barry, contact details for whom are available on the
+    FreeRTOS WEB site.
+
+    1 tab == 4 spaces!
+
+    http://www.FreeRTOS.org - Documentation, latest information, license and
+    contact details.
+
+    http://www.SafeRTOS.com - A version that is certified for use in safety
+    critical systems.
+
+    http://www.OpenRTOS.com - Commercial support, development, porting,
+    licensing and training services.
+*/
+
+#ifndef LOG_H
+#define LOG_H
+
+/* Deferred logging.  A log call formats its message into a record of a lock
+free ring and returns at once, so it may be made from any task or interrupt.
+A low priority task drains the ring and writes the records to the UART in
+bulk.  Records that find the ring full are dropped and counted.
+
+With logBINARY_FORMAT set to 1 nothing is formatted on the target.  The
+format string is placed in the .logfmt section of the ELF file, which is not
+loaded, and the record holds its offset there and the raw arguments as 32 bit
+words.  The drain task writes the records as binary frames, and
+logdecode.py turns them back into text on the host with the help of the ELF
+file.  In this mode a call may have at most logMAX_ARGUMENTS arguments, %f,
+%e and %g arguments must be wrapped in logFLOAT(), 64 bit arguments are not
+supported, and %s only works for strings in the program image, such as
+literals. */
+
+#define logLEVEL_ERROR				( 0U )
+#define logLEVEL_WARN				( 1U )
+#define logLEVEL_INFO				( 2U )
+#define logLEVEL_DEBUG				( 3U )
+
+/* Calls above this level are compiled out. */
+#ifndef logCOMPILE_LEVEL
+	#define logCOMPILE_LEVEL		logLEVEL_INFO
+#endif
+
+/* The longest message kept, including the terminating null.  Longer messages
+are truncated. */
+#ifndef logMAX_MESSAGE_LENGTH
+	#define logMAX_MESSAGE_LENGTH	( 96 )
+#endif
+
+/* The number of records in the ring.  Must be a power of two. */
+#ifndef logRING_RECORDS
+	#define logRING_RECORDS			( 32 )
+#endif
+
+/* Set to 1 for binary records decoded on the host, as described above. */
+#ifndef logBINARY_FORMAT
+	#define logBINARY_FORMAT		0
+#endif
+
+/* The UART the drain task writes to. */
+#ifndef logUART_PORT
+	#define logUART_PORT			( configUART_PORT )
+#endif
+
+typedef struct LOG_STATS
+{
+	unsigned long ulWritten;		/* Records written to the UART. */
+	unsigned long ulDropped;		/* Records lost because the ring was full. */
+	unsigned long ulTruncated;		/* Messages cut to logMAX_MESSAGE_LENGTH. */
+	unsigned long ulFiltered;		/* Calls below the runtime level. */
+} xLogStats;
+
+#if ( logBINARY_FORMAT == 1 )
+
+	/* The most arguments a binary record holds.  logCOUNT() and the
+	logARGUMENTS_n() macros below handle up to six. */
+	#define logMAX_ARGUMENTS		( 6 )
+
+	/* Frames written by the drain task start with this byte, which never
+	appears in text, followed by a byte holding the level in the top four bits
+	and the argument count in the bottom four, then the tick count, the format
+	offset and the arguments as little endian 32 bit words. */
+	#define logFRAME_START			( 0xA5U )
+
+	/* The format offset of the frame reporting dropped records, whose one
+	argument is the number dropped. */
+	#define logFRAME_DROPPED		( 0xFFFFFFFFUL )
+
+	#define logFLOAT( x )			ulLogFloat( x )
+
+	/* The number of arguments after the format. */
+	#define logCOUNT( ... )			logCOUNT_( __VA_ARGS__, 6, 5, 4, 3, 2, 1, 0, 0 )
+	#define logCOUNT_( f, a, b, c, d, e, g, n, ... )	n
+
+	#define logFORMAT( ... )		logFORMAT_( __VA_ARGS__, 0 )
+	#define logFORMAT_( f, ... )	f
+
+	#define logARGUMENT( x )		( ( unsigned long ) ( x ) )
+	#define logARGUMENTS_0( f )
+	#define logARGUMENTS_1( f, a )	, logARGUMENT( a )
+	#define logARGUMENTS_2( f, a, b )	, logARGUMENT( a ), logARGUMENT( b )
+	#define logARGUMENTS_3( f, a, b, c )	, logARGUMENT( a ), logARGUMENT( b ), logARGUMENT( c )
+	#define logARGUMENTS_4( f, a, b, c, d )	, logARGUMENT( a ), logARGUMENT( b ), logARGUMENT( c ), logARGUMENT( d )
+	#define logARGUMENTS_5( f, a, b, c, d, e )	, logARGUMENT( a ), logARGUMENT( b ), logARGUMENT( c ), logARGUMENT( d ), logARGUMENT( e )
+	#define logARGUMENTS_6( f, a, b, c, d, e, g )	, logARGUMENT( a ), logARGUMENT( b ), logARGUMENT( c ), logARGUMENT( d ), logARGUMENT( e ), logARGUMENT( g )
+	#define logARGUMENTS( n, ... )	logARGUMENTS_( n, __VA_ARGS__ )
+	#define logARGUMENTS_( n, ... )	logARGUMENTS_##n( __VA_ARGS__ )
+
+	/* The format is kept out of the image and only its offset is logged.  The
+	call that is never made keeps the compiler's format checking. */
+	#define logEMIT( uxLevel, ... )																	\
+		do																							\
+		{																							\
+			static const char cLogFormat[] __attribute__ ( ( section( ".logfmt" ) ) ) = logFORMAT( __VA_ARGS__ );	\
+			if( 0 )																					\
+			{																						\
+				vLogCheckFormat( __VA_ARGS__ );														\
+			}																						\
+			vLogBinary( ( uxLevel ), cLogFormat, logCOUNT( __VA_ARGS__ ) logARGUMENTS( logCOUNT( __VA_ARGS__ ), __VA_ARGS__ ) );	\
+		} while( 0 )
+
+#else
+
+	#define logFLOAT( x )			( x )
+
+	#define logEMIT( uxLevel, ... )		vLogPrintf( ( uxLevel ), __VA_ARGS__ )
+
+#endif /* logBINARY_FORMAT */
+
+#if ( logCOMPILE_LEVEL >= logLEVEL_ERROR )
+	#define logERROR( ... )		logEMIT( logLEVEL_ERROR, __VA_ARGS__ )
+#else
+	#define logERROR( ... )		do { } while( 0 )
+#endif
+
+#if ( logCOMPILE_LEVEL >= logLEVEL_WARN )
+	#define logWARN( ... )		logEMIT( logLEVEL_WARN, __VA_ARGS__ )
+#else
+	#define logWARN( ... )		do { } while( 0 )
+#endif
+
+#if ( logCOMPILE_LEVEL >= logLEVEL_INFO )
+	#define logINFO( ... )		logEMIT( logLEVEL_INFO, __VA_ARGS__ )
+#else
+	#define logINFO( ... )		do { } while( 0 )
+#endif
+
+#if ( logCOMPILE_LEVEL >= logLEVEL_DEBUG )
+	#define logDEBUG( ... )		logEMIT( logLEVEL_DEBUG, __VA_ARGS__ )
+#else
+	#define logDEBUG( ... )		do { } while( 0 )
+#endif
+
+/*
+ * Create the drain task.  Messages logged before this is called, or before
+ * the scheduler starts, wait in the ring.
+ */
+void vLogInitialise( unsigned portBASE_TYPE uxPriority );
+
+#if ( logBINARY_FORMAT == 1 )
+
+/*
+ * Store a record of the format offset and uxCount arguments, each an unsigned
+ * long.  Called through the log macros.
+ */
+void vLogBinary( unsigned portBASE_TYPE uxLevel, const char *pcFormat, unsigned portBASE_TYPE uxCount, ... );
+
+/*
+ * Does nothing.  Only there so the compiler checks the arguments against the
+ * format.
+ */
+void vLogCheckFormat( const char *pcFormat, ... ) __attribute__ ( ( format( printf, 1, 2 ) ) );
+
+/*
+ * The bits of a float, for a %f, %e or %g argument.
+ */
+static inline unsigned long ulLogFloat( float fValue )
+{
+union { float f; unsigned long ul; } xBits;
+
+	xBits.f = fValue;
+	return xBits.ul;
+}
+
+#else
+
+/*
+ * Format a message into the ring.  Never blocks, so may be called from an
+ * interrupt.  A trailing end of line is removed, the drain task adds its own.
+ */
+void vLogPrintf( unsigned portBASE_TYPE uxLevel, const char *pcFormat, ... ) __attribute__ ( ( format( printf, 2, 3 ) ) );
+
+#endif /* logBINARY_FORMAT */
+
+/*
+ * Change the level above which messages are discarded at run time.
+ */
+void vLogSetLevel( unsigned portBASE_TYPE uxLevel );
+unsigned portBASE_TYPE uxLogGetLevel( void );
+
+void vLogGetStats( xLogStats *pxStats );
+
+#endif /* LOG_H */
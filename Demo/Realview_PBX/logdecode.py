@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+"""
+Decode the binary log frames written by log.c when logBINARY_FORMAT is 1.
+
+Reads the UART output from a file, or from standard input if none is given,
+and writes it out with every frame replaced by its line of text.  Anything
+that is not a frame, such as the console output of the demo, is passed
+through unchanged.  The format strings are looked up in the .logfmt section
+of the ELF file the target is running, and %s arguments in its loaded
+sections.
+
+    qemu-system-arm -M realview-pbx-a9 -nographic -kernel FreeRTOSDemo.elf \\
+        | python3 logdecode.py FreeRTOSDemo.elf
+"""
+
+import re
+import struct
+import sys
+
+FRAME_START = 0xA5
+FRAME_DROPPED = 0xFFFFFFFF
+LEVEL_NAMES = "EWID"
+
+SHF_ALLOC = 0x2
+SHT_NOBITS = 8
+
+# A printf conversion: flags, width, precision, length and type.
+CONVERSION = re.compile(r"%([-+ #0]*)(\d+|\*)?(?:\.(\d+|\*))?(hh|h|ll|l|z|t|j)?([diuxXocspfFeEgG%])")
+
+
+class Image:
+    """The sections of a 32 bit little endian ELF file that decoding needs."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            data = f.read()
+        if data[:4] != b"\x7fELF" or data[4] != 1 or data[5] != 1:
+            raise ValueError("%s is not a 32 bit little endian ELF file" % path)
+
+        shoff, = struct.unpack_from("<I", data, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 0x2E)
+        headers = [struct.unpack_from("<IIIIIIIIII", data, shoff + i * shentsize) for i in range(shnum)]
+        names = headers[shstrndx]
+
+        self.formats = b""
+        self.loaded = []
+        for name, kind, flags, addr, offset, size in (h[:6] for h in headers):
+            name = data[names[4] + name:data.index(b"\0", names[4] + name)].decode()
+            contents = data[offset:offset + size] if kind != SHT_NOBITS else bytes(size)
+            if name == ".logfmt":
+                self.formats = contents
+            elif flags & SHF_ALLOC:
+                self.loaded.append((addr, contents))
+
+    def format(self, offset):
+        end = self.formats.find(b"\0", offset)
+        if offset >= len(self.formats) or end < 0:
+            return None
+        return self.formats[offset:end].decode("latin-1")
+
+    def string(self, address):
+        for start, contents in self.loaded:
+            if start <= address < start + len(contents):
+                end = contents.find(b"\0", address - start)
+                return contents[address - start:end if end >= 0 else None].decode("latin-1")
+        return "<%#x>" % address
+
+
+def render(image, fmt, arguments):
+    """Format the raw 32 bit arguments as the target's printf would."""
+    arguments = list(arguments)
+
+    def convert(match):
+        flags, width, precision, _, kind = match.groups()
+        if kind == "%":
+            return "%"
+        if width == "*":
+            width = str(struct.unpack("<i", struct.pack("<I", arguments.pop(0)))[0]) if arguments else ""
+        if precision == "*":
+            precision = str(arguments.pop(0)) if arguments else ""
+        if not arguments:
+            return "<missing>"
+        word = arguments.pop(0)
+
+        spec = "%" + flags + (width or "") + ("." + precision if precision else "")
+        if kind in "di":
+            return (spec + "d") % struct.unpack("<i", struct.pack("<I", word))[0]
+        if kind == "u":
+            return (spec + "d") % word
+        if kind in "xXoc":
+            return (spec + kind) % word
+        if kind == "p":
+            return (spec + "s") % ("0x%x" % word)
+        if kind == "s":
+            return (spec + "s") % image.string(word)
+        return (spec + kind) % struct.unpack("<f", struct.pack("<I", word))[0]
+
+    return CONVERSION.sub(convert, fmt)
+
+
+def decode(image, stream, out):
+    data = b""
+    while True:
+        chunk = stream.read1(4096) if hasattr(stream, "read1") else stream.read(4096)
+        if not chunk:
+            break
+        data += chunk
+
+        while data:
+            start = data.find(bytes([FRAME_START]))
+            if start != 0:
+                text = data if start < 0 else data[:start]
+                out.write(text.decode("latin-1"))
+                data = data[len(text):]
+                continue
+
+            if len(data) < 2:
+                break
+            level, count = data[1] >> 4, data[1] & 0xF
+            length = 10 + 4 * count
+            if len(data) < length:
+                break
+
+            tick, offset = struct.unpack_from("<II", data, 2)
+            arguments = struct.unpack_from("<%dI" % count, data, 10)
+            data = data[length:]
+
+            name = LEVEL_NAMES[level] if level < len(LEVEL_NAMES) else "?"
+            if offset == FRAME_DROPPED:
+                text = "log: %u dropped" % arguments[0] if arguments else "log: dropped"
+            else:
+                fmt = image.format(offset)
+                text = render(image, fmt, arguments) if fmt is not None else "<unknown format %#x>" % offset
+            out.write("[%u] %s %s\r\n" % (tick, name, text.rstrip("\r\n")))
+        out.flush()
+
+
+def main(argv):
+    if len(argv) not in (2, 3):
+        sys.stderr.write("usage: %s image.elf [uart-output]\n" % argv[0])
+        return 2
+
+    image = Image(argv[1])
+    stream = open(argv[2], "rb") if len(argv) == 3 else sys.stdin.buffer
+    try:
+        decode(image, stream, sys.stdout)
+    except KeyboardInterrupt:
+        pass
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -24,14 +24,28 @@ limitations under the License.
 
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stddef.h>
 
 #include "FreeRTOS.h"
 #include "task.h"
+#include "semphr.h"
+#include "timers.h"
 
 #include "app_config.h"
 #include "serial.h"
+#include "pl011.h"
+#include "log.h"
+#include "console.h"
+#include "net.h"
+#include "lan9118.h"
+#include "pl181_mmci.h"
+#include "blockcache.h"
+#include "fat.h"
+#include "aio.h"
+#include "sp804_timer.h"
+#include "pl031_rtc.h"
 
 
 /*
@@ -44,10 +58,147 @@ limitations under the License.
  */
 #pragma GCC diagnostic ignored "-Wmain"
 
+/*
+ * Set to 1 to measure how late an urgent timer runs while slow housekeeping
+ * callbacks hold up the timer service.  The urgent timer is bound to the last
+ * timer service, so with configTIMER_SERVICE_COUNT set to 1 it shares the
+ * daemon with the housekeeping timer, and with 2 it has one of its own.  Run
+ * it both ways to compare.
+ */
+#define mainTIMER_BENCHMARK             0
+
+/*
+ * Set to 1 to soak the heap with random allocations and frees of message
+ * sized blocks for as long as the demo runs.  Every round reports the free
+ * bytes, the largest free block and the share of the free memory that is not
+ * in it, which should settle rather than keep growing.  Needs a heap that
+ * coalesces free blocks.
+ */
+#define mainHEAP_SOAK_TEST              0
+
+/*
+ * Set to 1 to measure the worst case and mean cycles taken by pvPortMalloc()
+ * and vPortFree() as the number of free blocks in the heap grows.  The demo
+ * is built on heap_5.c; build it with "make clean; make HEAP=2" and run the
+ * benchmark again to compare heap_2.c, whose times grow with the number of
+ * free blocks.
+ */
+#define mainHEAP_BENCHMARK              0
+
+/*
+ * Set to 1 to compare the slabs of heap_5.c with its block allocator on a
+ * message sized workload.  The same allocations are made once through
+ * pvPortMalloc(), which serves them from the slabs, and once through
+ * pvPortMallocAttr(), which never does, and each run reports the mean and
+ * worst case cycles per allocation and free, the memory used per requested
+ * byte and, for the slabs, the occupancy of every size class.
+ */
+#define mainSLAB_BENCHMARK              0
+
+/*
+ * Set to 1 to measure newlib use from several tasks at once.  One, two and
+ * then four tasks of the same priority format a line, split it again with
+ * strtok() and strtoul(), look up a variable with getenv(), and allocate and
+ * free a buffer from newlib's malloc(), yielding between the tokens.  Each run
+ * reports the lines handled per second, how many came back wrong and, with
+ * configUSE_NEWLIB_REENTRANT set to 1, how often the tasks found newlib's heap
+ * and environment lock held by another.  strtok() keeps its position in
+ * newlib's reentrancy structure, so with configUSE_NEWLIB_REENTRANT set to 0
+ * the tasks share it and several tasks get each other's tokens, and with 1
+ * they should not.  Build it with "make HEAP=3 NEWLIB_REENTRANT=0" and with
+ * NEWLIB_REENTRANT=1 to compare.
+ */
+#define mainLIBC_BENCHMARK              0
+
+/*
+ * Set to 1 to measure the worst case and mean cycles taken by vListInsert()
+ * as the list grows, both for random item values and for values that go to
+ * the end of the list, which is the worst case of the linear walk.  Build it
+ * with configUSE_LIST_SKIP_INDEX set to 0 and to 1 to compare.
+ */
+#define mainLIST_BENCHMARK              0
+
+/*
+ * Set to 1 to run a comtest.c style loopback benchmark of the UART driver on
+ * UART1 once the scheduler starts, followed by a transmit only run of the same
+ * data a byte at a time and by DMA.  Each reports the throughput and the share
+ * of the CPU taken from the idle task while the transfer runs.  QEMU sends
+ * every byte instantly, so the throughput and CPU figures it gives say nothing
+ * about hardware, and its DMA controller cannot be paced by the UART, so the
+ * DMA part only runs there with UART_DMA_FLOW_CONTROL left at 0, its default.
+ */
+#define mainUART_BENCHMARK              0
+
+/*
+ * Set to 1 to measure UDP throughput over QEMU's user mode network.  Start the
+ * demo with "make qemu-run", which forwards UDP port 5555 of the host to the
+ * target, then run netbench.py on the host.  The target streams datagrams to
+ * the host and then counts those the host streams back, and reports the
+ * throughput and CPU use of each direction.
+ */
+#define mainNET_BENCHMARK               0
+
+/*
+ * Set to 1 to compare the SD card driver with and without the block cache,
+ * reading and writing a block at a time sequentially and at random.  The raw
+ * driver is also run with several blocks per request.  The benchmark writes
+ * over the upper half of the card image made by "make sd.img".
+ */
+#define mainSD_BENCHMARK                0
+
+/*
+ * Set to 1 to measure how fast log records can be appended to a file on the
+ * card, buffered and with a flush after every record, for several record
+ * sizes, and how fast the file reads back.  A last run then logs to and reads
+ * back two files from two tasks at once, which only wait for each other where
+ * they share blocks of the FAT or a directory, so each should take about as
+ * long as the single file run did.  The card image made by "make sd.img" holds
+ * an empty FAT file system; the logs are left in it as BENCH.LOG and
+ * BENCH2.LOG.
+ */
+#define mainFAT_BENCHMARK               0
+
+/*
+ * Set to 1 to drive several devices at once from one task through the
+ * asynchronous request queues of aio.h.  The task keeps UART1, in loopback,
+ * busy with batches of write and read requests while SP804 interval and RTC
+ * alarm requests run alongside, and waits on one completion queue for all of
+ * them.  It reports the UART throughput and CPU use, checks the data that
+ * came back, and cancels what is still queued at the end.
+ */
+#define mainAIO_BENCHMARK               0
+
+/* The address QEMU's user mode network gives the guest, and its gateway,
+which is also the host. */
+#define mainNET_ADDRESS                 netIP_ADDRESS( 10, 0, 2, 15 )
+#define mainNET_NETMASK                 netIP_ADDRESS( 255, 255, 255, 0 )
+#define mainNET_GATEWAY                 netIP_ADDRESS( 10, 0, 2, 2 )
+
+/* The benchmarks estimate their CPU use from how often the idle hook runs. */
+#define mainMEASURE_IDLE                ( ( mainUART_BENCHMARK == 1 ) || ( mainNET_BENCHMARK == 1 ) || ( mainSD_BENCHMARK == 1 ) || ( mainFAT_BENCHMARK == 1 ) || ( mainAIO_BENCHMARK == 1 ) )
+
 void vApplicationStackOverflowHook( xTaskHandle *pxTask, signed char *pcTaskName );
 void vApplicationTickHook( void );
 void vApplicationIdleHook( void );
 
+#if ( mainHEAP_SOAK_TEST == 1 ) && ( configHEAP_IMPLEMENTATION != 4 ) && ( configHEAP_IMPLEMENTATION != 5 )
+    #error The heap soak test needs heap_4.c or heap_5.c.
+#endif
+
+#if ( mainSLAB_BENCHMARK == 1 ) && ( configUSE_HEAP_SLABS != 1 )
+    #error The slab benchmark needs heap_5.c with configUSE_HEAP_SLABS set to 1.
+#endif
+
+#if ( mainLIBC_BENCHMARK == 1 ) && ( configHEAP_IMPLEMENTATION != 3 )
+    #error The libc benchmark needs heap_3.c, which provides the newlib malloc() locks.
+#endif
+
+/* Heap region boundaries, provided by the linker script. */
+extern unsigned char __heap_start[];
+extern unsigned char __heap_end[];
+extern unsigned char __dma_heap_start[];
+extern unsigned char __dma_heap_end[];
+
 extern void vPortUnknownInterruptHandler( void *pvParameter );
 extern void vPortInstallInterruptHandler( void (*vHandler)(void *), void *pvParameter, unsigned long ulVector, unsigned char ucEdgeTriggered, unsigned char ucPriority, unsigned char ucProcessorTargets );
 
@@ -131,104 +282,1708 @@ void vPeriodicTaskFunction(void* pvParameters)
 }
 
 
-/* Parameters for two tasks */
-paramStruct tParam[2] =
+/*
+ * Display each line typed on the console.  Echo and editing are done by the
+ * console line discipline in the UART interrupt, so this task is only woken
+ * when 'Enter' is pressed.
+ */
+static void prvConsoleTask( void *pvParameters )
 {
-    { .text="Task1\r\n", .delay=1000 },
-    { .text="Periodic task\r\n", .delay=3000 }
-};
+char cLine[ consoleLINE_LENGTH ];
 
-/* Startup function that creates and runs two FreeRTOS tasks */
-void main(void)
+	( void ) pvParameters;
+
+	for( ;; )
+	{
+		if ( pdTRUE == xConsoleReadLine( cLine, portMAX_DELAY ) )
+		{
+			printf("You entered: \"%s\"\r\n", cLine);
+		}
+	}
+}
+/*----------------------------------------------------------------------------*/
+
+#if mainMEASURE_IDLE
+
+/* Counts calls to the idle hook, to estimate how busy the CPU is. */
+static volatile unsigned long ulIdleCount = 0UL;
+
+/* Idle hook calls in one second with nothing else running. */
+static unsigned long ulIdleQuiet = 0UL;
+
+/*
+ * Measure how often the idle hook runs in one second with nothing else going
+ * on.
+ */
+static void prvBenchCalibrate( void )
 {
+	ulIdleCount = 0UL;
+	vTaskDelay( 1000 / portTICK_RATE_MS );
+	ulIdleQuiet = ulIdleCount;
+}
+/*----------------------------------------------------------------------------*/
 
-    unsigned long ulVector = 0UL;
-    unsigned long ulValue = 0UL;
-    char cAddress[32];
+/*
+ * The share of the CPU, in percent, that a run of xElapsed ticks took from the
+ * idle task, which ran ulIdleBusy times.
+ */
+static unsigned long prvBenchCPUPercent( unsigned long ulIdleBusy, portTickType xElapsed )
+{
+	/* Whatever the idle task did not get was used by the run. */
+	return 100UL - ( unsigned long ) ( ( 100ULL * ulIdleBusy * ( 1000 / portTICK_RATE_MS ) ) / ( ( unsigned long long ) ulIdleQuiet * xElapsed + 1ULL ) );
+}
+/*----------------------------------------------------------------------------*/
 
-    portDISABLE_INTERRUPTS();
-    
-    /* Install the Spurious Interrupt Handler to help catch interrupts. */
-    for ( ulVector = 0; ulVector < portMAX_VECTORS; ulVector++ )
-    	vPortInstallInterruptHandler( vPortUnknownInterruptHandler, (void *)ulVector, ulVector, pdTRUE, configMAX_SYSCALL_INTERRUPT_PRIORITY, 1 );
-    
-    /* Init of print related tasks: */
-    vUARTInitialise( mainPRINT_PORT, mainPRINT_BAUDRATE, 64);
+#endif /* mainMEASURE_IDLE */
 
-    portENABLE_INTERRUPTS();
+#if ( mainTIMER_BENCHMARK == 1 )
 
-    /*
-     * I M P O R T A N T :
-     * Make sure (in startup.s) that main is entered in Supervisor mode.
-     * When vTaskStartScheduler launches the first task, it will switch
-     * to System mode and enable interrupt exceptions.
-     */
-    vSerialPutString((xComPortHandle)configUART_PORT, (const signed char * const)("= = = T E S T   S T A R T E D = = =\r\n\r\n"), strlen("= = = T E S T   S T A R T E D = = =\r\n\r\n"));
+#define mainTIMER_BENCH_URGENT_PERIOD	( 5 / portTICK_RATE_MS )
+#define mainTIMER_BENCH_BULK_PERIOD		( 50 / portTICK_RATE_MS )
+#define mainTIMER_BENCH_BULK_COST		( 20 / portTICK_RATE_MS )	/* How long each housekeeping callback keeps its daemon busy. */
+#define mainTIMER_BENCH_DURATION		( 2000 / portTICK_RATE_MS )
+#define mainTIMER_BENCH_PRIORITY		( PRIOR_FIX_FREQ_PERIODIC + 1 )
 
-    /* And finally create two tasks: */
-    if ( pdPASS != xTaskCreate(vTaskFunction, "task1", 128, (void*) &tParam[0],
-                               PRIOR_PERIODIC, NULL) )
-    {
-        vSerialPutString((xComPortHandle)configUART_PORT, (const signed char * const)("Could not create task1\r\n"), strlen("Could not create task1\r\n"));
-	while(1);
-    }
+static void prvTimerBenchUrgent( xTimerHandle xTimer )
+{
+	( void ) xTimer;
+}
+/*----------------------------------------------------------------------------*/
 
-    if ( pdPASS != xTaskCreate(vPeriodicTaskFunction, "task2", 128, (void*) &tParam[1],
-                               PRIOR_FIX_FREQ_PERIODIC, NULL) )
-    {
-        vSerialPutString((xComPortHandle)configUART_PORT, (const signed char * const)("Could not create task2\r\n"), strlen("Could not create task2\r\n"));
-	while(1);
-    }
+static void prvTimerBenchBulk( xTimerHandle xTimer )
+{
+portTickType xStart = xTaskGetTickCount();
 
-    vSerialPutString((xComPortHandle)configUART_PORT, (const signed char * const)("A text may be entered using a keyboard.\r\n"), strlen("A text may be entered using a keyboard.\r\n"));
-    vSerialPutString((xComPortHandle)configUART_PORT, (const signed char * const)("It will be displayed when 'Enter' is pressed.\r\n\r\n"), strlen("It will be displayed when 'Enter' is pressed.\r\n\r\n"));
+	( void ) xTimer;
 
-    /* Start the FreeRTOS scheduler */
-    vTaskStartScheduler();
+	while( ( xTaskGetTickCount() - xStart ) < mainTIMER_BENCH_BULK_COST )
+	{
+		/* Stand in for slow housekeeping. */
+	}
+}
+/*----------------------------------------------------------------------------*/
 
-    /*
-     * If all goes well, vTaskStartScheduler should never return.
-     * If it does return, typically not enough heap memory is reserved.
-     */
+static void prvTimerBenchReport( const char *pcName, xTimerHandle xTimer, unsigned portBASE_TYPE uxServiceClass )
+{
+xTimerStats xStats;
+unsigned long ulMeanHundredths;
 
-    vSerialPutString((xComPortHandle)configUART_PORT, (const signed char * const)("Could not start the scheduler!!!\r\n"), strlen("Could not start the scheduler!!!\r\n"));
-    while(1);
+	if( pdPASS == xTimerGetTimerStats( xTimer, &xStats ) )
+	{
+		ulMeanHundredths = ( xStats.ulTotalLatenessTicks * 100UL ) / ( ( 0UL != xStats.ulExpiries ) ? xStats.ulExpiries : 1UL );
+		printf( "Timer %s on service %u: %lu expiries, lateness max %lu ticks, mean %lu.%02lu ticks\r\n",
+				pcName, ( unsigned int ) uxServiceClass, xStats.ulExpiries, ( unsigned long ) xStats.xMaxLatenessTicks,
+				ulMeanHundredths / 100UL, ulMeanHundredths % 100UL );
+	}
+}
+/*----------------------------------------------------------------------------*/
 
-    /* just in case if an infinite loop is somehow omitted in FreeRTOS_Error */
-    for ( ; ; );
+static void prvTimerBenchTask( void *pvParameters )
+{
+const unsigned portBASE_TYPE uxUrgentClass = ( unsigned portBASE_TYPE ) configTIMER_SERVICE_COUNT - 1U;
+xTimerHandle xUrgent, xBulk;
+xTimerServiceStats xServiceStats;
+unsigned portBASE_TYPE uxService;
+
+	( void ) pvParameters;
+
+	xUrgent = xTimerCreateForService( ( const signed char * ) "urgent", mainTIMER_BENCH_URGENT_PERIOD, pdTRUE, NULL, prvTimerBenchUrgent, uxUrgentClass );
+	xBulk = xTimerCreateForService( ( const signed char * ) "bulk", mainTIMER_BENCH_BULK_PERIOD, pdTRUE, NULL, prvTimerBenchBulk, 0U );
+
+	if( ( NULL == xUrgent ) || ( NULL == xBulk ) )
+	{
+		printf( "Timer benchmark: could not create the timers\r\n" );
+		vTaskDelete( NULL );
+	}
+
+	( void ) xTimerStart( xBulk, portMAX_DELAY );
+	( void ) xTimerStart( xUrgent, portMAX_DELAY );
+	vTaskDelay( mainTIMER_BENCH_DURATION );
+	( void ) xTimerStop( xUrgent, portMAX_DELAY );
+	( void ) xTimerStop( xBulk, portMAX_DELAY );
+
+	/* Let the daemons take the stop commands before reading the stats. */
+	vTaskDelay( mainTIMER_BENCH_BULK_COST * 2 );
+
+	prvTimerBenchReport( "urgent", xUrgent, uxUrgentClass );
+	prvTimerBenchReport( "bulk", xBulk, 0U );
+
+	for( uxService = 0U; uxService < ( unsigned portBASE_TYPE ) configTIMER_SERVICE_COUNT; uxService++ )
+	{
+		vTimerGetServiceStats( uxService, &xServiceStats );
+		printf( "  service %u: %lu expiries, commands queued %lu, direct %lu, dropped %lu\r\n",
+				( unsigned int ) uxService, xServiceStats.ulExpiries, xServiceStats.xCommands.ulCommandsQueued,
+				xServiceStats.xCommands.ulCommandsDirect, xServiceStats.xCommands.ulCommandsDropped );
+	}
+
+	( void ) xTimerDelete( xUrgent, portMAX_DELAY );
+	( void ) xTimerDelete( xBulk, portMAX_DELAY );
+	vTaskDelete( NULL );
 }
+/*----------------------------------------------------------------------------*/
 
-void vApplicationMallocFailedHook( void )
+#endif /* mainTIMER_BENCHMARK */
+
+#if ( mainHEAP_SOAK_TEST == 1 )
+
+#define mainHEAP_SOAK_SLOTS			( 512UL )
+#define mainHEAP_SOAK_ROUND			( 100000UL )	/* Operations between reports. */
+#define mainHEAP_SOAK_YIELD			( 1000UL )		/* Operations between delays, so the idle task gets to run. */
+#define mainHEAP_SOAK_PRIORITY		( tskIDLE_PRIORITY + 1 )
+
+static unsigned long ulHeapSoakSeed = 1UL;
+
+static unsigned char *pucHeapSoakBlocks[ mainHEAP_SOAK_SLOTS ];
+static unsigned short usHeapSoakSizes[ mainHEAP_SOAK_SLOTS ];
+
+static unsigned long prvHeapSoakRandom( void )
 {
-	__asm volatile (" smc #0 ");
+	ulHeapSoakSeed = ( ulHeapSoakSeed * 1103515245UL ) + 12345UL;
+	return ulHeapSoakSeed >> 8;
 }
 /*----------------------------------------------------------------------------*/
 
-extern void vAssertCalled( char *file, int line )
+/*
+ * A size from 1 byte to 4K, with small sizes the most common, as they are for
+ * messages.
+ */
+static unsigned short prvHeapSoakSize( void )
 {
-	printf("Assertion failed at %s, line %d\n\r",file,line);
-	taskDISABLE_INTERRUPTS();
-	for( ;; );
+unsigned long ulRandom = prvHeapSoakRandom();
+
+	return ( unsigned short ) ( 1UL + ( ( ulRandom >> 4 ) & ( ( 2UL << ( ulRandom % 12UL ) ) - 1UL ) ) );
 }
+/*----------------------------------------------------------------------------*/
 
-void vApplicationTickHook( void )
+static void prvHeapSoakTask( void *pvParameters )
 {
-	static int ticks = 0;
-	ticks++;
+unsigned long ulOperations = 0UL, ulRound = 0UL, ulSlot, ulLive = 0UL, ulFailures = 0UL, ulCorrupt = 0UL;
+unsigned long ulFragmentation, ulWorstFragmentation = 0UL;
+size_t xFree, xLargest;
+unsigned char ucPattern;
 
-	if (ticks % 1000 == 0)
-		printf("Time : %d sec\r\n\n", ticks / 1000);
+	( void ) pvParameters;
+
+	for( ;; )
+	{
+		ulSlot = prvHeapSoakRandom() % mainHEAP_SOAK_SLOTS;
+
+		if( NULL == pucHeapSoakBlocks[ ulSlot ] )
+		{
+			usHeapSoakSizes[ ulSlot ] = prvHeapSoakSize();
+			pucHeapSoakBlocks[ ulSlot ] = ( unsigned char * ) pvPortMalloc( usHeapSoakSizes[ ulSlot ] );
+
+			if( NULL != pucHeapSoakBlocks[ ulSlot ] )
+			{
+				/* Fill the block, so that an overlap with another shows up
+				when either is freed. */
+				memset( pucHeapSoakBlocks[ ulSlot ], ( int ) ( unsigned char ) ulSlot, usHeapSoakSizes[ ulSlot ] );
+				ulLive++;
+			}
+			else
+			{
+				ulFailures++;
+			}
+		}
+		else
+		{
+			ucPattern = ( unsigned char ) ulSlot;
+			if( ( pucHeapSoakBlocks[ ulSlot ][ 0 ] != ucPattern ) || ( pucHeapSoakBlocks[ ulSlot ][ usHeapSoakSizes[ ulSlot ] - 1U ] != ucPattern ) )
+			{
+				ulCorrupt++;
+			}
+
+			vPortFree( pucHeapSoakBlocks[ ulSlot ] );
+			pucHeapSoakBlocks[ ulSlot ] = NULL;
+			ulLive--;
+		}
+
+		ulOperations++;
+
+		if( 0UL == ( ulOperations % mainHEAP_SOAK_YIELD ) )
+		{
+			vTaskDelay( 1 );
+		}
+
+		if( 0UL == ( ulOperations % mainHEAP_SOAK_ROUND ) )
+		{
+			xFree = xPortGetFreeHeapSize();
+			xLargest = xPortGetLargestFreeBlockSize();
+			ulFragmentation = ( xFree > ( size_t ) 0 ) ? ( 100UL - ( unsigned long ) ( ( ( unsigned long long ) xLargest * 100ULL ) / xFree ) ) : 0UL;
+			if( ulFragmentation > ulWorstFragmentation )
+			{
+				ulWorstFragmentation = ulFragmentation;
+			}
+
+			ulRound++;
+			printf( "Heap soak round %lu: %lu live blocks, free %lu, minimum ever %lu, largest %lu, fragmentation %lu%% (worst %lu%%), failures %lu, corrupt %lu\r\n",
+					ulRound, ulLive, ( unsigned long ) xFree, ( unsigned long ) xPortGetMinimumEverFreeHeapSize(), ( unsigned long ) xLargest,
+					ulFragmentation, ulWorstFragmentation, ulFailures, ulCorrupt );
+		}
+	}
 }
 /*----------------------------------------------------------------------------*/
 
-void vApplicationIdleHook( void )
+#endif /* mainHEAP_SOAK_TEST */
+
+#if ( mainHEAP_BENCHMARK == 1 )
+
+#define mainHEAP_BENCH_MAX_FRAGMENTS	( 1024UL )
+#define mainHEAP_BENCH_TRIALS			( 64UL )
+#define mainHEAP_BENCH_LARGE			( 8192UL )	/* Larger than every fragment, so heap_2.c looks at all of them. */
+#define mainHEAP_BENCH_PRIORITY			( configMAX_PRIORITIES - 1 )
+
+static void *pvHeapBenchBlocks[ 2UL * mainHEAP_BENCH_MAX_FRAGMENTS ];
+
+/*
+ * Leave ulFragments free blocks in the heap, each kept from merging by the
+ * allocated blocks either side of it, then time a large allocation and its
+ * free.
+ */
+static void prvHeapBenchRun( unsigned long ulFragments )
 {
-signed char cChar;
-	if ( pdTRUE == xSerialGetChar( (xComPortHandle)mainPRINT_PORT, &cChar, 0UL ) )
+unsigned long ul, ulMade, ulStart, ulCycles, ulMallocMax = 0UL, ulFreeMax = 0UL;
+unsigned long long ullMallocTotal = 0ULL, ullFreeTotal = 0ULL;
+void *pvLarge;
+
+	/* From 600 bytes up, above the largest slab size class, so heap_5.c
+	serves them from its block allocator as well. */
+	for( ulMade = 0UL; ulMade < ( 2UL * ulFragments ); ulMade++ )
+	{
+		pvHeapBenchBlocks[ ulMade ] = pvPortMalloc( 600UL + ( ( ulMade * 37UL ) % 1024UL ) );
+		if( NULL == pvHeapBenchBlocks[ ulMade ] )
+		{
+			break;
+		}
+	}
+
+	for( ul = 0UL; ul < ulMade; ul += 2UL )
+	{
+		vPortFree( pvHeapBenchBlocks[ ul ] );
+	}
+
+	for( ul = 0UL; ul < mainHEAP_BENCH_TRIALS; ul++ )
+	{
+		ulStart = portGET_CYCLE_COUNT();
+		pvLarge = pvPortMalloc( mainHEAP_BENCH_LARGE );
+		ulCycles = portGET_CYCLE_COUNT() - ulStart;
+
+		ullMallocTotal += ulCycles;
+		if( ulCycles > ulMallocMax )
+		{
+			ulMallocMax = ulCycles;
+		}
+
+		ulStart = portGET_CYCLE_COUNT();
+		vPortFree( pvLarge );
+		ulCycles = portGET_CYCLE_COUNT() - ulStart;
+
+		ullFreeTotal += ulCycles;
+		if( ulCycles > ulFreeMax )
+		{
+			ulFreeMax = ulCycles;
+		}
+	}
+
+	for( ul = 1UL; ul < ulMade; ul += 2UL )
+	{
+		vPortFree( pvHeapBenchBlocks[ ul ] );
+	}
+
+	printf( "heap_%d with %lu free fragments: malloc max %lu, mean %lu cycles, free max %lu, mean %lu cycles\r\n",
+			configHEAP_IMPLEMENTATION, ulMade / 2UL, ulMallocMax, ( unsigned long ) ( ullMallocTotal / mainHEAP_BENCH_TRIALS ),
+			ulFreeMax, ( unsigned long ) ( ullFreeTotal / mainHEAP_BENCH_TRIALS ) );
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvHeapBenchTask( void *pvParameters )
+{
+unsigned long ulFragments;
+
+	( void ) pvParameters;
+
+	for( ulFragments = 0UL; ulFragments <= mainHEAP_BENCH_MAX_FRAGMENTS; ulFragments = ( 0UL == ulFragments ) ? 16UL : ( ulFragments * 4UL ) )
+	{
+		prvHeapBenchRun( ulFragments );
+	}
+
+	vTaskDelete( NULL );
+}
+/*----------------------------------------------------------------------------*/
+
+#endif /* mainHEAP_BENCHMARK */
+
+#if ( mainSLAB_BENCHMARK == 1 )
+
+#define mainSLAB_BENCH_OBJECTS			( 1024UL )
+#define mainSLAB_BENCH_ROUNDS			( 32UL )
+#define mainSLAB_BENCH_PAGE_SIZE		( 4096UL )	/* The size of a page of the slab zone of heap_5.c. */
+#define mainSLAB_BENCH_CLASSES			( 16UL )
+#define mainSLAB_BENCH_PRIORITY			( configMAX_PRIORITIES - 1 )
+
+/* Typical sizes of messages and the small structures that go with them. */
+static const unsigned short usSlabBenchSizes[] = { 16, 24, 32, 40, 64, 64, 100, 128, 200, 256, 400, 512 };
+#define mainSLAB_BENCH_SIZE_COUNT		( sizeof( usSlabBenchSizes ) / sizeof( usSlabBenchSizes[ 0 ] ) )
+
+static void *pvSlabBenchObjects[ mainSLAB_BENCH_OBJECTS ];
+static xHeapSlabStats xSlabBenchStats[ mainSLAB_BENCH_CLASSES ];
+
+/* The bytes of the slab zone that are in pages given to a size class. */
+static unsigned long prvSlabBenchPageBytes( void )
+{
+unsigned portBASE_TYPE uxClass, uxClasses;
+unsigned long ulBytes = 0UL;
+
+	uxClasses = uxPortGetSlabStats( xSlabBenchStats, mainSLAB_BENCH_CLASSES );
+	for( uxClass = 0U; uxClass < uxClasses; uxClass++ )
+	{
+		ulBytes += ( unsigned long ) xSlabBenchStats[ uxClass ].uxPages * mainSLAB_BENCH_PAGE_SIZE;
+	}
+
+	return ulBytes;
+}
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Allocate mainSLAB_BENCH_OBJECTS objects and free them again, odd ones
+ * first so the pages are left partly full for a while, mainSLAB_BENCH_ROUNDS
+ * times.  Uses the slabs if xSlabs is pdTRUE and only the block allocator
+ * otherwise.
+ */
+static void prvSlabBenchRun( portBASE_TYPE xSlabs )
+{
+unsigned long ulRound, ul, ulObject, ulStart, ulCycles, ulMallocMax = 0UL, ulFreeMax = 0UL;
+unsigned long ulRequested = 0UL, ulUsed = 0UL, ulFailures = 0UL;
+unsigned long long ullMallocTotal = 0ULL, ullFreeTotal = 0ULL;
+size_t xSize, xFreeBefore = 0;
+unsigned long ulPagesBefore = 0UL;
+
+	for( ulRound = 0UL; ulRound < mainSLAB_BENCH_ROUNDS; ulRound++ )
+	{
+		if( 0UL == ulRound )
+		{
+			xFreeBefore = xPortGetFreeHeapSize();
+			ulPagesBefore = prvSlabBenchPageBytes();
+		}
+
+		for( ul = 0UL; ul < mainSLAB_BENCH_OBJECTS; ul++ )
+		{
+			xSize = ( size_t ) usSlabBenchSizes[ ( ul * 7UL + ulRound ) % mainSLAB_BENCH_SIZE_COUNT ];
+
+			ulStart = portGET_CYCLE_COUNT();
+			pvSlabBenchObjects[ ul ] = ( pdFALSE != xSlabs ) ? pvPortMalloc( xSize ) : pvPortMallocAttr( xSize, portHEAP_ATTR_CACHEABLE );
+			ulCycles = portGET_CYCLE_COUNT() - ulStart;
+
+			ullMallocTotal += ulCycles;
+			if( ulCycles > ulMallocMax )
+			{
+				ulMallocMax = ulCycles;
+			}
+
+			if( NULL == pvSlabBenchObjects[ ul ] )
+			{
+				ulFailures++;
+			}
+			else if( 0UL == ulRound )
+			{
+				ulRequested += ( unsigned long ) xSize;
+			}
+		}
+
+		/* The memory taken by the first round, with every object
+		allocated. */
+		if( 0UL == ulRound )
+		{
+			if( pdFALSE != xSlabs )
+			{
+				ulUsed = prvSlabBenchPageBytes() - ulPagesBefore;
+			}
+			else
+			{
+				ulUsed = ( unsigned long ) ( xFreeBefore - xPortGetFreeHeapSize() );
+			}
+		}
+
+		/* Odd objects in the first pass, even ones in the second. */
+		for( ul = 0UL; ul < mainSLAB_BENCH_OBJECTS; ul++ )
+		{
+			ulObject = ( ul < ( mainSLAB_BENCH_OBJECTS / 2UL ) ) ? ( ( ul * 2UL ) + 1UL ) : ( ( ul - ( mainSLAB_BENCH_OBJECTS / 2UL ) ) * 2UL );
+
+			ulStart = portGET_CYCLE_COUNT();
+			vPortFree( pvSlabBenchObjects[ ulObject ] );
+			ulCycles = portGET_CYCLE_COUNT() - ulStart;
+
+			ullFreeTotal += ulCycles;
+			if( ulCycles > ulFreeMax )
+			{
+				ulFreeMax = ulCycles;
+			}
+		}
+	}
+
+	printf( "%s: malloc max %lu, mean %lu cycles, free max %lu, mean %lu cycles, %lu.%02lu bytes used per byte requested, %lu failures\r\n",
+			( pdFALSE != xSlabs ) ? "slabs" : "blocks",
+			ulMallocMax, ( unsigned long ) ( ullMallocTotal / ( mainSLAB_BENCH_ROUNDS * mainSLAB_BENCH_OBJECTS ) ),
+			ulFreeMax, ( unsigned long ) ( ullFreeTotal / ( mainSLAB_BENCH_ROUNDS * mainSLAB_BENCH_OBJECTS ) ),
+			ulUsed / ulRequested, ( ( ulUsed % ulRequested ) * 100UL ) / ulRequested, ulFailures );
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvSlabBenchTask( void *pvParameters )
+{
+unsigned portBASE_TYPE uxClass, uxClasses;
+
+	( void ) pvParameters;
+
+	prvSlabBenchRun( pdFALSE );
+	prvSlabBenchRun( pdTRUE );
+
+	/* Since every object has been freed again, the pages still held by a
+	class are those of the rest of the demo. */
+	uxClasses = uxPortGetSlabStats( xSlabBenchStats, mainSLAB_BENCH_CLASSES );
+	printf( "class   pages   in use    free   allocations  fallbacks\r\n" );
+	for( uxClass = 0U; uxClass < uxClasses; uxClass++ )
+	{
+		printf( "%5lu %7lu %8lu %7lu %13lu %10lu\r\n", ( unsigned long ) xSlabBenchStats[ uxClass ].xObjectSize,
+				( unsigned long ) xSlabBenchStats[ uxClass ].uxPages, xSlabBenchStats[ uxClass ].ulObjectsInUse,
+				xSlabBenchStats[ uxClass ].ulObjectsFree, xSlabBenchStats[ uxClass ].ulAllocations, xSlabBenchStats[ uxClass ].ulFallbacks );
+	}
+
+	vTaskDelete( NULL );
+}
+/*----------------------------------------------------------------------------*/
+
+#endif /* mainSLAB_BENCHMARK */
+
+#if ( mainLIBC_BENCHMARK == 1 )
+
+#define mainLIBC_BENCH_MAX_TASKS		( 4UL )
+#define mainLIBC_BENCH_DURATION			( 2000 / portTICK_RATE_MS )
+#define mainLIBC_BENCH_PRIORITY			( configMAX_PRIORITIES - 1 )
+#define mainLIBC_BENCH_WORKER_PRIORITY	( tskIDLE_PRIORITY + 1 )
+
+static volatile portBASE_TYPE xLibcBenchStop = pdFALSE;
+static volatile unsigned long ulLibcBenchLines[ mainLIBC_BENCH_MAX_TASKS ];
+static volatile unsigned long ulLibcBenchErrors[ mainLIBC_BENCH_MAX_TASKS ];
+static xSemaphoreHandle xLibcBenchDone = NULL;
+
+static void prvLibcBenchWorker( void *pvParameters )
+{
+const unsigned long ulTask = ( unsigned long ) pvParameters;
+unsigned long ulLine = 0UL;
+size_t xSize;
+char cLine[ 48 ];
+char *pcTask, *pcName, *pcLine;
+unsigned char *pucBuffer;
+
+	while( pdFALSE == xLibcBenchStop )
 	{
-		(void)xSerialPutChar( (xComPortHandle)mainPRINT_PORT, cChar, 0UL );
-		(void)xSerialPutChar( (xComPortHandle)mainPRINT_PORT, cChar, 0UL );
+		( void ) snprintf( cLine, sizeof( cLine ), "%lu,libc,%lu", ulTask, ulLine );
+
+		/* Yielding between the tokens lets the other tasks call strtok() in
+		the middle of this line. */
+		pcTask = strtok( cLine, "," );
+		taskYIELD();
+		pcName = strtok( NULL, "," );
+		taskYIELD();
+		pcLine = strtok( NULL, "," );
+
+		if( ( NULL == pcTask ) || ( NULL == pcName ) || ( NULL == pcLine ) ||
+			( strtoul( pcTask, NULL, 10 ) != ulTask ) || ( 0 != strcmp( pcName, "libc" ) ) || ( strtoul( pcLine, NULL, 10 ) != ulLine ) )
+		{
+			ulLibcBenchErrors[ ulTask ]++;
+		}
+
+		/* getenv() takes newlib's environment lock.  The demo sets no
+		variables. */
+		if( NULL != getenv( "LIBCBENCH" ) )
+		{
+			ulLibcBenchErrors[ ulTask ]++;
+		}
+
+		xSize = ( size_t ) ( 64UL + ( ( ulLine % 8UL ) * 32UL ) );
+		#if ( configUSE_NEWLIB_REENTRANT == 1 )
+		{
+			/* Straight into newlib's malloc(), serialised by the lock hooks
+			in heap_3.c. */
+			pucBuffer = ( unsigned char * ) malloc( xSize );
+		}
+		#else
+		{
+			/* newlib's malloc() has no lock of its own, so go through
+			pvPortMalloc(), which suspends the scheduler around it. */
+			pucBuffer = ( unsigned char * ) pvPortMalloc( xSize );
+		}
+		#endif
+
+		if( NULL != pucBuffer )
+		{
+			memset( pucBuffer, ( int ) ulLine, 64 );
+			#if ( configUSE_NEWLIB_REENTRANT == 1 )
+				free( pucBuffer );
+			#else
+				vPortFree( pucBuffer );
+			#endif
+		}
+		else
+		{
+			ulLibcBenchErrors[ ulTask ]++;
+		}
+
+		ulLine++;
+		ulLibcBenchLines[ ulTask ] = ulLine;
 	}
+
+	( void ) xSemaphoreGive( xLibcBenchDone );
+	vTaskDelete( NULL );
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvLibcBenchTask( void *pvParameters )
+{
+unsigned long ulTasks, ul, ulLines, ulErrors;
+#if ( configUSE_NEWLIB_REENTRANT == 1 )
+	unsigned long ulLocksBefore, ulWaitsBefore, ulLocks, ulWaits;
+#endif
+
+	( void ) pvParameters;
+
+	xLibcBenchDone = xSemaphoreCreateCounting( mainLIBC_BENCH_MAX_TASKS, 0 );
+	if( NULL == xLibcBenchDone )
+	{
+		printf( "libc benchmark: could not create the semaphore\r\n" );
+		vTaskDelete( NULL );
+	}
+
+	for( ulTasks = 1UL; ulTasks <= mainLIBC_BENCH_MAX_TASKS; ulTasks *= 2UL )
+	{
+		#if ( configUSE_NEWLIB_REENTRANT == 1 )
+		{
+			vPortGetLibcLockStats( &ulLocksBefore, &ulWaitsBefore );
+		}
+		#endif
+
+		xLibcBenchStop = pdFALSE;
+		for( ul = 0UL; ul < ulTasks; ul++ )
+		{
+			ulLibcBenchLines[ ul ] = 0UL;
+			ulLibcBenchErrors[ ul ] = 0UL;
+			( void ) xTaskCreate( prvLibcBenchWorker, ( const signed char * ) "libc", configMINIMAL_STACK_SIZE, ( void * ) ul, mainLIBC_BENCH_WORKER_PRIORITY, NULL );
+		}
+
+		vTaskDelay( mainLIBC_BENCH_DURATION );
+		xLibcBenchStop = pdTRUE;
+
+		ulLines = 0UL;
+		ulErrors = 0UL;
+		for( ul = 0UL; ul < ulTasks; ul++ )
+		{
+			( void ) xSemaphoreTake( xLibcBenchDone, portMAX_DELAY );
+		}
+
+		#if ( configUSE_NEWLIB_REENTRANT == 1 )
+		{
+			vPortGetLibcLockStats( &ulLocks, &ulWaits );
+		}
+		#endif
+
+		for( ul = 0UL; ul < ulTasks; ul++ )
+		{
+			ulLines += ulLibcBenchLines[ ul ];
+			ulErrors += ulLibcBenchErrors[ ul ];
+		}
+
+		printf( "libc with %lu tasks, newlib reentrancy %s: %lu lines/s, %lu wrong\r\n", ulTasks,
+				( configUSE_NEWLIB_REENTRANT == 1 ) ? "on" : "off",
+				( ulLines * 1000UL ) / ( mainLIBC_BENCH_DURATION * portTICK_RATE_MS ), ulErrors );
+		#if ( configUSE_NEWLIB_REENTRANT == 1 )
+		{
+			printf( "    newlib lock taken %lu times, %lu of them after waiting for another task\r\n",
+					ulLocks - ulLocksBefore, ulWaits - ulWaitsBefore );
+		}
+		#endif
+
+		/* Let the idle task free the workers before the next run. */
+		vTaskDelay( 10 / portTICK_RATE_MS );
+	}
+
+	vTaskDelete( NULL );
+}
+/*----------------------------------------------------------------------------*/
+
+#endif /* mainLIBC_BENCHMARK */
+
+#if ( mainLIST_BENCHMARK == 1 )
+
+#define mainLIST_BENCH_MAX_ITEMS		( 1024UL )
+#define mainLIST_BENCH_TRIALS			( 256UL )
+#define mainLIST_BENCH_PRIORITY			( configMAX_PRIORITIES - 1 )
+
+static xList xListBenchList;
+static xListItem xListBenchItems[ mainLIST_BENCH_MAX_ITEMS ];
+static unsigned long ulListBenchSeed = 1UL;
+
+static unsigned long prvListBenchRandom( void )
+{
+	/* The values must stay below portMAX_DELAY, which is kept for the end of
+	the list. */
+	ulListBenchSeed = ( ulListBenchSeed * 1103515245UL ) + 12345UL;
+	return ( ulListBenchSeed >> 8 ) & 0x00ffffffUL;
+}
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Fill the list with ulLength items of random value, then repeatedly take an
+ * item out and time putting it back with a new value.  The new value is
+ * random, or larger than every other if xAtEnd is pdTRUE.
+ */
+static void prvListBenchRun( unsigned long ulLength, portBASE_TYPE xAtEnd )
+{
+unsigned long ul, ulStart, ulCycles, ulMax = 0UL;
+unsigned long long ullTotal = 0ULL;
+xListItem *pxItem;
+
+	vListInitialise( &xListBenchList );
+	for( ul = 0UL; ul < ulLength; ul++ )
+	{
+		vListInitialiseItem( &( xListBenchItems[ ul ] ) );
+		listSET_LIST_ITEM_VALUE( &( xListBenchItems[ ul ] ), ( portTickType ) prvListBenchRandom() );
+		vListInsert( &xListBenchList, &( xListBenchItems[ ul ] ) );
+	}
+
+	for( ul = 0UL; ul < mainLIST_BENCH_TRIALS; ul++ )
+	{
+		pxItem = &( xListBenchItems[ prvListBenchRandom() % ulLength ] );
+		vListRemove( pxItem );
+		listSET_LIST_ITEM_VALUE( pxItem, ( portTickType ) ( ( pdFALSE != xAtEnd ) ? ( 0x01000000UL + ul ) : prvListBenchRandom() ) );
+
+		/* The kernel inserts with interrupts masked, so time it that way,
+		which also keeps the tick out of the measurement. */
+		taskENTER_CRITICAL();
+		{
+			ulStart = portGET_CYCLE_COUNT();
+			vListInsert( &xListBenchList, pxItem );
+			ulCycles = portGET_CYCLE_COUNT() - ulStart;
+		}
+		taskEXIT_CRITICAL();
+
+		ullTotal += ulCycles;
+		if( ulCycles > ulMax )
+		{
+			ulMax = ulCycles;
+		}
+	}
+
+	printf( "vListInsert, skip index %s, %4lu items, %s values: max %lu, mean %lu cycles\r\n",
+			( configUSE_LIST_SKIP_INDEX == 1 ) ? "on" : "off", ulLength, ( pdFALSE != xAtEnd ) ? "last" : "random",
+			ulMax, ( unsigned long ) ( ullTotal / mainLIST_BENCH_TRIALS ) );
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvListBenchTask( void *pvParameters )
+{
+unsigned long ulLength;
+
+	( void ) pvParameters;
+
+	for( ulLength = 16UL; ulLength <= mainLIST_BENCH_MAX_ITEMS; ulLength *= 4UL )
+	{
+		prvListBenchRun( ulLength, pdFALSE );
+		prvListBenchRun( ulLength, pdTRUE );
+	}
+
+	vTaskDelete( NULL );
+}
+/*----------------------------------------------------------------------------*/
+
+#endif /* mainLIST_BENCHMARK */
+
+#if ( mainUART_BENCHMARK == 1 )
+
+#define mainBENCH_PORT			( 1UL )
+#define mainBENCH_BAUDRATE		( 115200UL )
+#define mainBENCH_BYTES			( 32768UL )
+#define mainBENCH_RING_SIZE		( 256UL )
+#define mainBENCH_PRIORITY		( PRIOR_FIX_FREQ_PERIODIC + 1 )
+
+static volatile unsigned long ulBenchMismatches = 0UL;
+static xSemaphoreHandle xBenchDone = NULL;
+
+/* The data sent by the transmit only runs. */
+static unsigned char ucBenchBuffer[ mainBENCH_BYTES ];
+
+/*
+ * Receive half of the benchmark: checks that the bytes come back in the order
+ * they were sent, as the Rx task of comtest.c does.
+ */
+static void prvUARTBenchRxTask( void *pvParameters )
+{
+unsigned long ulReceived;
+signed char cChar;
+
+	( void ) pvParameters;
+
+	for( ulReceived = 0UL; ulReceived < mainBENCH_BYTES; ulReceived++ )
+	{
+		if( ( pdTRUE != xUARTReceiveCharacter( mainBENCH_PORT, &cChar, portMAX_DELAY ) ) || ( ( unsigned char ) cChar != ( unsigned char ) ulReceived ) )
+		{
+			ulBenchMismatches++;
+		}
+	}
+
+	xSemaphoreGive( xBenchDone );
+	vTaskDelete( NULL );
+}
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Print the throughput and CPU use of a run that started at xStart, when the
+ * idle count was zeroed.
+ */
+static void prvUARTBenchReport( const char *pcName, portTickType xStart )
+{
+unsigned long ulIdleBusy = ulIdleCount, ulCPUPercent;
+portTickType xElapsed = xTaskGetTickCount() - xStart;
+xUARTStats xStats;
+
+	if( 0 == xElapsed )
+	{
+		xElapsed = 1;
+	}
+
+	ulCPUPercent = prvBenchCPUPercent( ulIdleBusy, xElapsed );
+
+	vUARTGetStats( mainBENCH_PORT, &xStats );
+	printf( "UART %s: %lu bytes in %lu ms, %lu bytes/s, CPU %lu%%\r\n",
+			pcName, mainBENCH_BYTES, ( unsigned long ) ( xElapsed * portTICK_RATE_MS ), ( mainBENCH_BYTES * 1000UL ) / ( xElapsed * portTICK_RATE_MS ), ulCPUPercent );
+	printf( "  tx irqs %lu, rx irqs %lu, dma chains %lu (%lu timed out), overrun %lu, dropped %lu rx %lu tx, mismatches %lu\r\n",
+			xStats.ulTxInterrupts, xStats.ulRxInterrupts, xStats.ulTxDMATransfers, xStats.ulTxDMATimeouts, xStats.ulOverrunErrors, xStats.ulRxDropped, xStats.ulTxDropped, ulBenchMismatches );
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvUARTBenchTask( void *pvParameters )
+{
+unsigned long ulSent;
+portTickType xStart;
+
+	( void ) pvParameters;
+
+	vSemaphoreCreateBinary( xBenchDone );
+	( void ) xSemaphoreTake( xBenchDone, 0 );
+
+	for( ulSent = 0UL; ulSent < mainBENCH_BYTES; ulSent++ )
+	{
+		ucBenchBuffer[ ulSent ] = ( unsigned char ) ulSent;
+	}
+
+	vUARTInitialise( mainBENCH_PORT, mainBENCH_BAUDRATE, mainBENCH_RING_SIZE );
+	vUARTSetLoopback( mainBENCH_PORT, pdTRUE );
+
+	prvBenchCalibrate();
+
+	/* Loopback, checking every byte comes back. */
+	xTaskCreate( prvUARTBenchRxTask, ( signed char * ) "BenchRx", configMINIMAL_STACK_SIZE, NULL, mainBENCH_PRIORITY + 1, NULL );
+
+	xStart = xTaskGetTickCount();
+	ulIdleCount = 0UL;
+
+	for( ulSent = 0UL; ulSent < mainBENCH_BYTES; ulSent++ )
+	{
+		(void)xUARTSendCharacter( mainBENCH_PORT, ( signed char ) ucBenchBuffer[ ulSent ], portMAX_DELAY );
+	}
+
+	( void ) xSemaphoreTake( xBenchDone, portMAX_DELAY );
+	prvUARTBenchReport( "loopback", xStart );
+	vUARTSetLoopback( mainBENCH_PORT, pdFALSE );
+
+	/* Transmit only, a byte at a time through the ring. */
+	xStart = xTaskGetTickCount();
+	ulIdleCount = 0UL;
+
+	for( ulSent = 0UL; ulSent < mainBENCH_BYTES; ulSent++ )
+	{
+		(void)xUARTSendCharacter( mainBENCH_PORT, ( signed char ) ucBenchBuffer[ ulSent ], portMAX_DELAY );
+	}
+
+	prvUARTBenchReport( "tx by byte", xStart );
+
+	/* Transmit only, the whole buffer by DMA. */
+	xStart = xTaskGetTickCount();
+	ulIdleCount = 0UL;
+	(void)ulUARTSendBuffer( mainBENCH_PORT, ucBenchBuffer, mainBENCH_BYTES, portMAX_DELAY );
+	prvUARTBenchReport( "tx by DMA", xStart );
+
+	vTaskDelete( NULL );
+}
+/*----------------------------------------------------------------------------*/
+
+#endif /* mainUART_BENCHMARK */
+
+#if ( mainNET_BENCHMARK == 1 )
+
+#define mainNET_BENCH_PORT		( 5555U )
+#define mainNET_BENCH_DATAGRAMS	( 20000UL )
+#define mainNET_BENCH_QUEUE		( 8U )
+#define mainNET_BENCH_QUIET_MS	( 2000UL )
+#define mainNET_BENCH_PRIORITY	( PRIOR_FIX_FREQ_PERIODIC + 1 )
+
+/* The datagrams that start a run and end each direction, as netbench.py sends
+and expects them. */
+static const char cNetBenchStart[] = "go";
+static const char cNetBenchEnd[] = "end";
+
+/*
+ * Send a short control datagram.
+ */
+static void prvNetBenchSendText( xNetSocketHandle xSocket, unsigned long ulAddress, unsigned short usPort, const char *pcText )
+{
+xNetBuffer *pxBuffer = pxNetBufferAlloc( portMAX_DELAY );
+
+	pxBuffer->ulLength = strlen( pcText );
+	memcpy( pxBuffer->pucData, pcText, pxBuffer->ulLength );
+	( void ) xNetUDPSend( xSocket, pxBuffer, ulAddress, usPort );
+}
+/*----------------------------------------------------------------------------*/
+
+static portBASE_TYPE prvNetBenchIsText( const xNetBuffer *pxBuffer, const char *pcText )
+{
+	return ( ( pxBuffer->ulLength == strlen( pcText ) ) && ( 0 == memcmp( pxBuffer->pucData, pcText, pxBuffer->ulLength ) ) ) ? pdTRUE : pdFALSE;
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvNetBenchReport( const char *pcName, unsigned long ulDatagrams, unsigned long ulBytes, portTickType xElapsed, unsigned long ulIdleBusy )
+{
+	if( 0 == xElapsed )
+	{
+		xElapsed = 1;
+	}
+
+	printf( "UDP %s: %lu datagrams, %lu bytes in %lu ms, %lu bytes/s, CPU %lu%%\r\n",
+			pcName, ulDatagrams, ulBytes, ( unsigned long ) ( xElapsed * portTICK_RATE_MS ),
+			( unsigned long ) ( ( ( unsigned long long ) ulBytes * 1000ULL ) / ( xElapsed * portTICK_RATE_MS ) ), prvBenchCPUPercent( ulIdleBusy, xElapsed ) );
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvNetBenchTask( void *pvParameters )
+{
+xNetSocketHandle xSocket;
+xNetBuffer *pxBuffer;
+unsigned long ulAddress, ulSent, ulDatagrams, ulBytes, ulIdleBusy = 0UL;
+unsigned short usPort;
+portTickType xStart = 0, xLast = 0;
+xNetStats xStats;
+xLAN9118Stats xLANStats;
+
+	( void ) pvParameters;
+
+	xSocket = xNetUDPOpen( mainNET_BENCH_PORT, mainNET_BENCH_QUEUE );
+	configASSERT( xSocket );
+	prvBenchCalibrate();
+
+	for( ;; )
+	{
+		/* Wait for netbench.py, and answer it from the address and port it
+		used, which QEMU maps back to the host. */
+		pxBuffer = pxNetUDPReceive( xSocket, portMAX_DELAY );
+		if( NULL == pxBuffer )
+		{
+			continue;
+		}
+
+		ulAddress = pxBuffer->ulAddress;
+		usPort = pxBuffer->usPort;
+		if( pdFALSE == prvNetBenchIsText( pxBuffer, cNetBenchStart ) )
+		{
+			vNetBufferFree( pxBuffer );
+			continue;
+		}
+		vNetBufferFree( pxBuffer );
+		prvNetBenchSendText( xSocket, ulAddress, usPort, cNetBenchStart );
+
+		/* Target to host: full sized datagrams, each starting with its
+		number.  The payload is sent from the buffer it is written in. */
+		xStart = xTaskGetTickCount();
+		ulIdleCount = 0UL;
+
+		for( ulSent = 0UL; ulSent < mainNET_BENCH_DATAGRAMS; ulSent++ )
+		{
+			pxBuffer = pxNetBufferAlloc( portMAX_DELAY );
+			memcpy( pxBuffer->pucData, &ulSent, sizeof( ulSent ) );
+			pxBuffer->ulLength = netUDP_MAX_PAYLOAD;
+			( void ) xNetUDPSend( xSocket, pxBuffer, ulAddress, usPort );
+		}
+
+		prvNetBenchReport( "tx", mainNET_BENCH_DATAGRAMS, mainNET_BENCH_DATAGRAMS * netUDP_MAX_PAYLOAD, xTaskGetTickCount() - xStart, ulIdleCount );
+		prvNetBenchSendText( xSocket, ulAddress, usPort, cNetBenchEnd );
+
+		/* Host to target, until the host says it is done or goes quiet. */
+		ulDatagrams = 0UL;
+		ulBytes = 0UL;
+
+		while( NULL != ( pxBuffer = pxNetUDPReceive( xSocket, mainNET_BENCH_QUIET_MS / portTICK_RATE_MS ) ) )
+		{
+			if( pdFALSE != prvNetBenchIsText( pxBuffer, cNetBenchEnd ) )
+			{
+				vNetBufferFree( pxBuffer );
+				break;
+			}
+
+			if( 0UL == ulDatagrams )
+			{
+				xStart = xTaskGetTickCount();
+				ulIdleCount = 0UL;
+			}
+
+			ulDatagrams++;
+			ulBytes += pxBuffer->ulLength;
+			xLast = xTaskGetTickCount();
+			ulIdleBusy = ulIdleCount;
+			vNetBufferFree( pxBuffer );
+		}
+
+		if( ulDatagrams > 0UL )
+		{
+			prvNetBenchReport( "rx", ulDatagrams, ulBytes, xLast - xStart, ulIdleBusy );
+		}
+
+		vNetGetStats( &xStats );
+		vLAN9118GetStats( &xLANStats );
+		printf( "  frames rx %lu tx %lu, dropped %lu, no socket %lu, socket full %lu, unresolved %lu\r\n",
+				xStats.ulRxFrames, xStats.ulTxFrames, xStats.ulDropped, xStats.ulNoSocket, xStats.ulSocketFull, xStats.ulARPUnresolved );
+		printf( "  irqs %lu, rx errors %lu, no buffer %lu, overruns %lu, tx errors %lu, tx timeouts %lu\r\n",
+				xLANStats.ulInterrupts, xLANStats.ulRxErrors, xLANStats.ulRxNoBuffer, xLANStats.ulRxOverruns, xLANStats.ulTxErrors, xLANStats.ulTxTimeouts );
+	}
+}
+/*----------------------------------------------------------------------------*/
+
+#endif /* mainNET_BENCHMARK */
+
+#if ( mainSD_BENCHMARK == 1 )
+
+#define mainSD_BENCH_FIRST		( 65536UL )		/* Half way into the 64 MB image. */
+#define mainSD_BENCH_BLOCKS		( 2048UL )		/* Each sequential run covers 1 MB, */
+#define mainSD_BENCH_RANDOM		( 1024UL )		/* and each random one makes this many accesses */
+#define mainSD_BENCH_SPAN		( cacheENTRIES * 4UL )	/* to blocks this close together. */
+#define mainSD_BENCH_MULTIPLE	( 32UL )		/* Blocks per request of the multiple block runs. */
+#define mainSD_BENCH_PRIORITY	( PRIOR_FIX_FREQ_PERIODIC + 1 )
+
+typedef portBASE_TYPE ( *pdSD_BENCH_ACCESS )( unsigned long ulBlock, unsigned long ulCount, void *pvBuffer );
+
+typedef struct SD_BENCH_RUN
+{
+	const char *pcName;
+	pdSD_BENCH_ACCESS pxAccess;
+	unsigned long ulPerRequest;
+	portBASE_TYPE xRandom;
+} xSDBenchRun;
+
+static portBASE_TYPE prvSDBenchRawWrite( unsigned long ulBlock, unsigned long ulCount, void *pvBuffer )
+{
+	return xMMCIWrite( ulBlock, ulCount, pvBuffer );
+}
+/*----------------------------------------------------------------------------*/
+
+static portBASE_TYPE prvSDBenchCachedWrite( unsigned long ulBlock, unsigned long ulCount, void *pvBuffer )
+{
+	return xBlockCacheWrite( ulBlock, ulCount, pvBuffer );
+}
+/*----------------------------------------------------------------------------*/
+
+static const xSDBenchRun xSDBenchRuns[] =
+{
+	{ "raw sequential read", xMMCIRead, 1UL, pdFALSE },
+	{ "raw multiple block read", xMMCIRead, mainSD_BENCH_MULTIPLE, pdFALSE },
+	{ "cached sequential read", xBlockCacheRead, 1UL, pdFALSE },
+	{ "raw random read", xMMCIRead, 1UL, pdTRUE },
+	{ "cached random read", xBlockCacheRead, 1UL, pdTRUE },
+	{ "raw sequential write", prvSDBenchRawWrite, 1UL, pdFALSE },
+	{ "raw multiple block write", prvSDBenchRawWrite, mainSD_BENCH_MULTIPLE, pdFALSE },
+	{ "cached sequential write", prvSDBenchCachedWrite, 1UL, pdFALSE },
+	{ "raw random write", prvSDBenchRawWrite, 1UL, pdTRUE },
+	{ "cached random write", prvSDBenchCachedWrite, 1UL, pdTRUE }
+};
+
+static unsigned char ucSDBenchBuffer[ mainSD_BENCH_MULTIPLE * mmciBLOCK_SIZE ];
+
+/*
+ * Time one run.  Cached runs start from an empty cache, and end once all they
+ * wrote is on the card.
+ */
+static void prvSDBenchRun( const xSDBenchRun *pxRun )
+{
+unsigned long ulRequests = ( pdFALSE != pxRun->xRandom ) ? mainSD_BENCH_RANDOM : mainSD_BENCH_BLOCKS / pxRun->ulPerRequest;
+unsigned long ulSeed = 1UL, ulBlock, ulBytes, ulFailures = 0UL, ul;
+portTickType xStart, xElapsed;
+
+	( void ) xBlockCacheInvalidate();
+	xStart = xTaskGetTickCount();
+	ulIdleCount = 0UL;
+
+	for( ul = 0UL; ul < ulRequests; ul++ )
+	{
+		if( pdFALSE != pxRun->xRandom )
+		{
+			/* The same sequence for every run. */
+			ulSeed = ulSeed * 1103515245UL + 12345UL;
+			ulBlock = mainSD_BENCH_FIRST + ( ( ulSeed >> 16 ) % mainSD_BENCH_SPAN );
+		}
+		else
+		{
+			ulBlock = mainSD_BENCH_FIRST + ul * pxRun->ulPerRequest;
+		}
+
+		if( pdPASS != pxRun->pxAccess( ulBlock, pxRun->ulPerRequest, ucSDBenchBuffer ) )
+		{
+			ulFailures++;
+		}
+	}
+
+	if( pdPASS != xBlockCacheFlush() )
+	{
+		ulFailures++;
+	}
+
+	xElapsed = xTaskGetTickCount() - xStart;
+	if( 0 == xElapsed )
+	{
+		xElapsed = 1;
+	}
+
+	ulBytes = ulRequests * pxRun->ulPerRequest * mmciBLOCK_SIZE;
+	printf( "SD %s: %lu bytes in %lu ms, %lu bytes/s, CPU %lu%%, %lu failed\r\n",
+			pxRun->pcName, ulBytes, ( unsigned long ) ( xElapsed * portTICK_RATE_MS ),
+			( unsigned long ) ( ( ( unsigned long long ) ulBytes * 1000ULL ) / ( xElapsed * portTICK_RATE_MS ) ),
+			prvBenchCPUPercent( ulIdleCount, xElapsed ), ulFailures );
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvSDBenchTask( void *pvParameters )
+{
+xMMCIStats xStats;
+xBlockCacheStats xCacheStats;
+unsigned long ul;
+
+	( void ) pvParameters;
+
+	if( ulMMCIGetBlockCount() < mainSD_BENCH_FIRST + mainSD_BENCH_BLOCKS )
+	{
+		printf( "SD benchmark: the card is missing or too small\r\n" );
+		vTaskDelete( NULL );
+	}
+
+	prvBenchCalibrate();
+
+	for( ul = 0UL; ul < sizeof( xSDBenchRuns ) / sizeof( xSDBenchRuns[ 0 ] ); ul++ )
+	{
+		prvSDBenchRun( &xSDBenchRuns[ ul ] );
+	}
+
+	vMMCIGetStats( &xStats );
+	vBlockCacheGetStats( &xCacheStats );
+	printf( "  requests read %lu write %lu, blocks read %lu written %lu, errors %lu, irqs %lu\r\n",
+			xStats.ulReads, xStats.ulWrites, xStats.ulBlocksRead, xStats.ulBlocksWritten, xStats.ulErrors, xStats.ulInterrupts );
+	printf( "  cache hits %lu, misses %lu, read ahead %lu, write backs %lu of %lu blocks\r\n",
+			xCacheStats.ulHits, xCacheStats.ulMisses, xCacheStats.ulReadAhead, xCacheStats.ulWriteBacks, xCacheStats.ulBlocksWritten );
+
+	vTaskDelete( NULL );
+}
+/*----------------------------------------------------------------------------*/
+
+#endif /* mainSD_BENCHMARK */
+
+#if ( mainFAT_BENCHMARK == 1 )
+
+#define mainFAT_BENCH_FILE		"BENCH.LOG"
+#define mainFAT_BENCH_FILE2		"BENCH2.LOG"	/* Written alongside the first by the two file run. */
+#define mainFAT_BENCH_BYTES		( 262144UL )	/* Logged by each buffered run, */
+#define mainFAT_BENCH_FLUSHED	( 16384UL )		/* and by each that flushes every record. */
+#define mainFAT_BENCH_RECORD	( 512UL )		/* The longest record. */
+#define mainFAT_BENCH_PRIORITY	( PRIOR_FIX_FREQ_PERIODIC + 1 )
+
+typedef struct FAT_BENCH_RUN
+{
+	const char *pcName;
+	unsigned long ulRecordSize;
+	unsigned long ulBytes;
+	portBASE_TYPE xFlushEach;
+} xFATBenchRun;
+
+/* The buffered run of the longest records is last, and is read back. */
+static const xFATBenchRun xFATBenchRuns[] =
+{
+	{ "flushed", 32UL, mainFAT_BENCH_FLUSHED, pdTRUE },
+	{ "buffered", 32UL, mainFAT_BENCH_BYTES, pdFALSE },
+	{ "flushed", 128UL, mainFAT_BENCH_FLUSHED, pdTRUE },
+	{ "buffered", 128UL, mainFAT_BENCH_BYTES, pdFALSE },
+	{ "flushed", mainFAT_BENCH_RECORD, mainFAT_BENCH_FLUSHED, pdTRUE },
+	{ "buffered", mainFAT_BENCH_RECORD, mainFAT_BENCH_BYTES, pdFALSE }
+};
+
+/* Run by two tasks at once, one on each file. */
+static const xFATBenchRun xFATBenchPairRun = { "buffered, two files at once", mainFAT_BENCH_RECORD, mainFAT_BENCH_BYTES, pdFALSE };
+
+static xSemaphoreHandle xFATBenchPeerDone = NULL;
+
+static void prvFATBenchReport( const char *pcName, unsigned long ulRecordSize, unsigned long ulBytes, portTickType xElapsed, unsigned long ulFailures )
+{
+	if( 0 == xElapsed )
+	{
+		xElapsed = 1;
+	}
+
+	printf( "FAT %s, %lu byte records: %lu bytes in %lu ms, %lu bytes/s, CPU %lu%%, %lu failed\r\n",
+			pcName, ulRecordSize, ulBytes, ( unsigned long ) ( xElapsed * portTICK_RATE_MS ),
+			( unsigned long ) ( ( ( unsigned long long ) ulBytes * 1000ULL ) / ( xElapsed * portTICK_RATE_MS ) ),
+			prvBenchCPUPercent( ulIdleCount, xElapsed ), ulFailures );
+}
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Log to a new file, a numbered line of text per record, and close it so
+ * that the time includes putting everything on the card.
+ */
+static void prvFATBenchAppend( const xFATBenchRun *pxRun, const char *pcFile )
+{
+xFATFileHandle xFile;
+unsigned long ulRecord, ulFailures = 0UL;
+portTickType xStart;
+char cFATBenchRecord[ mainFAT_BENCH_RECORD ];
+
+	xFile = xFATOpen( pcFile, fatWRITE | fatCREATE | fatTRUNCATE );
+	if( NULL == xFile )
+	{
+		printf( "FAT benchmark: cannot create %s\r\n", pcFile );
+		return;
+	}
+
+	memset( cFATBenchRecord, '.', pxRun->ulRecordSize );
+	cFATBenchRecord[ pxRun->ulRecordSize - 2UL ] = '\r';
+	cFATBenchRecord[ pxRun->ulRecordSize - 1UL ] = '\n';
+
+	xStart = xTaskGetTickCount();
+	ulIdleCount = 0UL;
+
+	for( ulRecord = 0UL; ulRecord < pxRun->ulBytes / pxRun->ulRecordSize; ulRecord++ )
+	{
+		/* The number overwrites its terminator with a space. */
+		( void ) sprintf( cFATBenchRecord, "%08lu", ulRecord );
+		cFATBenchRecord[ 8 ] = ' ';
+
+		if( ulFATWrite( xFile, cFATBenchRecord, pxRun->ulRecordSize ) != pxRun->ulRecordSize )
+		{
+			ulFailures++;
+		}
+
+		if( ( pdFALSE != pxRun->xFlushEach ) && ( pdPASS != xFATFlush( xFile ) ) )
+		{
+			ulFailures++;
+		}
+	}
+
+	if( pdPASS != xFATClose( xFile ) )
+	{
+		ulFailures++;
+	}
+
+	prvFATBenchReport( pxRun->pcName, pxRun->ulRecordSize, pxRun->ulBytes, xTaskGetTickCount() - xStart, ulFailures );
+}
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Read the log of the last run back from the card, and check every record.
+ */
+static void prvFATBenchReadBack( const xFATBenchRun *pxRun, const char *pcFile )
+{
+xFATFileHandle xFile;
+unsigned long ulRecord, ulBytes = 0UL, ulFailures = 0UL;
+portTickType xStart;
+char cFATBenchRecord[ mainFAT_BENCH_RECORD ];
+char cFATBenchRead[ mainFAT_BENCH_RECORD ];
+
+	( void ) xBlockCacheInvalidate();
+
+	xFile = xFATOpen( pcFile, fatREAD );
+	if( NULL == xFile )
+	{
+		printf( "FAT benchmark: cannot open %s\r\n", pcFile );
+		return;
+	}
+
+	xStart = xTaskGetTickCount();
+	ulIdleCount = 0UL;
+
+	for( ulRecord = 0UL; ulFATRead( xFile, cFATBenchRead, pxRun->ulRecordSize ) == pxRun->ulRecordSize; ulRecord++ )
+	{
+		( void ) sprintf( cFATBenchRecord, "%08lu", ulRecord );
+		cFATBenchRecord[ 8 ] = ' ';
+
+		if( 0 != memcmp( cFATBenchRead, cFATBenchRecord, pxRun->ulRecordSize ) )
+		{
+			ulFailures++;
+		}
+		ulBytes += pxRun->ulRecordSize;
+	}
+
+	if( ulBytes != pxRun->ulBytes )
+	{
+		ulFailures++;
+	}
+	( void ) xFATClose( xFile );
+
+	prvFATBenchReport( "read back", pxRun->ulRecordSize, ulBytes, xTaskGetTickCount() - xStart, ulFailures );
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvFATBenchPeerTask( void *pvParameters )
+{
+	( void ) pvParameters;
+
+	prvFATBenchAppend( &xFATBenchPairRun, mainFAT_BENCH_FILE2 );
+	prvFATBenchReadBack( &xFATBenchPairRun, mainFAT_BENCH_FILE2 );
+
+	( void ) xSemaphoreGive( xFATBenchPeerDone );
+	vTaskDelete( NULL );
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvFATBenchTask( void *pvParameters )
+{
+xFATStats xStats;
+xBlockCacheStats xCacheStats;
+unsigned long ul;
+
+	( void ) pvParameters;
+
+	if( pdPASS != xFATMount() )
+	{
+		printf( "FAT benchmark: no FAT file system on the card\r\n" );
+		vTaskDelete( NULL );
+	}
+
+	prvBenchCalibrate();
+
+	for( ul = 0UL; ul < sizeof( xFATBenchRuns ) / sizeof( xFATBenchRuns[ 0 ] ); ul++ )
+	{
+		prvFATBenchAppend( &xFATBenchRuns[ ul ], mainFAT_BENCH_FILE );
+	}
+	prvFATBenchReadBack( &xFATBenchRuns[ ul - 1UL ], mainFAT_BENCH_FILE );
+
+	/* The same as the last run, on two files at once.  The CPU figures of
+	the two overlap, so only the times mean anything. */
+	xFATBenchPeerDone = xSemaphoreCreateCounting( 1, 0 );
+	if( ( NULL != xFATBenchPeerDone ) &&
+		( pdPASS == xTaskCreate( prvFATBenchPeerTask, ( const signed char * ) "fatpeer", configMINIMAL_STACK_SIZE * 2, NULL, mainFAT_BENCH_PRIORITY, NULL ) ) )
+	{
+		prvFATBenchAppend( &xFATBenchPairRun, mainFAT_BENCH_FILE );
+		prvFATBenchReadBack( &xFATBenchPairRun, mainFAT_BENCH_FILE );
+		( void ) xSemaphoreTake( xFATBenchPeerDone, portMAX_DELAY );
+	}
+
+	vFATGetStats( &xStats );
+	vBlockCacheGetStats( &xCacheStats );
+	printf( "  clusters from runs %lu, FAT entries read %lu, full clusters written %lu, part full %lu\r\n",
+			xStats.ulRunHits, xStats.ulFATReads, xStats.ulClusterWrites, xStats.ulTailWrites );
+	printf( "  cache hits %lu, misses %lu, read ahead %lu, write backs %lu of %lu blocks\r\n",
+			xCacheStats.ulHits, xCacheStats.ulMisses, xCacheStats.ulReadAhead, xCacheStats.ulWriteBacks, xCacheStats.ulBlocksWritten );
+
+	vTaskDelete( NULL );
+}
+/*----------------------------------------------------------------------------*/
+
+#endif /* mainFAT_BENCHMARK */
+
+#if ( mainAIO_BENCHMARK == 1 )
+
+#define mainAIO_BENCH_PORT			( 1UL )
+#define mainAIO_BENCH_BAUDRATE		( 115200UL )
+#define mainAIO_BENCH_RING_SIZE		( 256UL )
+#define mainAIO_BENCH_BYTES			( 16384UL )
+#define mainAIO_BENCH_CHUNK			( 512UL )
+#define mainAIO_BENCH_DEPTH			( 4 )			/* Requests kept queued on each direction of the UART. */
+#define mainAIO_BENCH_INTERVAL		( 10000UL )		/* Microseconds per timer request. */
+#define mainAIO_BENCH_ALARM			( 1UL )			/* Seconds per RTC request. */
+#define mainAIO_BENCH_STALL			( 5000 / portTICK_RATE_MS )
+#define mainAIO_BENCH_PRIORITY		( PRIOR_FIX_FREQ_PERIODIC + 1 )
+
+static unsigned char ucAIOBenchTx[ mainAIO_BENCH_BYTES ];
+static unsigned char ucAIOBenchRx[ mainAIO_BENCH_DEPTH ][ mainAIO_BENCH_CHUNK ];
+
+static xAIORequest xAIOBenchWrites[ mainAIO_BENCH_DEPTH ];
+static xAIORequest xAIOBenchReads[ mainAIO_BENCH_DEPTH ];
+static xAIORequest xAIOBenchIntervals[ 2 ];
+static xAIORequest xAIOBenchAlarm;
+
+/*
+ * Fill in a request that posts to xCompletions when it completes.
+ */
+static void prvAIOBenchPrepare( xAIORequest *pxRequest, unsigned char *pucBuffer, unsigned long ulLength, xQueueHandle xCompletions )
+{
+	memset( pxRequest, 0, sizeof( *pxRequest ) );
+	pxRequest->pucBuffer = pucBuffer;
+	pxRequest->ulLength = ulLength;
+	pxRequest->xCompletions = xCompletions;
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvAIOBenchPrintStats( const char *pcName, xAIODevice *pxDevice )
+{
+xAIOStats xStats;
+
+	vAIOGetStats( pxDevice, &xStats );
+	printf( "  %s: submitted %lu, completed %lu, errors %lu, cancelled %lu, lost %lu\r\n",
+			pcName, xStats.ulSubmitted, xStats.ulCompleted, xStats.ulErrors, xStats.ulCancelled, xStats.ulCompletionsLost );
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvAIOBenchTask( void *pvParameters )
+{
+xQueueHandle xCompletions;
+xAIODevice *pxTx, *pxRx, *pxTimer, *pxRTC;
+xAIORequest *pxRequest, *pxBatch[ mainAIO_BENCH_DEPTH ];
+unsigned long ulNextWrite = 0UL, ulNextRead = 0UL, ulChecked = 0UL, ulMismatches = 0UL;
+unsigned long ulIntervals = 0UL, ulAlarms = 0UL, ulIdleBusy, ul;
+portTickType xStart, xElapsed;
+
+	( void ) pvParameters;
+
+	for( ul = 0UL; ul < mainAIO_BENCH_BYTES; ul++ )
+	{
+		ucAIOBenchTx[ ul ] = ( unsigned char ) ul;
+	}
+
+	/* Room for every request that can be outstanding at once. */
+	xCompletions = xQueueCreate( 2 * mainAIO_BENCH_DEPTH + 3, sizeof( xAIORequest * ) );
+
+	vUARTInitialise( mainAIO_BENCH_PORT, mainAIO_BENCH_BAUDRATE, mainAIO_BENCH_RING_SIZE );
+	vUARTSetLoopback( mainAIO_BENCH_PORT, pdTRUE );
+	pxTx = pxUARTGetAIOTransmitter( mainAIO_BENCH_PORT );
+	pxRx = pxUARTGetAIOReceiver( mainAIO_BENCH_PORT );
+	pxTimer = pxTimer2Initialise();
+	pxRTC = pxRTCAlarmInitialise();
+
+	if( ( NULL == xCompletions ) || ( NULL == pxTx ) || ( NULL == pxRx ) )
+	{
+		printf( "AIO benchmark: needs the interrupt driven UART driver\r\n" );
+		vTaskDelete( NULL );
+	}
+
+	prvBenchCalibrate();
+
+	xStart = xTaskGetTickCount();
+	ulIdleCount = 0UL;
+
+	/* The reads go first, so that no byte coming back reaches the ring. */
+	for( ul = 0UL; ul < mainAIO_BENCH_DEPTH; ul++ )
+	{
+		prvAIOBenchPrepare( &xAIOBenchReads[ ul ], ucAIOBenchRx[ ul ], mainAIO_BENCH_CHUNK, xCompletions );
+		pxBatch[ ul ] = &xAIOBenchReads[ ul ];
+		ulNextRead += mainAIO_BENCH_CHUNK;
+	}
+	( void ) xAIOSubmitBatch( pxRx, pxBatch, mainAIO_BENCH_DEPTH );
+
+	for( ul = 0UL; ul < mainAIO_BENCH_DEPTH; ul++ )
+	{
+		prvAIOBenchPrepare( &xAIOBenchWrites[ ul ], &ucAIOBenchTx[ ulNextWrite ], mainAIO_BENCH_CHUNK, xCompletions );
+		pxBatch[ ul ] = &xAIOBenchWrites[ ul ];
+		ulNextWrite += mainAIO_BENCH_CHUNK;
+	}
+	( void ) xAIOSubmitBatch( pxTx, pxBatch, mainAIO_BENCH_DEPTH );
+
+	/* Two interval requests, so that the timer never waits for the task. */
+	for( ul = 0UL; ul < 2UL; ul++ )
+	{
+		prvAIOBenchPrepare( &xAIOBenchIntervals[ ul ], NULL, mainAIO_BENCH_INTERVAL, xCompletions );
+		( void ) xAIOSubmit( pxTimer, &xAIOBenchIntervals[ ul ] );
+	}
+
+	prvAIOBenchPrepare( &xAIOBenchAlarm, NULL, mainAIO_BENCH_ALARM, xCompletions );
+	( void ) xAIOSubmit( pxRTC, &xAIOBenchAlarm );
+
+	while( ulChecked < mainAIO_BENCH_BYTES )
+	{
+		pxRequest = pxAIOWait( xCompletions, mainAIO_BENCH_STALL );
+		if( NULL == pxRequest )
+		{
+			printf( "AIO benchmark: stalled after %lu of %lu bytes\r\n", ulChecked, mainAIO_BENCH_BYTES );
+			break;
+		}
+
+		if( ( pxRequest >= &xAIOBenchReads[ 0 ] ) && ( pxRequest < &xAIOBenchReads[ mainAIO_BENCH_DEPTH ] ) )
+		{
+			/* Reads complete in the order they were submitted, so each
+			carries on from the one before. */
+			for( ul = 0UL; ul < pxRequest->ulDone; ul++ )
+			{
+				if( pxRequest->pucBuffer[ ul ] != ( unsigned char ) ( ulChecked + ul ) )
+				{
+					ulMismatches++;
+				}
+			}
+			ulChecked += pxRequest->ulDone;
+
+			if( ulNextRead < mainAIO_BENCH_BYTES )
+			{
+				( void ) xAIOSubmit( pxRx, pxRequest );
+				ulNextRead += mainAIO_BENCH_CHUNK;
+			}
+		}
+		else if( ( pxRequest >= &xAIOBenchWrites[ 0 ] ) && ( pxRequest < &xAIOBenchWrites[ mainAIO_BENCH_DEPTH ] ) )
+		{
+			if( ulNextWrite < mainAIO_BENCH_BYTES )
+			{
+				pxRequest->pucBuffer = &ucAIOBenchTx[ ulNextWrite ];
+				( void ) xAIOSubmit( pxTx, pxRequest );
+				ulNextWrite += mainAIO_BENCH_CHUNK;
+			}
+		}
+		else if( &xAIOBenchAlarm == pxRequest )
+		{
+			ulAlarms++;
+			( void ) xAIOSubmit( pxRTC, pxRequest );
+		}
+		else
+		{
+			ulIntervals++;
+			( void ) xAIOSubmit( pxTimer, pxRequest );
+		}
+	}
+
+	ulIdleBusy = ulIdleCount;
+	xElapsed = xTaskGetTickCount() - xStart;
+	if( 0 == xElapsed )
+	{
+		xElapsed = 1;
+	}
+
+	/* Take back whatever is still queued; each posts its cancellation. */
+	for( ul = 0UL; ul < mainAIO_BENCH_DEPTH; ul++ )
+	{
+		( void ) xAIOCancel( pxTx, &xAIOBenchWrites[ ul ] );
+		( void ) xAIOCancel( pxRx, &xAIOBenchReads[ ul ] );
+	}
+	( void ) xAIOCancel( pxTimer, &xAIOBenchIntervals[ 0 ] );
+	( void ) xAIOCancel( pxTimer, &xAIOBenchIntervals[ 1 ] );
+	( void ) xAIOCancel( pxRTC, &xAIOBenchAlarm );
+
+	while( NULL != pxAIOWait( xCompletions, 0 ) )
+	{
+		/* Nothing more to count. */
+	}
+
+	vUARTSetLoopback( mainAIO_BENCH_PORT, pdFALSE );
+
+	printf( "AIO loopback: %lu bytes in %lu ms, %lu bytes/s, CPU %lu%%, mismatches %lu\r\n",
+			ulChecked, ( unsigned long ) ( xElapsed * portTICK_RATE_MS ), ( ulChecked * 1000UL ) / ( xElapsed * portTICK_RATE_MS ),
+			prvBenchCPUPercent( ulIdleBusy, xElapsed ), ulMismatches );
+	printf( "  alongside: %lu timer intervals of %lu us, %lu RTC alarms of %lu s\r\n",
+			ulIntervals, mainAIO_BENCH_INTERVAL, ulAlarms, mainAIO_BENCH_ALARM );
+	prvAIOBenchPrintStats( "uart tx", pxTx );
+	prvAIOBenchPrintStats( "uart rx", pxRx );
+	prvAIOBenchPrintStats( "timer", pxTimer );
+	prvAIOBenchPrintStats( "rtc", pxRTC );
+
+	vTaskDelete( NULL );
+}
+/*----------------------------------------------------------------------------*/
+
+#endif /* mainAIO_BENCHMARK */
+
+/* Parameters for two tasks */
+paramStruct tParam[2] =
+{
+    { .text="Task1\r\n", .delay=1000 },
+    { .text="Periodic task\r\n", .delay=3000 }
+};
+
+/*
+ * Hand all of the RAM that is not used by the program to the heap:
+ * the cached RAM from the end of bss to the DMA area, then the
+ * uncached DMA area at the top of RAM.  Must be called before anything
+ * is allocated.  The other heaps are a static array of configTOTAL_HEAP_SIZE
+ * bytes, so need nothing.
+ */
+static void prvSetupHeap( void )
+{
+#if ( configHEAP_IMPLEMENTATION == 5 )
+    /* The sizes are only known at link time, so the table is filled in here. */
+    static xHeapRegion xHeapRegions[ 3 ];
+
+    xHeapRegions[ 0 ].pucStartAddress = __heap_start;
+    xHeapRegions[ 0 ].xSizeInBytes = ( size_t ) ( __heap_end - __heap_start );
+    xHeapRegions[ 0 ].ulAttributes = portHEAP_ATTR_CACHEABLE | portHEAP_ATTR_FAST;
+
+    xHeapRegions[ 1 ].pucStartAddress = __dma_heap_start;
+    xHeapRegions[ 1 ].xSizeInBytes = ( size_t ) ( __dma_heap_end - __dma_heap_start );
+    xHeapRegions[ 1 ].ulAttributes = portHEAP_ATTR_DMA;
+
+    /* Terminates the table. */
+    xHeapRegions[ 2 ].pucStartAddress = NULL;
+    xHeapRegions[ 2 ].xSizeInBytes = 0;
+    xHeapRegions[ 2 ].ulAttributes = 0;
+
+    vPortDefineHeapRegions( xHeapRegions );
+#endif
+}
+
+/* Startup function that creates and runs two FreeRTOS tasks */
+void main(void)
+{
+
+    unsigned long ulVector = 0UL;
+    unsigned long ulValue = 0UL;
+    char cAddress[32];
+
+    portDISABLE_INTERRUPTS();
+
+    prvSetupHeap();
+    
+    /* Install the Spurious Interrupt Handler to help catch interrupts. */
+    for ( ulVector = 0; ulVector < portMAX_VECTORS; ulVector++ )
+    	vPortInstallInterruptHandler( vPortUnknownInterruptHandler, (void *)ulVector, ulVector, pdTRUE, configMAX_SYSCALL_INTERRUPT_PRIORITY, 1 );
+    
+    /* Init of print related tasks: */
+    vUARTInitialise( mainPRINT_PORT, mainPRINT_BAUDRATE, 256);
+    vLogInitialise( tskIDLE_PRIORITY + 1 );
+    vConsoleInitialise( mainPRINT_PORT );
+
+    if ( pdFAIL == xNetInitialise( mainNET_ADDRESS, mainNET_NETMASK, mainNET_GATEWAY, PRIOR_NETWORK ) )
+    {
+        vSerialPutString((xComPortHandle)configUART_PORT, (const signed char * const)("No network\r\n"), strlen("No network\r\n"));
+    }
+
+    if ( ( pdFAIL == xMMCIInitialise( PRIOR_BLOCK_IO ) ) || ( pdFAIL == xBlockCacheInitialise() ) )
+    {
+        vSerialPutString((xComPortHandle)configUART_PORT, (const signed char * const)("No SD card driver\r\n"), strlen("No SD card driver\r\n"));
+    }
+
+    portENABLE_INTERRUPTS();
+
+    /*
+     * I M P O R T A N T :
+     * Make sure (in startup.s) that main is entered in Supervisor mode.
+     * When vTaskStartScheduler launches the first task, it will switch
+     * to System mode and enable interrupt exceptions.
+     */
+    vSerialPutString((xComPortHandle)configUART_PORT, (const signed char * const)("= = = T E S T   S T A R T E D = = =\r\n\r\n"), strlen("= = = T E S T   S T A R T E D = = =\r\n\r\n"));
+
+    /* And finally create two tasks: */
+    if ( pdPASS != xTaskCreate(vTaskFunction, "task1", 128, (void*) &tParam[0],
+                               PRIOR_PERIODIC, NULL) )
+    {
+        vSerialPutString((xComPortHandle)configUART_PORT, (const signed char * const)("Could not create task1\r\n"), strlen("Could not create task1\r\n"));
+	while(1);
+    }
+
+    if ( pdPASS != xTaskCreate(vPeriodicTaskFunction, "task2", 128, (void*) &tParam[1],
+                               PRIOR_FIX_FREQ_PERIODIC, NULL) )
+    {
+        vSerialPutString((xComPortHandle)configUART_PORT, (const signed char * const)("Could not create task2\r\n"), strlen("Could not create task2\r\n"));
+	while(1);
+    }
+
+    if ( pdPASS != xTaskCreate(prvConsoleTask, "console", 128, NULL,
+                               PRIOR_RECEIVER, NULL) )
+    {
+        vSerialPutString((xComPortHandle)configUART_PORT, (const signed char * const)("Could not create the console task\r\n"), strlen("Could not create the console task\r\n"));
+	while(1);
+    }
+
+#if ( mainTIMER_BENCHMARK == 1 )
+    xTaskCreate(prvTimerBenchTask, "timerbench", configMINIMAL_STACK_SIZE * 2, NULL, mainTIMER_BENCH_PRIORITY, NULL);
+#endif
+
+#if ( mainHEAP_SOAK_TEST == 1 )
+    xTaskCreate(prvHeapSoakTask, "heapsoak", configMINIMAL_STACK_SIZE * 2, NULL, mainHEAP_SOAK_PRIORITY, NULL);
+#endif
+
+#if ( mainHEAP_BENCHMARK == 1 )
+    xTaskCreate(prvHeapBenchTask, "heapbench", configMINIMAL_STACK_SIZE * 2, NULL, mainHEAP_BENCH_PRIORITY, NULL);
+#endif
+
+#if ( mainSLAB_BENCHMARK == 1 )
+    xTaskCreate(prvSlabBenchTask, "slabbench", configMINIMAL_STACK_SIZE * 2, NULL, mainSLAB_BENCH_PRIORITY, NULL);
+#endif
+
+#if ( mainLIBC_BENCHMARK == 1 )
+    xTaskCreate(prvLibcBenchTask, "libcbench", configMINIMAL_STACK_SIZE, NULL, mainLIBC_BENCH_PRIORITY, NULL);
+#endif
+
+#if ( mainLIST_BENCHMARK == 1 )
+    xTaskCreate(prvListBenchTask, "listbench", configMINIMAL_STACK_SIZE, NULL, mainLIST_BENCH_PRIORITY, NULL);
+#endif
+
+#if ( mainUART_BENCHMARK == 1 )
+    xTaskCreate(prvUARTBenchTask, "bench", configMINIMAL_STACK_SIZE, NULL, mainBENCH_PRIORITY, NULL);
+#endif
+
+#if ( mainNET_BENCHMARK == 1 )
+    xTaskCreate(prvNetBenchTask, "netbench", configMINIMAL_STACK_SIZE * 2, NULL, mainNET_BENCH_PRIORITY, NULL);
+#endif
+
+#if ( mainSD_BENCHMARK == 1 )
+    xTaskCreate(prvSDBenchTask, "sdbench", configMINIMAL_STACK_SIZE * 2, NULL, mainSD_BENCH_PRIORITY, NULL);
+#endif
+
+#if ( mainFAT_BENCHMARK == 1 )
+    xTaskCreate(prvFATBenchTask, "fatbench", configMINIMAL_STACK_SIZE * 2, NULL, mainFAT_BENCH_PRIORITY, NULL);
+#endif
+
+#if ( mainAIO_BENCHMARK == 1 )
+    xTaskCreate(prvAIOBenchTask, "aiobench", configMINIMAL_STACK_SIZE * 2, NULL, mainAIO_BENCH_PRIORITY, NULL);
+#endif
+
+    vSerialPutString((xComPortHandle)configUART_PORT, (const signed char * const)("A text may be entered using a keyboard.\r\n"), strlen("A text may be entered using a keyboard.\r\n"));
+    vSerialPutString((xComPortHandle)configUART_PORT, (const signed char * const)("It will be displayed when 'Enter' is pressed.\r\n\r\n"), strlen("It will be displayed when 'Enter' is pressed.\r\n\r\n"));
+
+    /* Start the FreeRTOS scheduler */
+    vTaskStartScheduler();
+
+    /*
+     * If all goes well, vTaskStartScheduler should never return.
+     * If it does return, typically not enough heap memory is reserved.
+     */
+
+    vSerialPutString((xComPortHandle)configUART_PORT, (const signed char * const)("Could not start the scheduler!!!\r\n"), strlen("Could not start the scheduler!!!\r\n"));
+    while(1);
+
+    /* just in case if an infinite loop is somehow omitted in FreeRTOS_Error */
+    for ( ; ; );
+}
+
+void vApplicationMallocFailedHook( void )
+{
+	__asm volatile (" smc #0 ");
+}
+/*----------------------------------------------------------------------------*/
+
+extern void vAssertCalled( char *file, int line )
+{
+	printf("Assertion failed at %s, line %d\n\r",file,line);
+	taskDISABLE_INTERRUPTS();
+	for( ;; );
+}
+
+void vApplicationTickHook( void )
+{
+	static int ticks = 0;
+	ticks++;
+
+	/* Runs in the tick interrupt, so must not wait for the UART. */
+	if (ticks % 1000 == 0)
+		logINFO("Time : %d sec", ticks / 1000);
+}
+/*----------------------------------------------------------------------------*/
+
+void vApplicationIdleHook( void )
+{
+	/* Console input arrives by interrupt, so there is nothing to poll: sleep
+	until the next interrupt.  The benchmarks instead count idle iterations to
+	measure the CPU left over. */
+#if mainMEASURE_IDLE
+	ulIdleCount++;
+#else
+	__asm volatile ( "wfi" );
+#endif
 }
 /*----------------------------------------------------------------------------*/
 
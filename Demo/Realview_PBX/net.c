@@ -0,0 +1,992 @@
+/*
+    FreeRTOS V7.0.1 - Copyright (C) 2011 Real Time Engineers Ltd.
+
+
+	FreeRTOS supports many tools and architectures. V7.0.0 is sponsored by:
+	Atollic AB - Atollic provides professional embedded systems development
+	tools for C/C++ development, code analysis and test automation.
+	See http://www.atollic.com
+
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS tutorial books are available in pdf and paperback.        *
+     *    Complete, revised, and edited pdf reference manuals are also       *
+     *    available.                                                         *
+     *                                                                       *
+     *    Purchasing FreeRTOS documentation will not only help you, by       *
+     *    ensuring you get running as quickly as possible and with an        *
+     *    in-depth knowledge of how to use FreeRTOS, it will also help       *
+     *    the FreeRTOS project to continue with its mission of providing     *
+     *    professional grade, cross platform, de facto standard solutions    *
+     *    for microcontrollers - completely free of charge!                  *
+     *                                                                       *
+     *    >>> See http://www.FreeRTOS.org/Documentation for details. <<<     *
+     *                                                                       *
+     *    Thank you for using FreeRTOS, and thank you for your support!      *
+     *                                                                       *
+    ***************************************************************************
+
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation AND MODIFIED BY the FreeRTOS exception.
+    >>>NOTE<<< The modification to the GPL is included to allow you to
+    distribute a combined work that includes FreeRTOS without being obliged to
+    provide the source code for proprietary components outside of the FreeRTOS
+    kernel.  FreeRTOS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details. You should have received a copy of the GNU General Public
+    License and the FreeRTOS license exception along with FreeRTOS; if not it
+    can be viewed here: http://www.freertos.org/a00114.html and also obtained
+    by writing to Richard Barry, contact details for whom are available on the
+    FreeRTOS WEB site.
+
+    1 tab == 4 spaces!
+
+    http://www.FreeRTOS.org - Documentation, latest information, license and
+    contact details.
+
+    http://www.SafeRTOS.com - A version that is certified for use in safety
+    critical systems.
+
+    http://www.OpenRTOS.com - Commercial support, development, porting,
+    licensing and training services.
+*/
+
+/* Minimal IPv4 stack: ARP, ICMP echo and UDP. */
+
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "mempool.h"
+
+#include "net.h"
+#include "lan9118.h"
+/*----------------------------------------------------------------------------*/
+
+/* Byte order.  The CPU is little endian. */
+#define netHTONS( x )				( ( unsigned short ) ( ( ( ( x ) & 0xFFU ) << 8 ) | ( ( ( x ) >> 8 ) & 0xFFU ) ) )
+#define netNTOHS( x )				netHTONS( x )
+
+#define netETHERTYPE_IP				( 0x0800U )
+#define netETHERTYPE_ARP			( 0x0806U )
+
+#define netARP_HARDWARE_ETHERNET	( 1U )
+#define netARP_REQUEST				( 1U )
+#define netARP_REPLY				( 2U )
+
+#define netIP_VERSION_4				( 0x40U )
+#define netIP_VERSION_IHL			( 0x45U )		/* IPv4 without options. */
+#define netIP_DONT_FRAGMENT			( 0x4000U )
+#define netIP_FRAGMENT_MASK			( 0x3FFFU )		/* More fragments and the offset. */
+#define netIP_TTL					( 64U )
+#define netIP_PROTOCOL_ICMP			( 1U )
+#define netIP_PROTOCOL_UDP			( 17U )
+
+#define netICMP_ECHO_REPLY			( 0U )
+#define netICMP_ECHO_REQUEST		( 8U )
+
+#define netMAC_ADDRESS_SIZE			( 6UL )
+#define netIP_ADDRESS_SIZE			( 4UL )
+
+#define netARP_TIMEOUT_TICKS		( ( portTickType ) ( netARP_TIMEOUT_MS / portTICK_RATE_MS ) )
+
+/* An address is asked for at most this often. */
+#define netARP_RETRY_TICKS			( ( portTickType ) ( 1000UL / portTICK_RATE_MS ) )
+
+/* How long a frame may wait for room in the transmit FIFO. */
+#define netTX_DELAY					( ( portTickType ) ( 100UL / portTICK_RATE_MS ) )
+
+#define netTASK_STACK_SIZE			( configMINIMAL_STACK_SIZE * 2 )
+
+/* Counters are bumped from the network task and from the tasks sending. */
+#define netCOUNT( xField )			( void ) __atomic_fetch_add( &( xNetStatistics.xField ), 1UL, __ATOMIC_RELAXED )
+/*----------------------------------------------------------------------------*/
+
+/* Headers as they lie in a buffer, where the Ethernet header is halfword
+aligned and the IP header word aligned.  The ARP addresses are therefore
+split into halfwords. */
+typedef struct ETHERNET_HEADER
+{
+	unsigned char ucDestination[ netMAC_ADDRESS_SIZE ];
+	unsigned char ucSource[ netMAC_ADDRESS_SIZE ];
+	unsigned short usType;
+} xEthernetHeader;
+
+typedef struct ARP_PACKET
+{
+	unsigned short usHardware;
+	unsigned short usProtocol;
+	unsigned char ucHardwareLength;
+	unsigned char ucProtocolLength;
+	unsigned short usOperation;
+	unsigned char ucSenderMAC[ netMAC_ADDRESS_SIZE ];
+	unsigned short usSenderIP[ 2 ];
+	unsigned char ucTargetMAC[ netMAC_ADDRESS_SIZE ];
+	unsigned short usTargetIP[ 2 ];
+} xARPPacket;
+
+typedef struct IP_HEADER
+{
+	unsigned char ucVersionHeaderLength;
+	unsigned char ucTypeOfService;
+	unsigned short usLength;
+	unsigned short usIdentification;
+	unsigned short usFragment;
+	unsigned char ucTimeToLive;
+	unsigned char ucProtocol;
+	unsigned short usChecksum;
+	unsigned long ulSource;
+	unsigned long ulDestination;
+} xIPHeader;
+
+typedef struct ICMP_HEADER
+{
+	unsigned char ucType;
+	unsigned char ucCode;
+	unsigned short usChecksum;
+	unsigned short usIdentifier;
+	unsigned short usSequence;
+} xICMPHeader;
+
+typedef struct UDP_HEADER
+{
+	unsigned short usSourcePort;
+	unsigned short usDestinationPort;
+	unsigned short usLength;
+	unsigned short usChecksum;
+} xUDPHeader;
+
+typedef struct ARP_ENTRY
+{
+	unsigned long ulAddress;			/* 0 for a free entry. */
+	unsigned char ucMAC[ netMAC_ADDRESS_SIZE ];
+	portBASE_TYPE xResolved;
+	portTickType xUpdated;				/* When the last reply came. */
+	portTickType xRequested;			/* When the last request went. */
+	xNetBuffer *pxPending;				/* A frame waiting for the address. */
+} xARPEntry;
+
+typedef struct UDP_SOCKET
+{
+	unsigned short usPort;				/* 0 for a free socket. */
+	xQueueHandle xQueue;				/* Of xNetBuffer pointers. */
+} xUDPSocket;
+
+/* The checksum reads words and halfwords of headers written through the
+structures above. */
+typedef unsigned long __attribute__ ( ( may_alias ) ) xNetAliasedWord;
+typedef unsigned short __attribute__ ( ( may_alias ) ) xNetAliasedHalfword;
+/*----------------------------------------------------------------------------*/
+
+static xMemoryPoolHandle xNetPool = NULL;
+
+/* Frames from the interrupt for the network task. */
+static xQueueHandle xNetRxQueue = NULL;
+
+static unsigned long ulNetAddress = 0UL;
+static unsigned long ulNetNetmask = 0UL;
+static unsigned long ulNetGateway = 0UL;
+static unsigned char ucNetMAC[ netMAC_ADDRESS_SIZE ];
+static unsigned long ulNetIdentification = 0UL;
+
+/* Changed in critical sections, as sending tasks look addresses up. */
+static xARPEntry xNetARPTable[ netARP_ENTRIES ];
+
+/* Changed with the scheduler suspended, so the network task never queues to a
+socket being closed. */
+static xUDPSocket xNetSockets[ netMAX_SOCKETS ];
+
+static xNetStats xNetStatistics;
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Takes received frames from the interrupt and passes them up the stack.
+ */
+static void prvNetTask( void *pvParameters );
+
+static void prvNetProcessFrame( xNetBuffer *pxBuffer );
+static void prvNetProcessARP( xNetBuffer *pxBuffer );
+static void prvNetProcessIP( xNetBuffer *pxBuffer );
+static void prvNetProcessICMP( xNetBuffer *pxBuffer, xIPHeader *pxIP, unsigned long ulHeaderLength, unsigned long ulTotalLength );
+static void prvNetProcessUDP( xNetBuffer *pxBuffer, xIPHeader *pxIP, unsigned long ulHeaderLength, unsigned long ulTotalLength );
+
+/*
+ * Free a frame the stack has no use for.
+ */
+static void prvNetDrop( xNetBuffer *pxBuffer );
+
+/*
+ * Record the MAC address of ulAddress, and send the frame that was waiting for
+ * it.
+ */
+static void prvNetARPUpdate( unsigned long ulAddress, const unsigned char *pucMAC );
+
+/*
+ * Broadcast a request for the MAC address of ulAddress.
+ */
+static void prvNetARPRequest( unsigned long ulAddress );
+
+/*
+ * The entry for ulAddress, or NULL.  Called in a critical section.
+ */
+static xARPEntry *prvNetARPFind( unsigned long ulAddress );
+
+/*
+ * A free entry for ulAddress, evicting the oldest if need be.  The evicted
+ * entry's waiting frame is returned in *ppxPending.  Called in a critical
+ * section.
+ */
+static xARPEntry *prvNetARPAllocate( unsigned long ulAddress, xNetBuffer **ppxPending );
+
+/*
+ * Fill in the IP header in front of ulPayloadLength bytes at the transport
+ * header, and send the frame on.
+ */
+static portBASE_TYPE prvNetIPOutput( xNetBuffer *pxBuffer, unsigned long ulDestination, unsigned char ucProtocol, unsigned long ulPayloadLength );
+
+/*
+ * Address the Ethernet frame at pucData to ulNextHop and send it, or hold it
+ * until ARP finds the address.
+ */
+static portBASE_TYPE prvNetEthernetOutput( xNetBuffer *pxBuffer, unsigned long ulNextHop );
+
+static portBASE_TYPE prvNetTransmit( xNetBuffer *pxBuffer );
+
+/*
+ * The one's complement sum of ulLength bytes at the halfword aligned pvData,
+ * added to ulSum and not yet folded.  As RFC 1071 allows, the sum is taken
+ * over the halfwords as the CPU reads them.
+ */
+static unsigned long prvNetChecksumAdd( unsigned long ulSum, const void *pvData, unsigned long ulLength );
+
+/*
+ * Fold a sum to 16 bits and complement it.
+ */
+static unsigned short prvNetChecksumFold( unsigned long ulSum );
+
+/*
+ * The sum of the UDP pseudo header.
+ */
+static unsigned long prvNetPseudoHeader( unsigned long ulSource, unsigned long ulDestination, unsigned long ulLength );
+
+static portBASE_TYPE prvNetIsBroadcast( unsigned long ulAddress );
+/*----------------------------------------------------------------------------*/
+
+portBASE_TYPE xNetInitialise( unsigned long ulAddress, unsigned long ulNetmask, unsigned long ulGateway, unsigned portBASE_TYPE uxPriority )
+{
+	ulNetAddress = ulAddress;
+	ulNetNetmask = ulNetmask;
+	ulNetGateway = ulGateway;
+
+	xNetPool = xMemoryPoolCreate( sizeof( xNetBuffer ), netBUFFER_COUNT );
+	xNetRxQueue = xQueueCreate( netRX_QUEUE_LENGTH, sizeof( xNetBuffer * ) );
+
+	if( ( NULL == xNetPool ) || ( NULL == xNetRxQueue ) || ( pdFAIL == xLAN9118Initialise() ) )
+	{
+		return pdFAIL;
+	}
+
+	vLAN9118GetMACAddress( ucNetMAC );
+
+	return xTaskCreate( prvNetTask, ( signed char * ) "net", netTASK_STACK_SIZE, NULL, uxPriority, NULL );
+}
+/*----------------------------------------------------------------------------*/
+
+xNetBuffer *pxNetBufferAlloc( portTickType xDelay )
+{
+xNetBuffer *pxBuffer = ( xNetBuffer * ) pvMemoryPoolAlloc( xNetPool, xDelay );
+
+	if( NULL != pxBuffer )
+	{
+		pxBuffer->pucData = &( pxBuffer->ucFrame[ netUDP_PAYLOAD_OFFSET ] );
+		pxBuffer->ulLength = 0UL;
+	}
+
+	return pxBuffer;
+}
+/*----------------------------------------------------------------------------*/
+
+xNetBuffer *pxNetBufferAllocFromISR( void )
+{
+xNetBuffer *pxBuffer = ( xNetBuffer * ) pvMemoryPoolAllocFromISR( xNetPool );
+
+	if( NULL != pxBuffer )
+	{
+		pxBuffer->pucData = &( pxBuffer->ucFrame[ netFRAME_OFFSET ] );
+		pxBuffer->ulLength = 0UL;
+	}
+
+	return pxBuffer;
+}
+/*----------------------------------------------------------------------------*/
+
+void vNetBufferFree( xNetBuffer *pxBuffer )
+{
+	vMemoryPoolFree( xNetPool, pxBuffer );
+}
+/*----------------------------------------------------------------------------*/
+
+void vNetBufferFreeFromISR( xNetBuffer *pxBuffer, portBASE_TYPE *pxHigherPriorityTaskWoken )
+{
+	vMemoryPoolFreeFromISR( xNetPool, pxBuffer, pxHigherPriorityTaskWoken );
+}
+/*----------------------------------------------------------------------------*/
+
+void vNetReceiveFromISR( xNetBuffer *pxBuffer, portBASE_TYPE *pxHigherPriorityTaskWoken )
+{
+	/* The queue holds every buffer in the pool, so it cannot be full. */
+	if( pdTRUE != xQueueSendFromISR( xNetRxQueue, &pxBuffer, pxHigherPriorityTaskWoken ) )
+	{
+		vNetBufferFreeFromISR( pxBuffer, pxHigherPriorityTaskWoken );
+	}
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvNetTask( void *pvParameters )
+{
+xNetBuffer *pxBuffer;
+
+	( void ) pvParameters;
+
+	for( ;; )
+	{
+		if( pdTRUE == xQueueReceive( xNetRxQueue, &pxBuffer, portMAX_DELAY ) )
+		{
+			prvNetProcessFrame( pxBuffer );
+		}
+	}
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvNetDrop( xNetBuffer *pxBuffer )
+{
+	netCOUNT( ulDropped );
+	vNetBufferFree( pxBuffer );
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvNetProcessFrame( xNetBuffer *pxBuffer )
+{
+const xEthernetHeader *pxEthernet = ( const xEthernetHeader * ) pxBuffer->pucData;
+
+	netCOUNT( ulRxFrames );
+
+	if( netHTONS( netETHERTYPE_IP ) == pxEthernet->usType )
+	{
+		prvNetProcessIP( pxBuffer );
+	}
+	else if( netHTONS( netETHERTYPE_ARP ) == pxEthernet->usType )
+	{
+		prvNetProcessARP( pxBuffer );
+	}
+	else
+	{
+		prvNetDrop( pxBuffer );
+	}
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvNetProcessARP( xNetBuffer *pxBuffer )
+{
+xEthernetHeader *pxEthernet = ( xEthernetHeader * ) pxBuffer->pucData;
+xARPPacket *pxARP = ( xARPPacket * ) ( pxBuffer->pucData + netETHERNET_HEADER_SIZE );
+unsigned long ulSender, ulTarget;
+
+	if( ( pxBuffer->ulLength < netETHERNET_HEADER_SIZE + sizeof( xARPPacket ) ) ||
+		( netHTONS( netARP_HARDWARE_ETHERNET ) != pxARP->usHardware ) || ( netHTONS( netETHERTYPE_IP ) != pxARP->usProtocol ) ||
+		( netMAC_ADDRESS_SIZE != pxARP->ucHardwareLength ) || ( netIP_ADDRESS_SIZE != pxARP->ucProtocolLength ) )
+	{
+		prvNetDrop( pxBuffer );
+		return;
+	}
+
+	ulSender = ( unsigned long ) pxARP->usSenderIP[ 0 ] | ( ( unsigned long ) pxARP->usSenderIP[ 1 ] << 16 );
+	ulTarget = ( unsigned long ) pxARP->usTargetIP[ 0 ] | ( ( unsigned long ) pxARP->usTargetIP[ 1 ] << 16 );
+
+	if( ulTarget != ulNetAddress )
+	{
+		prvNetDrop( pxBuffer );
+		return;
+	}
+
+	/* Whoever asks for us is likely to be talked to. */
+	prvNetARPUpdate( ulSender, pxARP->ucSenderMAC );
+
+	if( netHTONS( netARP_REQUEST ) != pxARP->usOperation )
+	{
+		vNetBufferFree( pxBuffer );
+		return;
+	}
+
+	/* Answer in the same buffer. */
+	pxARP->usOperation = netHTONS( netARP_REPLY );
+	memcpy( pxARP->ucTargetMAC, pxARP->ucSenderMAC, netMAC_ADDRESS_SIZE );
+	pxARP->usTargetIP[ 0 ] = pxARP->usSenderIP[ 0 ];
+	pxARP->usTargetIP[ 1 ] = pxARP->usSenderIP[ 1 ];
+	memcpy( pxARP->ucSenderMAC, ucNetMAC, netMAC_ADDRESS_SIZE );
+	pxARP->usSenderIP[ 0 ] = ( unsigned short ) ulNetAddress;
+	pxARP->usSenderIP[ 1 ] = ( unsigned short ) ( ulNetAddress >> 16 );
+
+	memcpy( pxEthernet->ucDestination, pxARP->ucTargetMAC, netMAC_ADDRESS_SIZE );
+	memcpy( pxEthernet->ucSource, ucNetMAC, netMAC_ADDRESS_SIZE );
+	pxBuffer->ulLength = netETHERNET_HEADER_SIZE + sizeof( xARPPacket );
+
+	( void ) prvNetTransmit( pxBuffer );
+}
+/*----------------------------------------------------------------------------*/
+
+static xARPEntry *prvNetARPFind( unsigned long ulAddress )
+{
+unsigned portBASE_TYPE uxEntry;
+
+	for( uxEntry = 0U; uxEntry < netARP_ENTRIES; uxEntry++ )
+	{
+		if( xNetARPTable[ uxEntry ].ulAddress == ulAddress )
+		{
+			return &( xNetARPTable[ uxEntry ] );
+		}
+	}
+
+	return NULL;
+}
+/*----------------------------------------------------------------------------*/
+
+static xARPEntry *prvNetARPAllocate( unsigned long ulAddress, xNetBuffer **ppxPending )
+{
+xARPEntry *pxEntry = &( xNetARPTable[ 0 ] );
+portTickType xNow = xTaskGetTickCount();
+unsigned portBASE_TYPE uxEntry;
+
+	for( uxEntry = 0U; uxEntry < netARP_ENTRIES; uxEntry++ )
+	{
+		if( 0UL == xNetARPTable[ uxEntry ].ulAddress )
+		{
+			pxEntry = &( xNetARPTable[ uxEntry ] );
+			break;
+		}
+
+		if( ( xNow - xNetARPTable[ uxEntry ].xUpdated ) > ( xNow - pxEntry->xUpdated ) )
+		{
+			pxEntry = &( xNetARPTable[ uxEntry ] );
+		}
+	}
+
+	*ppxPending = pxEntry->pxPending;
+	pxEntry->ulAddress = ulAddress;
+	pxEntry->xResolved = pdFALSE;
+	pxEntry->xUpdated = xNow;
+	pxEntry->xRequested = xNow - netARP_RETRY_TICKS;
+	pxEntry->pxPending = NULL;
+
+	return pxEntry;
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvNetARPUpdate( unsigned long ulAddress, const unsigned char *pucMAC )
+{
+xARPEntry *pxEntry;
+xNetBuffer *pxPending = NULL, *pxEvicted = NULL;
+
+	taskENTER_CRITICAL();
+	{
+		pxEntry = prvNetARPFind( ulAddress );
+		if( NULL == pxEntry )
+		{
+			pxEntry = prvNetARPAllocate( ulAddress, &pxEvicted );
+		}
+
+		memcpy( pxEntry->ucMAC, pucMAC, netMAC_ADDRESS_SIZE );
+		pxEntry->xResolved = pdTRUE;
+		pxEntry->xUpdated = xTaskGetTickCount();
+		pxPending = pxEntry->pxPending;
+		pxEntry->pxPending = NULL;
+	}
+	taskEXIT_CRITICAL();
+
+	if( NULL != pxEvicted )
+	{
+		netCOUNT( ulARPUnresolved );
+		vNetBufferFree( pxEvicted );
+	}
+
+	if( NULL != pxPending )
+	{
+		memcpy( ( ( xEthernetHeader * ) pxPending->pucData )->ucDestination, pucMAC, netMAC_ADDRESS_SIZE );
+		( void ) prvNetTransmit( pxPending );
+	}
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvNetARPRequest( unsigned long ulAddress )
+{
+xNetBuffer *pxBuffer = pxNetBufferAlloc( 0 );
+xEthernetHeader *pxEthernet;
+xARPPacket *pxARP;
+
+	if( NULL == pxBuffer )
+	{
+		/* Asked again by the next frame to the address. */
+		return;
+	}
+
+	pxBuffer->pucData = &( pxBuffer->ucFrame[ netFRAME_OFFSET ] );
+	pxEthernet = ( xEthernetHeader * ) pxBuffer->pucData;
+	pxARP = ( xARPPacket * ) ( pxBuffer->pucData + netETHERNET_HEADER_SIZE );
+
+	memset( pxEthernet->ucDestination, 0xFF, netMAC_ADDRESS_SIZE );
+	memcpy( pxEthernet->ucSource, ucNetMAC, netMAC_ADDRESS_SIZE );
+	pxEthernet->usType = netHTONS( netETHERTYPE_ARP );
+
+	pxARP->usHardware = netHTONS( netARP_HARDWARE_ETHERNET );
+	pxARP->usProtocol = netHTONS( netETHERTYPE_IP );
+	pxARP->ucHardwareLength = netMAC_ADDRESS_SIZE;
+	pxARP->ucProtocolLength = netIP_ADDRESS_SIZE;
+	pxARP->usOperation = netHTONS( netARP_REQUEST );
+	memcpy( pxARP->ucSenderMAC, ucNetMAC, netMAC_ADDRESS_SIZE );
+	pxARP->usSenderIP[ 0 ] = ( unsigned short ) ulNetAddress;
+	pxARP->usSenderIP[ 1 ] = ( unsigned short ) ( ulNetAddress >> 16 );
+	memset( pxARP->ucTargetMAC, 0, netMAC_ADDRESS_SIZE );
+	pxARP->usTargetIP[ 0 ] = ( unsigned short ) ulAddress;
+	pxARP->usTargetIP[ 1 ] = ( unsigned short ) ( ulAddress >> 16 );
+
+	pxBuffer->ulLength = netETHERNET_HEADER_SIZE + sizeof( xARPPacket );
+	( void ) prvNetTransmit( pxBuffer );
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvNetProcessIP( xNetBuffer *pxBuffer )
+{
+xIPHeader *pxIP = ( xIPHeader * ) ( pxBuffer->pucData + netETHERNET_HEADER_SIZE );
+unsigned long ulHeaderLength, ulTotalLength;
+
+	if( pxBuffer->ulLength < netETHERNET_HEADER_SIZE + netIP_HEADER_SIZE )
+	{
+		prvNetDrop( pxBuffer );
+		return;
+	}
+
+	ulHeaderLength = ( unsigned long ) ( pxIP->ucVersionHeaderLength & 0x0FU ) << 2;
+	ulTotalLength = netNTOHS( pxIP->usLength );
+
+	/* Frames may be padded, so the IP length is the one that counts.
+	Fragments are not reassembled. */
+	if( ( netIP_VERSION_4 != ( pxIP->ucVersionHeaderLength & 0xF0U ) ) || ( ulHeaderLength < netIP_HEADER_SIZE ) ||
+		( ulTotalLength < ulHeaderLength ) || ( ulTotalLength > pxBuffer->ulLength - netETHERNET_HEADER_SIZE ) ||
+		( 0U != ( netNTOHS( pxIP->usFragment ) & netIP_FRAGMENT_MASK ) ) ||
+		( 0U != prvNetChecksumFold( prvNetChecksumAdd( 0UL, pxIP, ulHeaderLength ) ) ) ||
+		( ( pxIP->ulDestination != ulNetAddress ) && ( pdFALSE == prvNetIsBroadcast( pxIP->ulDestination ) ) ) )
+	{
+		prvNetDrop( pxBuffer );
+		return;
+	}
+
+	switch( pxIP->ucProtocol )
+	{
+		case netIP_PROTOCOL_UDP :
+			prvNetProcessUDP( pxBuffer, pxIP, ulHeaderLength, ulTotalLength );
+			break;
+
+		case netIP_PROTOCOL_ICMP :
+			prvNetProcessICMP( pxBuffer, pxIP, ulHeaderLength, ulTotalLength );
+			break;
+
+		default :
+			prvNetDrop( pxBuffer );
+			break;
+	}
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvNetProcessICMP( xNetBuffer *pxBuffer, xIPHeader *pxIP, unsigned long ulHeaderLength, unsigned long ulTotalLength )
+{
+xEthernetHeader *pxEthernet = ( xEthernetHeader * ) pxBuffer->pucData;
+xICMPHeader *pxICMP = ( xICMPHeader * ) ( ( unsigned char * ) pxIP + ulHeaderLength );
+unsigned long ulLength = ulTotalLength - ulHeaderLength;
+
+	if( ( ulLength < sizeof( xICMPHeader ) ) || ( netICMP_ECHO_REQUEST != pxICMP->ucType ) || ( pxIP->ulDestination != ulNetAddress ) ||
+		( 0U != prvNetChecksumFold( prvNetChecksumAdd( 0UL, pxICMP, ulLength ) ) ) )
+	{
+		prvNetDrop( pxBuffer );
+		return;
+	}
+
+	/* Answer in the same buffer. */
+	pxICMP->ucType = netICMP_ECHO_REPLY;
+	pxICMP->usChecksum = 0U;
+	pxICMP->usChecksum = prvNetChecksumFold( prvNetChecksumAdd( 0UL, pxICMP, ulLength ) );
+
+	pxIP->ulDestination = pxIP->ulSource;
+	pxIP->ulSource = ulNetAddress;
+	pxIP->ucTimeToLive = netIP_TTL;
+	pxIP->usChecksum = 0U;
+	pxIP->usChecksum = prvNetChecksumFold( prvNetChecksumAdd( 0UL, pxIP, ulHeaderLength ) );
+
+	memcpy( pxEthernet->ucDestination, pxEthernet->ucSource, netMAC_ADDRESS_SIZE );
+	memcpy( pxEthernet->ucSource, ucNetMAC, netMAC_ADDRESS_SIZE );
+	pxBuffer->ulLength = netETHERNET_HEADER_SIZE + ulTotalLength;
+
+	netCOUNT( ulEchoReplies );
+	( void ) prvNetTransmit( pxBuffer );
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvNetProcessUDP( xNetBuffer *pxBuffer, xIPHeader *pxIP, unsigned long ulHeaderLength, unsigned long ulTotalLength )
+{
+xUDPHeader *pxUDP = ( xUDPHeader * ) ( ( unsigned char * ) pxIP + ulHeaderLength );
+unsigned long ulLength;
+unsigned short usPort;
+unsigned portBASE_TYPE uxSocket;
+portBASE_TYPE xFound = pdFALSE, xQueued = pdFALSE;
+
+	if( ulTotalLength - ulHeaderLength < netUDP_HEADER_SIZE )
+	{
+		prvNetDrop( pxBuffer );
+		return;
+	}
+
+	ulLength = netNTOHS( pxUDP->usLength );
+
+	/* A zero checksum was not computed by the sender. */
+	if( ( ulLength < netUDP_HEADER_SIZE ) || ( ulLength > ulTotalLength - ulHeaderLength ) ||
+		( ( 0U != pxUDP->usChecksum ) &&
+		  ( 0U != prvNetChecksumFold( prvNetChecksumAdd( prvNetPseudoHeader( pxIP->ulSource, pxIP->ulDestination, ulLength ), pxUDP, ulLength ) ) ) ) )
+	{
+		prvNetDrop( pxBuffer );
+		return;
+	}
+
+	usPort = netNTOHS( pxUDP->usDestinationPort );
+	pxBuffer->ulAddress = pxIP->ulSource;
+	pxBuffer->usPort = netNTOHS( pxUDP->usSourcePort );
+	pxBuffer->pucData = ( unsigned char * ) pxUDP + netUDP_HEADER_SIZE;
+	pxBuffer->ulLength = ulLength - netUDP_HEADER_SIZE;
+
+	vTaskSuspendAll();
+	{
+		for( uxSocket = 0U; uxSocket < netMAX_SOCKETS; uxSocket++ )
+		{
+			if( xNetSockets[ uxSocket ].usPort == usPort )
+			{
+				xFound = pdTRUE;
+				xQueued = ( pdTRUE == xQueueSend( xNetSockets[ uxSocket ].xQueue, &pxBuffer, 0 ) ) ? pdTRUE : pdFALSE;
+				break;
+			}
+		}
+	}
+	( void ) xTaskResumeAll();
+
+	if( pdFALSE == xFound )
+	{
+		netCOUNT( ulNoSocket );
+		vNetBufferFree( pxBuffer );
+	}
+	else if( pdFALSE == xQueued )
+	{
+		netCOUNT( ulSocketFull );
+		vNetBufferFree( pxBuffer );
+	}
+}
+/*----------------------------------------------------------------------------*/
+
+xNetSocketHandle xNetUDPOpen( unsigned short usPort, unsigned portBASE_TYPE uxQueueLength )
+{
+xQueueHandle xQueue;
+xUDPSocket *pxSocket = NULL;
+unsigned portBASE_TYPE uxSocket;
+
+	if( 0U == usPort )
+	{
+		return NULL;
+	}
+
+	xQueue = xQueueCreate( uxQueueLength, sizeof( xNetBuffer * ) );
+	if( NULL == xQueue )
+	{
+		return NULL;
+	}
+
+	vTaskSuspendAll();
+	{
+		for( uxSocket = 0U; uxSocket < netMAX_SOCKETS; uxSocket++ )
+		{
+			if( xNetSockets[ uxSocket ].usPort == usPort )
+			{
+				pxSocket = NULL;
+				break;
+			}
+
+			if( ( NULL == pxSocket ) && ( 0U == xNetSockets[ uxSocket ].usPort ) )
+			{
+				pxSocket = &( xNetSockets[ uxSocket ] );
+			}
+		}
+
+		if( NULL != pxSocket )
+		{
+			pxSocket->xQueue = xQueue;
+			pxSocket->usPort = usPort;
+		}
+	}
+	( void ) xTaskResumeAll();
+
+	if( NULL == pxSocket )
+	{
+		vQueueDelete( xQueue );
+	}
+
+	return ( xNetSocketHandle ) pxSocket;
+}
+/*----------------------------------------------------------------------------*/
+
+void vNetUDPClose( xNetSocketHandle xSocket )
+{
+xUDPSocket *pxSocket = ( xUDPSocket * ) xSocket;
+xNetBuffer *pxBuffer;
+
+	vTaskSuspendAll();
+	{
+		pxSocket->usPort = 0U;
+	}
+	( void ) xTaskResumeAll();
+
+	while( pdTRUE == xQueueReceive( pxSocket->xQueue, &pxBuffer, 0 ) )
+	{
+		vNetBufferFree( pxBuffer );
+	}
+
+	vQueueDelete( pxSocket->xQueue );
+	pxSocket->xQueue = NULL;
+}
+/*----------------------------------------------------------------------------*/
+
+xNetBuffer *pxNetUDPReceive( xNetSocketHandle xSocket, portTickType xDelay )
+{
+xNetBuffer *pxBuffer = NULL;
+
+	if( pdTRUE != xQueueReceive( ( ( xUDPSocket * ) xSocket )->xQueue, &pxBuffer, xDelay ) )
+	{
+		pxBuffer = NULL;
+	}
+
+	return pxBuffer;
+}
+/*----------------------------------------------------------------------------*/
+
+portBASE_TYPE xNetUDPSend( xNetSocketHandle xSocket, xNetBuffer *pxBuffer, unsigned long ulAddress, unsigned short usPort )
+{
+xUDPSocket *pxSocket = ( xUDPSocket * ) xSocket;
+xUDPHeader *pxUDP = ( xUDPHeader * ) &( pxBuffer->ucFrame[ netUDP_PAYLOAD_OFFSET - netUDP_HEADER_SIZE ] );
+unsigned long ulLength = pxBuffer->ulLength + netUDP_HEADER_SIZE;
+
+	if( ( pxBuffer->pucData != &( pxBuffer->ucFrame[ netUDP_PAYLOAD_OFFSET ] ) ) || ( pxBuffer->ulLength > netUDP_MAX_PAYLOAD ) )
+	{
+		prvNetDrop( pxBuffer );
+		return pdFAIL;
+	}
+
+	pxUDP->usSourcePort = netHTONS( pxSocket->usPort );
+	pxUDP->usDestinationPort = netHTONS( usPort );
+	pxUDP->usLength = netHTONS( ulLength );
+	pxUDP->usChecksum = 0U;
+
+	#if ( netUDP_CHECKSUM == 1 )
+	{
+		pxUDP->usChecksum = prvNetChecksumFold( prvNetChecksumAdd( prvNetPseudoHeader( ulNetAddress, ulAddress, ulLength ), pxUDP, ulLength ) );
+
+		/* A computed zero is sent as all ones, as zero means no checksum. */
+		if( 0U == pxUDP->usChecksum )
+		{
+			pxUDP->usChecksum = 0xFFFFU;
+		}
+	}
+	#endif
+
+	return prvNetIPOutput( pxBuffer, ulAddress, netIP_PROTOCOL_UDP, ulLength );
+}
+/*----------------------------------------------------------------------------*/
+
+static portBASE_TYPE prvNetIPOutput( xNetBuffer *pxBuffer, unsigned long ulDestination, unsigned char ucProtocol, unsigned long ulPayloadLength )
+{
+xIPHeader *pxIP = ( xIPHeader * ) &( pxBuffer->ucFrame[ netFRAME_OFFSET + netETHERNET_HEADER_SIZE ] );
+unsigned long ulNextHop = ulDestination;
+unsigned long ulIdentification = __atomic_fetch_add( &ulNetIdentification, 1UL, __ATOMIC_RELAXED );
+
+	pxIP->ucVersionHeaderLength = netIP_VERSION_IHL;
+	pxIP->ucTypeOfService = 0U;
+	pxIP->usLength = netHTONS( netIP_HEADER_SIZE + ulPayloadLength );
+	pxIP->usIdentification = netHTONS( ulIdentification );
+	pxIP->usFragment = netHTONS( netIP_DONT_FRAGMENT );
+	pxIP->ucTimeToLive = netIP_TTL;
+	pxIP->ucProtocol = ucProtocol;
+	pxIP->usChecksum = 0U;
+	pxIP->ulSource = ulNetAddress;
+	pxIP->ulDestination = ulDestination;
+	pxIP->usChecksum = prvNetChecksumFold( prvNetChecksumAdd( 0UL, pxIP, netIP_HEADER_SIZE ) );
+
+	pxBuffer->pucData = &( pxBuffer->ucFrame[ netFRAME_OFFSET ] );
+	pxBuffer->ulLength = netETHERNET_HEADER_SIZE + netIP_HEADER_SIZE + ulPayloadLength;
+
+	/* Beyond the local network everything goes through the gateway. */
+	if( ( pdFALSE == prvNetIsBroadcast( ulDestination ) ) && ( 0UL != ( ( ulDestination ^ ulNetAddress ) & ulNetNetmask ) ) )
+	{
+		ulNextHop = ulNetGateway;
+	}
+
+	return prvNetEthernetOutput( pxBuffer, ulNextHop );
+}
+/*----------------------------------------------------------------------------*/
+
+static portBASE_TYPE prvNetEthernetOutput( xNetBuffer *pxBuffer, unsigned long ulNextHop )
+{
+xEthernetHeader *pxEthernet = ( xEthernetHeader * ) pxBuffer->pucData;
+xARPEntry *pxEntry;
+xNetBuffer *pxReplaced = NULL, *pxEvicted = NULL;
+portTickType xNow = xTaskGetTickCount();
+portBASE_TYPE xResolved = pdFALSE, xRequest = pdFALSE;
+
+	memcpy( pxEthernet->ucSource, ucNetMAC, netMAC_ADDRESS_SIZE );
+	pxEthernet->usType = netHTONS( netETHERTYPE_IP );
+
+	if( pdFALSE != prvNetIsBroadcast( ulNextHop ) )
+	{
+		memset( pxEthernet->ucDestination, 0xFF, netMAC_ADDRESS_SIZE );
+		return prvNetTransmit( pxBuffer );
+	}
+
+	taskENTER_CRITICAL();
+	{
+		pxEntry = prvNetARPFind( ulNextHop );
+		if( NULL == pxEntry )
+		{
+			pxEntry = prvNetARPAllocate( ulNextHop, &pxEvicted );
+		}
+
+		if( pdFALSE != pxEntry->xResolved )
+		{
+			/* A stale address is still used while it is asked for again. */
+			memcpy( pxEthernet->ucDestination, pxEntry->ucMAC, netMAC_ADDRESS_SIZE );
+			xResolved = pdTRUE;
+		}
+		else
+		{
+			pxReplaced = pxEntry->pxPending;
+			pxEntry->pxPending = pxBuffer;
+		}
+
+		if( ( ( pdFALSE == pxEntry->xResolved ) || ( ( xNow - pxEntry->xUpdated ) >= netARP_TIMEOUT_TICKS ) ) &&
+			( ( xNow - pxEntry->xRequested ) >= netARP_RETRY_TICKS ) )
+		{
+			pxEntry->xRequested = xNow;
+			xRequest = pdTRUE;
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	if( NULL != pxEvicted )
+	{
+		netCOUNT( ulARPUnresolved );
+		vNetBufferFree( pxEvicted );
+	}
+
+	if( NULL != pxReplaced )
+	{
+		netCOUNT( ulARPUnresolved );
+		vNetBufferFree( pxReplaced );
+	}
+
+	if( pdFALSE != xRequest )
+	{
+		prvNetARPRequest( ulNextHop );
+	}
+
+	return ( pdFALSE != xResolved ) ? prvNetTransmit( pxBuffer ) : pdPASS;
+}
+/*----------------------------------------------------------------------------*/
+
+static portBASE_TYPE prvNetTransmit( xNetBuffer *pxBuffer )
+{
+	netCOUNT( ulTxFrames );
+	return xLAN9118Transmit( pxBuffer, netTX_DELAY );
+}
+/*----------------------------------------------------------------------------*/
+
+static unsigned long prvNetChecksumAdd( unsigned long ulSum, const void *pvData, unsigned long ulLength )
+{
+const unsigned char *pucData = ( const unsigned char * ) pvData;
+unsigned long long ullSum = ulSum;
+
+	if( ( 0UL != ( ( unsigned long ) pucData & 2UL ) ) && ( ulLength >= 2UL ) )
+	{
+		ullSum += *( const xNetAliasedHalfword * ) pucData;
+		pucData += 2;
+		ulLength -= 2UL;
+	}
+
+	/* A word at a time, carrying into the top half of the sum. */
+	while( ulLength >= 4UL )
+	{
+		ullSum += *( const xNetAliasedWord * ) pucData;
+		pucData += 4;
+		ulLength -= 4UL;
+	}
+
+	if( ulLength >= 2UL )
+	{
+		ullSum += *( const xNetAliasedHalfword * ) pucData;
+		pucData += 2;
+		ulLength -= 2UL;
+	}
+
+	/* An odd last byte is the high byte of a halfword padded with zero. */
+	if( ulLength > 0UL )
+	{
+		ullSum += *pucData;
+	}
+
+	ullSum = ( ullSum & 0xFFFFFFFFULL ) + ( ullSum >> 32 );
+	ullSum = ( ullSum & 0xFFFFFFFFULL ) + ( ullSum >> 32 );
+
+	return ( unsigned long ) ullSum;
+}
+/*----------------------------------------------------------------------------*/
+
+static unsigned short prvNetChecksumFold( unsigned long ulSum )
+{
+	ulSum = ( ulSum & 0xFFFFUL ) + ( ulSum >> 16 );
+	ulSum = ( ulSum & 0xFFFFUL ) + ( ulSum >> 16 );
+
+	return ( unsigned short ) ~ulSum;
+}
+/*----------------------------------------------------------------------------*/
+
+static unsigned long prvNetPseudoHeader( unsigned long ulSource, unsigned long ulDestination, unsigned long ulLength )
+{
+unsigned long ulSum = prvNetChecksumAdd( prvNetChecksumAdd( 0UL, &ulSource, sizeof( ulSource ) ), &ulDestination, sizeof( ulDestination ) );
+
+	/* Fold before adding, so the sum cannot overflow. */
+	return ( ulSum & 0xFFFFUL ) + ( ulSum >> 16 ) + netHTONS( netIP_PROTOCOL_UDP ) + netHTONS( ulLength );
+}
+/*----------------------------------------------------------------------------*/
+
+static portBASE_TYPE prvNetIsBroadcast( unsigned long ulAddress )
+{
+	return ( ( netIP_BROADCAST == ulAddress ) || ( ( ulNetAddress | ~ulNetNetmask ) == ulAddress ) ) ? pdTRUE : pdFALSE;
+}
+/*----------------------------------------------------------------------------*/
+
+void vNetGetStats( xNetStats *pxStats )
+{
+	taskENTER_CRITICAL();
+	{
+		*pxStats = xNetStatistics;
+	}
+	taskEXIT_CRITICAL();
+}
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,207 @@
+/*
+    FreeRTOS V7.0.1 - Copyright (C) 2011 Real Time Engineers Ltd.
+
+
+	FreeRTOS supports many tools and architectures. V7.0.0 is sponsored by:
+	Atollic AB - Atollic provides professional embedded systems development
+	tools for C/C++ development, code analysis and test automation.
+	See http://www.atollic.com
+
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS tutorial books are available in pdf and paperback.        *
+     *    Complete, revised, and edited pdf reference manuals are also       *
+     *    available.                                                         *
+     *                                                                       *
+     *    Purchasing FreeRTOS documentation will not only help you, by       *
+     *    ensuring you get running as quickly as possible and with an        *
+     *    in-depth knowledge of how to use FreeRTOS, it will also help       *
+     *    the FreeRTOS project to continue with its mission of providing     *
+     *    professional grade, cross platform, de facto standard solutions    *
+     *    for microcontrollers - completely free of charge!                  *
+     *                                                                       *
+     *    >>> See http://www.FreeRTOS.org/Documentation for details. <<<     *
+     *                                                                       *
+     *    Thank you for using FreeRTOS, and thank you for your support!      *
+     *                                                                       *
+    ***************************************************************************
+
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation AND MODIFIED BY the FreeRTOS exception.
+    >>>NOTE<<< The modification to the GPL is included to allow you to
+    distribute a combined work that includes FreeRTOS without being obliged to
+    provide the source code for proprietary components outside of the FreeRTOS
+    kernel.  FreeRTOS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details. You should have received a copy of the GNU General Public
+    License and the FreeRTOS license exception along with FreeRTOS; if not it
+    can be viewed here: http://www.freertos.org/a00114.html and also obtained
+    by writing to Richard Barry, contact details for whom are available on the
+    FreeRTOS WEB site.
+
+    1 tab == 4 spaces!
+
+    http://www.FreeRTOS.org - Documentation, latest information, license and
+    contact details.
+
+    http://www.SafeRTOS.com - A version that is certified for use in safety
+    critical systems.
+
+    http://www.OpenRTOS.com - Commercial support, development, porting,
+    licensing and training services.
+*/
+
+#ifndef NET_H
+#define NET_H
+
+/* A minimal IPv4 stack: ARP, ICMP echo and UDP over the LAN9118.
+
+Frames live in fixed size buffers from a memory pool and are never copied.
+The Ethernet interrupt reads each received frame straight into a buffer and
+queues it for the network task, which hands UDP datagrams to the receive
+queue of their socket still in the same buffer.  To send, a task takes a
+buffer, writes its payload where pucData points and passes the buffer to
+xNetUDPSend(), which writes the headers in the headroom in front of the
+payload.  Whoever holds a buffer frees it: the application once it has read
+a datagram, the stack once it has sent one.
+
+IP addresses are held in network byte order, as built by netIP_ADDRESS();
+ports are in host byte order. */
+
+#include "queue.h"
+
+/* Buffers in the pool.  Each holds one full sized frame. */
+#ifndef netBUFFER_COUNT
+	#define netBUFFER_COUNT				( 16 )
+#endif
+
+/* Received frames waiting for the network task. */
+#ifndef netRX_QUEUE_LENGTH
+	#define netRX_QUEUE_LENGTH			( netBUFFER_COUNT )
+#endif
+
+/* Addresses remembered by ARP, and for how long. */
+#ifndef netARP_ENTRIES
+	#define netARP_ENTRIES				( 8 )
+#endif
+
+#ifndef netARP_TIMEOUT_MS
+	#define netARP_TIMEOUT_MS			( 300000UL )
+#endif
+
+/* Open UDP sockets. */
+#ifndef netMAX_SOCKETS
+	#define netMAX_SOCKETS				( 4 )
+#endif
+
+/* Set to 0 to send UDP datagrams without a checksum. */
+#ifndef netUDP_CHECKSUM
+	#define netUDP_CHECKSUM				1
+#endif
+
+#define netETHERNET_HEADER_SIZE		( 14UL )
+#define netIP_HEADER_SIZE			( 20UL )
+#define netUDP_HEADER_SIZE			( 8UL )
+#define netMTU						( 1500UL )
+#define netUDP_MAX_PAYLOAD			( netMTU - netIP_HEADER_SIZE - netUDP_HEADER_SIZE )
+
+/* Frames start two bytes into the buffer, so the IP header that follows the
+Ethernet header is word aligned. */
+#define netFRAME_OFFSET				( 2UL )
+
+/* Where the payload of a UDP datagram starts in the buffer. */
+#define netUDP_PAYLOAD_OFFSET		( netFRAME_OFFSET + netETHERNET_HEADER_SIZE + netIP_HEADER_SIZE + netUDP_HEADER_SIZE )
+
+/* A full sized frame and its FCS, rounded up to whole words as the LAN9118
+reads them, after the offset. */
+#define netBUFFER_SIZE				( netFRAME_OFFSET + ( ( netETHERNET_HEADER_SIZE + netMTU + 4UL + 3UL ) & ~3UL ) )
+
+#define netIP_ADDRESS( a, b, c, d )	( ( unsigned long ) ( a ) | ( ( unsigned long ) ( b ) << 8 ) | ( ( unsigned long ) ( c ) << 16 ) | ( ( unsigned long ) ( d ) << 24 ) )
+#define netIP_BROADCAST				( 0xFFFFFFFFUL )
+
+typedef struct NET_BUFFER
+{
+	unsigned char ucFrame[ netBUFFER_SIZE ];	/* First, so as aligned as the pool's blocks. */
+	unsigned char *pucData;			/* The data the holder is working on: the frame in the driver, the payload for sockets. */
+	unsigned long ulLength;			/* Bytes from pucData. */
+	unsigned long ulAddress;		/* A received datagram's source address. */
+	unsigned short usPort;			/* A received datagram's source port. */
+} xNetBuffer;
+
+typedef void * xNetSocketHandle;
+
+typedef struct NET_STATS
+{
+	unsigned long ulRxFrames;		/* Frames processed by the network task. */
+	unsigned long ulTxFrames;		/* Frames handed to the driver. */
+	unsigned long ulDropped;		/* Malformed, unsupported or not for us. */
+	unsigned long ulNoSocket;		/* Datagrams for a port nobody has open. */
+	unsigned long ulSocketFull;		/* Datagrams whose socket queue was full. */
+	unsigned long ulARPUnresolved;	/* Datagrams dropped while waiting for ARP. */
+	unsigned long ulEchoReplies;	/* Pings answered. */
+} xNetStats;
+
+/*
+ * Bring up the LAN9118 with the given address, netmask and default gateway,
+ * and start the network task at uxPriority.  Returns pdFAIL if there is no
+ * LAN9118 or the heap is too small.
+ */
+portBASE_TYPE xNetInitialise( unsigned long ulAddress, unsigned long ulNetmask, unsigned long ulGateway, unsigned portBASE_TYPE uxPriority );
+
+/*
+ * Take a buffer, waiting up to xDelay ticks for one, with pucData at the
+ * payload of a UDP datagram and ulLength 0.  Returns NULL if none was freed in
+ * time.
+ */
+xNetBuffer *pxNetBufferAlloc( portTickType xDelay );
+
+/*
+ * As pxNetBufferAlloc(), from an interrupt, without waiting.  pucData is at
+ * the start of the frame.
+ */
+xNetBuffer *pxNetBufferAllocFromISR( void );
+
+void vNetBufferFree( xNetBuffer *pxBuffer );
+void vNetBufferFreeFromISR( xNetBuffer *pxBuffer, portBASE_TYPE *pxHigherPriorityTaskWoken );
+
+/*
+ * Called by the driver from its interrupt with a received frame at pucData.
+ */
+void vNetReceiveFromISR( xNetBuffer *pxBuffer, portBASE_TYPE *pxHigherPriorityTaskWoken );
+
+/*
+ * Open a socket receiving the datagrams sent to usPort, of which up to
+ * uxQueueLength are held until read.  Returns NULL if the port is in use or
+ * there is no free socket.
+ */
+xNetSocketHandle xNetUDPOpen( unsigned short usPort, unsigned portBASE_TYPE uxQueueLength );
+
+/*
+ * Close a socket, freeing the datagrams it has not read.
+ */
+void vNetUDPClose( xNetSocketHandle xSocket );
+
+/*
+ * Wait up to xDelay ticks for a datagram.  The buffer returned has the
+ * payload at pucData, and the sender in ulAddress and usPort, and must be
+ * freed with vNetBufferFree().  Returns NULL if nothing arrived in time.
+ */
+xNetBuffer *pxNetUDPReceive( xNetSocketHandle xSocket, portTickType xDelay );
+
+/*
+ * Send the ulLength bytes at pucData of a buffer from pxNetBufferAlloc() to
+ * usPort at ulAddress.  The buffer is the stack's from then on, whether or not
+ * it could be sent.  The first datagram to a new address waits in the ARP
+ * table, and is dropped if another replaces it before the address resolves.
+ */
+portBASE_TYPE xNetUDPSend( xNetSocketHandle xSocket, xNetBuffer *pxBuffer, unsigned long ulAddress, unsigned short usPort );
+
+void vNetGetStats( xNetStats *pxStats );
+
+#endif /* NET_H */
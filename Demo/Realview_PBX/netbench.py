@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+"""
+Host side of the UDP throughput benchmark of main.c, built with
+mainNET_BENCHMARK set to 1.  Start the demo with "make qemu-run", which
+forwards UDP port 5555 of the host to the target, then run
+
+    python3 netbench.py [seconds]
+
+The target first streams numbered datagrams to this script, which reports how
+many arrived and how fast.  This script then streams datagrams to the target
+for the given number of seconds, 5 by default.  The target prints its own view
+of both directions on its console.
+"""
+
+import socket
+import struct
+import sys
+import time
+
+TARGET = ("127.0.0.1", 5555)
+PAYLOAD = 1472
+START = b"go"
+END = b"end"
+
+
+def report(name, datagrams, seconds, lost=None):
+    seconds = max(seconds, 1e-6)
+    line = "%s: %d datagrams, %d bytes in %.0f ms, %.0f bytes/s" % (
+        name, datagrams, datagrams * PAYLOAD, seconds * 1000, datagrams * PAYLOAD / seconds)
+    if lost is not None:
+        line += ", %d lost" % lost
+    print(line)
+
+
+def main(argv):
+    seconds = float(argv[1]) if len(argv) > 1 else 5.0
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 4 << 20)
+
+    # The target may still be booting, so keep asking until it answers.
+    sock.settimeout(0.5)
+    while True:
+        sock.sendto(START, TARGET)
+        try:
+            data, _ = sock.recvfrom(2048)
+        except socket.timeout:
+            continue
+        if data == START:
+            break
+
+    # Target to host.
+    sock.settimeout(5.0)
+    received, highest, first, last = 0, -1, None, None
+    while True:
+        try:
+            data, _ = sock.recvfrom(2048)
+        except socket.timeout:
+            break
+        if data == END:
+            break
+        last = time.monotonic()
+        if first is None:
+            first = last
+        received += 1
+        if len(data) >= 4:
+            highest = max(highest, struct.unpack_from("<I", data)[0])
+    report("target to host", received, (last - first) if received else 0, highest + 1 - received)
+
+    # Host to target, as fast as the socket takes them.
+    payload = bytearray(PAYLOAD)
+    sent = 0
+    start = time.monotonic()
+    while time.monotonic() - start < seconds:
+        struct.pack_into("<I", payload, 0, sent)
+        sock.sendto(payload, TARGET)
+        sent += 1
+    elapsed = time.monotonic() - start
+    for _ in range(3):
+        sock.sendto(END, TARGET)
+    report("host to target", sent, elapsed)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
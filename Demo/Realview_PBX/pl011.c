@@ -59,13 +59,45 @@
 
 /* UART Driver for the PL011 Peripheral. */
 
+#include <string.h>
+
 #include "FreeRTOS.h"
 #include "queue.h"
 #include "task.h"
 #include "semphr.h"
+
+#include "pl011.h"
+#include "pl081_dma.h"
 /*----------------------------------------------------------------------------*/
 
-#define UART_USE_INTERRUPT			0
+#define UART_USE_INTERRUPT			1
+
+/* Hand buffers given to xUARTSendBuffer() to the PL081 DMA controller.  Needs
+UART_USE_INTERRUPT. */
+#define UART_USE_DMA				1
+
+/* Set to 1 to have the transmitter pace DMA transfers through its request
+line, so the controller only writes to UARTDR when the FIFO has room.  That
+needs the PL081 request line of the transmitter of each port, from the manual
+of the board, given as UART_DMA_TX_REQUEST( ulPort ).  With 0 the controller
+copies memory to UARTDR as fast as it can, which only works on QEMU: it models
+neither the request lines nor peripheral flow control, but transmits
+instantly.  On hardware that loses data, so a build for hardware must set this
+to 1 ("make UART_DMA_FLOW_CONTROL=1") or UART_USE_DMA to 0. */
+#ifndef UART_DMA_FLOW_CONTROL
+	#define UART_DMA_FLOW_CONTROL	0
+#endif
+
+/* A transfer that has taken twice as long as sending its bytes at the line
+rate, 10 bits to a byte, has stalled. */
+#define UART_DMA_TIMEOUT_TICKS( ulBytes, ulBaud )	( ( portTickType ) ( ( ( ( ulBytes ) * 20000UL ) / ( ulBaud ) ) / portTICK_RATE_MS ) + ( portTickType ) 2 )
+
+/* Buffers shorter than this are not worth setting up a DMA transfer for. */
+#define UART_DMA_MIN_BYTES			( 64UL )
+
+/* The descriptors allocated per port, each moving up to dmaMAX_TRANSFERS
+bytes.  Longer buffers are sent as several chains. */
+#define UART_DMA_MAX_DESCRIPTORS	( 8U )
 
 #define UART0_BASE			( 0x10009000UL )		/* Realview PBX Cortex-A9, Versatile Express. */
 #define UART1_BASE			( 0x1000A000UL )		/* Realview PBX Cortex-A9, Versatile Express. */
@@ -74,6 +106,7 @@
 #define UART_DEVICE_TYPE	0
 
 #define UARTDR(x)			( (volatile unsigned char *)	( (x) + 0x0000UL ) )	/* Data Register */
+#define UARTDR_STATUS(x)	( (volatile unsigned short *)( (x) + 0x0000UL ) )	/* Data Register, with the receive error flags */
 #define UARTRSR_UARTECR(x)	( (volatile unsigned char *)	( (x) + 0x0004UL ) )	/* Receive Status Register / Error Clear Register */
 #define UARTFR(x)			( (volatile unsigned short *)( (x) + 0x0018UL ) )	/* Flag Register */
 #define UARTILPR(x)			( (volatile unsigned char *)	( (x) + 0x0020UL ) )	/* IrDA Low-Power Counter Register */
@@ -96,24 +129,56 @@
 #define UARTPCellID2(x)		( (volatile unsigned char *)	( (x) + 0x0FF8UL ) )	/* UARTPCellID2 Register */
 #define UARTPCellID3(x)		( (volatile unsigned char *)	( (x) + 0x0FFCUL ) )	/* UARTPCellID3 Register */
 
+#define UART_INT_STATUS_OE	( 1 << 10 )
+#define UART_INT_STATUS_BE	( 1 << 9 )
+#define UART_INT_STATUS_PE	( 1 << 8 )
+#define UART_INT_STATUS_FE	( 1 << 7 )
+#define UART_INT_STATUS_RT	( 1 << 6 )
 #define UART_INT_STATUS_TX	( 1 << 5 )
 #define UART_INT_STATUS_RX	( 1 << 4 )
+#define UART_INT_STATUS_ERRORS	( UART_INT_STATUS_OE | UART_INT_STATUS_BE | UART_INT_STATUS_PE | UART_INT_STATUS_FE )
+#define UART_INT_STATUS_ALL		( 0x07FF )
+
+#define UART_DR_OE			( 1 << 11 )
+#define UART_DR_BE			( 1 << 10 )
+#define UART_DR_PE			( 1 << 9 )
+#define UART_DR_FE			( 1 << 8 )
+#define UART_DR_DATA_MASK	( 0xFF )
 
 #define UART_FLAG_TXFE		( 1 << 7 )
 #define UART_FLAG_TXFF		( 1 << 5 )
 #define UART_FLAG_RXFE		( 1 << 4 )
 
+#define UART_DMACR_TXDMAE	( 1 << 1 )
+
+#define UART_CR_RXE			( 1 << 9 )
+#define UART_CR_TXE			( 1 << 8 )
+#define UART_CR_LBE			( 1 << 7 )
+#define UART_CR_UARTEN		( 1 << 0 )
+
+/* FIFO trigger levels for UARTIFLS, as a fraction of the FIFO depth. */
+#define UART_IFLS_1_8		( 0 )
+#define UART_IFLS_1_4		( 1 )
+#define UART_IFLS_1_2		( 2 )
+#define UART_IFLS_3_4		( 3 )
+#define UART_IFLS_7_8		( 4 )
+#define UART_IFLS( ulRx, ulTx )	( ( ( ulRx ) << 3 ) | ( ulTx ) )
+
 #define UART_CLK_HZ				( 3686400UL )
 
-#define UART_FIFO_SIZE_BYTES	( 32UL )
+/* The depth of both the transmit and the receive FIFO.  The PL011 revisions
+before r1p5, which include the one QEMU models on this board, have 16 byte
+FIFOs. */
+#define UART_FIFO_SIZE_BYTES	( 16UL )
+
 #define UART0_VECTOR_ID			( 44 )
 #define UART1_VECTOR_ID			( 45 )
 #define UART2_VECTOR_ID			( 46 )
 #define UART3_VECTOR_ID			( 47 )
 #define UART4_VECTOR_ID			( 48 )
 
-#define TX_QUEUE				( 0 )
-#define RX_QUEUE				( 1 )
+#define UART_MAX_PORTS			( 4UL )
+
 /*----------------------------------------------------------------------------*/
 
 #if configPLATFORM == 0 || configPLATFORM == 2
@@ -124,273 +189,1035 @@
 #define UART_CLK 24000000
 #endif
 
+#if UART_USE_INTERRUPT && ( INCLUDE_xTaskGetSchedulerState != 1 )
+	#error The interrupt driven UART driver needs INCLUDE_xTaskGetSchedulerState set to 1.
+#endif
+
+#if UART_USE_DMA && !UART_USE_INTERRUPT
+	#error UART_USE_DMA needs UART_USE_INTERRUPT.
+#endif
+
+#if UART_USE_DMA && UART_DMA_FLOW_CONTROL && !defined( UART_DMA_TX_REQUEST )
+	#error UART_DMA_FLOW_CONTROL needs UART_DMA_TX_REQUEST( ulPort ), the PL081 request lines of the transmitters from the manual of the board.
+#endif
+
+/* A byte ring buffer between a task and the interrupt handler, and the
+semaphore the interrupt handler gives whenever it moves bytes through it. */
+typedef struct UART_RING
+{
+	unsigned char *pucBuffer;
+	unsigned long ulSize;
+	unsigned long ulHead;				/* Where the next byte is written. */
+	unsigned long ulTail;				/* Where the next byte is read. */
+	volatile unsigned long ulCount;
+	xSemaphoreHandle xEvent;
+} xUARTRing;
+
+typedef struct UART_PORT
+{
+	unsigned long ulBase;
+	xUARTRing xTx;
+	xUARTRing xRx;
+	xUARTStats xStats;
 #if UART_USE_INTERRUPT
+	pdUART_RX_HOOK pxRxHook;			/* Takes received bytes instead of xRx when set. */
+	void *pvRxHookContext;
+	unsigned char ucRxBurst[ UART_FIFO_SIZE_BYTES ];	/* Bytes collected for the hook. */
+	unsigned long ulRxBurst;
+	xAIODevice xTxAIO;					/* Sent after the transmit ring. */
+	xAIODevice xRxAIO;					/* Filled ahead of the hook and the receive ring. */
+#endif /* UART_USE_INTERRUPT */
+#if UART_USE_DMA
+	xDMAChannelHandle xTxDMA;			/* Claimed on the first DMA transfer. */
+	xDMADescriptor *pxTxDescriptors;
+	xSemaphoreHandle xTxDMALock;		/* Held by the task transmitting by DMA. */
+	xSemaphoreHandle xTxDMADone;		/* Given by the DMA interrupt at the end of each chain. */
+	volatile portBASE_TYPE xTxDMAActive;	/* While set, xUARTSendCharacter() only queues. */
+	volatile portBASE_TYPE xTxDMAError;
+	portBASE_TYPE xTxDMAStalled;		/* Set when a transfer times out, after which the ring is used instead. */
+	unsigned long ulBaud;				/* For the transfer timeouts. */
+#endif /* UART_USE_DMA */
+} xUARTPort;
 
-static xQueueHandle xUartQueues[5][2] = { { NULL, NULL } };
+static const unsigned long ulUARTBases[ UART_MAX_PORTS ] = { UART0_BASE, UART1_BASE, UART2_BASE, UART3_BASE };
+static const unsigned long ulUARTVectors[ UART_MAX_PORTS ] = { UART0_VECTOR_ID, UART1_VECTOR_ID, UART2_VECTOR_ID, UART3_VECTOR_ID };
+
+static xUARTPort xUARTPorts[ UART_MAX_PORTS ];
 /*----------------------------------------------------------------------------*/
 
-void vUARTInterruptHandler( void *pvBaseAddress )
+/*
+ * Move bytes between a buffer and the rings, waiting for the interrupt for up
+ * to xDelay ticks in total.  Return the number of bytes moved.
+ */
+static unsigned long prvUARTWrite( xUARTPort *pxPort, const unsigned char *pucBuffer, unsigned long ulLength, portTickType xDelay );
+static unsigned long prvUARTRead( xUARTPort *pxPort, unsigned char *pucBuffer, unsigned long ulLength, portTickType xDelay );
+
+/*
+ * Move one received byte, with its error flags, into the statistics and the
+ * receive ring.  Bytes with framing, parity or break errors are dropped.
+ */
+static portBASE_TYPE prvUARTReceiveByte( xUARTPort *pxPort, unsigned short usData );
+
+#if UART_USE_INTERRUPT
+
+/*
+ * Ring buffer helpers.  Must be called with the UART interrupt masked, or from
+ * the UART interrupt itself.
+ */
+static portBASE_TYPE prvRingPut( xUARTRing *pxRing, unsigned char ucByte );
+static portBASE_TYPE prvRingGet( xUARTRing *pxRing, unsigned char *pucByte );
+static unsigned long prvRingWrite( xUARTRing *pxRing, const unsigned char *pucData, unsigned long ulLength );
+static unsigned long prvRingRead( xUARTRing *pxRing, unsigned char *pucData, unsigned long ulLength );
+
+/*
+ * Move up to UART_FIFO_SIZE_BYTES from the transmit ring into the FIFO, stopping
+ * early if the FIFO fills.  Returns the number of bytes moved.
+ */
+static unsigned long prvUARTFillFIFO( xUARTPort *pxPort );
+
+/*
+ * Whether the caller may block on the ring semaphores.  Before the scheduler
+ * starts, and while it is suspended, the driver polls the hardware instead.
+ */
+static portBASE_TYPE prvUARTCanBlock( void );
+
+/*
+ * Start the transmitter on whatever is in the transmit ring, or failing that
+ * in the transmit request, unless it is already running.  Called with the
+ * UART interrupt masked.
+ */
+static void prvUARTStartTx( xUARTPort *pxPort );
+
+/*
+ * Start the transmitter on a request submitted while it was idle.
+ */
+static void prvUARTAIOStartTx( xAIODevice *pxDevice, xAIORequest *pxRequest, portBASE_TYPE *pxHigherPriorityTaskWoken );
+
+#if UART_USE_DMA
+
+/*
+ * Claim the channel, descriptors and semaphores used to transmit by DMA the
+ * first time they are needed.  Returns pdFALSE if any are unavailable.
+ */
+static portBASE_TYPE prvUARTDMAPrepare( xUARTPort *pxPort );
+
+/*
+ * Send one buffer by DMA, as chains of at most UART_DMA_MAX_DESCRIPTORS
+ * descriptors, waiting for each chain to complete.  A chain that times out is
+ * stopped, and sets xTxDMAStalled.  Returns the number of bytes sent.
+ */
+static unsigned long prvUARTDMASend( xUARTPort *pxPort, const unsigned char *pucBuffer, unsigned long ulLength );
+
+/*
+ * Called from the DMA interrupt at the end of each chain.
+ */
+static void prvUARTDMAComplete( void *pvContext, portBASE_TYPE xError, portBASE_TYPE *pxHigherPriorityTaskWoken );
+
+#endif /* UART_USE_DMA */
+
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvRingPut( xUARTRing *pxRing, unsigned char ucByte )
 {
-unsigned long ulBase = (unsigned long)pvBaseAddress;
-unsigned short usStatus = 0;
-signed char cTransmitChar = 0;
-signed char cReceiveChar = 0;
-portBASE_TYPE xTaskWoken = pdFALSE;
-xQueueHandle xTxQueue = NULL;
-xQueueHandle xRxQueue = NULL;
-unsigned long ulUART = 0;
+	if( pxRing->ulCount >= pxRing->ulSize )
+	{
+		return pdFALSE;
+	}
 
-	/* Select the UART Queues. */
-	switch ( ulBase )
+	pxRing->pucBuffer[ pxRing->ulHead ] = ucByte;
+	if( ++( pxRing->ulHead ) == pxRing->ulSize )
 	{
-	case UART0_BASE:
-		ulUART = 0;
-		break;
-	case UART1_BASE:
-		ulUART = 1;
-		break;
-	case UART2_BASE:
-		ulUART = 2;
-		break;
-	case UART3_BASE:
-		ulUART = 3;
-		break;
+		pxRing->ulHead = 0UL;
 	}
+	pxRing->ulCount++;
 
-	xTxQueue = xUartQueues[ulUART][TX_QUEUE];
-	xRxQueue = xUartQueues[ulUART][RX_QUEUE];
+	return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvRingGet( xUARTRing *pxRing, unsigned char *pucByte )
+{
+	if( 0UL == pxRing->ulCount )
+	{
+		return pdFALSE;
+	}
+
+	*pucByte = pxRing->pucBuffer[ pxRing->ulTail ];
+	if( ++( pxRing->ulTail ) == pxRing->ulSize )
+	{
+		pxRing->ulTail = 0UL;
+	}
+	pxRing->ulCount--;
+
+	return pdTRUE;
+}
+/*-----------------------------------------------------------*/
 
-	/* Figure out the reason for the interrupt. */
-	usStatus = *UARTMIS(ulBase);
+static unsigned long prvRingWrite( xUARTRing *pxRing, const unsigned char *pucData, unsigned long ulLength )
+{
+unsigned long ulCopied = 0UL, ulChunk;
 
-	if ( usStatus & UART_INT_STATUS_TX )
+	/* At most two copies, either side of the wrap. */
+	while( ( ulCopied < ulLength ) && ( pxRing->ulCount < pxRing->ulSize ) )
 	{
-		/* Buffer is almost empty, try to refill. */
-		while ( *UARTFR(ulBase) & UART_FLAG_TXFF )
+		ulChunk = pxRing->ulSize - pxRing->ulHead;
+		if( ulChunk > ( pxRing->ulSize - pxRing->ulCount ) )
+		{
+			ulChunk = pxRing->ulSize - pxRing->ulCount;
+		}
+		if( ulChunk > ( ulLength - ulCopied ) )
+		{
+			ulChunk = ulLength - ulCopied;
+		}
+
+		memcpy( &( pxRing->pucBuffer[ pxRing->ulHead ] ), pucData + ulCopied, ulChunk );
+		pxRing->ulHead += ulChunk;
+		if( pxRing->ulHead == pxRing->ulSize )
+		{
+			pxRing->ulHead = 0UL;
+		}
+		pxRing->ulCount += ulChunk;
+		ulCopied += ulChunk;
+	}
+
+	return ulCopied;
+}
+/*-----------------------------------------------------------*/
+
+static unsigned long prvRingRead( xUARTRing *pxRing, unsigned char *pucData, unsigned long ulLength )
+{
+unsigned long ulCopied = 0UL, ulChunk;
+
+	while( ( ulCopied < ulLength ) && ( pxRing->ulCount > 0UL ) )
+	{
+		ulChunk = pxRing->ulSize - pxRing->ulTail;
+		if( ulChunk > pxRing->ulCount )
+		{
+			ulChunk = pxRing->ulCount;
+		}
+		if( ulChunk > ( ulLength - ulCopied ) )
 		{
-			if ( pdTRUE == xQueueReceiveFromISR( xTxQueue, &cTransmitChar, &xTaskWoken ) )
+			ulChunk = ulLength - ulCopied;
+		}
+
+		memcpy( pucData + ulCopied, &( pxRing->pucBuffer[ pxRing->ulTail ] ), ulChunk );
+		pxRing->ulTail += ulChunk;
+		if( pxRing->ulTail == pxRing->ulSize )
+		{
+			pxRing->ulTail = 0UL;
+		}
+		pxRing->ulCount -= ulChunk;
+		ulCopied += ulChunk;
+	}
+
+	return ulCopied;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRingCreate( xUARTRing *pxRing, unsigned long ulSize )
+{
+	pxRing->pucBuffer = ( unsigned char * ) pvPortMalloc( ulSize );
+	pxRing->ulSize = ulSize;
+	pxRing->ulHead = 0UL;
+	pxRing->ulTail = 0UL;
+	pxRing->ulCount = 0UL;
+
+	/* Binary semaphores are created available, so take it straight away. */
+	vSemaphoreCreateBinary( pxRing->xEvent );
+	configASSERT( ( NULL != pxRing->pucBuffer ) && ( NULL != pxRing->xEvent ) );
+	( void ) xSemaphoreTake( pxRing->xEvent, 0 );
+}
+/*-----------------------------------------------------------*/
+
+static unsigned long prvUARTFillFIFO( xUARTPort *pxPort )
+{
+unsigned long ulMoved = 0UL;
+unsigned char ucByte;
+xAIORequest *pxRequest;
+
+	while( ( ulMoved < UART_FIFO_SIZE_BYTES ) && !( *UARTFR( pxPort->ulBase ) & UART_FLAG_TXFF ) )
+	{
+		if( pdFALSE == prvRingGet( &( pxPort->xTx ), &ucByte ) )
+		{
+			/* The ring goes first, then the request being sent, which the
+			interrupt completes once all of it is in the FIFO. */
+			pxRequest = pxAIOActive( &( pxPort->xTxAIO ) );
+			if( ( NULL == pxRequest ) || ( pxRequest->ulDone >= pxRequest->ulLength ) )
 			{
-				*UARTDR(ulBase) = cTransmitChar;
+				break;
 			}
-			else
+			ucByte = pxRequest->pucBuffer[ pxRequest->ulDone++ ];
+		}
+
+		*UARTDR( pxPort->ulBase ) = ucByte;
+		ulMoved++;
+	}
+
+	pxPort->xStats.ulTxBytes += ulMoved;
+	return ulMoved;
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvUARTCanBlock( void )
+{
+	return ( taskSCHEDULER_RUNNING == xTaskGetSchedulerState() ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvUARTStartTx( xUARTPort *pxPort )
+{
+#if UART_USE_DMA
+	if( pdFALSE != pxPort->xTxDMAActive )
+	{
+		/* The DMA transfer owns the FIFO, the ring is started when it ends. */
+		return;
+	}
+#endif /* UART_USE_DMA */
+
+	if( !( *UARTIMSC( pxPort->ulBase ) & UART_INT_STATUS_TX ) )
+	{
+		/* The transmitter is idle, so start it.  Anything that does not fit
+		in the FIFO is sent by the interrupt. */
+		( void ) prvUARTFillFIFO( pxPort );
+
+		if( ( pxPort->xTx.ulCount > 0UL ) || ( NULL != pxAIOActive( &( pxPort->xTxAIO ) ) ) )
+		{
+			*UARTIMSC( pxPort->ulBase ) |= UART_INT_STATUS_TX;
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvUARTAIOStartTx( xAIODevice *pxDevice, xAIORequest *pxRequest, portBASE_TYPE *pxHigherPriorityTaskWoken )
+{
+	( void ) pxRequest;
+	( void ) pxHigherPriorityTaskWoken;
+
+	prvUARTStartTx( ( xUARTPort * ) pxDevice->pvDriver );
+}
+/*-----------------------------------------------------------*/
+
+#if UART_USE_DMA
+
+static portBASE_TYPE prvUARTDMAPrepare( xUARTPort *pxPort )
+{
+	if( NULL == pxPort->xTxDMALock )
+	{
+		pxPort->xTxDMALock = xSemaphoreCreateMutex();
+		vSemaphoreCreateBinary( pxPort->xTxDMADone );
+		if( NULL != pxPort->xTxDMADone )
+		{
+			( void ) xSemaphoreTake( pxPort->xTxDMADone, 0 );
+		}
+
+		/* The controller reads the descriptors, so they live in memory it
+		sees without cache maintenance where there is some. */
+		pxPort->pxTxDescriptors = ( xDMADescriptor * ) pvPortMallocAlignedAttr( UART_DMA_MAX_DESCRIPTORS * sizeof( xDMADescriptor ), portCACHE_LINE_SIZE, portHEAP_ATTR_DMA );
+		if( NULL == pxPort->pxTxDescriptors )
+		{
+			pxPort->pxTxDescriptors = ( xDMADescriptor * ) pvPortMallocAlignedAttr( UART_DMA_MAX_DESCRIPTORS * sizeof( xDMADescriptor ), portCACHE_LINE_SIZE, 0UL );
+		}
+	}
+
+	if( ( NULL != pxPort->xTxDMALock ) && ( NULL != pxPort->xTxDMADone ) && ( NULL != pxPort->pxTxDescriptors ) && ( NULL == pxPort->xTxDMA ) )
+	{
+		pxPort->xTxDMA = xDMAChannelAllocate();
+	}
+
+	return ( ( NULL != pxPort->xTxDMA ) && ( NULL != pxPort->xTxDMALock ) && ( NULL != pxPort->xTxDMADone ) && ( NULL != pxPort->pxTxDescriptors ) ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvUARTDMAComplete( void *pvContext, portBASE_TYPE xError, portBASE_TYPE *pxHigherPriorityTaskWoken )
+{
+xUARTPort *pxPort = ( xUARTPort * ) pvContext;
+
+	if( pdFALSE != xError )
+	{
+		pxPort->xTxDMAError = pdTRUE;
+	}
+
+	( void ) xSemaphoreGiveFromISR( pxPort->xTxDMADone, pxHigherPriorityTaskWoken );
+}
+/*-----------------------------------------------------------*/
+
+static unsigned long prvUARTDMASend( xUARTPort *pxPort, const unsigned char *pucBuffer, unsigned long ulLength )
+{
+const unsigned long ulChainBytes = UART_DMA_MAX_DESCRIPTORS * dmaMAX_TRANSFERS;
+unsigned long ulSent = 0UL, ulChunk, ulMask, ulConfig;
+unsigned portBASE_TYPE uxDescriptors;
+portBASE_TYPE xWaited = pdFALSE;
+
+#if UART_DMA_FLOW_CONTROL
+	ulConfig = dmaCONFIG_MEM_TO_PERIPHERAL | dmaCONFIG_DEST_PERIPHERAL( UART_DMA_TX_REQUEST( pxPort - xUARTPorts ) );
+	*UARTDMACR( pxPort->ulBase ) |= UART_DMACR_TXDMAE;
+#else
+	ulConfig = dmaCONFIG_MEM_TO_MEM;
+#endif /* UART_DMA_FLOW_CONTROL */
+
+	/* The controller reads the buffer from memory, not the cache. */
+	portCLEAN_DCACHE_RANGE( pucBuffer, ulLength );
+
+	/* Bytes already in the ring, and the transmit request being sent, must
+	go first.  Once both are in the FIFO, claim it so that nothing queued from
+	now on is written into the middle of the transfer.  The interrupt gives
+	the ring semaphore whenever it moves bytes of either. */
+	for( ;; )
+	{
+		ulMask = portSET_INTERRUPT_MASK_FROM_ISR();
+		{
+			if( ( 0UL == pxPort->xTx.ulCount ) && ( NULL == pxAIOActive( &( pxPort->xTxAIO ) ) ) )
 			{
-				/* Run out of characters to send. */
-				break;
+				pxPort->xTxDMAActive = pdTRUE;
 			}
 		}
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( ulMask );
+
+		if( pdFALSE != pxPort->xTxDMAActive )
+		{
+			break;
+		}
+
+		( void ) xSemaphoreTake( pxPort->xTx.xEvent, portMAX_DELAY );
+		xWaited = pdTRUE;
+	}
+
+	if( pdFALSE != xWaited )
+	{
+		/* Pass on the wake up that may have been meant for a task waiting
+		for room in the ring. */
+		( void ) xSemaphoreGive( pxPort->xTx.xEvent );
 	}
 
-	if ( usStatus & UART_INT_STATUS_RX )
+	pxPort->xTxDMAError = pdFALSE;
+
+	while( ( ulSent < ulLength ) && ( pdFALSE == pxPort->xTxDMAError ) )
 	{
-		/* Receive Buffer is almost full. */
-		while ( !( *UARTFR(ulBase) & UART_FLAG_RXFE ) )
+		ulChunk = ( ( ulLength - ulSent ) > ulChainBytes ) ? ulChainBytes : ( ulLength - ulSent );
+
+		uxDescriptors = uxDMABuildChain( pxPort->pxTxDescriptors, UART_DMA_MAX_DESCRIPTORS, ( unsigned long ) ( pucBuffer + ulSent ), ( unsigned long ) UARTDR( pxPort->ulBase ), ulChunk,
+										 dmaCONTROL_SWIDTH( 0 ) | dmaCONTROL_DWIDTH( 0 ) | dmaCONTROL_SBSIZE( 2 ) | dmaCONTROL_DBSIZE( 2 ) | dmaCONTROL_SI );
+		portCLEAN_DCACHE_RANGE( pxPort->pxTxDescriptors, uxDescriptors * sizeof( xDMADescriptor ) );
+
+		if( pdFALSE == xDMAStart( pxPort->xTxDMA, pxPort->pxTxDescriptors, ulConfig, prvUARTDMAComplete, pxPort ) )
 		{
-			cReceiveChar = *UARTDR(ulBase);
-			if ( pdTRUE != xQueueSendFromISR( xRxQueue, &cReceiveChar, &xTaskWoken ) )
+			break;
+		}
+
+		/* The UART paces the transfer, so it takes as long as sending the
+		chunk at the line rate.  If it takes much longer then the request line
+		is not being asserted, so stop the transfer and leave the rest to the
+		ring. */
+		if( pdTRUE != xSemaphoreTake( pxPort->xTxDMADone, UART_DMA_TIMEOUT_TICKS( ulChunk, pxPort->ulBaud ) ) )
+		{
+			vDMAAbort( pxPort->xTxDMA );
+
+			/* It may have completed just before it was stopped. */
+			if( pdTRUE != xSemaphoreTake( pxPort->xTxDMADone, 0 ) )
 			{
-				/* Receive Queue is Full. */
-				/* Not good as we are going to lose this character. */
+				pxPort->xStats.ulTxDMATimeouts++;
+				pxPort->xTxDMAStalled = pdTRUE;
 				break;
 			}
 		}
+
+		if( pdFALSE == pxPort->xTxDMAError )
+		{
+			ulSent += ulChunk;
+			pxPort->xStats.ulTxBytes += ulChunk;
+			pxPort->xStats.ulTxDMATransfers++;
+		}
 	}
 
-	/* Here we should deal with any errors. */
+#if UART_DMA_FLOW_CONTROL
+	*UARTDMACR( pxPort->ulBase ) &= ~UART_DMACR_TXDMAE;
+#endif /* UART_DMA_FLOW_CONTROL */
+
+	/* Hand the FIFO back, and send whatever was queued meanwhile. */
+	ulMask = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		pxPort->xTxDMAActive = pdFALSE;
+		prvUARTStartTx( pxPort );
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( ulMask );
+
+	return ulSent;
+}
+/*-----------------------------------------------------------*/
 
-	/* Acknownledge the interrupt. */
-	*UARTICR(ulBase) = usStatus;
+#endif /* UART_USE_DMA */
+
+void vUARTInterruptHandler( void *pvParameter )
+{
+xUARTPort *pxPort = ( xUARTPort * ) pvParameter;
+unsigned long ulBase = pxPort->ulBase;
+unsigned short usStatus = 0;
+portBASE_TYPE xTaskWoken = pdFALSE;
+portBASE_TYPE xReceived = pdFALSE;
+xAIORequest *pxRequest;
+
+	/* Figure out the reason for the interrupt, and acknowledge it before
+	touching the FIFOs so that anything they raise from here on is not lost. */
+	usStatus = *UARTMIS( ulBase );
+	*UARTICR( ulBase ) = usStatus;
+
+	if( usStatus & ( UART_INT_STATUS_RX | UART_INT_STATUS_RT | UART_INT_STATUS_ERRORS ) )
+	{
+		/* The receive FIFO reached its trigger level, or held bytes for 32
+		bit periods without reaching it.  Empty it either way. */
+		pxPort->xStats.ulRxInterrupts++;
+
+		while( !( *UARTFR( ulBase ) & UART_FLAG_RXFE ) )
+		{
+			if( pdFALSE != prvUARTReceiveByte( pxPort, *UARTDR_STATUS( ulBase ) ) )
+			{
+				xReceived = pdTRUE;
+			}
+
+			pxRequest = pxAIOActive( &( pxPort->xRxAIO ) );
+			if( ( NULL != pxRequest ) && ( pxRequest->ulDone >= pxRequest->ulLength ) )
+			{
+				( void ) pxAIOComplete( &( pxPort->xRxAIO ), aioDONE, &xTaskWoken );
+			}
+
+			if( pxPort->ulRxBurst == UART_FIFO_SIZE_BYTES )
+			{
+				/* More arrived while draining than the burst holds. */
+				pxPort->pxRxHook( pxPort->pvRxHookContext, pxPort->ucRxBurst, pxPort->ulRxBurst, &xTaskWoken );
+				pxPort->ulRxBurst = 0UL;
+			}
+		}
+
+		if( usStatus & UART_INT_STATUS_ERRORS )
+		{
+			*UARTRSR_UARTECR( ulBase ) = 0;
+		}
+
+		/* The line has gone quiet, which ends a read that may be short. */
+		pxRequest = pxAIOActive( &( pxPort->xRxAIO ) );
+		if( ( usStatus & UART_INT_STATUS_RT ) && ( NULL != pxRequest ) && ( pxRequest->ulFlags & aioFLAG_PARTIAL ) && ( pxRequest->ulDone > 0UL ) )
+		{
+			( void ) pxAIOComplete( &( pxPort->xRxAIO ), aioDONE, &xTaskWoken );
+		}
+
+		if( NULL != pxPort->pxRxHook )
+		{
+			if( pxPort->ulRxBurst > 0UL )
+			{
+				pxPort->pxRxHook( pxPort->pvRxHookContext, pxPort->ucRxBurst, pxPort->ulRxBurst, &xTaskWoken );
+				pxPort->ulRxBurst = 0UL;
+			}
+
+			/* The hook takes the bytes in place of the ring, so there is
+			nobody to wake. */
+			xReceived = pdFALSE;
+		}
+
+		if( pdFALSE != xReceived )
+		{
+			( void ) xSemaphoreGiveFromISR( pxPort->xRx.xEvent, &xTaskWoken );
+		}
+	}
+
+#if UART_USE_DMA
+	if( ( usStatus & UART_INT_STATUS_TX ) && ( pdFALSE != pxPort->xTxDMAActive ) )
+	{
+		/* A DMA transfer owns the FIFO.  prvUARTDMASend() starts the
+		transmitter again when it hands the FIFO back. */
+		*UARTIMSC( ulBase ) &= ~UART_INT_STATUS_TX;
+		usStatus &= ~UART_INT_STATUS_TX;
+	}
+#endif /* UART_USE_DMA */
+
+	if( usStatus & UART_INT_STATUS_TX )
+	{
+		/* The transmit FIFO drained to its trigger level, refill it in one
+		burst. */
+		pxPort->xStats.ulTxInterrupts++;
+
+		if( prvUARTFillFIFO( pxPort ) > 0UL )
+		{
+			( void ) xSemaphoreGiveFromISR( pxPort->xTx.xEvent, &xTaskWoken );
+		}
+
+		/* Complete the requests that are all in the FIFO, and carry on
+		with the next. */
+		pxRequest = pxAIOActive( &( pxPort->xTxAIO ) );
+		while( ( NULL != pxRequest ) && ( pxRequest->ulDone >= pxRequest->ulLength ) )
+		{
+			pxRequest = pxAIOComplete( &( pxPort->xTxAIO ), aioDONE, &xTaskWoken );
+			( void ) prvUARTFillFIFO( pxPort );
+		}
+
+		if( ( 0UL == pxPort->xTx.ulCount ) && ( NULL == pxRequest ) )
+		{
+			/* Nothing left to send, so stop asking for room. */
+			*UARTIMSC( ulBase ) &= ~UART_INT_STATUS_TX;
+		}
+	}
 
 	/* Finally, switch task if necessary. */
-	portEND_SWITCHING_ISR(xTaskWoken);
+	portEND_SWITCHING_ISR( xTaskWoken );
 }
 /*----------------------------------------------------------------------------*/
 
 #endif /* UART_USE_INTERRUPT */
 
+static portBASE_TYPE prvUARTReceiveByte( xUARTPort *pxPort, unsigned short usData )
+{
+#if UART_USE_INTERRUPT
+xAIORequest *pxRequest;
+#endif /* UART_USE_INTERRUPT */
+
+	if( usData & ( UART_DR_OE | UART_DR_BE | UART_DR_PE | UART_DR_FE ) )
+	{
+		if( usData & UART_DR_OE )
+		{
+			pxPort->xStats.ulOverrunErrors++;
+		}
+		if( usData & UART_DR_BE )
+		{
+			pxPort->xStats.ulBreakErrors++;
+		}
+		if( usData & UART_DR_PE )
+		{
+			pxPort->xStats.ulParityErrors++;
+		}
+		if( usData & UART_DR_FE )
+		{
+			pxPort->xStats.ulFramingErrors++;
+		}
+
+		/* An overrun loses the bytes after this one, but this one is good. */
+		if( usData & ( UART_DR_BE | UART_DR_PE | UART_DR_FE ) )
+		{
+			return pdFALSE;
+		}
+	}
+
+	pxPort->xStats.ulRxBytes++;
+
+#if UART_USE_INTERRUPT
+	pxRequest = pxAIOActive( &( pxPort->xRxAIO ) );
+	if( ( NULL != pxRequest ) && ( pxRequest->ulDone < pxRequest->ulLength ) )
+	{
+		/* Nothing for the readers of the ring. */
+		pxRequest->pucBuffer[ pxRequest->ulDone++ ] = ( unsigned char ) ( usData & UART_DR_DATA_MASK );
+		return pdFALSE;
+	}
+
+	if( NULL != pxPort->pxRxHook )
+	{
+		pxPort->ucRxBurst[ pxPort->ulRxBurst++ ] = ( unsigned char ) ( usData & UART_DR_DATA_MASK );
+		return pdTRUE;
+	}
+
+	if( pdFALSE == prvRingPut( &( pxPort->xRx ), ( unsigned char ) ( usData & UART_DR_DATA_MASK ) ) )
+	{
+		pxPort->xStats.ulRxDropped++;
+		return pdFALSE;
+	}
+#endif /* UART_USE_INTERRUPT */
+
+	return pdTRUE;
+}
+/*----------------------------------------------------------------------------*/
+
 void vUARTInitialise(unsigned long ulUARTPeripheral, unsigned long ulBaud, unsigned long ulQueueSize )
 {
 extern void vPortInstallInterruptHandler( void (*vHandler)(void *), void *pvParameter, unsigned long ulVector, unsigned char ucEdgeTriggered, unsigned char ucPriority, unsigned char ucProcessorTargets );
-unsigned long ulBase = 0;
-#if UART_USE_INTERRUPT
-unsigned long ulVectorID = 0;
-#endif
+xUARTPort *pxPort;
+unsigned long ulBase;
+unsigned long ulDivisor;
 
-	switch ( ulUARTPeripheral )
-	{
-	case 0:
-		ulBase = UART0_BASE;
-		#if UART_USE_INTERRUPT
-		ulVectorID = UART0_VECTOR_ID;
-		/* Create the Queues to Handle the bytes. */
-		xUartQueues[0][TX_QUEUE] = xSemaphoreCreateCounting( ulQueueSize, ulQueueSize );
-		xUartQueues[0][RX_QUEUE] = xQueueCreate( ulQueueSize, sizeof( char ) );
-		#endif
-		break;
-	case 1:
-		ulBase = UART1_BASE;
-		#if UART_USE_INTERRUPT
-		ulVectorID = UART1_VECTOR_ID;
-		/* Create the Queues to Handle the bytes. */
-		xUartQueues[1][TX_QUEUE] = xQueueCreate( ulQueueSize, sizeof( char ) );
-		xUartQueues[1][RX_QUEUE] = xQueueCreate( ulQueueSize, sizeof( char ) );
-		#endif
-		break;
-	case 2:
-		ulBase = UART2_BASE;
-		#if UART_USE_INTERRUPT
-		ulVectorID = UART2_VECTOR_ID;
-		/* Create the Queues to Handle the bytes. */
-		xUartQueues[2][TX_QUEUE] = xQueueCreate( ulQueueSize, sizeof( char ) );
-		xUartQueues[2][RX_QUEUE] = xQueueCreate( ulQueueSize, sizeof( char ) );
-		#endif
-		break;
-	case 3:
-		ulBase = UART3_BASE;
-		#if UART_USE_INTERRUPT
-		ulVectorID = UART3_VECTOR_ID;
-		/* Create the Queues to Handle the bytes. */
-		xUartQueues[3][TX_QUEUE] = xQueueCreate( ulQueueSize, sizeof( char ) );
-		xUartQueues[3][RX_QUEUE] = xQueueCreate( ulQueueSize, sizeof( char ) );
-		#endif
-		break;
+	if ( ulUARTPeripheral >= UART_MAX_PORTS )
+	{
+		return;
 	}
 
+	pxPort = &( xUARTPorts[ ulUARTPeripheral ] );
+	ulBase = ulUARTBases[ ulUARTPeripheral ];
+	pxPort->ulBase = ulBase;
+
+#if UART_USE_INTERRUPT
+	/* Create the rings the first time the port is initialised only, so it
+	can be reconfigured later. */
+	if ( NULL == pxPort->xTx.pucBuffer )
+	{
+		prvRingCreate( &( pxPort->xTx ), ulQueueSize );
+		prvRingCreate( &( pxPort->xRx ), ulQueueSize );
+		vAIODeviceInitialise( &( pxPort->xTxAIO ), prvUARTAIOStartTx, NULL, pxPort );
+		vAIODeviceInitialise( &( pxPort->xRxAIO ), NULL, NULL, pxPort );
+	}
+#else
+	( void ) ulQueueSize;
+#endif /* UART_USE_INTERRUPT */
+
 	/* First Disable the Peripheral. */
 	*UARTCR(ulBase) = 0UL;
 
-	/* Configure the Peripheral. */
-	*UARTIBRD(ulBase) = UART_CLK / ( 16 * ulBaud );
-	*UARTFBRD(ulBase) = UART_CLK % ( 16 * ulBaud );
+	/* Configure the Peripheral.  The divisor is in 1/64ths, rounded to the
+	nearest. */
+	ulDivisor = ( ( 8UL * UART_CLK ) / ulBaud + 1UL ) / 2UL;
+#if UART_USE_DMA
+	pxPort->ulBaud = ulBaud;
+#endif /* UART_USE_DMA */
+	*UARTIBRD(ulBase) = ( unsigned short ) ( ulDivisor >> 6 );
+	*UARTFBRD(ulBase) = ( unsigned char ) ( ulDivisor & 0x3FUL );
 	*UARTLCR_H(ulBase) = ( 3 << 5 ) | ( 1 << 4 );
 
-	/* Configure the Interrupts. */
-	*UARTIFLS(ulBase) = ( 0 << 3 ) | ( 0 << 0 );
-	*UARTICR(ulBase) = 0xFFFF;	/* Clear all Iterrupts. */
+	/* Configure the Interrupts.  Receive interrupts at half full, leaving
+	room for the latency of the interrupt, and the receive timeout picks up
+	whatever is left below that.  Transmit interrupts when the FIFO is nearly
+	empty, so each interrupt can refill it in one burst. */
+	*UARTIFLS(ulBase) = UART_IFLS( UART_IFLS_1_2, UART_IFLS_1_8 );
+	*UARTICR(ulBase) = UART_INT_STATUS_ALL;	/* Clear all Iterrupts. */
 
 #if UART_USE_INTERRUPT
-	*UARTIMSC(ulBase) = UART_INT_STATUS_TX | UART_INT_STATUS_RX;
-	vPortInstallInterruptHandler( vUARTInterruptHandler, (void *)ulBase, ulVectorID, pdFALSE, configMAX_SYSCALL_INTERRUPT_PRIORITY, 1 );
+	/* Transmit interrupts are only enabled while there is something to send. */
+	*UARTIMSC(ulBase) = UART_INT_STATUS_RX | UART_INT_STATUS_RT | UART_INT_STATUS_ERRORS;
+	vPortInstallInterruptHandler( vUARTInterruptHandler, (void *)pxPort, ulUARTVectors[ ulUARTPeripheral ], pdFALSE, configMAX_SYSCALL_INTERRUPT_PRIORITY, 1 << portCORE_ID() );
+#else
+	*UARTIMSC(ulBase) = 0;
 #endif /* UART_USE_INTERRUPT */
 
 	/* Finally enable the peripheral. */
-	*UARTCR(ulBase) = ( 1 << 9 ) | ( 1 << 8 ) | /* Loopback Enable ( 1 << 7 ) | */ ( 1 << 0 );
+	*UARTCR(ulBase) = UART_CR_RXE | UART_CR_TXE | UART_CR_UARTEN;
 }
 /*----------------------------------------------------------------------------*/
 
-portBASE_TYPE xUARTSendCharacter( unsigned long ulUARTPeripheral, signed char cChar, portTickType xDelay )
+void vUARTSetReceiveHook( unsigned long ulUARTPeripheral, pdUART_RX_HOOK pxHook, void *pvContext )
 {
-unsigned long ulBase = 0;
-portBASE_TYPE xReturn = pdFALSE;
 #if UART_USE_INTERRUPT
-xQueueHandle xTxQueue = NULL;
-unsigned char ucStatus = 0;
-#endif	/* UART_USE_INTERRUPT */
-
-	switch ( ulUARTPeripheral )
-	{
-	case 0:
-		ulBase = UART0_BASE;
-		#if UART_USE_INTERRUPT
-		xTxQueue = xUartQueues[0][TX_QUEUE];
-		#endif
-		break;
-	case 1:
-		ulBase = UART1_BASE;
-		#if UART_USE_INTERRUPT
-		xTxQueue = xUartQueues[1][TX_QUEUE];
-		#endif
-		break;
-	case 2:
-		ulBase = UART2_BASE;
-		#if UART_USE_INTERRUPT
-		xTxQueue = xUartQueues[2][TX_QUEUE];
-		#endif
-		break;
-	case 3:
-		ulBase = UART3_BASE;
-		#if UART_USE_INTERRUPT
-		xTxQueue = xUartQueues[3][TX_QUEUE];
-		#endif
-		break;
-	}
-
-	if ( 0 != ulBase )
+unsigned long ulMask;
+
+	if ( ulUARTPeripheral < UART_MAX_PORTS )
+	{
+		/* The interrupt must not see the hook without its context. */
+		ulMask = portSET_INTERRUPT_MASK_FROM_ISR();
+		{
+			xUARTPorts[ ulUARTPeripheral ].pvRxHookContext = pvContext;
+			xUARTPorts[ ulUARTPeripheral ].pxRxHook = pxHook;
+		}
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( ulMask );
+	}
+#else
+	( void ) ulUARTPeripheral;
+	( void ) pxHook;
+	( void ) pvContext;
+#endif /* UART_USE_INTERRUPT */
+}
+/*----------------------------------------------------------------------------*/
+
+void vUARTSetLoopback( unsigned long ulUARTPeripheral, portBASE_TYPE xEnable )
+{
+unsigned long ulBase;
+
+	if ( ulUARTPeripheral < UART_MAX_PORTS )
 	{
+		ulBase = ulUARTBases[ ulUARTPeripheral ];
+
+		/* The control register must only be changed while the UART is
+		disabled. */
+		*UARTCR(ulBase) &= ~UART_CR_UARTEN;
+
+		if ( pdFALSE != xEnable )
+		{
+			*UARTCR(ulBase) |= UART_CR_LBE;
+		}
+		else
+		{
+			*UARTCR(ulBase) &= ~UART_CR_LBE;
+		}
+
+		*UARTCR(ulBase) |= UART_CR_UARTEN;
+	}
+}
+/*----------------------------------------------------------------------------*/
+
 #if UART_USE_INTERRUPT
-		xReturn = xQueueSend( xTxQueue, &cChar, xDelay );
-		taskENTER_CRITICAL();
-			ucStatus = *UARTFR(ulBase);
-		taskEXIT_CRITICAL();
 
-		if ( ucStatus & UART_FLAG_TXFE )
+static unsigned long prvUARTWrite( xUARTPort *pxPort, const unsigned char *pucBuffer, unsigned long ulLength, portTickType xDelay )
+{
+unsigned long ulSent = 0UL, ulMask;
+portBASE_TYPE xWaited = pdFALSE, xDropped = pdFALSE;
+xTimeOutType xTimeOut;
+portTickType xTicksToWait = xDelay;
+
+	vTaskSetTimeOutState( &xTimeOut );
+
+	for( ;; )
+	{
+		ulMask = portSET_INTERRUPT_MASK_FROM_ISR();
+		{
+			if( ( pxPort->xTx.ulCount >= pxPort->xTx.ulSize ) && ( ( 0 == xDelay ) || ( pdFALSE == prvUARTCanBlock() ) ) )
+			{
+#if UART_USE_DMA
+				if( pdFALSE != pxPort->xTxDMAActive )
+				{
+					/* A DMA transfer owns the FIFO and the ring cannot drain
+					until it ends, so what does not fit is dropped. */
+					xDropped = pdTRUE;
+				}
+				else
+#endif /* UART_USE_DMA */
+				{
+					/* The caller cannot wait for the interrupt to make room -
+					it may be an interrupt itself, or the scheduler may not be
+					running - so make room by hand as the polled driver
+					would. */
+					while ( *UARTFR( pxPort->ulBase ) & UART_FLAG_TXFF );
+					( void ) prvUARTFillFIFO( pxPort );
+				}
+			}
+
+			ulSent += prvRingWrite( &( pxPort->xTx ), pucBuffer + ulSent, ulLength - ulSent );
+			prvUARTStartTx( pxPort );
+
+			if( pdFALSE != xDropped )
+			{
+				pxPort->xStats.ulTxDropped += ulLength - ulSent;
+			}
+		}
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( ulMask );
+
+		if( ulSent >= ulLength )
+		{
+			if( ( pdFALSE != xWaited ) && ( pxPort->xTx.ulCount < pxPort->xTx.ulSize ) )
+			{
+				/* The semaphore only wakes one task, so pass the wake up on
+				to any other task waiting for room. */
+				( void ) xSemaphoreGive( pxPort->xTx.xEvent );
+			}
+			break;
+		}
+
+		if( pdFALSE != xDropped )
+		{
+			break;
+		}
+
+		if( ( 0 == xDelay ) || ( pdFALSE == prvUARTCanBlock() ) )
+		{
+			/* Keep making room by hand until everything is queued. */
+			continue;
+		}
+
+		/* Wait for the interrupt to drain some of the ring, for no longer
+		than is left of the caller's delay in total. */
+		if( ( pdFALSE != xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) ) || ( pdTRUE != xSemaphoreTake( pxPort->xTx.xEvent, xTicksToWait ) ) )
+		{
+			break;
+		}
+		xWaited = pdTRUE;
+	}
+
+	return ulSent;
+}
+/*----------------------------------------------------------------------------*/
+
+static unsigned long prvUARTRead( xUARTPort *pxPort, unsigned char *pucBuffer, unsigned long ulLength, portTickType xDelay )
+{
+unsigned long ulReceived = 0UL, ulMask;
+portBASE_TYPE xWaited = pdFALSE;
+xTimeOutType xTimeOut;
+portTickType xTicksToWait = xDelay;
+
+	vTaskSetTimeOutState( &xTimeOut );
+
+	for( ;; )
+	{
+		ulMask = portSET_INTERRUPT_MASK_FROM_ISR();
 		{
-			/* Need to kick of the Tx. */
-			(void)xQueueReceive( xTxQueue, &cChar, 0 );
-			*UARTDR(ulBase) = cChar;
-			xReturn = pdTRUE;
+			ulReceived += prvRingRead( &( pxPort->xRx ), pucBuffer + ulReceived, ulLength - ulReceived );
 		}
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( ulMask );
+
+		if( ( ulReceived >= ulLength ) && ( pdFALSE != xWaited ) && ( pxPort->xRx.ulCount > 0UL ) )
+		{
+			/* Pass the wake up on to any other task waiting for a byte. */
+			( void ) xSemaphoreGive( pxPort->xRx.xEvent );
+		}
+
+		if( ( ulReceived >= ulLength ) || ( 0 == xDelay ) || ( pdFALSE == prvUARTCanBlock() ) )
+		{
+			break;
+		}
+
+		/* Wait for the interrupt to deliver more. */
+		if( ( pdFALSE != xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) ) || ( pdTRUE != xSemaphoreTake( pxPort->xRx.xEvent, xTicksToWait ) ) )
+		{
+			break;
+		}
+		xWaited = pdTRUE;
+	}
+
+	return ulReceived;
+}
+/*----------------------------------------------------------------------------*/
+
 #else
-		while ( !(*UARTFR(ulBase) & UART_FLAG_TXFE) );
-		*UARTDR(ulBase) = cChar;
-		xReturn = pdTRUE;
-#endif	/* UART_USE_INTERRUPT */
+
+static unsigned long prvUARTWrite( xUARTPort *pxPort, const unsigned char *pucBuffer, unsigned long ulLength, portTickType xDelay )
+{
+unsigned long ulSent;
+
+	( void ) xDelay;
+
+	for( ulSent = 0UL; ulSent < ulLength; ulSent++ )
+	{
+		while ( !(*UARTFR( pxPort->ulBase ) & UART_FLAG_TXFE) );
+		*UARTDR( pxPort->ulBase ) = pucBuffer[ ulSent ];
 	}
-	return xReturn;
+
+	pxPort->xStats.ulTxBytes += ulLength;
+	return ulLength;
+}
+/*----------------------------------------------------------------------------*/
+
+static unsigned long prvUARTRead( xUARTPort *pxPort, unsigned char *pucBuffer, unsigned long ulLength, portTickType xDelay )
+{
+unsigned long ulReceived = 0UL;
+unsigned short usData;
+
+	( void ) xDelay;
+
+	/* Take what the FIFO holds, without waiting for more. */
+	while ( ( ulReceived < ulLength ) && ( ( *UARTFR( pxPort->ulBase ) & UART_FLAG_RXFE ) == 0 ) )
+	{
+		usData = *UARTDR_STATUS( pxPort->ulBase );
+
+		if ( pdFALSE != prvUARTReceiveByte( pxPort, usData ) )
+		{
+			pucBuffer[ ulReceived++ ] = ( unsigned char ) ( usData & UART_DR_DATA_MASK );
+		}
+	}
+
+	return ulReceived;
+}
+/*----------------------------------------------------------------------------*/
+
+#endif /* UART_USE_INTERRUPT */
+
+portBASE_TYPE xUARTSendCharacter( unsigned long ulUARTPeripheral, signed char cChar, portTickType xDelay )
+{
+unsigned char ucChar = ( unsigned char ) cChar;
+
+	return ( 1UL == ulUARTWrite( ulUARTPeripheral, &ucChar, 1UL, xDelay ) ) ? pdTRUE : pdFALSE;
 }
 /*----------------------------------------------------------------------------*/
 
 portBASE_TYPE xUARTReceiveCharacter( unsigned long ulUARTPeripheral, signed char *pcChar, portTickType xDelay )
 {
-unsigned long ulBase = 0;
-portBASE_TYPE xReturn = pdFALSE;
-#if UART_USE_INTERRUPT
-xQueueHandle xRxQueue = NULL;
-#endif
+	return ( 1UL == ulUARTRead( ulUARTPeripheral, ( unsigned char * ) pcChar, 1UL, xDelay ) ) ? pdTRUE : pdFALSE;
+}
+/*----------------------------------------------------------------------------*/
 
-	switch ( ulUARTPeripheral )
-	{
-	case 0:
-		ulBase = UART0_BASE;
-		#if UART_USE_INTERRUPT
-		xRxQueue = xUartQueues[0][RX_QUEUE];
-		#endif
-		break;
-	case 1:
-		ulBase = UART1_BASE;
-		#if UART_USE_INTERRUPT
-		xRxQueue = xUartQueues[1][RX_QUEUE];
-		#endif
-		break;
-	case 2:
-		ulBase = UART2_BASE;
-		#if UART_USE_INTERRUPT
-		xRxQueue = xUartQueues[2][RX_QUEUE];
-		#endif
-		break;
-	case 3:
-		ulBase = UART3_BASE;
-		#if UART_USE_INTERRUPT
-		xRxQueue = xUartQueues[3][RX_QUEUE];
-		#endif
-		break;
-	}
-
-	if ( 0 != ulBase )
+unsigned long ulUARTWrite( unsigned long ulUARTPeripheral, const unsigned char *pucBuffer, unsigned long ulLength, portTickType xDelay )
+{
+	if ( ( ulUARTPeripheral >= UART_MAX_PORTS ) || ( 0UL == xUARTPorts[ ulUARTPeripheral ].ulBase ) )
 	{
-#if UART_USE_INTERRUPT
-		xReturn = xQueueReceive( xRxQueue, pcChar, xDelay );
-#else
-		if ( ( *UARTFR(ulBase) & UART_FLAG_RXFE ) == 0 )
+		return 0UL;
+	}
+
+	return prvUARTWrite( &( xUARTPorts[ ulUARTPeripheral ] ), pucBuffer, ulLength, xDelay );
+}
+/*----------------------------------------------------------------------------*/
+
+unsigned long ulUARTRead( unsigned long ulUARTPeripheral, unsigned char *pucBuffer, unsigned long ulLength, portTickType xDelay )
+{
+	if ( ( ulUARTPeripheral >= UART_MAX_PORTS ) || ( 0UL == xUARTPorts[ ulUARTPeripheral ].ulBase ) )
+	{
+		return 0UL;
+	}
+
+	return prvUARTRead( &( xUARTPorts[ ulUARTPeripheral ] ), pucBuffer, ulLength, xDelay );
+}
+/*----------------------------------------------------------------------------*/
+
+unsigned long ulUARTSendBuffer( unsigned long ulUARTPeripheral, const unsigned char *pucBuffer, unsigned long ulLength, portTickType xDelay )
+{
+unsigned long ulSent = 0UL;
+#if UART_USE_DMA
+xUARTPort *pxPort;
+#endif /* UART_USE_DMA */
+
+	if ( ( ulUARTPeripheral >= UART_MAX_PORTS ) || ( 0UL == xUARTPorts[ ulUARTPeripheral ].ulBase ) )
+	{
+		return 0UL;
+	}
+
+#if UART_USE_DMA
+	pxPort = &( xUARTPorts[ ulUARTPeripheral ] );
+
+	/* DMA needs a task that can block until the transfer completes. */
+	if ( ( ulLength >= UART_DMA_MIN_BYTES ) && ( pdFALSE == pxPort->xTxDMAStalled ) && ( pdFALSE != prvUARTCanBlock() ) && ( pdFALSE != prvUARTDMAPrepare( pxPort ) ) )
+	{
+		if ( pdTRUE == xSemaphoreTake( pxPort->xTxDMALock, xDelay ) )
 		{
-			*pcChar = *UARTDR(ulBase);
-			xReturn = pdTRUE;
+			ulSent = prvUARTDMASend( pxPort, pucBuffer, ulLength );
+			( void ) xSemaphoreGive( pxPort->xTxDMALock );
 		}
+
+		/* After a stall the rest goes through the ring, as does everything
+		sent from now on. */
+		if ( pdFALSE == pxPort->xTxDMAStalled )
+		{
+			return ulSent;
+		}
+	}
+#endif /* UART_USE_DMA */
+
+	ulSent += ulUARTWrite( ulUARTPeripheral, pucBuffer + ulSent, ulLength - ulSent, xDelay );
+
+	return ulSent;
+}
+/*----------------------------------------------------------------------------*/
+
+xAIODevice *pxUARTGetAIOTransmitter( unsigned long ulUARTPeripheral )
+{
+#if UART_USE_INTERRUPT
+	if ( ( ulUARTPeripheral < UART_MAX_PORTS ) && ( 0UL != xUARTPorts[ ulUARTPeripheral ].ulBase ) )
+	{
+		return &( xUARTPorts[ ulUARTPeripheral ].xTxAIO );
+	}
+#else
+	( void ) ulUARTPeripheral;
 #endif /* UART_USE_INTERRUPT */
+
+	return NULL;
+}
+/*----------------------------------------------------------------------------*/
+
+xAIODevice *pxUARTGetAIOReceiver( unsigned long ulUARTPeripheral )
+{
+#if UART_USE_INTERRUPT
+	if ( ( ulUARTPeripheral < UART_MAX_PORTS ) && ( 0UL != xUARTPorts[ ulUARTPeripheral ].ulBase ) )
+	{
+		return &( xUARTPorts[ ulUARTPeripheral ].xRxAIO );
 	}
+#else
+	( void ) ulUARTPeripheral;
+#endif /* UART_USE_INTERRUPT */
 
-	return xReturn;
+	return NULL;
 }
 /*----------------------------------------------------------------------------*/
 
-#endif /* configPLATFORM == 0 */
+void vUARTGetStats( unsigned long ulUARTPeripheral, xUARTStats *pxStats )
+{
+unsigned long ulMask;
 
+	if ( ulUARTPeripheral < UART_MAX_PORTS )
+	{
+		/* Take a consistent copy of the counters. */
+		ulMask = portSET_INTERRUPT_MASK_FROM_ISR();
+		{
+			*pxStats = xUARTPorts[ ulUARTPeripheral ].xStats;
+		}
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( ulMask );
+	}
+}
+/*----------------------------------------------------------------------------*/
+
+#endif /* configPLATFORM == 0 */
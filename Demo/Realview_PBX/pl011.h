@@ -0,0 +1,162 @@
+/*
+    FreeRTOS V7.0.1 - Copyright (C) 2011 Real Time Engineers Ltd.
+
+
+	FreeRTOS supports many tools and architectures. V7.0.0 is sponsored by:
+	Atollic AB - Atollic provides professional embedded systems development
+	tools for C/C++ development, code analysis and test automation.
+	See http://www.atollic.com
+
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS tutorial books are available in pdf and paperback.        *
+     *    Complete, revised, and edited pdf reference manuals are also       *
+     *    available.                                                         *
+     *                                                                       *
+     *    Purchasing FreeRTOS documentation will not only help you, by       *
+     *    ensuring you get running as quickly as possible and with an        *
+     *    in-depth knowledge of how to use FreeRTOS, it will also help       *
+     *    the FreeRTOS project to continue with its mission of providing     *
+     *    professional grade, cross platform, de facto standard solutions    *
+     *    for microcontrollers - completely free of charge!                  *
+     *                                                                       *
+     *    >>> See http://www.FreeRTOS.org/Documentation for details. <<<     *
+     *                                                                       *
+     *    Thank you for using FreeRTOS, and thank you for your support!      *
+     *                                                                       *
+    ***************************************************************************
+
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation AND MODIFIED BY the FreeRTOS exception.
+    >>>NOTE<<< The modification to the GPL is included to allow you to
+    distribute a combined work that includes FreeRTOS without being obliged to
+    provide the source code for proprietary components outside of the FreeRTOS
+    kernel.  FreeRTOS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details. You should have received a copy of the GNU General Public
+    License and the FreeRTOS license exception along with FreeRTOS; if not it
+    can be viewed here: http://www.freertos.org/a00114.html and also obtained
+    by writing to Richard Barry, contact details for whom are available on the
+    FreeRTOS WEB site.
+
+    1 tab == 4 spaces!
+
+    http://www.FreeRTOS.org - Documentation, latest information, license and
+    contact details.
+
+    http://www.SafeRTOS.com - A version that is certified for use in safety
+    critical systems.
+
+    http://www.OpenRTOS.com - Commercial support, development, porting,
+    licensing and training services.
+*/
+
+#ifndef PL011_H
+#define PL011_H
+
+#include "aio.h"
+
+/* Interrupt driven driver for the PL011 UART.  Each port has a transmit and a
+receive ring buffer of the size given to vUARTInitialise(), filled and drained
+by the UART interrupt a FIFO burst at a time. */
+
+/* Counters kept per port by the driver. */
+typedef struct UART_STATISTICS
+{
+	unsigned long ulTxBytes;		/* Bytes written to the transmit FIFO. */
+	unsigned long ulRxBytes;		/* Good bytes read from the receive FIFO. */
+	unsigned long ulTxInterrupts;
+	unsigned long ulRxInterrupts;	/* Receive, receive timeout and error interrupts. */
+	unsigned long ulOverrunErrors;
+	unsigned long ulBreakErrors;
+	unsigned long ulParityErrors;
+	unsigned long ulFramingErrors;
+	unsigned long ulRxDropped;		/* Good bytes lost because the receive ring was full. */
+	unsigned long ulTxDMATransfers;	/* Descriptor chains completed by the DMA controller. */
+	unsigned long ulTxDMATimeouts;	/* Chains stopped for taking too long, after which the port stops using DMA. */
+	unsigned long ulTxDropped;		/* Bytes dropped by writers that could not wait while a DMA transfer owned the transmit FIFO. */
+} xUARTStats;
+
+/* Called from the UART interrupt with the good bytes read from the receive
+FIFO, at most a FIFO full at a time, in place of putting them in the receive
+ring. */
+typedef void ( *pdUART_RX_HOOK )( void *pvContext, const unsigned char *pucBytes, unsigned long ulLength, portBASE_TYPE *pxHigherPriorityTaskWoken );
+
+/*
+ * Configure the UART for 8N1 at ulBaud with the FIFOs enabled, and install its
+ * interrupt handler.  ulQueueSize is the size in bytes of each ring buffer.
+ */
+void vUARTInitialise( unsigned long ulUARTPeripheral, unsigned long ulBaud, unsigned long ulQueueSize );
+
+/*
+ * Queue one byte for transmission, waiting up to xDelay ticks for room in the
+ * transmit ring.  With a delay of 0, or when the scheduler is not running, a
+ * full ring is emptied into the FIFO by polling instead, so the byte is never
+ * lost.  Only a delay of 0 may be used from an interrupt.
+ */
+portBASE_TYPE xUARTSendCharacter( unsigned long ulUARTPeripheral, signed char cChar, portTickType xDelay );
+
+/*
+ * Copy up to ulLength bytes into the transmit ring, blocking for up to xDelay
+ * ticks in total while it is full, and return the number copied.  As with
+ * xUARTSendCharacter(), a delay of 0 polls rather than giving up.
+ */
+unsigned long ulUARTWrite( unsigned long ulUARTPeripheral, const unsigned char *pucBuffer, unsigned long ulLength, portTickType xDelay );
+
+/*
+ * Copy up to ulLength received bytes into pucBuffer, blocking for up to xDelay
+ * ticks in total until that many have arrived, and return the number copied.
+ * A delay of 0 takes only what is already in the receive ring.
+ */
+unsigned long ulUARTRead( unsigned long ulUARTPeripheral, unsigned char *pucBuffer, unsigned long ulLength, portTickType xDelay );
+
+/*
+ * Send ulLength bytes from pucBuffer, returning the number sent.  Long buffers
+ * are handed to the DMA controller and the calling task blocks until they have
+ * been transmitted, waiting up to xDelay ticks for any other DMA transfer on
+ * the port to finish first.  Short buffers, or calls made before the scheduler
+ * starts, go through the transmit ring as ulUARTWrite() does.
+ */
+unsigned long ulUARTSendBuffer( unsigned long ulUARTPeripheral, const unsigned char *pucBuffer, unsigned long ulLength, portTickType xDelay );
+
+/*
+ * Take one received byte, waiting up to xDelay ticks for one to arrive.
+ */
+portBASE_TYPE xUARTReceiveCharacter( unsigned long ulUARTPeripheral, signed char *pcChar, portTickType xDelay );
+
+/*
+ * Hand received bytes to pxHook, called with pvContext, instead of the receive
+ * ring, or back to the ring if pxHook is NULL.  Needs the interrupt driven
+ * driver.
+ */
+void vUARTSetReceiveHook( unsigned long ulUARTPeripheral, pdUART_RX_HOOK pxHook, void *pvContext );
+
+/*
+ * Route the transmitter back into the receiver, for testing without a cable.
+ */
+void vUARTSetLoopback( unsigned long ulUARTPeripheral, portBASE_TYPE xEnable );
+
+/*
+ * The asynchronous transmitter and receiver of a port (see aio.h), or NULL
+ * if the port is not initialised.  A write request sends ulLength bytes from
+ * pucBuffer after whatever is in the transmit ring, and completes once the
+ * last of them is in the FIFO.  A read request fills pucBuffer with ulLength
+ * bytes received once it is at the head of the queue, ahead of the receive
+ * hook and ring; with aioFLAG_PARTIAL it also completes when the line goes
+ * quiet.  Needs the interrupt driven driver.
+ */
+xAIODevice *pxUARTGetAIOTransmitter( unsigned long ulUARTPeripheral );
+xAIODevice *pxUARTGetAIOReceiver( unsigned long ulUARTPeripheral );
+
+/*
+ * Copy the counters of a port into *pxStats.
+ */
+void vUARTGetStats( unsigned long ulUARTPeripheral, xUARTStats *pxStats );
+
+#endif /* PL011_H */
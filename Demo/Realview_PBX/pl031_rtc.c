@@ -58,6 +58,9 @@
 */
 
 #include "FreeRTOS.h"
+
+#include "aio.h"
+#include "pl031_rtc.h"
 /*----------------------------------------------------------------------------*/
 
 #define RTC_BASE			( 0x10017000 )
@@ -69,6 +72,18 @@
 #define RTCRIS				( (unsigned portBASE_TYPE * volatile )( RTC_BASE + 0x014 ) )	/* Raw interrupt status Register */
 #define RTCMIS				( (unsigned portBASE_TYPE * volatile )( RTC_BASE + 0x018 ) )	/* Masked interrupt status Register */
 #define RTCICR				( (unsigned portBASE_TYPE * volatile )( RTC_BASE + 0x01C ) )	/* Interrupt clear Register */
+#define RTC_VECTOR_ID		( 42 )
+/*----------------------------------------------------------------------------*/
+
+static xAIODevice xRTCAlarmAIO;
+static portBASE_TYPE xRTCAlarmInstalled = pdFALSE;
+
+/*
+ * Set the match register for the request at the head, or stop matching when
+ * it is cancelled.
+ */
+static void prvRTCAlarmStart( xAIODevice *pxDevice, xAIORequest *pxRequest, portBASE_TYPE *pxHigherPriorityTaskWoken );
+static void prvRTCAlarmStop( xAIODevice *pxDevice, xAIORequest *pxRequest );
 /*----------------------------------------------------------------------------*/
 
 void vRTCInitialise( void )
@@ -99,3 +114,74 @@ void vRTCAcknowledgeInterrupt( unsigned long ulOffset )
 #endif /* configUSE_PREEMPTION */
 }
 /*----------------------------------------------------------------------------*/
+
+xAIODevice *pxRTCAlarmInitialise( void )
+{
+extern void vPortInstallInterruptHandler( void (*vHandler)(void *), void *pvParameter, unsigned long ulVector, unsigned char ucEdgeTriggered, unsigned char ucPriority, unsigned char ucProcessorTargets );
+
+	if ( pdFALSE == xRTCAlarmInstalled )
+	{
+		*RTCIMSC = 0;
+		*RTCICR = 1;
+		*RTCCR = 1;
+
+		vAIODeviceInitialise( &xRTCAlarmAIO, prvRTCAlarmStart, prvRTCAlarmStop, NULL );
+		vPortInstallInterruptHandler( vRTCAlarmInterruptHandler, NULL, RTC_VECTOR_ID, pdFALSE, configMAX_SYSCALL_INTERRUPT_PRIORITY, 1 << portCORE_ID() );
+		xRTCAlarmInstalled = pdTRUE;
+	}
+
+	return &xRTCAlarmAIO;
+}
+/*----------------------------------------------------------------------------*/
+
+void vRTCAlarmInterruptHandler( void *pvParameter )
+{
+xAIORequest *pxRequest;
+portBASE_TYPE xTaskWoken = pdFALSE;
+
+	( void ) pvParameter;
+
+	*RTCICR = 1;
+
+	pxRequest = pxAIOActive( &xRTCAlarmAIO );
+	if ( NULL != pxRequest )
+	{
+		pxRequest->ulDone = pxRequest->ulLength;
+		pxRequest = pxAIOComplete( &xRTCAlarmAIO, aioDONE, &xTaskWoken );
+	}
+
+	if ( NULL != pxRequest )
+	{
+		prvRTCAlarmStart( &xRTCAlarmAIO, pxRequest, &xTaskWoken );
+	}
+	else
+	{
+		*RTCIMSC = 0;
+	}
+
+	portEND_SWITCHING_ISR( xTaskWoken );
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvRTCAlarmStart( xAIODevice *pxDevice, xAIORequest *pxRequest, portBASE_TYPE *pxHigherPriorityTaskWoken )
+{
+	( void ) pxDevice;
+	( void ) pxHigherPriorityTaskWoken;
+
+	/* The alarm goes off when the counter reaches the match value, so a
+	request for 0 seconds waits for the next tick of the counter. */
+	*RTCMR = *RTCDR + ( ( 0UL != pxRequest->ulLength ) ? pxRequest->ulLength : 1UL );
+	*RTCICR = 1;
+	*RTCIMSC = 1;
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvRTCAlarmStop( xAIODevice *pxDevice, xAIORequest *pxRequest )
+{
+	( void ) pxDevice;
+	( void ) pxRequest;
+
+	*RTCIMSC = 0;
+	*RTCICR = 1;
+}
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,312 @@
+/*
+    FreeRTOS V7.0.1 - Copyright (C) 2011 Real Time Engineers Ltd.
+
+
+	FreeRTOS supports many tools and architectures. V7.0.0 is sponsored by:
+	Atollic AB - Atollic provides professional embedded systems development
+	tools for C/C++ development, code analysis and test automation.
+	See http://www.atollic.com
+
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS tutorial books are available in pdf and paperback.        *
+     *    Complete, revised, and edited pdf reference manuals are also       *
+     *    available.                                                         *
+     *                                                                       *
+     *    Purchasing FreeRTOS documentation will not only help you, by       *
+     *    ensuring you get running as quickly as possible and with an        *
+     *    in-depth knowledge of how to use FreeRTOS, it will also help       *
+     *    the FreeRTOS project to continue with its mission of providing     *
+     *    professional grade, cross platform, de facto standard solutions    *
+     *    for microcontrollers - completely free of charge!                  *
+     *                                                                       *
+     *    >>> See http://www.FreeRTOS.org/Documentation for details. <<<     *
+     *                                                                       *
+     *    Thank you for using FreeRTOS, and thank you for your support!      *
+     *                                                                       *
+    ***************************************************************************
+
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation AND MODIFIED BY the FreeRTOS exception.
+    >>>NOTE<<< The modification to the GPL is included to allow you to
+    distribute a combined work that includes FreeRTOS without being obliged to
+    provide the source code for proprietary components outside of the FreeRTOS
+    kernel.  FreeRTOS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details. You should have received a copy of the GNU General Public
+    License and the FreeRTOS license exception along with FreeRTOS; if not it
+    can be viewed here: http://www.freertos.org/a00114.html and also obtained
+    by writing to Richard Barry, contact details for whom are available on the
+    FreeRTOS WEB site.
+
+    1 tab == 4 spaces!
+
+    http://www.FreeRTOS.org - Documentation, latest information, license and
+    contact details.
+
+    http://www.SafeRTOS.com - A version that is certified for use in safety
+    critical systems.
+
+    http://www.OpenRTOS.com - Commercial support, development, porting,
+    licensing and training services.
+*/
+
+/* DMA Driver for the PL081 Peripheral. */
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "pl081_dma.h"
+/*----------------------------------------------------------------------------*/
+
+#define DMAC_BASE				( 0x10030000UL )		/* Realview PBX Cortex-A9. */
+#define DMAC_VECTOR_ID			( 56 )
+
+#define DMACIntStatus(x)		( (volatile unsigned long *)( (x) + 0x000UL ) )	/* Interrupt Status Register */
+#define DMACIntTCStatus(x)		( (volatile unsigned long *)( (x) + 0x004UL ) )	/* Interrupt Terminal Count Status Register */
+#define DMACIntTCClear(x)		( (volatile unsigned long *)( (x) + 0x008UL ) )	/* Interrupt Terminal Count Clear Register */
+#define DMACIntErrorStatus(x)	( (volatile unsigned long *)( (x) + 0x00CUL ) )	/* Interrupt Error Status Register */
+#define DMACIntErrClr(x)		( (volatile unsigned long *)( (x) + 0x010UL ) )	/* Interrupt Error Clear Register */
+#define DMACEnbldChns(x)		( (volatile unsigned long *)( (x) + 0x01CUL ) )	/* Enabled Channel Register */
+#define DMACConfiguration(x)	( (volatile unsigned long *)( (x) + 0x030UL ) )	/* Configuration Register */
+
+#define DMACCxSrcAddr(x,n)		( (volatile unsigned long *)( (x) + 0x100UL + ( (n) * 0x20UL ) ) )	/* Channel Source Address Register */
+#define DMACCxDestAddr(x,n)		( (volatile unsigned long *)( (x) + 0x104UL + ( (n) * 0x20UL ) ) )	/* Channel Destination Address Register */
+#define DMACCxLLI(x,n)			( (volatile unsigned long *)( (x) + 0x108UL + ( (n) * 0x20UL ) ) )	/* Channel Linked List Item Register */
+#define DMACCxControl(x,n)		( (volatile unsigned long *)( (x) + 0x10CUL + ( (n) * 0x20UL ) ) )	/* Channel Control Register */
+#define DMACCxConfiguration(x,n)	( (volatile unsigned long *)( (x) + 0x110UL + ( (n) * 0x20UL ) ) )	/* Channel Configuration Register */
+
+#define DMAC_CONFIG_ENABLE		( 1UL << 0 )
+
+#define DMAC_CHANNEL_ENABLE		( 1UL << 0 )
+#define DMAC_CHANNEL_IE			( 1UL << 14 )		/* Unmask the error interrupt. */
+#define DMAC_CHANNEL_ITC		( 1UL << 15 )		/* Unmask the terminal count interrupt. */
+#define DMAC_CHANNEL_ACTIVE		( 1UL << 17 )
+#define DMAC_CHANNEL_HALT		( 1UL << 18 )
+/*----------------------------------------------------------------------------*/
+
+typedef struct DMA_CHANNEL
+{
+	unsigned long ulChannel;
+	portBASE_TYPE xAllocated;
+	pdDMA_CALLBACK pxCallback;
+	void *pvContext;
+} xDMAChannel;
+
+static xDMAChannel xDMAChannels[ dmaNUM_CHANNELS ];
+static portBASE_TYPE xDMAInitialised = pdFALSE;
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Enable the controller and install its interrupt handler.
+ */
+static void prvDMAInitialise( void );
+
+/*
+ * Reports completed and failed chains to their channel's callback.
+ */
+void vDMAInterruptHandler( void *pvParameter );
+/*----------------------------------------------------------------------------*/
+
+static void prvDMAInitialise( void )
+{
+extern void vPortInstallInterruptHandler( void (*vHandler)(void *), void *pvParameter, unsigned long ulVector, unsigned char ucEdgeTriggered, unsigned char ucPriority, unsigned char ucProcessorTargets );
+unsigned long ulChannel;
+
+	for( ulChannel = 0UL; ulChannel < dmaNUM_CHANNELS; ulChannel++ )
+	{
+		xDMAChannels[ ulChannel ].ulChannel = ulChannel;
+		*DMACCxConfiguration( DMAC_BASE, ulChannel ) = 0UL;
+	}
+
+	*DMACIntTCClear( DMAC_BASE ) = ( 1UL << dmaNUM_CHANNELS ) - 1UL;
+	*DMACIntErrClr( DMAC_BASE ) = ( 1UL << dmaNUM_CHANNELS ) - 1UL;
+	*DMACConfiguration( DMAC_BASE ) = DMAC_CONFIG_ENABLE;
+
+	vPortInstallInterruptHandler( vDMAInterruptHandler, NULL, DMAC_VECTOR_ID, pdFALSE, configMAX_SYSCALL_INTERRUPT_PRIORITY, 1 << portCORE_ID() );
+}
+/*----------------------------------------------------------------------------*/
+
+void vDMAInterruptHandler( void *pvParameter )
+{
+unsigned long ulTC, ulError, ulChannel;
+portBASE_TYPE xTaskWoken = pdFALSE;
+xDMAChannel *pxChannel;
+
+	( void ) pvParameter;
+
+	ulTC = *DMACIntTCStatus( DMAC_BASE );
+	ulError = *DMACIntErrorStatus( DMAC_BASE );
+	*DMACIntTCClear( DMAC_BASE ) = ulTC;
+	*DMACIntErrClr( DMAC_BASE ) = ulError;
+
+	for( ulChannel = 0UL; ulChannel < dmaNUM_CHANNELS; ulChannel++ )
+	{
+		if( ( ulTC | ulError ) & ( 1UL << ulChannel ) )
+		{
+			pxChannel = &( xDMAChannels[ ulChannel ] );
+
+			/* An error stops the chain, but leaves the channel enabled. */
+			if( ulError & ( 1UL << ulChannel ) )
+			{
+				*DMACCxConfiguration( DMAC_BASE, ulChannel ) &= ~DMAC_CHANNEL_ENABLE;
+			}
+
+			if( NULL != pxChannel->pxCallback )
+			{
+				pxChannel->pxCallback( pxChannel->pvContext, ( ulError & ( 1UL << ulChannel ) ) ? pdTRUE : pdFALSE, &xTaskWoken );
+			}
+		}
+	}
+
+	portEND_SWITCHING_ISR( xTaskWoken );
+}
+/*----------------------------------------------------------------------------*/
+
+xDMAChannelHandle xDMAChannelAllocate( void )
+{
+xDMAChannel *pxReturn = NULL;
+unsigned long ulChannel;
+
+	taskENTER_CRITICAL();
+	{
+		if( pdFALSE == xDMAInitialised )
+		{
+			prvDMAInitialise();
+			xDMAInitialised = pdTRUE;
+		}
+
+		for( ulChannel = 0UL; ulChannel < dmaNUM_CHANNELS; ulChannel++ )
+		{
+			if( pdFALSE == xDMAChannels[ ulChannel ].xAllocated )
+			{
+				xDMAChannels[ ulChannel ].xAllocated = pdTRUE;
+				pxReturn = &( xDMAChannels[ ulChannel ] );
+				break;
+			}
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	return ( xDMAChannelHandle ) pxReturn;
+}
+/*----------------------------------------------------------------------------*/
+
+void vDMAChannelFree( xDMAChannelHandle xChannel )
+{
+xDMAChannel *pxChannel = ( xDMAChannel * ) xChannel;
+
+	if( NULL != pxChannel )
+	{
+		vDMAAbort( xChannel );
+		pxChannel->xAllocated = pdFALSE;
+	}
+}
+/*----------------------------------------------------------------------------*/
+
+unsigned portBASE_TYPE uxDMABuildChain( xDMADescriptor *pxDescriptors, unsigned portBASE_TYPE uxMaxDescriptors, unsigned long ulSource, unsigned long ulDestination, unsigned long ulLength, unsigned long ulControl )
+{
+unsigned long ulWidthBytes = 1UL << ( ( ulControl >> 18 ) & 0x07UL );
+unsigned long ulTransfers = ulLength / ulWidthBytes;
+unsigned long ulChunk;
+unsigned portBASE_TYPE uxUsed = 0U;
+
+	ulControl &= ~( dmaCONTROL_TRANSFER_MASK | dmaCONTROL_TC_INTERRUPT );
+
+	if( ( 0UL == ulTransfers ) || ( ( ( ulTransfers + dmaMAX_TRANSFERS - 1UL ) / dmaMAX_TRANSFERS ) > uxMaxDescriptors ) )
+	{
+		return 0U;
+	}
+
+	while( ulTransfers > 0UL )
+	{
+		ulChunk = ( ulTransfers > dmaMAX_TRANSFERS ) ? dmaMAX_TRANSFERS : ulTransfers;
+
+		pxDescriptors[ uxUsed ].ulSource = ulSource;
+		pxDescriptors[ uxUsed ].ulDestination = ulDestination;
+		pxDescriptors[ uxUsed ].ulControl = ulControl | ulChunk;
+		pxDescriptors[ uxUsed ].ulNext = ( unsigned long ) &( pxDescriptors[ uxUsed + 1U ] );
+
+		if( ulControl & dmaCONTROL_SI )
+		{
+			ulSource += ulChunk * ulWidthBytes;
+		}
+		if( ulControl & dmaCONTROL_DI )
+		{
+			ulDestination += ulChunk * ulWidthBytes;
+		}
+
+		ulTransfers -= ulChunk;
+		uxUsed++;
+	}
+
+	/* Only the end of the whole chain interrupts. */
+	pxDescriptors[ uxUsed - 1U ].ulNext = 0UL;
+	pxDescriptors[ uxUsed - 1U ].ulControl |= dmaCONTROL_TC_INTERRUPT;
+
+	return uxUsed;
+}
+/*----------------------------------------------------------------------------*/
+
+portBASE_TYPE xDMAStart( xDMAChannelHandle xChannel, const xDMADescriptor *pxFirst, unsigned long ulConfig, pdDMA_CALLBACK pxCallback, void *pvContext )
+{
+xDMAChannel *pxChannel = ( xDMAChannel * ) xChannel;
+unsigned long ulChannel;
+
+	if( ( NULL == pxChannel ) || ( NULL == pxFirst ) )
+	{
+		return pdFALSE;
+	}
+
+	ulChannel = pxChannel->ulChannel;
+
+	if( *DMACEnbldChns( DMAC_BASE ) & ( 1UL << ulChannel ) )
+	{
+		/* The previous transfer has not finished. */
+		return pdFALSE;
+	}
+
+	pxChannel->pxCallback = pxCallback;
+	pxChannel->pvContext = pvContext;
+
+	*DMACIntTCClear( DMAC_BASE ) = 1UL << ulChannel;
+	*DMACIntErrClr( DMAC_BASE ) = 1UL << ulChannel;
+
+	/* The channel registers take the first descriptor, and the controller
+	follows ulNext from there. */
+	*DMACCxSrcAddr( DMAC_BASE, ulChannel ) = pxFirst->ulSource;
+	*DMACCxDestAddr( DMAC_BASE, ulChannel ) = pxFirst->ulDestination;
+	*DMACCxLLI( DMAC_BASE, ulChannel ) = pxFirst->ulNext;
+	*DMACCxControl( DMAC_BASE, ulChannel ) = pxFirst->ulControl;
+	*DMACCxConfiguration( DMAC_BASE, ulChannel ) = ulConfig | DMAC_CHANNEL_IE | DMAC_CHANNEL_ITC | DMAC_CHANNEL_ENABLE;
+
+	return pdTRUE;
+}
+/*----------------------------------------------------------------------------*/
+
+void vDMAAbort( xDMAChannelHandle xChannel )
+{
+xDMAChannel *pxChannel = ( xDMAChannel * ) xChannel;
+unsigned long ulChannel;
+
+	if( NULL != pxChannel )
+	{
+		ulChannel = pxChannel->ulChannel;
+
+		/* Halt, let the FIFO drain, then disable. */
+		*DMACCxConfiguration( DMAC_BASE, ulChannel ) |= DMAC_CHANNEL_HALT;
+		while( *DMACCxConfiguration( DMAC_BASE, ulChannel ) & DMAC_CHANNEL_ACTIVE );
+		*DMACCxConfiguration( DMAC_BASE, ulChannel ) &= ~( DMAC_CHANNEL_ENABLE | DMAC_CHANNEL_HALT );
+
+		*DMACIntTCClear( DMAC_BASE ) = 1UL << ulChannel;
+		*DMACIntErrClr( DMAC_BASE ) = 1UL << ulChannel;
+		pxChannel->pxCallback = NULL;
+	}
+}
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,140 @@
+/*
+    FreeRTOS V7.0.1 - Copyright (C) 2011 Real Time Engineers Ltd.
+
+
+	FreeRTOS supports many tools and architectures. V7.0.0 is sponsored by:
+	Atollic AB - Atollic provides professional embedded systems development
+	tools for C/C++ development, code analysis and test automation.
+	See http://www.atollic.com
+
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS tutorial books are available in pdf and paperback.        *
+     *    Complete, revised, and edited pdf reference manuals are also       *
+     *    available.                                                         *
+     *                                                                       *
+     *    Purchasing FreeRTOS documentation will not only help you, by       *
+     *    ensuring you get running as quickly as possible and with an        *
+     *    in-depth knowledge of how to use FreeRTOS, it will also help       *
+     *    the FreeRTOS project to continue with its mission of providing     *
+     *    professional grade, cross platform, de facto standard solutions    *
+     *    for microcontrollers - completely free of charge!                  *
+     *                                                                       *
+     *    >>> See http://www.FreeRTOS.org/Documentation for details. <<<     *
+     *                                                                       *
+     *    Thank you for using FreeRTOS, and thank you for your support!      *
+     *                                                                       *
+    ***************************************************************************
+
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation AND MODIFIED BY the FreeRTOS exception.
+    >>>NOTE<<< The modification to the GPL is included to allow you to
+    distribute a combined work that includes FreeRTOS without being obliged to
+    provide the source code for proprietary components outside of the FreeRTOS
+    kernel.  FreeRTOS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details. You should have received a copy of the GNU General Public
+    License and the FreeRTOS license exception along with FreeRTOS; if not it
+    can be viewed here: http://www.freertos.org/a00114.html and also obtained
+    by writing to Richard Barry, contact details for whom are available on the
+    FreeRTOS WEB site.
+
+    1 tab == 4 spaces!
+
+    http://www.FreeRTOS.org - Documentation, latest information, license and
+    contact details.
+
+    http://www.SafeRTOS.com - A version that is certified for use in safety
+    critical systems.
+
+    http://www.OpenRTOS.com - Commercial support, development, porting,
+    licensing and training services.
+*/
+
+#ifndef PL081_DMA_H
+#define PL081_DMA_H
+
+/* Driver for the PL081 DMA controller of the Realview PBX-A9.  Channels are
+allocated to a driver, which then starts transfers described by chains of
+linked list descriptors and is called back from the DMA interrupt when each
+chain completes. */
+
+/* The number of channels of the PL081. */
+#define dmaNUM_CHANNELS				( 2UL )
+
+/* The most transfers one descriptor can move. */
+#define dmaMAX_TRANSFERS			( 4095UL )
+
+/* Fields of the descriptor control word. */
+#define dmaCONTROL_SBSIZE( x )		( ( ( unsigned long ) ( x ) ) << 12 )	/* Source burst, 0 = 1 transfer ... 7 = 256 transfers. */
+#define dmaCONTROL_DBSIZE( x )		( ( ( unsigned long ) ( x ) ) << 15 )	/* Destination burst. */
+#define dmaCONTROL_SWIDTH( x )		( ( ( unsigned long ) ( x ) ) << 18 )	/* Source width, 0 = byte, 1 = halfword, 2 = word. */
+#define dmaCONTROL_DWIDTH( x )		( ( ( unsigned long ) ( x ) ) << 21 )	/* Destination width. */
+#define dmaCONTROL_SI				( 1UL << 26 )		/* Increment the source address. */
+#define dmaCONTROL_DI				( 1UL << 27 )		/* Increment the destination address. */
+#define dmaCONTROL_TC_INTERRUPT		( 1UL << 31 )		/* Interrupt when this descriptor completes. */
+#define dmaCONTROL_TRANSFER_MASK	( 0xFFFUL )
+
+/* Fields of the channel configuration passed to xDMAStart(). */
+#define dmaCONFIG_SRC_PERIPHERAL( x )	( ( ( unsigned long ) ( x ) ) << 1 )
+#define dmaCONFIG_DEST_PERIPHERAL( x )	( ( ( unsigned long ) ( x ) ) << 6 )
+#define dmaCONFIG_MEM_TO_MEM			( 0UL << 11 )
+#define dmaCONFIG_MEM_TO_PERIPHERAL		( 1UL << 11 )
+#define dmaCONFIG_PERIPHERAL_TO_MEM		( 2UL << 11 )
+
+/* A linked list descriptor, laid out as the controller reads it.  Must be word
+aligned and visible to the controller, so either allocated from a
+portHEAP_ATTR_DMA region or cleaned from the cache before the transfer. */
+typedef struct DMA_DESCRIPTOR
+{
+	unsigned long ulSource;
+	unsigned long ulDestination;
+	unsigned long ulNext;			/* Address of the next descriptor, or 0 for the last. */
+	unsigned long ulControl;
+} xDMADescriptor;
+
+typedef void * xDMAChannelHandle;
+
+/* Called from the DMA interrupt when a chain completes, or stops on an error
+(xError is pdTRUE). */
+typedef void ( *pdDMA_CALLBACK )( void *pvContext, portBASE_TYPE xError, portBASE_TYPE *pxHigherPriorityTaskWoken );
+
+/*
+ * Claim a free channel, initialising the controller on first use.  Returns
+ * NULL if every channel is in use.
+ */
+xDMAChannelHandle xDMAChannelAllocate( void );
+
+/*
+ * Return a channel that has no transfer in progress.
+ */
+void vDMAChannelFree( xDMAChannelHandle xChannel );
+
+/*
+ * Fill pxDescriptors with a chain that moves ulLength bytes from ulSource to
+ * ulDestination, splitting it every dmaMAX_TRANSFERS transfers.  ulControl
+ * gives the widths, bursts and increments; the transfer counts and the
+ * completion interrupt of the last descriptor are filled in.  ulLength must
+ * be a multiple of the source width.  Returns the number of descriptors used,
+ * or 0 if more than uxMaxDescriptors are needed.
+ */
+unsigned portBASE_TYPE uxDMABuildChain( xDMADescriptor *pxDescriptors, unsigned portBASE_TYPE uxMaxDescriptors, unsigned long ulSource, unsigned long ulDestination, unsigned long ulLength, unsigned long ulControl );
+
+/*
+ * Start the chain beginning at pxFirst on a channel with no transfer in
+ * progress.  pxCallback is called from the interrupt when it completes.
+ */
+portBASE_TYPE xDMAStart( xDMAChannelHandle xChannel, const xDMADescriptor *pxFirst, unsigned long ulConfig, pdDMA_CALLBACK pxCallback, void *pvContext );
+
+/*
+ * Stop a transfer in progress.  The callback is not called.
+ */
+void vDMAAbort( xDMAChannelHandle xChannel );
+
+#endif /* PL081_DMA_H */
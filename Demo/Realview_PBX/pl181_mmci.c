@@ -0,0 +1,850 @@
+/*
+    FreeRTOS V7.0.1 - Copyright (C) 2011 Real Time Engineers Ltd.
+
+
+	FreeRTOS supports many tools and architectures. V7.0.0 is sponsored by:
+	Atollic AB - Atollic provides professional embedded systems development
+	tools for C/C++ development, code analysis and test automation.
+	See http://www.atollic.com
+
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS tutorial books are available in pdf and paperback.        *
+     *    Complete, revised, and edited pdf reference manuals are also       *
+     *    available.                                                         *
+     *                                                                       *
+     *    Purchasing FreeRTOS documentation will not only help you, by       *
+     *    ensuring you get running as quickly as possible and with an        *
+     *    in-depth knowledge of how to use FreeRTOS, it will also help       *
+     *    the FreeRTOS project to continue with its mission of providing     *
+     *    professional grade, cross platform, de facto standard solutions    *
+     *    for microcontrollers - completely free of charge!                  *
+     *                                                                       *
+     *    >>> See http://www.FreeRTOS.org/Documentation for details. <<<     *
+     *                                                                       *
+     *    Thank you for using FreeRTOS, and thank you for your support!      *
+     *                                                                       *
+    ***************************************************************************
+
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation AND MODIFIED BY the FreeRTOS exception.
+    >>>NOTE<<< The modification to the GPL is included to allow you to
+    distribute a combined work that includes FreeRTOS without being obliged to
+    provide the source code for proprietary components outside of the FreeRTOS
+    kernel.  FreeRTOS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details. You should have received a copy of the GNU General Public
+    License and the FreeRTOS license exception along with FreeRTOS; if not it
+    can be viewed here: http://www.freertos.org/a00114.html and also obtained
+    by writing to Richard Barry, contact details for whom are available on the
+    FreeRTOS WEB site.
+
+    1 tab == 4 spaces!
+
+    http://www.FreeRTOS.org - Documentation, latest information, license and
+    contact details.
+
+    http://www.SafeRTOS.com - A version that is certified for use in safety
+    critical systems.
+
+    http://www.OpenRTOS.com - Commercial support, development, porting,
+    licensing and training services.
+*/
+
+
+/* SD Card Driver for the PL181 MMCI Peripheral. */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+#include "log.h"
+#include "pl181_mmci.h"
+/*----------------------------------------------------------------------------*/
+
+#define MMCI_BASE				( 0x10005000UL )		/* Realview PBX Cortex-A9. */
+#define MMCI_VECTOR_ID0			( 49 )		/* Command and transfer status, as selected by MASK0. */
+#define MMCI_VECTOR_ID1			( 50 )		/* FIFO status, as selected by MASK1. */
+
+#define MMCIPower(x)			( (volatile unsigned long *)( (x) + 0x00UL ) )	/* Power Control Register */
+#define MMCIClock(x)			( (volatile unsigned long *)( (x) + 0x04UL ) )	/* Clock Control Register */
+#define MMCIArgument(x)			( (volatile unsigned long *)( (x) + 0x08UL ) )	/* Argument Register */
+#define MMCICommand(x)			( (volatile unsigned long *)( (x) + 0x0CUL ) )	/* Command Register */
+#define MMCIResponse(x,n)		( (volatile unsigned long *)( (x) + 0x14UL + ( (n) << 2 ) ) )	/* Response Registers */
+#define MMCIDataTimer(x)		( (volatile unsigned long *)( (x) + 0x24UL ) )	/* Data Timer */
+#define MMCIDataLength(x)		( (volatile unsigned long *)( (x) + 0x28UL ) )	/* Data Length Register */
+#define MMCIDataCtrl(x)			( (volatile unsigned long *)( (x) + 0x2CUL ) )	/* Data Control Register */
+#define MMCIStatus(x)			( (volatile unsigned long *)( (x) + 0x34UL ) )	/* Status Register */
+#define MMCIClear(x)			( (volatile unsigned long *)( (x) + 0x38UL ) )	/* Clear Register */
+#define MMCIMask0(x)			( (volatile unsigned long *)( (x) + 0x3CUL ) )	/* Interrupt 0 Mask Register */
+#define MMCIMask1(x)			( (volatile unsigned long *)( (x) + 0x40UL ) )	/* Interrupt 1 Mask Register */
+#define MMCIFIFO(x)				( (volatile unsigned long *)( (x) + 0x80UL ) )	/* Data FIFO */
+
+#define MMCI_POWER_UP			( 2UL )
+#define MMCI_POWER_ON			( 3UL )
+
+/* MCLK is 24 MHz, and the card clock MCLK / ( 2 * ( DIV + 1 ) ): about
+200 kHz to identify the card, which must be done at 400 kHz at most, and
+12 MHz after that. */
+#define MMCI_CLOCK_DIV( x )		( ( unsigned long ) ( x ) & 0xFFUL )
+#define MMCI_CLOCK_ENABLE		( 1UL << 8 )
+#define MMCI_CLOCK_IDENTIFY		( MMCI_CLOCK_ENABLE | MMCI_CLOCK_DIV( 59 ) )
+#define MMCI_CLOCK_TRANSFER		( MMCI_CLOCK_ENABLE | MMCI_CLOCK_DIV( 0 ) )
+
+#define MMCI_CMD_RESPONSE		( 1UL << 6 )
+#define MMCI_CMD_LONG_RESPONSE	( 1UL << 7 )
+#define MMCI_CMD_ENABLE			( 1UL << 10 )
+
+#define MMCI_STATUS_CMDCRCFAIL		( 1UL << 0 )
+#define MMCI_STATUS_DATACRCFAIL		( 1UL << 1 )
+#define MMCI_STATUS_CMDTIMEOUT		( 1UL << 2 )
+#define MMCI_STATUS_DATATIMEOUT		( 1UL << 3 )
+#define MMCI_STATUS_TXUNDERRUN		( 1UL << 4 )
+#define MMCI_STATUS_RXOVERRUN		( 1UL << 5 )
+#define MMCI_STATUS_CMDRESPEND		( 1UL << 6 )
+#define MMCI_STATUS_CMDSENT			( 1UL << 7 )
+#define MMCI_STATUS_DATAEND			( 1UL << 8 )
+#define MMCI_STATUS_TXFIFOHALFEMPTY	( 1UL << 14 )
+#define MMCI_STATUS_TXFIFOFULL		( 1UL << 16 )
+#define MMCI_STATUS_RXDATAAVLBL		( 1UL << 21 )
+
+/* The bits that stay set until cleared through the Clear Register. */
+#define MMCI_STATUS_COMMAND		( MMCI_STATUS_CMDCRCFAIL | MMCI_STATUS_CMDTIMEOUT | MMCI_STATUS_CMDRESPEND | MMCI_STATUS_CMDSENT )
+#define MMCI_STATUS_STATIC		( 0x7FFUL )
+
+#define MMCI_STATUS_DATA_ERRORS	( MMCI_STATUS_DATACRCFAIL | MMCI_STATUS_DATATIMEOUT | MMCI_STATUS_TXUNDERRUN | MMCI_STATUS_RXOVERRUN )
+
+#define MMCI_DATA_ENABLE		( 1UL << 0 )
+#define MMCI_DATA_READ			( 1UL << 1 )		/* From the card. */
+#define MMCI_DATA_BLOCK_SIZE	( 9UL << 4 )		/* log2 of mmciBLOCK_SIZE. */
+
+/* In card clock cycles: about 1.4 s at 12 MHz. */
+#define MMCI_DATA_TIMER			( 0x00FFFFFFUL )
+
+/* The Data Length Register has 16 bits, so longer requests are split. */
+#define MMCI_MAX_BLOCKS			( 0xFFFFUL / mmciBLOCK_SIZE )
+
+/* The response expected by prvMMCICommand().  R3 has no valid CRC. */
+#define MMCI_RESPONSE_NONE		( 0UL )
+#define MMCI_RESPONSE_SHORT		( MMCI_CMD_RESPONSE )
+#define MMCI_RESPONSE_LONG		( MMCI_CMD_RESPONSE | MMCI_CMD_LONG_RESPONSE )
+#define MMCI_RESPONSE_NO_CRC	( 1UL << 31 )
+
+/* SD commands, and application specific commands which follow APP_CMD. */
+#define MMCI_SD_GO_IDLE_STATE			( 0UL )
+#define MMCI_SD_ALL_SEND_CID			( 2UL )
+#define MMCI_SD_SEND_RELATIVE_ADDR		( 3UL )
+#define MMCI_SD_SELECT_CARD				( 7UL )
+#define MMCI_SD_SEND_IF_COND			( 8UL )
+#define MMCI_SD_SEND_CSD				( 9UL )
+#define MMCI_SD_STOP_TRANSMISSION		( 12UL )
+#define MMCI_SD_SEND_STATUS				( 13UL )
+#define MMCI_SD_SET_BLOCKLEN			( 16UL )
+#define MMCI_SD_READ_SINGLE_BLOCK		( 17UL )
+#define MMCI_SD_READ_MULTIPLE_BLOCK		( 18UL )
+#define MMCI_SD_WRITE_BLOCK				( 24UL )
+#define MMCI_SD_WRITE_MULTIPLE_BLOCK	( 25UL )
+#define MMCI_SD_APP_CMD					( 55UL )
+#define MMCI_SD_APP_SEND_OP_COND		( 41UL )
+
+/* SEND_IF_COND: 2.7 to 3.6 V, and a pattern echoed by version 2 cards. */
+#define MMCI_IF_COND			( 0x1AAUL )
+
+#define MMCI_OCR_VOLTAGES		( 0x00FF8000UL )	/* 2.7 to 3.6 V. */
+#define MMCI_OCR_HCS			( 1UL << 30 )		/* High capacity, addressed in blocks. */
+#define MMCI_OCR_READY			( 1UL << 31 )		/* Power up is over. */
+
+#define MMCI_RCA_MASK			( 0xFFFF0000UL )
+
+/* Card status: everything from OUT_OF_RANGE to ERROR except CARD_IS_LOCKED. */
+#define MMCI_R1_ERRORS			( 0xFDF80000UL )
+#define MMCI_R1_READY_FOR_DATA	( 1UL << 8 )
+#define MMCI_R1_STATE( x )		( ( ( x ) >> 9 ) & 0xFUL )
+#define MMCI_R1_STATE_TRAN		( 4UL )
+
+#define MMCI_COMMAND_TIMEOUT_MS	( 100UL )
+#define MMCI_DATA_TIMEOUT_MS	( 2000UL )
+#define MMCI_BUSY_TIMEOUT_MS	( 1000UL )		/* Programming after a write. */
+#define MMCI_POWER_UP_TIMEOUT_MS	( 1000UL )
+
+#define MMCI_OP_READ			( 0UL )
+#define MMCI_OP_WRITE			( 1UL )
+#define MMCI_OP_INFO			( 2UL )		/* Only waits for the card to be brought up. */
+/*----------------------------------------------------------------------------*/
+
+typedef struct MMCI_REQUEST
+{
+	unsigned long ulOperation;
+	unsigned long ulBlock;
+	unsigned long ulCount;
+	unsigned char *pucBuffer;			/* Either a contiguous buffer, */
+	unsigned char * const *ppucBlocks;	/* or one for each block. */
+	portBASE_TYPE xResult;
+	xSemaphoreHandle xDone;				/* Given by the I/O task when xResult is set. */
+} xMMCIRequest;
+
+/* The transfer the interrupt is moving through the FIFO. */
+typedef struct MMCI_TRANSFER
+{
+	unsigned char *pucBuffer;
+	unsigned char * const *ppucBlocks;
+	unsigned char *pucNext;				/* Next byte of the current block, */
+	unsigned long ulLeft;				/* and how many of its bytes are left. */
+	unsigned long ulBlock;				/* The next block. */
+	unsigned long ulRemaining;			/* Bytes left in the transfer. */
+	portBASE_TYPE xRead;
+	unsigned long ulStatus;				/* The status that ended the last wait. */
+} xMMCITransfer;
+
+/* Buffers passed in by the caller need not be word aligned. */
+typedef unsigned long __attribute__ ( ( may_alias ) ) xMMCIAliasedWord;
+/*----------------------------------------------------------------------------*/
+
+static xMMCIRequest xMMCIRequests[ mmciMAX_REQUESTS ];
+
+/* Of pointers into xMMCIRequests: those free, and those for the I/O task. */
+static xQueueHandle xMMCIFree = NULL;
+static xQueueHandle xMMCIPending = NULL;
+
+/* Given by the interrupt when a status selected by MASK0 is raised. */
+static xSemaphoreHandle xMMCIEvent = NULL;
+
+static xMMCITransfer xMMCIXfer;
+
+/* Set by the I/O task before it takes the first request. */
+static portBASE_TYPE xMMCIReady = pdFALSE;
+static portBASE_TYPE xMMCIHighCapacity = pdFALSE;
+static unsigned long ulMMCIRCA = 0UL;
+static unsigned long ulMMCIBlockCount = 0UL;
+
+static xMMCIStats xMMCIStatistics;
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Moves data between the FIFO and the buffers, and wakes the I/O task when
+ * the command or transfer it waits for is over.
+ */
+void vMMCIInterruptHandler( void *pvParameter );
+
+/*
+ * Brings up the card, then carries out the requests one by one.
+ */
+static void prvMMCITask( void *pvParameters );
+
+/*
+ * Queue a request for the I/O task and wait for its result.
+ */
+static portBASE_TYPE prvMMCISubmit( unsigned long ulOperation, unsigned long ulBlock, unsigned long ulCount, unsigned char *pucBuffer, unsigned char * const *ppucBlocks );
+
+static portBASE_TYPE prvMMCIService( const xMMCIRequest *pxRequest );
+
+/*
+ * Identify the card, select it, and read its capacity.
+ */
+static portBASE_TYPE prvMMCICardInitialise( void );
+
+/*
+ * Send a command and wait for its response, which is copied to pulResponse:
+ * one word, or four for a long response, the most significant first.
+ */
+static portBASE_TYPE prvMMCICommand( unsigned long ulCommand, unsigned long ulArgument, unsigned long ulResponseType, unsigned long *pulResponse );
+static portBASE_TYPE prvMMCIAppCommand( unsigned long ulCommand, unsigned long ulArgument, unsigned long ulResponseType, unsigned long *pulResponse );
+
+/*
+ * Read or write up to MMCI_MAX_BLOCKS blocks with one command.
+ */
+static portBASE_TYPE prvMMCITransfer( unsigned long ulBlock, unsigned long ulCount, unsigned char *pucBuffer, unsigned char * const *ppucBlocks, portBASE_TYPE xRead );
+
+/*
+ * Select the status bits that end the wait in MASK0, and wait up to xTimeout
+ * ticks for one of them.  Returns the status then, or 0 on a timeout.
+ */
+static unsigned long prvMMCIWait( unsigned long ulMask, portTickType xTimeout );
+
+/*
+ * Wait for the card to finish programming after a write.
+ */
+static portBASE_TYPE prvMMCIWaitReady( void );
+
+/*
+ * The card's capacity in blocks, from its CSD.
+ */
+static unsigned long prvMMCIBlockCount( const unsigned long *pulCSD );
+
+/*
+ * The ulWidth bit field starting at bit ulStart of the 128 bit pulCSD.
+ */
+static unsigned long prvMMCICSDBits( const unsigned long *pulCSD, unsigned long ulStart, unsigned long ulWidth );
+/*----------------------------------------------------------------------------*/
+
+portBASE_TYPE xMMCIInitialise( unsigned portBASE_TYPE uxPriority )
+{
+extern void vPortInstallInterruptHandler( void (*vHandler)(void *), void *pvParameter, unsigned long ulVector, unsigned char ucEdgeTriggered, unsigned char ucPriority, unsigned char ucProcessorTargets );
+xMMCIRequest *pxRequest;
+unsigned portBASE_TYPE ux;
+
+	vSemaphoreCreateBinary( xMMCIEvent );
+	xMMCIFree = xQueueCreate( mmciMAX_REQUESTS, sizeof( xMMCIRequest * ) );
+	xMMCIPending = xQueueCreate( mmciMAX_REQUESTS, sizeof( xMMCIRequest * ) );
+
+	if( ( NULL == xMMCIEvent ) || ( NULL == xMMCIFree ) || ( NULL == xMMCIPending ) )
+	{
+		return pdFAIL;
+	}
+	( void ) xSemaphoreTake( xMMCIEvent, 0 );
+
+	for( ux = 0U; ux < mmciMAX_REQUESTS; ux++ )
+	{
+		pxRequest = &xMMCIRequests[ ux ];
+		vSemaphoreCreateBinary( pxRequest->xDone );
+		if( NULL == pxRequest->xDone )
+		{
+			return pdFAIL;
+		}
+		( void ) xSemaphoreTake( pxRequest->xDone, 0 );
+		( void ) xQueueSend( xMMCIFree, &pxRequest, 0 );
+	}
+
+	*MMCIMask0( MMCI_BASE ) = 0UL;
+	*MMCIMask1( MMCI_BASE ) = 0UL;
+	*MMCIClear( MMCI_BASE ) = MMCI_STATUS_STATIC;
+
+	vPortInstallInterruptHandler( vMMCIInterruptHandler, NULL, MMCI_VECTOR_ID0, pdFALSE, configMAX_SYSCALL_INTERRUPT_PRIORITY, 1 << portCORE_ID() );
+	vPortInstallInterruptHandler( vMMCIInterruptHandler, NULL, MMCI_VECTOR_ID1, pdFALSE, configMAX_SYSCALL_INTERRUPT_PRIORITY, 1 << portCORE_ID() );
+
+	return xTaskCreate( prvMMCITask, ( signed char * ) "mmci", mmciTASK_STACK_SIZE, NULL, uxPriority, NULL );
+}
+/*----------------------------------------------------------------------------*/
+
+portBASE_TYPE xMMCIRead( unsigned long ulBlock, unsigned long ulCount, void *pvBuffer )
+{
+	return prvMMCISubmit( MMCI_OP_READ, ulBlock, ulCount, ( unsigned char * ) pvBuffer, NULL );
+}
+/*----------------------------------------------------------------------------*/
+
+portBASE_TYPE xMMCIWrite( unsigned long ulBlock, unsigned long ulCount, const void *pvBuffer )
+{
+	/* Only read from, as the operation says. */
+	return prvMMCISubmit( MMCI_OP_WRITE, ulBlock, ulCount, ( unsigned char * ) pvBuffer, NULL );
+}
+/*----------------------------------------------------------------------------*/
+
+portBASE_TYPE xMMCIReadBlocks( unsigned long ulBlock, unsigned long ulCount, unsigned char * const *ppucBlocks )
+{
+	return prvMMCISubmit( MMCI_OP_READ, ulBlock, ulCount, NULL, ppucBlocks );
+}
+/*----------------------------------------------------------------------------*/
+
+portBASE_TYPE xMMCIWriteBlocks( unsigned long ulBlock, unsigned long ulCount, unsigned char * const *ppucBlocks )
+{
+	return prvMMCISubmit( MMCI_OP_WRITE, ulBlock, ulCount, NULL, ppucBlocks );
+}
+/*----------------------------------------------------------------------------*/
+
+unsigned long ulMMCIGetBlockCount( void )
+{
+	( void ) prvMMCISubmit( MMCI_OP_INFO, 0UL, 0UL, NULL, NULL );
+
+	return ulMMCIBlockCount;
+}
+/*----------------------------------------------------------------------------*/
+
+void vMMCIGetStats( xMMCIStats *pxStats )
+{
+	taskENTER_CRITICAL();
+	{
+		*pxStats = xMMCIStatistics;
+	}
+	taskEXIT_CRITICAL();
+}
+/*----------------------------------------------------------------------------*/
+
+static portBASE_TYPE prvMMCISubmit( unsigned long ulOperation, unsigned long ulBlock, unsigned long ulCount, unsigned char *pucBuffer, unsigned char * const *ppucBlocks )
+{
+xMMCIRequest *pxRequest;
+portBASE_TYPE xResult;
+
+	if( NULL == xMMCIFree )
+	{
+		return pdFAIL;
+	}
+
+	( void ) xQueueReceive( xMMCIFree, &pxRequest, portMAX_DELAY );
+
+	pxRequest->ulOperation = ulOperation;
+	pxRequest->ulBlock = ulBlock;
+	pxRequest->ulCount = ulCount;
+	pxRequest->pucBuffer = pucBuffer;
+	pxRequest->ppucBlocks = ppucBlocks;
+
+	/* There are as many places in the queue as requests, so neither of these
+	can wait. */
+	( void ) xQueueSend( xMMCIPending, &pxRequest, portMAX_DELAY );
+	( void ) xSemaphoreTake( pxRequest->xDone, portMAX_DELAY );
+
+	xResult = pxRequest->xResult;
+	( void ) xQueueSend( xMMCIFree, &pxRequest, portMAX_DELAY );
+
+	return xResult;
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvMMCITask( void *pvParameters )
+{
+xMMCIRequest *pxRequest;
+
+	( void ) pvParameters;
+
+	xMMCIReady = prvMMCICardInitialise();
+	if( pdFALSE != xMMCIReady )
+	{
+		logINFO( "SD card: %lu blocks", ulMMCIBlockCount );
+	}
+	else
+	{
+		ulMMCIBlockCount = 0UL;
+		logWARN( "No SD card" );
+	}
+
+	for( ;; )
+	{
+		if( pdTRUE == xQueueReceive( xMMCIPending, &pxRequest, portMAX_DELAY ) )
+		{
+			pxRequest->xResult = prvMMCIService( pxRequest );
+			( void ) xSemaphoreGive( pxRequest->xDone );
+		}
+	}
+}
+/*----------------------------------------------------------------------------*/
+
+static portBASE_TYPE prvMMCIService( const xMMCIRequest *pxRequest )
+{
+unsigned long ulDone, ulCount;
+portBASE_TYPE xRead = ( MMCI_OP_READ == pxRequest->ulOperation ) ? pdTRUE : pdFALSE;
+portBASE_TYPE xResult = pdPASS;
+
+	if( MMCI_OP_INFO == pxRequest->ulOperation )
+	{
+		return pdPASS;
+	}
+
+	if( ( pdFALSE == xMMCIReady ) || ( pxRequest->ulBlock >= ulMMCIBlockCount ) || ( pxRequest->ulCount > ulMMCIBlockCount - pxRequest->ulBlock ) )
+	{
+		xResult = pdFAIL;
+	}
+
+	for( ulDone = 0UL; ( pdPASS == xResult ) && ( ulDone < pxRequest->ulCount ); ulDone += ulCount )
+	{
+		ulCount = pxRequest->ulCount - ulDone;
+		if( ulCount > MMCI_MAX_BLOCKS )
+		{
+			ulCount = MMCI_MAX_BLOCKS;
+		}
+
+		xResult = prvMMCITransfer( pxRequest->ulBlock + ulDone, ulCount,
+								   ( NULL != pxRequest->pucBuffer ) ? pxRequest->pucBuffer + ulDone * mmciBLOCK_SIZE : NULL,
+								   ( NULL != pxRequest->ppucBlocks ) ? pxRequest->ppucBlocks + ulDone : NULL, xRead );
+	}
+
+	taskENTER_CRITICAL();
+	{
+		if( pdFALSE != xRead )
+		{
+			xMMCIStatistics.ulReads++;
+		}
+		else
+		{
+			xMMCIStatistics.ulWrites++;
+		}
+
+		if( pdPASS == xResult )
+		{
+			if( pdFALSE != xRead )
+			{
+				xMMCIStatistics.ulBlocksRead += pxRequest->ulCount;
+			}
+			else
+			{
+				xMMCIStatistics.ulBlocksWritten += pxRequest->ulCount;
+			}
+		}
+		else
+		{
+			xMMCIStatistics.ulErrors++;
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	return xResult;
+}
+/*----------------------------------------------------------------------------*/
+
+static portBASE_TYPE prvMMCICardInitialise( void )
+{
+unsigned long ulResponse[ 4 ];
+unsigned long ulHighCapacity = 0UL;
+unsigned long ulOCR = 0UL;
+portTickType xStart;
+
+	*MMCIPower( MMCI_BASE ) = MMCI_POWER_UP;
+	vTaskDelay( 1 + 2 / portTICK_RATE_MS );
+	*MMCIPower( MMCI_BASE ) = MMCI_POWER_ON;
+
+	/* The card wants at least 74 clock cycles before the first command. */
+	*MMCIClock( MMCI_BASE ) = MMCI_CLOCK_IDENTIFY;
+	vTaskDelay( 1 + 2 / portTICK_RATE_MS );
+
+	( void ) prvMMCICommand( MMCI_SD_GO_IDLE_STATE, 0UL, MMCI_RESPONSE_NONE, NULL );
+
+	/* Only version 2 cards answer, and only they can be high capacity. */
+	if( ( pdPASS == prvMMCICommand( MMCI_SD_SEND_IF_COND, MMCI_IF_COND, MMCI_RESPONSE_SHORT, ulResponse ) ) &&
+		( MMCI_IF_COND == ( ulResponse[ 0 ] & 0xFFFUL ) ) )
+	{
+		ulHighCapacity = MMCI_OCR_HCS;
+	}
+
+	/* Repeat until the card has powered up.  The first APP_CMD fails if there
+	is no card. */
+	xStart = xTaskGetTickCount();
+	do
+	{
+		if( pdFAIL == prvMMCIAppCommand( MMCI_SD_APP_SEND_OP_COND, ulHighCapacity | MMCI_OCR_VOLTAGES, MMCI_RESPONSE_SHORT | MMCI_RESPONSE_NO_CRC, ulResponse ) )
+		{
+			return pdFAIL;
+		}
+
+		ulOCR = ulResponse[ 0 ];
+		if( 0UL == ( ulOCR & MMCI_OCR_READY ) )
+		{
+			vTaskDelay( 1 + 10 / portTICK_RATE_MS );
+		}
+	} while( ( 0UL == ( ulOCR & MMCI_OCR_READY ) ) && ( ( xTaskGetTickCount() - xStart ) < MMCI_POWER_UP_TIMEOUT_MS / portTICK_RATE_MS ) );
+
+	if( 0UL == ( ulOCR & MMCI_OCR_READY ) )
+	{
+		return pdFAIL;
+	}
+	xMMCIHighCapacity = ( ulOCR & MMCI_OCR_HCS ) ? pdTRUE : pdFALSE;
+
+	if( ( pdFAIL == prvMMCICommand( MMCI_SD_ALL_SEND_CID, 0UL, MMCI_RESPONSE_LONG, ulResponse ) ) ||
+		( pdFAIL == prvMMCICommand( MMCI_SD_SEND_RELATIVE_ADDR, 0UL, MMCI_RESPONSE_SHORT, ulResponse ) ) )
+	{
+		return pdFAIL;
+	}
+	ulMMCIRCA = ulResponse[ 0 ] & MMCI_RCA_MASK;
+
+	if( pdFAIL == prvMMCICommand( MMCI_SD_SEND_CSD, ulMMCIRCA, MMCI_RESPONSE_LONG, ulResponse ) )
+	{
+		return pdFAIL;
+	}
+	ulMMCIBlockCount = prvMMCIBlockCount( ulResponse );
+
+	if( pdFAIL == prvMMCICommand( MMCI_SD_SELECT_CARD, ulMMCIRCA, MMCI_RESPONSE_SHORT, ulResponse ) )
+	{
+		return pdFAIL;
+	}
+
+	/* Standard capacity cards are addressed in bytes, and their block length
+	could be set otherwise. */
+	if( ( pdFALSE == xMMCIHighCapacity ) &&
+		( pdFAIL == prvMMCICommand( MMCI_SD_SET_BLOCKLEN, mmciBLOCK_SIZE, MMCI_RESPONSE_SHORT, ulResponse ) ) )
+	{
+		return pdFAIL;
+	}
+
+	*MMCIClock( MMCI_BASE ) = MMCI_CLOCK_TRANSFER;
+
+	return ( ulMMCIBlockCount > 0UL ) ? pdPASS : pdFAIL;
+}
+/*----------------------------------------------------------------------------*/
+
+static unsigned long prvMMCIWait( unsigned long ulMask, portTickType xTimeout )
+{
+	xMMCIXfer.ulStatus = 0UL;
+
+	/* The status bits stay set, so if one already is the interrupt is taken
+	as soon as it is selected. */
+	*MMCIMask0( MMCI_BASE ) = ulMask;
+
+	if( pdTRUE != xSemaphoreTake( xMMCIEvent, xTimeout ) )
+	{
+		*MMCIMask0( MMCI_BASE ) = 0UL;
+
+		/* In case the interrupt came in between. */
+		( void ) xSemaphoreTake( xMMCIEvent, 0 );
+	}
+
+	return xMMCIXfer.ulStatus;
+}
+/*----------------------------------------------------------------------------*/
+
+static portBASE_TYPE prvMMCICommand( unsigned long ulCommand, unsigned long ulArgument, unsigned long ulResponseType, unsigned long *pulResponse )
+{
+unsigned long ulStatus, ulMask;
+
+	*MMCIClear( MMCI_BASE ) = MMCI_STATUS_COMMAND;
+	*MMCIArgument( MMCI_BASE ) = ulArgument;
+	*MMCICommand( MMCI_BASE ) = ulCommand | ( ulResponseType & MMCI_RESPONSE_LONG ) | MMCI_CMD_ENABLE;
+
+	if( ulResponseType & MMCI_CMD_RESPONSE )
+	{
+		ulMask = MMCI_STATUS_CMDRESPEND | MMCI_STATUS_CMDCRCFAIL | MMCI_STATUS_CMDTIMEOUT;
+	}
+	else
+	{
+		ulMask = MMCI_STATUS_CMDSENT;
+	}
+
+	ulStatus = prvMMCIWait( ulMask, 1 + MMCI_COMMAND_TIMEOUT_MS / portTICK_RATE_MS );
+
+	if( ( 0UL == ulStatus ) || ( ulStatus & MMCI_STATUS_CMDTIMEOUT ) ||
+		( ( ulStatus & MMCI_STATUS_CMDCRCFAIL ) && ( 0UL == ( ulResponseType & MMCI_RESPONSE_NO_CRC ) ) ) )
+	{
+		return pdFAIL;
+	}
+
+	if( NULL != pulResponse )
+	{
+		pulResponse[ 0 ] = *MMCIResponse( MMCI_BASE, 0 );
+		if( ulResponseType & MMCI_CMD_LONG_RESPONSE )
+		{
+			pulResponse[ 1 ] = *MMCIResponse( MMCI_BASE, 1 );
+			pulResponse[ 2 ] = *MMCIResponse( MMCI_BASE, 2 );
+			pulResponse[ 3 ] = *MMCIResponse( MMCI_BASE, 3 );
+		}
+	}
+
+	return pdPASS;
+}
+/*----------------------------------------------------------------------------*/
+
+static portBASE_TYPE prvMMCIAppCommand( unsigned long ulCommand, unsigned long ulArgument, unsigned long ulResponseType, unsigned long *pulResponse )
+{
+unsigned long ulStatus;
+
+	if( pdFAIL == prvMMCICommand( MMCI_SD_APP_CMD, ulMMCIRCA, MMCI_RESPONSE_SHORT, &ulStatus ) )
+	{
+		return pdFAIL;
+	}
+
+	return prvMMCICommand( ulCommand, ulArgument, ulResponseType, pulResponse );
+}
+/*----------------------------------------------------------------------------*/
+
+static portBASE_TYPE prvMMCITransfer( unsigned long ulBlock, unsigned long ulCount, unsigned char *pucBuffer, unsigned char * const *ppucBlocks, portBASE_TYPE xRead )
+{
+unsigned long ulAddress = ( pdFALSE != xMMCIHighCapacity ) ? ulBlock : ulBlock * mmciBLOCK_SIZE;
+unsigned long ulResponse = 0UL;
+unsigned long ulStatus;
+portBASE_TYPE xResult;
+
+	xMMCIXfer.pucBuffer = pucBuffer;
+	xMMCIXfer.ppucBlocks = ppucBlocks;
+	xMMCIXfer.ulLeft = 0UL;
+	xMMCIXfer.ulBlock = 0UL;
+	xMMCIXfer.ulRemaining = ulCount * mmciBLOCK_SIZE;
+	xMMCIXfer.xRead = xRead;
+
+	*MMCIClear( MMCI_BASE ) = MMCI_STATUS_STATIC;
+	*MMCIDataTimer( MMCI_BASE ) = MMCI_DATA_TIMER;
+	*MMCIDataLength( MMCI_BASE ) = ulCount * mmciBLOCK_SIZE;
+
+	if( pdFALSE != xRead )
+	{
+		/* Ready for the data before the card starts to send it. */
+		*MMCIDataCtrl( MMCI_BASE ) = MMCI_DATA_ENABLE | MMCI_DATA_READ | MMCI_DATA_BLOCK_SIZE;
+		*MMCIMask1( MMCI_BASE ) = MMCI_STATUS_RXDATAAVLBL;
+		xResult = prvMMCICommand( ( ulCount > 1UL ) ? MMCI_SD_READ_MULTIPLE_BLOCK : MMCI_SD_READ_SINGLE_BLOCK, ulAddress, MMCI_RESPONSE_SHORT, &ulResponse );
+	}
+	else
+	{
+		/* The card only takes data once it has answered. */
+		xResult = prvMMCICommand( ( ulCount > 1UL ) ? MMCI_SD_WRITE_MULTIPLE_BLOCK : MMCI_SD_WRITE_BLOCK, ulAddress, MMCI_RESPONSE_SHORT, &ulResponse );
+		if( pdPASS == xResult )
+		{
+			*MMCIDataCtrl( MMCI_BASE ) = MMCI_DATA_ENABLE | MMCI_DATA_BLOCK_SIZE;
+			*MMCIMask1( MMCI_BASE ) = MMCI_STATUS_TXFIFOHALFEMPTY;
+		}
+	}
+
+	if( ( pdPASS == xResult ) && ( 0UL == ( ulResponse & MMCI_R1_ERRORS ) ) )
+	{
+		ulStatus = prvMMCIWait( MMCI_STATUS_DATAEND | MMCI_STATUS_DATA_ERRORS, MMCI_DATA_TIMEOUT_MS / portTICK_RATE_MS );
+		if( ( 0UL == ( ulStatus & MMCI_STATUS_DATAEND ) ) || ( ulStatus & MMCI_STATUS_DATA_ERRORS ) || ( 0UL != xMMCIXfer.ulRemaining ) )
+		{
+			xResult = pdFAIL;
+		}
+	}
+	else
+	{
+		xResult = pdFAIL;
+	}
+
+	*MMCIMask1( MMCI_BASE ) = 0UL;
+	*MMCIDataCtrl( MMCI_BASE ) = 0UL;
+	xMMCIXfer.ulRemaining = 0UL;
+
+	if( ulCount > 1UL )
+	{
+		( void ) prvMMCICommand( MMCI_SD_STOP_TRANSMISSION, 0UL, MMCI_RESPONSE_SHORT, &ulResponse );
+	}
+
+	if( ( pdFALSE == xRead ) && ( pdFAIL == prvMMCIWaitReady() ) )
+	{
+		xResult = pdFAIL;
+	}
+
+	return xResult;
+}
+/*----------------------------------------------------------------------------*/
+
+static portBASE_TYPE prvMMCIWaitReady( void )
+{
+unsigned long ulStatus;
+portTickType xStart = xTaskGetTickCount();
+
+	/* The PL181 does not see the busy signal, so ask the card. */
+	for( ;; )
+	{
+		if( ( pdPASS == prvMMCICommand( MMCI_SD_SEND_STATUS, ulMMCIRCA, MMCI_RESPONSE_SHORT, &ulStatus ) ) &&
+			( ulStatus & MMCI_R1_READY_FOR_DATA ) && ( MMCI_R1_STATE_TRAN == MMCI_R1_STATE( ulStatus ) ) )
+		{
+			return pdPASS;
+		}
+
+		if( ( xTaskGetTickCount() - xStart ) >= MMCI_BUSY_TIMEOUT_MS / portTICK_RATE_MS )
+		{
+			return pdFAIL;
+		}
+
+		vTaskDelay( 1 );
+	}
+}
+/*----------------------------------------------------------------------------*/
+
+static unsigned long prvMMCICSDBits( const unsigned long *pulCSD, unsigned long ulStart, unsigned long ulWidth )
+{
+unsigned long ulWord = 3UL - ( ulStart >> 5 );
+unsigned long ulShift = ulStart & 31UL;
+unsigned long ulBits = pulCSD[ ulWord ] >> ulShift;
+
+	if( ulShift + ulWidth > 32UL )
+	{
+		ulBits |= pulCSD[ ulWord - 1UL ] << ( 32UL - ulShift );
+	}
+
+	return ulBits & ( ( 1UL << ulWidth ) - 1UL );
+}
+/*----------------------------------------------------------------------------*/
+
+static unsigned long prvMMCIBlockCount( const unsigned long *pulCSD )
+{
+unsigned long ulSize;
+
+	if( 1UL == prvMMCICSDBits( pulCSD, 126UL, 2UL ) )
+	{
+		/* CSD version 2: C_SIZE counts 512 KB. */
+		ulSize = prvMMCICSDBits( pulCSD, 48UL, 22UL );
+		return ( ulSize + 1UL ) << 10;
+	}
+
+	/* Version 1: ( C_SIZE + 1 ) << ( C_SIZE_MULT + 2 ) blocks of
+	1 << READ_BL_LEN bytes. */
+	ulSize = ( prvMMCICSDBits( pulCSD, 62UL, 12UL ) + 1UL ) << ( prvMMCICSDBits( pulCSD, 47UL, 3UL ) + 2UL );
+	return ( ulSize << prvMMCICSDBits( pulCSD, 80UL, 4UL ) ) / mmciBLOCK_SIZE;
+}
+/*----------------------------------------------------------------------------*/
+
+void vMMCIInterruptHandler( void *pvParameter )
+{
+unsigned long ulWord, ulStatus;
+unsigned char *pucNext;
+portBASE_TYPE xTaskWoken = pdFALSE;
+
+	( void ) pvParameter;
+	xMMCIStatistics.ulInterrupts++;
+
+	while( xMMCIXfer.ulRemaining > 0UL )
+	{
+		ulStatus = *MMCIStatus( MMCI_BASE );
+		if( ( pdFALSE != xMMCIXfer.xRead ) ? ( 0UL == ( ulStatus & MMCI_STATUS_RXDATAAVLBL ) ) : ( 0UL != ( ulStatus & MMCI_STATUS_TXFIFOFULL ) ) )
+		{
+			break;
+		}
+
+		if( 0UL == xMMCIXfer.ulLeft )
+		{
+			if( NULL != xMMCIXfer.ppucBlocks )
+			{
+				xMMCIXfer.pucNext = xMMCIXfer.ppucBlocks[ xMMCIXfer.ulBlock ];
+			}
+			else
+			{
+				xMMCIXfer.pucNext = xMMCIXfer.pucBuffer + xMMCIXfer.ulBlock * mmciBLOCK_SIZE;
+			}
+			xMMCIXfer.ulBlock++;
+			xMMCIXfer.ulLeft = mmciBLOCK_SIZE;
+		}
+
+		/* The FIFO is little endian, as is the CPU. */
+		pucNext = xMMCIXfer.pucNext;
+		if( pdFALSE != xMMCIXfer.xRead )
+		{
+			ulWord = *MMCIFIFO( MMCI_BASE );
+			if( 0UL == ( ( unsigned long ) pucNext & 3UL ) )
+			{
+				*( xMMCIAliasedWord * ) pucNext = ulWord;
+			}
+			else
+			{
+				pucNext[ 0 ] = ( unsigned char ) ulWord;
+				pucNext[ 1 ] = ( unsigned char ) ( ulWord >> 8 );
+				pucNext[ 2 ] = ( unsigned char ) ( ulWord >> 16 );
+				pucNext[ 3 ] = ( unsigned char ) ( ulWord >> 24 );
+			}
+		}
+		else
+		{
+			if( 0UL == ( ( unsigned long ) pucNext & 3UL ) )
+			{
+				ulWord = *( const xMMCIAliasedWord * ) pucNext;
+			}
+			else
+			{
+				ulWord = ( unsigned long ) pucNext[ 0 ] | ( ( unsigned long ) pucNext[ 1 ] << 8 ) |
+						 ( ( unsigned long ) pucNext[ 2 ] << 16 ) | ( ( unsigned long ) pucNext[ 3 ] << 24 );
+			}
+			*MMCIFIFO( MMCI_BASE ) = ulWord;
+		}
+
+		xMMCIXfer.pucNext = pucNext + 4;
+		xMMCIXfer.ulLeft -= 4UL;
+		xMMCIXfer.ulRemaining -= 4UL;
+	}
+
+	/* Nothing more to move, so the FIFO interrupt is not wanted until the
+	next transfer. */
+	if( 0UL == xMMCIXfer.ulRemaining )
+	{
+		*MMCIMask1( MMCI_BASE ) = 0UL;
+	}
+
+	ulStatus = *MMCIStatus( MMCI_BASE );
+	if( ulStatus & *MMCIMask0( MMCI_BASE ) )
+	{
+		/* Selected again by the next wait. */
+		*MMCIMask0( MMCI_BASE ) = 0UL;
+		xMMCIXfer.ulStatus = ulStatus;
+		( void ) xSemaphoreGiveFromISR( xMMCIEvent, &xTaskWoken );
+	}
+
+	portEND_SWITCHING_ISR( xTaskWoken );
+}
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,126 @@
+/*
+    FreeRTOS V7.0.1 - Copyright (C) 2011 Real Time Engineers Ltd.
+
+
+	FreeRTOS supports many tools and architectures. V7.0.0 is sponsored by:
+	Atollic AB - Atollic provides professional embedded systems development
+	tools for C/C++ development, code analysis and test automation.
+	See http://www.atollic.com
+
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS tutorial books are available in pdf and paperback.        *
+     *    Complete, revised, and edited pdf reference manuals are also       *
+     *    available.                                                         *
+     *                                                                       *
+     *    Purchasing FreeRTOS documentation will not only help you, by       *
+     *    ensuring you get running as quickly as possible and with an        *
+     *    in-depth knowledge of how to use FreeRTOS, it will also help       *
+     *    the FreeRTOS project to continue with its mission of providing     *
+     *    professional grade, cross platform, de facto standard solutions    *
+     *    for microcontrollers - completely free of charge!                  *
+     *                                                                       *
+     *    >>> See http://www.FreeRTOS.org/Documentation for details. <<<     *
+     *                                                                       *
+     *    Thank you for using FreeRTOS, and thank you for your support!      *
+     *                                                                       *
+    ***************************************************************************
+
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation AND MODIFIED BY the FreeRTOS exception.
+    >>>NOTE<<< The modification to the GPL is included to allow you to
+    distribute a combined work that includes FreeRTOS without being obliged to
+    provide the source code for proprietary components outside of the FreeRTOS
+    kernel.  FreeRTOS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details. You should have received a copy of the GNU General Public
+    License and the FreeRTOS license exception along with FreeRTOS; if not it
+    can be viewed here: http://www.freertos.org/a00114.html and also obtained
+    by writing to Richard Barry, contact details for whom are available on the
+    FreeRTOS WEB site.
+
+    1 tab == 4 spaces!
+
+    http://www.FreeRTOS.org - Documentation, latest information, license and
+    contact details.
+
+    http://www.SafeRTOS.com - A version that is certified for use in safety
+    critical systems.
+
+    http://www.OpenRTOS.com - Commercial support, development, porting,
+    licensing and training services.
+*/
+
+
+#ifndef PL181_MMCI_H
+#define PL181_MMCI_H
+
+/* Driver for the SD card in the PL181 MultiMedia Card Interface of the
+Realview PBX-A9.
+
+Reads and writes are queued by the calling tasks and carried out one at a time
+by the I/O task, which also brings the card up when it starts.  A transfer of
+several blocks is made with one multiple block command.  The interrupt moves
+the data between the FIFO and the buffers, so the I/O task only waits for the
+end of each command and transfer. */
+
+/* Bytes in a block.  Every transfer is made of whole blocks. */
+#define mmciBLOCK_SIZE				( 512UL )
+
+/* Requests that can be queued at once.  Further callers wait for a slot. */
+#ifndef mmciMAX_REQUESTS
+	#define mmciMAX_REQUESTS		( 4 )
+#endif
+
+#ifndef mmciTASK_STACK_SIZE
+	#define mmciTASK_STACK_SIZE		( configMINIMAL_STACK_SIZE * 2 )
+#endif
+
+typedef struct MMCI_STATISTICS
+{
+	unsigned long ulInterrupts;
+	unsigned long ulReads;			/* Read requests, each made of one or more commands. */
+	unsigned long ulWrites;
+	unsigned long ulBlocksRead;
+	unsigned long ulBlocksWritten;
+	unsigned long ulErrors;			/* Requests that failed. */
+} xMMCIStats;
+
+/*
+ * Create the I/O task, which brings up the card before it takes the first
+ * request.  Requests made before then wait for it, and fail if there is no
+ * card.
+ */
+portBASE_TYPE xMMCIInitialise( unsigned portBASE_TYPE uxPriority );
+
+/*
+ * Transfer ulCount blocks, starting at block ulBlock, between the card and the
+ * contiguous buffer at pvBuffer.  Each returns once the transfer is over, and
+ * pdFAIL if any of it failed.
+ */
+portBASE_TYPE xMMCIRead( unsigned long ulBlock, unsigned long ulCount, void *pvBuffer );
+portBASE_TYPE xMMCIWrite( unsigned long ulBlock, unsigned long ulCount, const void *pvBuffer );
+
+/*
+ * As above, with a separate buffer for each block: block ulBlock + n goes to or
+ * comes from ppucBlocks[ n ].  The block cache uses these to read ahead and to
+ * write back into and out of its scattered buffers with one command.
+ */
+portBASE_TYPE xMMCIReadBlocks( unsigned long ulBlock, unsigned long ulCount, unsigned char * const *ppucBlocks );
+portBASE_TYPE xMMCIWriteBlocks( unsigned long ulBlock, unsigned long ulCount, unsigned char * const *ppucBlocks );
+
+/*
+ * The number of blocks on the card, or 0 if there is none.  Waits for the card
+ * to be brought up.
+ */
+unsigned long ulMMCIGetBlockCount( void );
+
+void vMMCIGetStats( xMMCIStats *pxStats );
+
+#endif /* PL181_MMCI_H */
@@ -18,49 +18,127 @@
 */
 
 #include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <string.h>
 #include <stdbool.h>
 
+#include "printf-stdarg.h"
+
 #ifdef PRINTF_FLOAT_SUPPORT
 #include <math.h>
-#include <stdint.h>
 #include <ctype.h>
 #endif
 
-static int print(char **out,const char *format,va_list args);
+// Size of the buffer a single conversion is built in. Zero padding and float
+// precision are limited so that a conversion always fits.
+#define PRINT_BUFFER_SIZE 128
+#define PRINT_MAX_ZEROPAD (PRINT_BUFFER_SIZE-8)
+#define PRINT_MAX_PRECISION 40
+
+// Where formatted output goes: a string, stopping at end if end is not null,
+// or a sink, which is handed the output in runs collected in stage.
+typedef struct
+{
+	char *pos;
+	char *end;
+	printsink sink;
+	void *context;
+	size_t staged;
+	char stage[32];
+} printdest;
+
+static int print(printdest *out,const char *format,va_list args);
 static char *formatinteger(char *bufferend,unsigned int absvalue,
 unsigned int base,char letterbase,int zeropadwidth,bool zeroisempty);
 #ifdef PRINTF_FLOAT_SUPPORT
 static char *formatfloat(char *bufferstart,double absvalue,
 int precision,int zeropadwidth,bool forceperiod);
+static char *formatlargefloat(char *bufferstart,double absvalue,
+int precision,int zeropadwidth,bool forceperiod);
 #endif
-static int printstring(char **out,const char *string,int width,bool padleft);
-static void printchar(char **out,int c);
+static int printstring(printdest *out,const char *string,int width,bool padleft);
+static void printrun(printdest *out,const char *string,size_t length);
+static void printchar(printdest *out,int c);
+static void printflush(printdest *out);
+static void consolesink(void *context,const char *data,size_t length);
+int vsnprintf(char *out,size_t size,const char *format,va_list args);
 int putchar(int c);
 
+// Two digit decimal strings for 00 to 99.
+static const char digitpairs[200]=
+"00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+"40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+"8081828384858687888990919293949596979899";
+
 int printf(const char *format,...)
 {
 	va_list args;
 	va_start(args,format);
-	return print(0,format,args);
+	int count=vsinkprintf(consolesink,NULL,format,args);
+	va_end(args);
+	return count;
 }
 
 int sprintf(char *out,const char *format,...)
+{
+	printdest dest={out,NULL,NULL,NULL,0};
+	va_list args;
+	va_start(args,format);
+	int count=print(&dest,format,args);
+	va_end(args);
+	return count;
+}
+
+int snprintf(char *out,size_t size,const char *format,...)
+{
+	va_list args;
+	va_start(args,format);
+	int count=vsnprintf(out,size,format,args);
+	va_end(args);
+	return count;
+}
+
+// Like sprintf, but writes at most size characters including the terminating
+// null. Returns the length the whole output would have had.
+int vsnprintf(char *out,size_t size,const char *format,va_list args)
+{
+	char scratch[1];
+	printdest dest={scratch,scratch,NULL,NULL,0};
+
+	// With size 0 nothing may be written, so only the scratch byte is used.
+	if(size>0) { dest.pos=out; dest.end=out+size-1; }
+
+	return print(&dest,format,args);
+}
+
+int sinkprintf(printsink sink,void *context,const char *format,...)
 {
 	va_list args;
 	va_start(args,format);
-	return print(&out,format,args);
+	int count=vsinkprintf(sink,context,format,args);
+	va_end(args);
+	return count;
+}
+
+int vsinkprintf(printsink sink,void *context,const char *format,va_list args)
+{
+	printdest dest={NULL,NULL,sink,context,0};
+	return print(&dest,format,args);
 }
 
 int puts(const char *s)
 {
-	return printstring(0,s,0,false);
+	printdest dest={NULL,NULL,consolesink,NULL,0};
+	int count=printstring(&dest,s,0,false);
+	printflush(&dest);
+	return count;
 	//printf("%s",s);
 }
 
-static int print(char **out,const char *format,va_list args)
+static int print(printdest *out,const char *format,va_list args)
 {
-	char buffer[128];
+	char buffer[PRINT_BUFFER_SIZE];
 	char *bufferend=&buffer[sizeof(buffer)];
 	int count=0;
 
@@ -252,6 +330,7 @@ static int print(char **out,const char *format,va_list args)
 
 				// Default precision is 6.
 				if(precision<0) precision=6;
+				if(precision>PRINT_MAX_PRECISION) precision=PRINT_MAX_PRECISION;
 
 				// Calculate zero padding.
 				int zeropadwidth=0;
@@ -262,7 +341,8 @@ static int print(char **out,const char *format,va_list args)
 					if(isnegative || positivechar) zeropadwidth-=1;
 				}
 
-				char *string=formatfloat(buffer,absvalue,precision,zeropadwidth,alternate);
+				// Leave room in front for the sign.
+				char *string=formatfloat(&buffer[1],absvalue,precision,zeropadwidth,alternate);
 
 				// Handle the sign.
 				if(isnegative) *--string='-';
@@ -285,9 +365,12 @@ static int print(char **out,const char *format,va_list args)
 		}
 		else
 		{
-			printnormal:
-			printchar(out,*format);
-			count++;
+			// Pass the text up to the next conversion on in one go.
+			printnormal: (void)0;
+			const char *run=format;
+			while(format[1] && format[1]!='%') format++;
+			printrun(out,run,format-run+1);
+			count+=format-run+1;
 		}
 
 		format++;
@@ -295,9 +378,8 @@ static int print(char **out,const char *format,va_list args)
 
 	end: (void)0;
 
-	if(out) **out=0;
-
-	va_end(args);
+	if(out->sink) printflush(out);
+	else *out->pos=0;
 
 	return count;
 }
@@ -308,16 +390,39 @@ unsigned int base,char letterbase,int zeropadwidth,bool zeroisempty)
 	char *string=bufferend;
 	*--string=0;
 
-	// Generate the digits in reverse.
+	// Generate the digits in reverse. The Cortex-A9 has no divide instruction,
+	// so only multiplications and shifts are used.
 	if(!absvalue)
 	{
 		if(!zeroisempty) *--string='0';
 	}
+	else if(base==10)
+	{
+		while(absvalue>=100)
+		{
+			// Divide by 100 by multiplying with its reciprocal, which is exact
+			// for every 32 bit value, and emit two digits at once.
+			unsigned int quotient=(unsigned int)(((uint64_t)absvalue*0x51EB851FU)>>37);
+			const char *pair=&digitpairs[(absvalue-quotient*100)*2];
+			*--string=pair[1];
+			*--string=pair[0];
+			absvalue=quotient;
+		}
+
+		if(absvalue>=10)
+		{
+			*--string=digitpairs[absvalue*2+1];
+			*--string=digitpairs[absvalue*2];
+		}
+		else *--string=absvalue+'0';
+	}
 	else
 	{
+		// Bases 8 and 16.
+		unsigned int shift=base==16?4:3;
 		while(absvalue)
 		{
-			unsigned int digit=absvalue%base;
+			unsigned int digit=absvalue&(base-1);
 
 			char c;
 			if(digit>=10) c=digit-10+letterbase;
@@ -325,11 +430,12 @@ unsigned int base,char letterbase,int zeropadwidth,bool zeroisempty)
 
 			*--string=c;
 
-			absvalue/=base;
+			absvalue>>=shift;
 		}
 	}
 
 	// Zero pad the number if requested.
+	if(zeropadwidth>PRINT_MAX_ZEROPAD) zeropadwidth=PRINT_MAX_ZEROPAD;
 	if(zeropadwidth>0)
 	{
 		int length=bufferend-string-1;
@@ -342,6 +448,121 @@ unsigned int base,char letterbase,int zeropadwidth,bool zeroisempty)
 #ifdef PRINTF_FLOAT_SUPPORT
 
 static char *formatfloat(char *bufferstart,double absvalue,int precision,int zeropadwidth,bool forceperiod)
+{
+	union { uint64_t l; double f; } pun;
+
+	pun.f=absvalue;
+	int exp2=(pun.l>>52)&0x7ff;
+	uint64_t mant=pun.l&0x000fffffffffffffULL;
+
+	if(exp2==0x7ff)
+	{
+		if(mant) strcpy(bufferstart,"nan");
+		else strcpy(bufferstart,"inf");
+		return bufferstart;
+	}
+
+	// Denormals have no implicit leading one.
+	if(exp2==0) exp2=1;
+	else mant|=0x0010000000000000ULL;
+
+	// The value is mant/2^fractionbits. Work on it with integers only, which
+	// avoids the soft-float library unless the integer part needs more than 64
+	// bits.
+	int fractionbits=1075-exp2;
+	if(fractionbits<-11) return formatlargefloat(bufferstart,absvalue,precision,zeropadwidth,forceperiod);
+
+	// Split off the integer part, leaving a fraction of at most 60 bits that can
+	// be multiplied by 10 without overflowing. Bits below 2^-60 are dropped,
+	// which can only show from the 19th decimal on.
+	uint64_t integer=0;
+	if(fractionbits<=0)
+	{
+		integer=mant<<-fractionbits;
+		mant=0;
+		fractionbits=1;
+	}
+	else if(fractionbits<=60)
+	{
+		integer=mant>>fractionbits;
+		mant&=(1ULL<<fractionbits)-1;
+	}
+	else
+	{
+		mant=fractionbits-60<64?mant>>(fractionbits-60):0;
+		fractionbits=60;
+	}
+
+	// Generate the fraction digits, then round what is left, to even on a tie.
+	char fraction[PRINT_MAX_PRECISION];
+	uint64_t mask=(1ULL<<fractionbits)-1;
+	for(int i=0;i<precision;i++)
+	{
+		mant*=10;
+		fraction[i]=(mant>>fractionbits)+'0';
+		mant&=mask;
+	}
+
+	uint64_t half=1ULL<<(fractionbits-1);
+	bool odd=precision>0?fraction[precision-1]&1:integer&1;
+	if(mant>half || (mant==half && odd))
+	{
+		int i=precision-1;
+		while(i>=0 && fraction[i]=='9') fraction[i--]='0';
+		if(i>=0) fraction[i]++;
+		else integer++;
+	}
+
+	// Generate the integer digits in reverse, nine at a time while they do not
+	// fit in 32 bits. Only then is the library called, for a 64 bit division.
+	char integerbuffer[20];
+	char *integerdigits=&integerbuffer[sizeof(integerbuffer)];
+	unsigned int part;
+	while(integer>0xFFFFFFFFULL)
+	{
+		part=integer%1000000000U;
+		integer/=1000000000U;
+		for(int i=0;i<9;i++)
+		{
+			// Divide by 10 by multiplying with its reciprocal.
+			unsigned int quotient=(unsigned int)(((uint64_t)part*0xCCCCCCCDU)>>35);
+			*--integerdigits=part-quotient*10+'0';
+			part=quotient;
+		}
+	}
+	part=integer;
+	do
+	{
+		unsigned int quotient=(unsigned int)(((uint64_t)part*0xCCCCCCCDU)>>35);
+		*--integerdigits=part-quotient*10+'0';
+		part=quotient;
+	}
+	while(part);
+	int integerlength=&integerbuffer[sizeof(integerbuffer)]-integerdigits;
+
+	// Elide decimal point for 0-precision, except when explicitly requested.
+	bool period=precision>0 || forceperiod;
+	int numberofdigits=integerlength+(period?precision+1:0);
+
+	char *ptr=bufferstart;
+
+	// Zero pad if requested.
+	if(zeropadwidth>PRINT_MAX_ZEROPAD) zeropadwidth=PRINT_MAX_ZEROPAD;
+	for(int i=numberofdigits;i<zeropadwidth;i++) *ptr++='0';
+
+	memcpy(ptr,integerdigits,integerlength);
+	ptr+=integerlength;
+	if(period) *ptr++='.';
+	memcpy(ptr,fraction,precision);
+	ptr+=precision;
+
+	*ptr=0;
+	return bufferstart;
+}
+
+// The soft-float version, for values of 2^64 and up, too large for
+// formatfloat() to split into integers.
+static char *formatlargefloat(char *bufferstart,double absvalue,int precision,int zeropadwidth,bool forceperiod)
 {
 	absvalue+=0.5/pow(10,precision);
 
@@ -397,6 +618,13 @@ static char *formatfloat(char *bufferstart,double absvalue,int precision,int zer
 		if(!forceperiod) numberofdigits--;
 	}
 
+	// Give up on numbers too long for the buffer.
+	if(numberofdigits>PRINT_MAX_ZEROPAD)
+	{
+		strcpy(bufferstart,"ovf");
+		return bufferstart;
+	}
+
 	pun.f=absvalue;
 	exp2=((pun.l>>52)&0x7ff)-1023;
 	mant=pun.l&0x000fffffffffffffULL;
@@ -410,6 +638,7 @@ static char *formatfloat(char *bufferstart,double absvalue,int precision,int zer
 	char *ptr=bufferstart;
 
 	// Zero pad if requested.
+	if(zeropadwidth>PRINT_MAX_ZEROPAD) zeropadwidth=PRINT_MAX_ZEROPAD;
 	if(numberofdigits<zeropadwidth)
 	{
 		int pad=zeropadwidth-numberofdigits;
@@ -437,56 +666,84 @@ static char *formatfloat(char *bufferstart,double absvalue,int precision,int zer
 	*ptr++=0;
 	return bufferstart;
 }
+
 #endif
 
-static int printstring(char **out,const char *string,int width,bool padleft)
+static int printstring(printdest *out,const char *string,int width,bool padleft)
 {
-	int count=0;
+	int length=strlen(string);
+	int count=length;
 
-	// If we need to pad on the left, calculate the length of the string and
-	// print the appropriate amount of padding.
-	if(width>0 && padleft)
+	// Print any padding on the left, then the string, then any padding on the
+	// right.
+	if(padleft)
 	{
-		const char *end=string;
-		while(*end) end++;
+		for(;count<width;count++) printchar(out,' ');
+	}
+
+	printrun(out,string,length);
+
+	for(;count<width;count++) printchar(out,' ');
+
+	return count;
+}
 
-		int length=end-string;
-		for(int i=0;i<width-length;i++)
+static void printrun(printdest *out,const char *string,size_t length)
+{
+	if(out->sink)
+	{
+		if(out->staged+length>sizeof(out->stage))
 		{
-			printchar(out,' ');
-			count++;
+			printflush(out);
+
+			// Long runs go to the sink directly rather than through the stage.
+			if(length>=sizeof(out->stage))
+			{
+				out->sink(out->context,string,length);
+				return;
+			}
 		}
-	}
 
-	// Print the contents of the string.
-	while(*string)
+		memcpy(&out->stage[out->staged],string,length);
+		out->staged+=length;
+	}
+	else
 	{
-		printchar(out,*string);
-		count++;
-		string++;
+		// Drop what does not fit.
+		if(out->end && length>(size_t)(out->end-out->pos)) length=out->end-out->pos;
+		memcpy(out->pos,string,length);
+		out->pos+=length;
 	}
+}
 
-	// Print any remaining padding on the right, if needed.
-	while(count<width)
+static void printchar(printdest *out,int c)
+{
+	if(out->sink)
 	{
-		printchar(out,' ');
-		count++;
+		if(out->staged==sizeof(out->stage)) printflush(out);
+		out->stage[out->staged++]=c;
+	}
+	else
+	{
+		// Drop what does not fit, but keep counting.
+		if(!out->end || out->pos<out->end) *out->pos++=c;
 	}
-
-	return count;
 }
 
-static void printchar(char **out,int c)
+static void printflush(printdest *out)
 {
-	if(out) *(*out)++=c;
-	else putchar(c);
+	if(out->staged)
+	{
+		out->sink(out->context,out->stage,out->staged);
+		out->staged=0;
+	}
 }
 
 
 
 
 #ifndef TEST_PRINTF
-extern void xUARTSendCharacter(unsigned long ulUARTPeripheral,signed char cChar,unsigned long xDelay);
+extern unsigned long ulUARTWrite(unsigned long ulUARTPeripheral,const unsigned char *pucBuffer,unsigned long ulLength,unsigned long xDelay);
 
 static inline unsigned long portCORE_ID(void)
 {
@@ -495,16 +752,51 @@ static inline unsigned long portCORE_ID(void)
 	return val&3;
 }
 
+// Console output goes straight into the UART transmit ring.
+static void consolesink(void *context,const char *data,size_t length)
+{
+	(void)context;
+	ulUARTWrite(portCORE_ID(),(const unsigned char *)data,length,0);
+}
+
 int putchar(int c)
 {
-	xUARTSendCharacter(portCORE_ID(),c,0);
+	char ch=c;
+	consolesink(NULL,&ch,1);
 	return 0;
 }
+#else
+static void consolesink(void *context,const char *data,size_t length)
+{
+	(void)context;
+	while(length--) putchar(*data++);
+}
 #endif
 
 
 
 #ifdef TEST_PRINTF
+// Counts what sinkprintf() hands over and passes it on to the console.
+static void countingsink(void *context,const char *data,size_t length)
+{
+	*(size_t *)context+=length;
+	consolesink(NULL,data,length);
+}
+
+#ifdef BENCHMARK_PRINTF
+#include <time.h>
+
+// Time one conversion type, in nanoseconds per call. The format is hidden
+// from the compiler, which would otherwise turn some calls into strcpy().
+#define BENCHMARK(format,value) \
+	do { \
+		const char *volatile hidden=format; \
+		clock_t start=clock(); \
+		for(long n=0;n<1000000;n++) snprintf(buf,sizeof(buf),hidden,value); \
+		printf("%-8s %d ns\n",format,(int)((clock()-start)*1000/CLOCKS_PER_SEC)); \
+	} while(0)
+#endif
+
 int main(void)
 {
 	char *ptr = "Hello world!";
@@ -561,6 +853,27 @@ int main(void)
 	sprintf(buf, "3.141592 precision 4: %.4f\n", 3.141592); printf("%s", buf);
 	sprintf(buf, "3.141592 precision 5: %.5f\n", 3.141592); printf("%s", buf);
 	sprintf(buf, "3.141592 precision 6: %.6f\n", 3.141592); printf("%s", buf);
+	sprintf(buf, "-2.5 rounded to even: %.0f\n", -2.5); printf("%s", buf);
+	sprintf(buf, "0.0999 rounded up: %.2f\n", 0.0999); printf("%s", buf);
+	sprintf(buf, "2^40 + 0.25: %.2f\n", 1099511627776.25); printf("%s", buf);
+	sprintf(buf, "1e-5 zero padded: %010.6f\n", 1e-5); printf("%s", buf);
+	#endif
+	i = snprintf(buf, 8, "%s", "truncated string");
+	printf("snprintf: \"%s\" of %d\n", buf, i);
+	i = snprintf(NULL, 0, "%d", 12345);
+	printf("snprintf length only: %d\n", i);
+	size_t sunk = 0;
+	sinkprintf(countingsink, &sunk, "sinkprintf %s %u\n", "hands over", 4000000000u);
+	printf("sinkprintf: %d characters\n", (int)sunk);
+
+	#ifdef BENCHMARK_PRINTF
+	BENCHMARK("%d", -123456789);
+	BENCHMARK("%u", 4000000000u);
+	BENCHMARK("%08x", 0xdeadbeef);
+	BENCHMARK("%s", "a string of some length");
+	BENCHMARK("%f", 3.141592);
+	BENCHMARK("%.2f", 123456.789);
+	BENCHMARK("text %d", 0);
 	#endif
 
 	return 0;
@@ -612,6 +925,29 @@ int main(void)
  * -3:  -03 with precision and width
  * -3: -03  with precision, width and left justification
  * -3:  -03 with precision, width and zero padding
+ *
+ * and with PRINTF_FLOAT_SUPPORT defined:
+ *
+ * 3.141592 precision 0: 3
+ * 3.141592 precision 1: 3.1
+ * 3.141592 precision 2: 3.14
+ * 3.141592 precision 3: 3.142
+ * 3.141592 precision 4: 3.1416
+ * 3.141592 precision 5: 3.14159
+ * 3.141592 precision 6: 3.141592
+ * -2.5 rounded to even: -2
+ * 0.0999 rounded up: 0.10
+ * 2^40 + 0.25: 1099511627776.25
+ * 1e-5 zero padded: 000.000010
+ *
+ * followed by:
+ *
+ * snprintf: "truncat" of 16
+ * snprintf length only: 5
+ * sinkprintf hands over 4000000000
+ * sinkprintf: 33 characters
+ *
+ * Defining BENCHMARK_PRINTF as well times snprintf() for each conversion.
  */
 
 #endif
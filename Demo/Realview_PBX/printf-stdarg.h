@@ -0,0 +1,37 @@
+/*
+	Copyright 2001, 2002 Georges Menie (www.menie.org)
+	stdarg version contributed by Christian Ettinger
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+// The parts of printf-stdarg.c that stdio.h does not declare.
+
+#ifndef PRINTF_STDARG_H
+#define PRINTF_STDARG_H
+
+#include <stdarg.h>
+#include <stddef.h>
+
+// Receives formatted output a run of length characters at a time. The runs
+// are not null terminated.
+typedef void (*printsink)(void *context,const char *data,size_t length);
+
+// Like printf, but hands the output to sink, along with context, instead of
+// the console. Returns the number of characters output.
+int sinkprintf(printsink sink,void *context,const char *format,...) __attribute__((format(printf,3,4)));
+int vsinkprintf(printsink sink,void *context,const char *format,va_list args);
+
+#endif
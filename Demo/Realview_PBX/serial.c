@@ -59,10 +59,7 @@
 
 #include "FreeRTOS.h"
 #include "serial.h"
-
-extern portBASE_TYPE xUARTReceiveCharacter( unsigned long ulUARTPeripheral, signed char *pcChar, portTickType xDelay );
-extern portBASE_TYPE xUARTSendCharacter( unsigned long ulUARTPeripheral, signed char cChar, portTickType xDelay );
-extern void vUARTInitialise(unsigned long ulUARTPeripheral, unsigned long ulBaud, unsigned long ulQueueSize );
+#include "pl011.h"
 
 xComPortHandle xSerialPortInitMinimal( unsigned long ulWantedBaud, unsigned portBASE_TYPE uxQueueLength )
 {
@@ -70,25 +67,28 @@ xComPortHandle xSerialPortInitMinimal( unsigned long ulWantedBaud, unsigned port
 	return (xComPortHandle) configUART_PORT;
 }
 
+signed portBASE_TYPE xSerialWrite( xComPortHandle pxPort, const void *pvBuffer, unsigned portBASE_TYPE uxLength, portTickType xBlockTime )
+{
+	/* Long buffers go out by DMA, the rest through the transmit ring. */
+	return ( signed portBASE_TYPE ) ulUARTSendBuffer( (unsigned long)pxPort, ( const unsigned char * ) pvBuffer, uxLength, xBlockTime );
+}
+
+signed portBASE_TYPE xSerialRead( xComPortHandle pxPort, void *pvBuffer, unsigned portBASE_TYPE uxLength, portTickType xBlockTime )
+{
+	return ( signed portBASE_TYPE ) ulUARTRead( (unsigned long)pxPort, ( unsigned char * ) pvBuffer, uxLength, xBlockTime );
+}
+
 void vSerialPutString( xComPortHandle pxPort, const signed char * const pcString, unsigned short usStringLength )
 {
-unsigned short usIndex = 0;
-	for ( usIndex = 0; usIndex < usStringLength; usIndex++ )
-	{
-		if ( pdTRUE != xUARTSendCharacter( (unsigned long)pxPort, pcString[usIndex], portMAX_DELAY ) )
-		{
-			/* Something has gone wrong with the queue. */
-			break;
-		}
-	}
+	( void ) xSerialWrite( pxPort, pcString, usStringLength, portMAX_DELAY );
 }
 
 signed portBASE_TYPE xSerialGetChar( xComPortHandle pxPort, signed char *pcRxedChar, portTickType xBlockTime )
 {
-	return xUARTReceiveCharacter( (unsigned long)pxPort, pcRxedChar, xBlockTime );
+	return ( 1 == xSerialRead( pxPort, pcRxedChar, 1, xBlockTime ) ) ? pdTRUE : pdFALSE;
 }
 
 signed portBASE_TYPE xSerialPutChar( xComPortHandle pxPort, signed char cOutChar, portTickType xBlockTime )
 {
-	return xUARTSendCharacter( (unsigned long)pxPort, cOutChar, xBlockTime );
+	return ( 1 == xSerialWrite( pxPort, &cOutChar, 1, xBlockTime ) ) ? pdTRUE : pdFALSE;
 }
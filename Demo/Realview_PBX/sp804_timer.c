@@ -58,6 +58,9 @@
 */
 
 #include "FreeRTOS.h"
+
+#include "aio.h"
+#include "sp804_timer.h"
 /*----------------------------------------------------------------------------*/
 
 #define TIMER_0_1_BASE		( 0x10011000 )	/* Realview PBX-A9 */
@@ -76,6 +79,30 @@
 #define TIMER_2_RIS			( ( unsigned long * volatile ) ( TIMER_0_1_BASE + 0x30 ) )	/* Raw Interrupt Status Register */
 #define TIMER_2_MIS			( ( unsigned long * volatile ) ( TIMER_0_1_BASE + 0x34 ) )	/* Masked Interrupt Status Register */
 #define TIMER_2_BGLOAD		( ( unsigned long * volatile ) ( TIMER_0_1_BASE + 0x38 ) )	/* Background Load Register */
+
+/* Timer 2, the first of the second SP804, counts requests down. */
+#define TIMER_2_3_BASE		( 0x10012000 )	/* Realview PBX-A9 */
+#define TIMER_3_LOAD		( ( unsigned long * volatile ) ( TIMER_2_3_BASE + 0x0 ) )	/* Load Register */
+#define TIMER_3_VALUE		( ( unsigned long * volatile ) ( TIMER_2_3_BASE + 0x04 ) )	/* Current Value Register */
+#define TIMER_3_CONTROL		( ( unsigned long * volatile ) ( TIMER_2_3_BASE + 0x08 ) )	/* Control Register */
+#define TIMER_3_INTCLR		( ( unsigned long * volatile ) ( TIMER_2_3_BASE + 0x0C ) )	/* Interrupt Clear Register */
+#define TIMER_2_3_VECTOR_ID	( 37 )
+
+#define TIMER_CONTROL_ENABLE		( 0x80UL )
+#define TIMER_CONTROL_INT_ENABLE	( 0x20UL )
+#define TIMER_CONTROL_32BIT			( 0x02UL )
+#define TIMER_CONTROL_ONE_SHOT		( 0x01UL )
+/*----------------------------------------------------------------------------*/
+
+static xAIODevice xTimer2AIO;
+static portBASE_TYPE xTimer2Installed = pdFALSE;
+
+/*
+ * Count down the request at the head, or stop counting it when it is
+ * cancelled.
+ */
+static void prvTimer2Start( xAIODevice *pxDevice, xAIORequest *pxRequest, portBASE_TYPE *pxHigherPriorityTaskWoken );
+static void prvTimer2Stop( xAIODevice *pxDevice, xAIORequest *pxRequest );
 /*----------------------------------------------------------------------------*/
 
 void vTimer0Initialise( unsigned long ulLoadValue )
@@ -102,3 +129,73 @@ extern void vTaskIncrementTick( void );
 #endif /* configUSE_PREEMPTION */
 }
 /*----------------------------------------------------------------------------*/
+
+xAIODevice *pxTimer2Initialise( void )
+{
+extern void vPortInstallInterruptHandler( void (*vHandler)(void *), void *pvParameter, unsigned long ulVector, unsigned char ucEdgeTriggered, unsigned char ucPriority, unsigned char ucProcessorTargets );
+
+	if( pdFALSE == xTimer2Installed )
+	{
+		*TIMER_3_CONTROL = 0UL;
+		*TIMER_3_INTCLR = 1;
+
+		vAIODeviceInitialise( &xTimer2AIO, prvTimer2Start, prvTimer2Stop, NULL );
+		vPortInstallInterruptHandler( vTimer2InterruptHandler, NULL, TIMER_2_3_VECTOR_ID, pdFALSE, configMAX_SYSCALL_INTERRUPT_PRIORITY, 1 << portCORE_ID() );
+		xTimer2Installed = pdTRUE;
+	}
+
+	return &xTimer2AIO;
+}
+/*----------------------------------------------------------------------------*/
+
+void vTimer2InterruptHandler( void *pvParameter )
+{
+xAIORequest *pxRequest;
+portBASE_TYPE xTaskWoken = pdFALSE;
+
+	( void ) pvParameter;
+
+	/* One shot, so the timer has stopped itself. */
+	*TIMER_3_INTCLR = 1;
+
+	pxRequest = pxAIOActive( &xTimer2AIO );
+	if( NULL != pxRequest )
+	{
+		pxRequest->ulDone = pxRequest->ulLength;
+		pxRequest = pxAIOComplete( &xTimer2AIO, aioDONE, &xTaskWoken );
+
+		if( NULL != pxRequest )
+		{
+			prvTimer2Start( &xTimer2AIO, pxRequest, &xTaskWoken );
+		}
+	}
+
+	portEND_SWITCHING_ISR( xTaskWoken );
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvTimer2Start( xAIODevice *pxDevice, xAIORequest *pxRequest, portBASE_TYPE *pxHigherPriorityTaskWoken )
+{
+	( void ) pxDevice;
+	( void ) pxHigherPriorityTaskWoken;
+
+	/* The counter interrupts on reaching 0, so 0 itself is not a count. */
+	*TIMER_3_CONTROL = 0UL;
+	*TIMER_3_LOAD = ( 0UL != pxRequest->ulLength ) ? pxRequest->ulLength : 1UL;
+	*TIMER_3_CONTROL = TIMER_CONTROL_ENABLE | TIMER_CONTROL_INT_ENABLE | TIMER_CONTROL_32BIT | TIMER_CONTROL_ONE_SHOT;
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvTimer2Stop( xAIODevice *pxDevice, xAIORequest *pxRequest )
+{
+	( void ) pxDevice;
+
+	*TIMER_3_CONTROL = 0UL;
+	*TIMER_3_INTCLR = 1;
+
+	if( *TIMER_3_VALUE < pxRequest->ulLength )
+	{
+		pxRequest->ulDone = pxRequest->ulLength - *TIMER_3_VALUE;
+	}
+}
+/*----------------------------------------------------------------------------*/
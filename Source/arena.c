@@ -0,0 +1,232 @@
+/*
+    FreeRTOS V7.1.0 - Copyright (C) 2011 Real Time Engineers Ltd.
+	
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS tutorial books are available in pdf and paperback.        *
+     *    Complete, revised, and edited pdf reference manuals are also       *
+     *    available.                                                         *
+     *                                                                       *
+     *    Purchasing FreeRTOS documentation will not only help you, by       *
+     *    ensuring you get running as quickly as possible and with an        *
+     *    in-depth knowledge of how to use FreeRTOS, it will also help       *
+     *    the FreeRTOS project to continue with its mission of providing     *
+     *    professional grade, cross platform, de facto standard solutions    *
+     *    for microcontrollers - completely free of charge!                  *
+     *                                                                       *
+     *    >>> See http://www.FreeRTOS.org/Documentation for details. <<<     *
+     *                                                                       *
+     *    Thank you for using FreeRTOS, and thank you for your support!      *
+     *                                                                       *
+    ***************************************************************************
+
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation AND MODIFIED BY the FreeRTOS exception.
+    >>>NOTE<<< The modification to the GPL is included to allow you to
+    distribute a combined work that includes FreeRTOS without being obliged to
+    provide the source code for proprietary components outside of the FreeRTOS
+    kernel.  FreeRTOS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details. You should have received a copy of the GNU General Public
+    License and the FreeRTOS license exception along with FreeRTOS; if not it
+    can be viewed here: http://www.freertos.org/a00114.html and also obtained
+    by writing to Richard Barry, contact details for whom are available on the
+    FreeRTOS WEB site.
+
+    1 tab == 4 spaces!
+
+    http://www.FreeRTOS.org - Documentation, latest information, license and
+    contact details.
+
+    http://www.SafeRTOS.com - A version that is certified for use in safety
+    critical systems.
+
+    http://www.OpenRTOS.com - Commercial support, development, porting,
+    licensing and training services.
+*/
+
+#include <stdlib.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "arena.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* Round a size up to keep the memory that follows it aligned. */
+#define arenaALIGN_UP( xSize )	( ( ( xSize ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+
+/* Every chunk other than the first starts with a link to the next chunk.  The
+memory handed out follows the link. */
+typedef struct ARENA_CHUNK
+{
+	struct ARENA_CHUNK *pxNextChunk;
+} xArenaChunk;
+
+#define arenaCHUNK_HEADER_SIZE	arenaALIGN_UP( sizeof( xArenaChunk ) )
+
+/* The definition of the arenas themselves.  The first chunk immediately
+follows the control structure. */
+typedef struct arenaArenaControl
+{
+	unsigned char	*pucNextFree;		/*<< The next byte that will be handed out from the current chunk. */
+	unsigned char	*pucChunkEnd;		/*<< One past the last byte of the current chunk. */
+	xArenaChunk		*pxChunks;			/*<< The chunks allocated after the first, most recent first. */
+	size_t			xChunkSize;			/*<< The number of bytes in each chunk, rounded up to a multiple of portBYTE_ALIGNMENT. */
+	size_t			xBytesAllocated;	/*<< The bytes handed out since the arena was created or reset. */
+} xARENA;
+
+#define arenaCONTROL_SIZE	arenaALIGN_UP( sizeof( xARENA ) )
+
+/*
+ * Allocate xSize bytes from a new chunk, which becomes the current chunk if
+ * it would have more free space left than the chunk currently in use.
+ */
+static void *prvAllocateFromNewChunk( xARENA *pxArena, size_t xSize ) PRIVILEGED_FUNCTION;
+
+/*
+ * Return every chunk other than the first to the heap.
+ */
+static void prvFreeChunks( xARENA *pxArena ) PRIVILEGED_FUNCTION;
+
+/*-----------------------------------------------------------*/
+
+xArenaHandle xArenaCreate( size_t xChunkSize )
+{
+xARENA *pxArena = NULL;
+
+	configASSERT( ( xChunkSize > 0 ) );
+
+	if( xChunkSize > 0 )
+	{
+		xChunkSize = arenaALIGN_UP( xChunkSize );
+
+		/* Allocate the control structure and the first chunk together. */
+		pxArena = ( xARENA * ) pvPortMalloc( arenaCONTROL_SIZE + xChunkSize );
+
+		if( pxArena != NULL )
+		{
+			pxArena->xChunkSize = xChunkSize;
+			pxArena->pxChunks = NULL;
+			vArenaReset( ( xArenaHandle ) pxArena );
+		}
+	}
+
+	return ( xArenaHandle ) pxArena;
+}
+/*-----------------------------------------------------------*/
+
+void vArenaDelete( xArenaHandle xArena )
+{
+xARENA *pxArena = ( xARENA * ) xArena;
+
+	prvFreeChunks( pxArena );
+
+	/* This also frees the first chunk. */
+	vPortFree( pxArena );
+}
+/*-----------------------------------------------------------*/
+
+void *pvArenaAlloc( xArenaHandle xArena, size_t xSize )
+{
+xARENA *pxArena = ( xARENA * ) xArena;
+void *pvReturn;
+
+	xSize = arenaALIGN_UP( xSize );
+
+	if( xSize <= ( size_t ) ( pxArena->pucChunkEnd - pxArena->pucNextFree ) )
+	{
+		/* The common case - just advance through the current chunk. */
+		pvReturn = ( void * ) pxArena->pucNextFree;
+		pxArena->pucNextFree += xSize;
+	}
+	else
+	{
+		pvReturn = prvAllocateFromNewChunk( pxArena, xSize );
+	}
+
+	if( pvReturn != NULL )
+	{
+		pxArena->xBytesAllocated += xSize;
+	}
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vArenaReset( xArenaHandle xArena )
+{
+xARENA *pxArena = ( xARENA * ) xArena;
+
+	prvFreeChunks( pxArena );
+
+	pxArena->pucNextFree = ( ( unsigned char * ) pxArena ) + arenaCONTROL_SIZE;
+	pxArena->pucChunkEnd = pxArena->pucNextFree + pxArena->xChunkSize;
+	pxArena->xBytesAllocated = ( size_t ) 0;
+}
+/*-----------------------------------------------------------*/
+
+size_t xArenaGetBytesAllocated( xArenaHandle xArena )
+{
+	return ( ( xARENA * ) xArena )->xBytesAllocated;
+}
+/*-----------------------------------------------------------*/
+
+static void *prvAllocateFromNewChunk( xARENA *pxArena, size_t xSize )
+{
+xArenaChunk *pxChunk;
+size_t xChunkSize;
+unsigned char *pucMemory;
+
+	/* An allocation that is larger than a chunk gets a chunk of its own. */
+	xChunkSize = ( xSize > pxArena->xChunkSize ) ? xSize : pxArena->xChunkSize;
+
+	pxChunk = ( xArenaChunk * ) pvPortMalloc( arenaCHUNK_HEADER_SIZE + xChunkSize );
+
+	if( pxChunk != NULL )
+	{
+		pxChunk->pxNextChunk = pxArena->pxChunks;
+		pxArena->pxChunks = pxChunk;
+
+		pucMemory = ( ( unsigned char * ) pxChunk ) + arenaCHUNK_HEADER_SIZE;
+
+		/* Keep using whichever of the old and new chunks has the most space
+		left, so a single large allocation does not waste the rest of the
+		current chunk. */
+		if( ( xChunkSize - xSize ) > ( size_t ) ( pxArena->pucChunkEnd - pxArena->pucNextFree ) )
+		{
+			pxArena->pucNextFree = pucMemory + xSize;
+			pxArena->pucChunkEnd = pucMemory + xChunkSize;
+		}
+	}
+	else
+	{
+		pucMemory = NULL;
+	}
+
+	return ( void * ) pucMemory;
+}
+/*-----------------------------------------------------------*/
+
+static void prvFreeChunks( xARENA *pxArena )
+{
+xArenaChunk *pxChunk;
+
+	while( pxArena->pxChunks != NULL )
+	{
+		pxChunk = pxArena->pxChunks;
+		pxArena->pxChunks = pxChunk->pxNextChunk;
+		vPortFree( pxChunk );
+	}
+}
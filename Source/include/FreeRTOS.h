@@ -211,6 +211,22 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 		#error If configUSE_TIMERS is set to 1 then configTIMER_TASK_STACK_DEPTH must also be defined.
 	#endif /* configTIMER_TASK_STACK_DEPTH */
 
+	#ifndef configTIMER_SERVICE_COUNT
+		#define configTIMER_SERVICE_COUNT 1
+	#endif
+
+	#if ( configTIMER_SERVICE_COUNT < 1 ) || ( configTIMER_SERVICE_COUNT > 10 )
+		#error configTIMER_SERVICE_COUNT must be between 1 and 10.
+	#endif
+
+	#ifndef configTIMER_SERVICE_PRIORITIES
+		#if configTIMER_SERVICE_COUNT == 1
+			#define configTIMER_SERVICE_PRIORITIES { configTIMER_TASK_PRIORITY }
+		#else
+			#error If configTIMER_SERVICE_COUNT is greater than 1 then configTIMER_SERVICE_PRIORITIES must also be defined.
+		#endif
+	#endif /* configTIMER_SERVICE_PRIORITIES */
+
 #endif /* configUSE_TIMERS */
 
 #ifndef INCLUDE_xTaskGetSchedulerState
@@ -473,10 +489,85 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 	#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
 #endif
 
+#ifndef configGENERATE_TIMER_STATS
+	#define configGENERATE_TIMER_STATS 0
+#endif
+
+#if ( configGENERATE_TIMER_STATS == 1 )
+
+	#if ( configUSE_TIMERS != 1 )
+		#error configGENERATE_TIMER_STATS can only be set to 1 if configUSE_TIMERS is also set to 1.
+	#endif
+
+	#ifndef portGET_CYCLE_COUNT
+		#error If configGENERATE_TIMER_STATS is defined then portGET_CYCLE_COUNT must also be defined.  portGET_CYCLE_COUNT should return the value of a free running counter that increments at the processor clock rate.
+	#endif /* portGET_CYCLE_COUNT */
+
+	#if !defined( portGET_TICK_CYCLE_COUNT ) || !defined( portGET_CYCLES_PER_TICK )
+		#error If configGENERATE_TIMER_STATS is defined then portGET_TICK_CYCLE_COUNT and portGET_CYCLES_PER_TICK must also be defined.  They should return the value of the cycle counter when the most recent tick interrupt was taken, and the number of cycles between the two most recent tick interrupts.
+	#endif
+
+#endif /* configGENERATE_TIMER_STATS */
+
 #ifndef configUSE_MALLOC_FAILED_HOOK
 	#define configUSE_MALLOC_FAILED_HOOK 0
 #endif
 
+/* The maximum number of regions that can be passed to vPortDefineHeapRegions(). */
+#ifndef configHEAP_MAX_REGIONS
+	#define configHEAP_MAX_REGIONS 4
+#endif
+
+#ifndef configUSE_HEAP_INSTRUMENTATION
+	#define configUSE_HEAP_INSTRUMENTATION 0
+#endif
+
+#ifndef configUSE_HEAP_SLABS
+	#define configUSE_HEAP_SLABS 0
+#endif
+
+/* The number of bytes heap_5.c sets aside for slabs when configUSE_HEAP_SLABS
+is 1.  Rounded down to a multiple of the 4K slab page size. */
+#ifndef configHEAP_SLAB_ZONE_SIZE
+	#define configHEAP_SLAB_ZONE_SIZE ( 64 * 1024 )
+#endif
+
+/* Set to 1 to give each task its own newlib reentrancy structure, and to have
+heap_3.c serialise newlib's malloc and environment with a kernel mutex. */
+#ifndef configUSE_NEWLIB_REENTRANT
+	#define configUSE_NEWLIB_REENTRANT 0
+#endif
+
+/* Set to 1 to add a skip list index to every list, so ordered insertion into
+long event and delayed lists takes logarithmic rather than linear time.  Each
+list item grows by two pointers per extra level. */
+#ifndef configUSE_LIST_SKIP_INDEX
+	#define configUSE_LIST_SKIP_INDEX 0
+#endif
+
+#ifndef configLIST_SKIP_LEVELS
+	#define configLIST_SKIP_LEVELS 4
+#endif
+
+#if ( configUSE_LIST_SKIP_INDEX == 1 ) && ( configLIST_SKIP_LEVELS < 2 )
+	#error configLIST_SKIP_LEVELS must be at least 2 when configUSE_LIST_SKIP_INDEX is 1.
+#endif
+
+#ifndef configUSE_TASK_ARENAS
+	#define configUSE_TASK_ARENAS 0
+#endif
+
+/* The alignment of the task stacks and TCBs allocated by the kernel.  Setting
+these to the cache line size stops a TCB or stack sharing a cache line with
+other data. */
+#ifndef configSTACK_ALIGNMENT
+	#define configSTACK_ALIGNMENT portBYTE_ALIGNMENT
+#endif
+
+#ifndef configTCB_ALIGNMENT
+	#define configTCB_ALIGNMENT portBYTE_ALIGNMENT
+#endif
+
 #ifndef portPRIVILEGE_BIT
 	#define portPRIVILEGE_BIT ( ( unsigned portBASE_TYPE ) 0x00 )
 #endif
@@ -486,7 +577,7 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 #endif
 
 #ifndef pvPortMallocAligned
-	#define pvPortMallocAligned( x, puxStackBuffer ) ( ( ( puxStackBuffer ) == NULL ) ? ( pvPortMalloc( ( x ) ) ) : ( puxStackBuffer ) )
+	#define pvPortMallocAligned( x, puxStackBuffer ) ( ( ( puxStackBuffer ) == NULL ) ? ( pvPortMallocAlignedAttr( ( x ), configSTACK_ALIGNMENT, 0UL ) ) : ( puxStackBuffer ) )
 #endif
 
 #ifndef vPortFreeAligned
@@ -0,0 +1,170 @@
+/*
+    FreeRTOS V7.1.0 - Copyright (C) 2011 Real Time Engineers Ltd.
+	
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS tutorial books are available in pdf and paperback.        *
+     *    Complete, revised, and edited pdf reference manuals are also       *
+     *    available.                                                         *
+     *                                                                       *
+     *    Purchasing FreeRTOS documentation will not only help you, by       *
+     *    ensuring you get running as quickly as possible and with an        *
+     *    in-depth knowledge of how to use FreeRTOS, it will also help       *
+     *    the FreeRTOS project to continue with its mission of providing     *
+     *    professional grade, cross platform, de facto standard solutions    *
+     *    for microcontrollers - completely free of charge!                  *
+     *                                                                       *
+     *    >>> See http://www.FreeRTOS.org/Documentation for details. <<<     *
+     *                                                                       *
+     *    Thank you for using FreeRTOS, and thank you for your support!      *
+     *                                                                       *
+    ***************************************************************************
+
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation AND MODIFIED BY the FreeRTOS exception.
+    >>>NOTE<<< The modification to the GPL is included to allow you to
+    distribute a combined work that includes FreeRTOS without being obliged to
+    provide the source code for proprietary components outside of the FreeRTOS
+    kernel.  FreeRTOS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details. You should have received a copy of the GNU General Public
+    License and the FreeRTOS license exception along with FreeRTOS; if not it
+    can be viewed here: http://www.freertos.org/a00114.html and also obtained
+    by writing to Richard Barry, contact details for whom are available on the
+    FreeRTOS WEB site.
+
+    1 tab == 4 spaces!
+
+    http://www.FreeRTOS.org - Documentation, latest information, license and
+    contact details.
+
+    http://www.SafeRTOS.com - A version that is certified for use in safety
+    critical systems.
+
+    http://www.OpenRTOS.com - Commercial support, development, porting,
+    licensing and training services.
+*/
+
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#ifndef INC_FREERTOS_H
+	#error "include FreeRTOS.h must appear in source files before include arena.h"
+#endif
+
+#include "portable.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*-----------------------------------------------------------
+ * MACROS AND DEFINITIONS
+ *----------------------------------------------------------*/
+
+/**
+ * Type by which arenas are referenced.  For example, a call to xArenaCreate()
+ * returns an xArenaHandle variable that can then be used to reference the
+ * arena in calls to pvArenaAlloc(), vArenaReset(), etc.
+ */
+typedef void * xArenaHandle;
+
+/*-----------------------------------------------------------
+ * ARENA API
+ *----------------------------------------------------------*/
+
+/**
+ * xArenaHandle xArenaCreate( size_t xChunkSize );
+ *
+ * Creates an arena.  Memory is obtained from an arena by advancing a pointer
+ * through a chunk of memory, and is never freed individually.  Instead all the
+ * memory obtained from the arena is released at once by vArenaReset() or
+ * vArenaDelete(), which take a time proportional to the number of chunks, not
+ * the number of allocations.
+ *
+ * The control structure and the first chunk are allocated from the FreeRTOS
+ * heap with a single call to pvPortMalloc().  Further chunks are allocated
+ * from the heap as they are needed.
+ *
+ * An arena is not protected against concurrent access, so should only be
+ * used by one task at a time.  It can be attached to a task with
+ * vTaskSetArena(), in which case it is deleted along with the task.
+ *
+ * @param xChunkSize The number of bytes in each chunk.  An allocation that
+ * is larger than this is given a chunk of its own.
+ *
+ * @return The handle of the arena, or NULL if there was insufficient heap for
+ * the arena to be created.
+ *
+ * Example usage:
+ *
+ * void vHandleRequest( xRequest *pxRequest )
+ * {
+ * xArenaHandle xArena;
+ * xHeader *pxHeader;
+ *
+ *     xArena = xArenaCreate( 1024 );
+ *
+ *     if( xArena != NULL )
+ *     {
+ *         // Build the response from memory obtained from the arena.  The
+ *         // individual allocations are never freed.
+ *         pxHeader = ( xHeader * ) pvArenaAlloc( xArena, sizeof( xHeader ) );
+ *
+ *         ...
+ *
+ *         // Release everything obtained while handling the request.
+ *         vArenaDelete( xArena );
+ *     }
+ * }
+ */
+xArenaHandle xArenaCreate( size_t xChunkSize ) PRIVILEGED_FUNCTION;
+
+/**
+ * void vArenaDelete( xArenaHandle xArena );
+ *
+ * Delete an arena, returning all of its chunks, and so every allocation made
+ * from it, to the FreeRTOS heap.
+ */
+void vArenaDelete( xArenaHandle xArena ) PRIVILEGED_FUNCTION;
+
+/**
+ * void *pvArenaAlloc( xArenaHandle xArena, size_t xSize );
+ *
+ * Obtain xSize bytes from an arena.  The memory is aligned to
+ * portBYTE_ALIGNMENT, and remains valid until the arena is reset or deleted.
+ *
+ * @return The memory, or NULL if a new chunk was needed and there was
+ * insufficient heap to allocate one.
+ */
+void *pvArenaAlloc( xArenaHandle xArena, size_t xSize ) PRIVILEGED_FUNCTION;
+
+/**
+ * void vArenaReset( xArenaHandle xArena );
+ *
+ * Release every allocation made from an arena, so the arena can be reused.
+ * The first chunk is kept, and every other chunk is returned to the FreeRTOS
+ * heap.
+ */
+void vArenaReset( xArenaHandle xArena ) PRIVILEGED_FUNCTION;
+
+/**
+ * size_t xArenaGetBytesAllocated( xArenaHandle xArena );
+ *
+ * @return The number of bytes obtained from the arena since it was created or
+ * last reset, including the padding that keeps each allocation aligned.
+ */
+size_t xArenaGetBytesAllocated( xArenaHandle xArena ) PRIVILEGED_FUNCTION;
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* ARENA_H */
+
@@ -74,6 +74,15 @@
  * effectively a two way link between the object containing the list item and
  * the list item itself.
  *
+ * When configUSE_LIST_SKIP_INDEX is set to 1 each list and list item also
+ * carries a skip list index of configLIST_SKIP_LEVELS - 1 extra levels.  Each
+ * level links a randomly chosen quarter of the items of the level below in
+ * item value order, so vListInsert() can find the insertion point in a time
+ * proportional to the logarithm of the list length rather than the length
+ * itself.  The index is only used to find the insertion point - the items are
+ * still held in the ordinary doubly linked list, so every other operation and
+ * macro behaves exactly as before.
+ *
  *
  * \page ListIntroduction List Implementation
  * \ingroup FreeRTOSIntro
@@ -94,6 +103,11 @@ struct xLIST_ITEM
 	portTickType xItemValue;				/*< The value being listed.  In most cases this is used to sort the list in descending order. */
 	volatile struct xLIST_ITEM * pxNext;	/*< Pointer to the next xListItem in the list. */
 	volatile struct xLIST_ITEM * pxPrevious;/*< Pointer to the previous xListItem in the list. */
+	#if ( configUSE_LIST_SKIP_INDEX == 1 )
+		volatile struct xLIST_ITEM * pxSkipNext[ configLIST_SKIP_LEVELS - 1 ];		/*< The next item on each level of the skip index that this item is on. */
+		volatile struct xLIST_ITEM * pxSkipPrevious[ configLIST_SKIP_LEVELS - 1 ];	/*< The previous item on each level of the skip index that this item is on. */
+		unsigned portBASE_TYPE uxSkipLevels;	/*< The number of levels of the skip index the item is on. */
+	#endif
 	void * pvOwner;							/*< Pointer to the object (normally a TCB) that contains the list item.  There is therefore a two way link between the object containing the list item and the list item itself. */
 	void * pvContainer;						/*< Pointer to the list in which this list item is placed (if any). */
 };
@@ -104,6 +118,11 @@ struct xMINI_LIST_ITEM
 	portTickType xItemValue;
 	volatile struct xLIST_ITEM *pxNext;
 	volatile struct xLIST_ITEM *pxPrevious;
+	#if ( configUSE_LIST_SKIP_INDEX == 1 )
+		volatile struct xLIST_ITEM *pxSkipNext[ configLIST_SKIP_LEVELS - 1 ];
+		volatile struct xLIST_ITEM *pxSkipPrevious[ configLIST_SKIP_LEVELS - 1 ];
+		unsigned portBASE_TYPE uxSkipLevels;
+	#endif
 };
 typedef struct xMINI_LIST_ITEM xMiniListItem;
 
@@ -257,6 +276,8 @@ void vListInitialiseItem( xListItem *pxItem );
 /*
  * Insert a list item into a list.  The item will be inserted into the list in
  * a position determined by its item value (descending item value order).
+ * When configUSE_LIST_SKIP_INDEX is 1 finding the position takes O(log n)
+ * time on average, otherwise O(n).
  *
  * @param pxList The list into which the item is to be inserted.
  *
@@ -0,0 +1,238 @@
+/*
+    FreeRTOS V7.1.0 - Copyright (C) 2011 Real Time Engineers Ltd.
+
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS tutorial books are available in pdf and paperback.        *
+     *    Complete, revised, and edited pdf reference manuals are also       *
+     *    available.                                                         *
+     *                                                                       *
+     *    Purchasing FreeRTOS documentation will not only help you, by       *
+     *    ensuring you get running as quickly as possible and with an        *
+     *    in-depth knowledge of how to use FreeRTOS, it will also help       *
+     *    the FreeRTOS project to continue with its mission of providing     *
+     *    professional grade, cross platform, de facto standard solutions    *
+     *    for microcontrollers - completely free of charge!                  *
+     *                                                                       *
+     *    >>> See http://www.FreeRTOS.org/Documentation for details. <<<     *
+     *                                                                       *
+     *    Thank you for using FreeRTOS, and thank you for your support!      *
+     *                                                                       *
+    ***************************************************************************
+
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation AND MODIFIED BY the FreeRTOS exception.
+    >>>NOTE<<< The modification to the GPL is included to allow you to
+    distribute a combined work that includes FreeRTOS without being obliged to
+    provide the source code for proprietary components outside of the FreeRTOS
+    kernel.  FreeRTOS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details. You should have received a copy of the GNU General Public
+    License and the FreeRTOS license exception along with FreeRTOS; if not it
+    can be viewed here: http://www.freertos.org/a00114.html and also obtained
+    by writing to Richard Barry, contact details for whom are available on the
+    FreeRTOS WEB site.
+
+    1 tab == 4 spaces!
+
+    http://www.FreeRTOS.org - Documentation, latest information, license and
+    contact details.
+
+    http://www.SafeRTOS.com - A version that is certified for use in safety
+    critical systems.
+
+    http://www.OpenRTOS.com - Commercial support, development, porting,
+    licensing and training services.
+*/
+
+
+#ifndef MEMPOOL_H
+#define MEMPOOL_H
+
+#ifndef INC_FREERTOS_H
+	#error "include FreeRTOS.h must appear in source files before include mempool.h"
+#endif
+
+#include "portable.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*-----------------------------------------------------------
+ * MACROS AND DEFINITIONS
+ *----------------------------------------------------------*/
+
+/**
+ * Type by which memory pools are referenced.  For example, a call to
+ * xMemoryPoolCreate() returns an xMemoryPoolHandle variable that can then be
+ * used to reference the pool in calls to pvMemoryPoolAlloc(),
+ * vMemoryPoolFree(), etc.
+ */
+typedef void * xMemoryPoolHandle;
+
+/**
+ * Usage statistics for a single memory pool.  Obtained using
+ * vMemoryPoolGetStats().
+ */
+typedef struct xMEMORY_POOL_STATS
+{
+	size_t xBlockSize;								/*<< The size of each block, after rounding up to portBYTE_ALIGNMENT. */
+	unsigned portBASE_TYPE uxBlockCount;			/*<< The number of blocks in the pool. */
+	unsigned portBASE_TYPE uxBlocksFree;			/*<< The number of blocks not allocated at the time of the call. */
+	unsigned portBASE_TYPE uxMinimumEverBlocksFree;	/*<< The lowest value uxBlocksFree has had since the pool was created. */
+	unsigned long ulAllocations;					/*<< Successful calls to pvMemoryPoolAlloc() and pvMemoryPoolAllocFromISR(). */
+	unsigned long ulFrees;							/*<< Calls to vMemoryPoolFree() and vMemoryPoolFreeFromISR(). */
+	unsigned long ulFailures;						/*<< Allocation calls that returned NULL. */
+	unsigned long ulWaits;							/*<< Allocation calls that found the pool empty and blocked. */
+} xMemoryPoolStats;
+
+/*-----------------------------------------------------------
+ * MEMORY POOL API
+ *----------------------------------------------------------*/
+
+/**
+ * xMemoryPoolHandle xMemoryPoolCreate( size_t xBlockSize, unsigned portBASE_TYPE uxBlockCount );
+ *
+ * Creates a pool of uxBlockCount blocks, each of which is xBlockSize bytes.
+ * The control structure and the blocks themselves are allocated from the
+ * FreeRTOS heap with a single call to pvPortMalloc().
+ *
+ * Blocks are held on an intrusive free list, so allocating and freeing a block
+ * takes a constant time regardless of the number of blocks in the pool, and
+ * a pool never fragments.  Every block returned by the pool is aligned to
+ * portBYTE_ALIGNMENT.
+ *
+ * @param xBlockSize The size of each block.  This is rounded up to a multiple
+ * of portBYTE_ALIGNMENT, and to at least the size of a pointer.
+ *
+ * @param uxBlockCount The number of blocks in the pool.
+ *
+ * @return The handle of the pool, or NULL if there was insufficient heap for
+ * the pool to be created.
+ *
+ * Example usage:
+ *
+ * xMemoryPoolHandle xMessagePool;
+ *
+ * void vAFunction( void )
+ * {
+ * xMessage *pxMessage;
+ *
+ *     // Create a pool of 32 messages.
+ *     xMessagePool = xMemoryPoolCreate( sizeof( xMessage ), 32 );
+ *
+ *     // Obtain a message, waiting up to 10 ticks for one to be freed if the
+ *     // pool is empty.
+ *     pxMessage = ( xMessage * ) pvMemoryPoolAlloc( xMessagePool, 10 );
+ *
+ *     if( pxMessage != NULL )
+ *     {
+ *         // Use the message, then return it to the pool.
+ *         vMemoryPoolFree( xMessagePool, pxMessage );
+ *     }
+ * }
+ */
+xMemoryPoolHandle xMemoryPoolCreate( size_t xBlockSize, unsigned portBASE_TYPE uxBlockCount ) PRIVILEGED_FUNCTION;
+
+/**
+ * xMemoryPoolHandle xMemoryPoolCreateStatic( size_t xBlockSize, unsigned portBASE_TYPE uxBlockCount, void *pvStorage );
+ *
+ * As xMemoryPoolCreate(), but the blocks are carved from the buffer pointed to
+ * by pvStorage rather than being allocated from the FreeRTOS heap.  Only the
+ * small control structure is allocated from the heap.
+ *
+ * @param pvStorage A buffer that is aligned to portBYTE_ALIGNMENT and that is
+ * at least poolSTORAGE_SIZE( xBlockSize, uxBlockCount ) bytes long.  The buffer
+ * must remain valid for the life of the pool.
+ */
+xMemoryPoolHandle xMemoryPoolCreateStatic( size_t xBlockSize, unsigned portBASE_TYPE uxBlockCount, void *pvStorage ) PRIVILEGED_FUNCTION;
+
+/* The size of the block storage needed for a pool of uxBlockCount blocks of
+xBlockSize bytes.  Used to dimension the buffer passed to
+xMemoryPoolCreateStatic(). */
+#define poolBLOCK_STRIDE( xBlockSize )	( ( ( ( xBlockSize ) < sizeof( void * ) ? sizeof( void * ) : ( xBlockSize ) ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+#define poolSTORAGE_SIZE( xBlockSize, uxBlockCount )	( poolBLOCK_STRIDE( xBlockSize ) * ( size_t ) ( uxBlockCount ) )
+
+/**
+ * void vMemoryPoolDelete( xMemoryPoolHandle xPool );
+ *
+ * Delete a pool created with xMemoryPoolCreate() or xMemoryPoolCreateStatic().
+ * All the blocks must have been returned to the pool, and no task may be
+ * blocked waiting for a block.  The storage passed to
+ * xMemoryPoolCreateStatic() is not freed.
+ */
+void vMemoryPoolDelete( xMemoryPoolHandle xPool ) PRIVILEGED_FUNCTION;
+
+/**
+ * void *pvMemoryPoolAlloc( xMemoryPoolHandle xPool, portTickType xTicksToWait );
+ *
+ * Obtain a block from a pool.
+ *
+ * @param xPool The pool from which the block is obtained.
+ *
+ * @param xTicksToWait The time in ticks to wait for a block to be freed if
+ * the pool is empty.  A block time of zero can be used to poll the pool.  A
+ * block time of portMAX_DELAY can be used to block indefinitely (provided
+ * INCLUDE_vTaskSuspend is set to 1 in FreeRTOSConfig.h).
+ *
+ * @return The block, or NULL if the pool remained empty for xTicksToWait
+ * ticks.
+ */
+void *pvMemoryPoolAlloc( xMemoryPoolHandle xPool, portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * void *pvMemoryPoolAllocFromISR( xMemoryPoolHandle xPool );
+ *
+ * A version of pvMemoryPoolAlloc() that can be called from an interrupt
+ * service routine.  It never blocks.
+ *
+ * @return The block, or NULL if the pool was empty.
+ */
+void *pvMemoryPoolAllocFromISR( xMemoryPoolHandle xPool ) PRIVILEGED_FUNCTION;
+
+/**
+ * void vMemoryPoolFree( xMemoryPoolHandle xPool, void *pv );
+ *
+ * Return a block to the pool from which it was obtained.  If a task is
+ * blocked in pvMemoryPoolAlloc() waiting for a block then it is unblocked.
+ *
+ * @param xPool The pool from which the block was obtained.
+ *
+ * @param pv The block.  Passing NULL has no effect.
+ */
+void vMemoryPoolFree( xMemoryPoolHandle xPool, void *pv ) PRIVILEGED_FUNCTION;
+
+/**
+ * void vMemoryPoolFreeFromISR( xMemoryPoolHandle xPool, void *pv, signed portBASE_TYPE *pxHigherPriorityTaskWoken );
+ *
+ * A version of vMemoryPoolFree() that can be called from an interrupt service
+ * routine.
+ *
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if freeing the block
+ * unblocked a task that has a priority higher than the currently running task,
+ * in which case a context switch should be requested before the interrupt is
+ * exited.
+ */
+void vMemoryPoolFreeFromISR( xMemoryPoolHandle xPool, void *pv, signed portBASE_TYPE *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * void vMemoryPoolGetStats( xMemoryPoolHandle xPool, xMemoryPoolStats *pxStats );
+ *
+ * Take a snapshot of the usage statistics of a pool.
+ *
+ * @param pxStats The structure into which the statistics are copied.
+ */
+void vMemoryPoolGetStats( xMemoryPoolHandle xPool, xMemoryPoolStats *pxStats ) PRIVILEGED_FUNCTION;
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* MEMPOOL_H */
+
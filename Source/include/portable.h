@@ -357,6 +357,136 @@ void vPortFree( void *pv ) PRIVILEGED_FUNCTION;
 void vPortInitialiseBlocks( void ) PRIVILEGED_FUNCTION;
 size_t xPortGetFreeHeapSize( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * The lowest value xPortGetFreeHeapSize() has returned since the heap was
+ * initialised, and the size of the largest single block that pvPortMalloc()
+ * could currently return.  Only provided by the memory management
+ * implementations that coalesce free blocks.
+ */
+size_t xPortGetMinimumEverFreeHeapSize( void ) PRIVILEGED_FUNCTION;
+size_t xPortGetLargestFreeBlockSize( void ) PRIVILEGED_FUNCTION;
+
+/*
+ * Used by heap_5.c to describe the blocks of RAM that make up the heap.  The
+ * array passed to vPortDefineHeapRegions() is terminated by a region with a
+ * xSizeInBytes of zero.  Each region is tagged with portHEAP_ATTR_ bits that
+ * describe the memory, so pvPortMallocAttr() can allocate from a particular
+ * class of memory.  pvPortMalloc() uses the regions in the order they are
+ * listed, so the regions intended for general use should be listed first.
+ */
+#define portHEAP_ATTR_CACHEABLE		( 0x01UL )	/* Normal memory that is cached. */
+#define portHEAP_ATTR_DMA			( 0x02UL )	/* Memory that can be accessed by DMA masters without cache maintenance. */
+#define portHEAP_ATTR_FAST			( 0x04UL )	/* Memory with a low access latency. */
+
+typedef struct HeapRegion
+{
+	unsigned char *pucStartAddress;
+	size_t xSizeInBytes;
+	unsigned long ulAttributes;
+} xHeapRegion;
+
+void vPortDefineHeapRegions( const xHeapRegion * const pxHeapRegions ) PRIVILEGED_FUNCTION;
+void *pvPortMallocAttr( size_t xSize, unsigned long ulAttributes ) PRIVILEGED_FUNCTION;
+
+/*
+ * Allocate xSize bytes at an address that is a multiple of xAlignment, which
+ * must be a power of two.  When xAlignment is larger than portBYTE_ALIGNMENT
+ * the size is also rounded up to a multiple of xAlignment, so a buffer aligned
+ * to a cache line never shares a line with other data.  The block is freed
+ * with vPortFree().  Every memory management implementation provides this
+ * function, but only heap_5.c honours ulAttributes - the others only have one
+ * class of memory.
+ */
+void *pvPortMallocAlignedAttr( size_t xSize, size_t xAlignment, unsigned long ulAttributes ) PRIVILEGED_FUNCTION;
+
+/*
+ * Versions of pvPortMalloc(), pvPortMallocAttr() and vPortFree() that can be
+ * called from an interrupt whose priority is at or below
+ * configMAX_SYSCALL_INTERRUPT_PRIORITY.  Only heap_5.c provides these, as it
+ * is the only implementation that does not lock the heap by suspending the
+ * scheduler.  Blocks allocated from an interrupt are not charged to any task.
+ */
+void *pvPortMallocFromISR( size_t xSize ) PRIVILEGED_FUNCTION;
+void *pvPortMallocAttrFromISR( size_t xSize, unsigned long ulAttributes ) PRIVILEGED_FUNCTION;
+void vPortFreeFromISR( void *pv ) PRIVILEGED_FUNCTION;
+
+/*
+ * Heap instrumentation, provided by heap_5.c when configUSE_HEAP_INSTRUMENTATION
+ * is set to 1.  Bucket 0 of the size histograms counts blocks of less than 32
+ * bytes, and bucket n counts blocks of 2^(n+4) to (2^(n+5))-1 bytes, with the
+ * last bucket also counting everything larger.  Block sizes include the block
+ * header.
+ */
+#define portHEAP_HISTOGRAM_BUCKETS	16
+
+typedef struct HeapStats
+{
+	size_t xFreeBytes;								/*<< As returned by xPortGetFreeHeapSize(). */
+	size_t xMinimumEverFreeBytes;					/*<< As returned by xPortGetMinimumEverFreeHeapSize(). */
+	size_t xLargestFreeBlock;						/*<< As returned by xPortGetLargestFreeBlockSize(). */
+	unsigned portBASE_TYPE uxFragmentationIndex;	/*<< The percentage of the free bytes that are not in the largest free block. */
+	unsigned long ulAllocations;					/*<< Successful allocations since the heap was initialised. */
+	unsigned long ulFrees;							/*<< Blocks freed since the heap was initialised. */
+	unsigned long ulFailures;						/*<< Allocations that returned NULL. */
+	unsigned long ulOutstandingBySize[ portHEAP_HISTOGRAM_BUCKETS ];	/*<< Blocks currently allocated, by size. */
+	unsigned long ulAllocationsBySize[ portHEAP_HISTOGRAM_BUCKETS ];	/*<< Successful allocations since the heap was initialised, by size. */
+} xHeapStats;
+
+/* A block that is currently allocated, as reported by uxPortGetHeapAllocations(). */
+typedef struct HeapAllocationRecord
+{
+	void *pvAddress;		/*<< The pointer returned by pvPortMalloc(). */
+	size_t xSize;			/*<< The usable size of the block, which may be larger than was requested. */
+	void *pvCaller;			/*<< The return address of the call to pvPortMalloc(). */
+} xHeapAllocationRecord;
+
+void vPortGetHeapStats( xHeapStats *pxStats ) PRIVILEGED_FUNCTION;
+
+/*
+ * The occupancy of one slab size class, as reported by uxPortGetSlabStats().
+ * heap_5.c provides slabs when configUSE_HEAP_SLABS is set to 1.
+ */
+typedef struct HeapSlabStats
+{
+	size_t xObjectSize;				/*<< The size of the objects in the class. */
+	unsigned portBASE_TYPE uxPages;	/*<< The number of pages of the zone that hold objects of this class. */
+	unsigned long ulObjectsInUse;	/*<< Objects that are currently allocated. */
+	unsigned long ulObjectsFree;	/*<< Objects in those pages that are free. */
+	unsigned long ulAllocations;	/*<< Objects allocated since the heap was initialised. */
+	unsigned long ulFallbacks;		/*<< Allocations of this class made by the block allocator because the zone had no free pages. */
+} xHeapSlabStats;
+
+/*
+ * Write the statistics of up to uxMaxClasses size classes, smallest first, to
+ * pxStats.  Returns the number of classes written.
+ */
+unsigned portBASE_TYPE uxPortGetSlabStats( xHeapSlabStats *pxStats, unsigned portBASE_TYPE uxMaxClasses ) PRIVILEGED_FUNCTION;
+
+/*
+ * Report the blocks that are charged to the task whose handle is pvOwner.  A
+ * pvOwner of NULL reports the blocks that are not charged to any task: blocks
+ * allocated before the scheduler was started, and blocks that were still held
+ * by a task when it was deleted.  Up to uxMaxRecords blocks are written to
+ * pxRecords.  Returns the total number of blocks found, which may be larger
+ * than uxMaxRecords.  The task must not have been deleted.  Interrupts are
+ * masked while the blocks of pvOwner are listed.
+ */
+unsigned portBASE_TYPE uxPortGetHeapAllocations( void *pvOwner, xHeapAllocationRecord *pxRecords, unsigned portBASE_TYPE uxMaxRecords ) PRIVILEGED_FUNCTION;
+
+/*
+ * Called by the kernel when a task is deleted, so the blocks it still holds
+ * are no longer charged to it.
+ */
+void vPortHeapOwnerDeleted( void *pvOwner ) PRIVILEGED_FUNCTION;
+
+/*
+ * The number of times the mutex that serialises newlib's malloc() and
+ * environment has been taken, and how many of those had to wait for another
+ * task to give it.  heap_3.c provides the mutex when configUSE_NEWLIB_REENTRANT
+ * is set to 1.
+ */
+void vPortGetLibcLockStats( unsigned long *pulLocks, unsigned long *pulWaits ) PRIVILEGED_FUNCTION;
+
 /*
  * Setup the hardware ready for the scheduler to take control.  This generally
  * sets up a tick interrupt and sets timers for the correct tick frequency.
@@ -1125,6 +1125,26 @@ unsigned long ulTaskEndTrace( void ) PRIVILEGED_FUNCTION;
  */
 unsigned portBASE_TYPE uxTaskGetStackHighWaterMark( xTaskHandle xTask ) PRIVILEGED_FUNCTION;
 
+/**
+ * task.h
+ * <PRE>void vTaskGetHeapUsage( xTaskHandle xTask, size_t *pxBytes, unsigned portBASE_TYPE *puxBlocks );</PRE>
+ *
+ * configUSE_HEAP_INSTRUMENTATION must be set to 1 in FreeRTOSConfig.h for
+ * this function to be available.
+ *
+ * Returns the number of heap bytes and blocks that are charged to xTask.  A
+ * block is charged to the task that allocated it until it is freed, whichever
+ * task frees it.  The bytes include the block headers.
+ *
+ * @param xTask Handle of the task being queried.  Set xTask to NULL to query
+ * the calling task.
+ *
+ * @param pxBytes Set to the number of bytes charged to the task.
+ *
+ * @param puxBlocks Set to the number of blocks charged to the task.
+ */
+void vTaskGetHeapUsage( xTaskHandle xTask, size_t *pxBytes, unsigned portBASE_TYPE *puxBlocks ) PRIVILEGED_FUNCTION;
+
 /* When using trace macros it is sometimes necessary to include tasks.h before
 FreeRTOS.h.  When this is done pdTASK_HOOK_CODE will not yet have been defined,
 so the following two prototypes will cause a compilation error.  This can be
@@ -1174,6 +1194,38 @@ portBASE_TYPE xTaskCallApplicationTaskHook( xTaskHandle xTask, void *pvParameter
  */
 xTaskHandle xTaskGetIdleTaskHandle( void );
 
+/**
+ * task.h
+ * <pre>void vTaskSetArena( xTaskHandle xTask, void *pvArena );</pre>
+ *
+ * configUSE_TASK_ARENAS must be set to 1 in FreeRTOSConfig.h for this function
+ * to be available.
+ *
+ * Attach an arena created by xArenaCreate() to a task.  The arena is deleted
+ * with vArenaDelete() when the task is deleted, so everything the task
+ * allocated from it is released even if the task is deleted part way through
+ * its work.  Attaching a different arena, or NULL, detaches the previous arena
+ * without deleting it.
+ *
+ * @param xTask Handle of the task.  Passing NULL attaches the arena to the
+ * calling task.
+ *
+ * @param pvArena The xArenaHandle of the arena.
+ */
+void vTaskSetArena( xTaskHandle xTask, void *pvArena ) PRIVILEGED_FUNCTION;
+
+/**
+ * task.h
+ * <pre>void *pvTaskGetArena( xTaskHandle xTask );</pre>
+ *
+ * configUSE_TASK_ARENAS must be set to 1 in FreeRTOSConfig.h for this function
+ * to be available.
+ *
+ * Returns the arena attached to xTask, or NULL if there is none.  Passing
+ * xTask as NULL queries the calling task.
+ */
+void *pvTaskGetArena( xTaskHandle xTask ) PRIVILEGED_FUNCTION;
+
 /*-----------------------------------------------------------
  * SCHEDULER INTERNALS AVAILABLE FOR PORTING PURPOSES
  *----------------------------------------------------------*/
@@ -1190,6 +1242,28 @@ xTaskHandle xTaskGetIdleTaskHandle( void );
  */
 void vTaskIncrementTick( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS ONLY
+ * INTENDED FOR USE BY THE MEMORY ALLOCATOR.
+ *
+ * Charge xBytes of heap to the calling task and return its handle, or return
+ * NULL if the scheduler has not been started.  vTaskHeapRelease() takes the
+ * returned handle and removes the charge again.  Must be called with the heap
+ * locked.
+ */
+void *pvTaskHeapCharge( size_t xBytes ) PRIVILEGED_FUNCTION;
+void vTaskHeapRelease( void *pvOwner, size_t xBytes ) PRIVILEGED_FUNCTION;
+
+/*
+ * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS ONLY
+ * INTENDED FOR USE BY THE MEMORY ALLOCATOR.
+ *
+ * The head of the list of heap blocks charged to the task whose handle is
+ * pvOwner, which the allocator keeps in the TCB.  Only accessed with the heap
+ * locked.
+ */
+void **ppvTaskHeapRecords( void *pvOwner ) PRIVILEGED_FUNCTION;
+
 /*
  * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS AN
  * INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
@@ -75,6 +75,10 @@ as defined below. */
 #define tmrCOMMAND_CHANGE_PERIOD			2
 #define tmrCOMMAND_DELETE					3
 
+/* The service class of the timer service task used by timers created with
+xTimerCreate().  See xTimerCreateForService(). */
+#define tmrSERVICE_CLASS_DEFAULT			0U
+
 /*-----------------------------------------------------------
  * MACROS AND DEFINITIONS
  *----------------------------------------------------------*/
@@ -217,7 +221,40 @@ typedef void (*tmrTIMER_CALLBACK)( xTimerHandle xTimer );
  *     for( ;; );
  * }
  */
-xTimerHandle xTimerCreate( const signed char *pcTimerName, portTickType xTimerPeriodInTicks, unsigned portBASE_TYPE uxAutoReload, void * pvTimerID, tmrTIMER_CALLBACK pxCallbackFunction ) PRIVILEGED_FUNCTION;
+#define xTimerCreate( pcTimerName, xTimerPeriodInTicks, uxAutoReload, pvTimerID, pxCallbackFunction ) xTimerGenericCreate( ( pcTimerName ), ( xTimerPeriodInTicks ), ( uxAutoReload ), ( pvTimerID ), ( pxCallbackFunction ), tmrSERVICE_CLASS_DEFAULT )
+
+/**
+ * xTimerHandle xTimerCreateForService( const signed char *pcTimerName,
+ * 										portTickType xTimerPeriodInTicks,
+ * 										unsigned portBASE_TYPE uxAutoReload,
+ * 										void * pvTimerID,
+ * 										tmrTIMER_CALLBACK pxCallbackFunction,
+ * 										unsigned portBASE_TYPE uxServiceClass );
+ *
+ * As xTimerCreate(), but binds the timer to the timer service task of the
+ * given service class rather than to the default service.
+ *
+ * configTIMER_SERVICE_COUNT timer service tasks are created when the scheduler
+ * is started, the task of service class n running at the priority given by
+ * entry n of configTIMER_SERVICE_PRIORITIES.  Each service has its own command
+ * queue and its own list of active timers, so the callbacks of timers bound to
+ * a high priority service are never held up behind the callbacks of timers
+ * bound to a lower priority service.  A timer stays bound to the same service
+ * for its whole life.
+ *
+ * @param uxServiceClass The service class of the timer service task that will
+ * run the timer.  Must be less than configTIMER_SERVICE_COUNT.
+ *
+ * All other parameters and the return value are as per xTimerCreate().
+ *
+ * Example usage:
+ *
+ * // Create a timer that retransmits a frame if no acknowledgement arrives
+ * // within 20 ticks.  The callback runs in the timer service task of service
+ * // class 1, which has been given a higher priority than the default service.
+ * xRetransmitTimer = xTimerCreateForService( "Retransmit", 20, pdFALSE, NULL, vRetransmitCallback, 1 );
+ */
+#define xTimerCreateForService( pcTimerName, xTimerPeriodInTicks, uxAutoReload, pvTimerID, pxCallbackFunction, uxServiceClass ) xTimerGenericCreate( ( pcTimerName ), ( xTimerPeriodInTicks ), ( uxAutoReload ), ( pvTimerID ), ( pxCallbackFunction ), ( uxServiceClass ) )
 
 /**
  * void *pvTimerGetTimerID( xTimerHandle xTimer );
@@ -286,6 +323,112 @@ portBASE_TYPE xTimerIsTimerActive( xTimerHandle xTimer ) PRIVILEGED_FUNCTION;
  */
 xTaskHandle xTimerGetTimerDaemonTaskHandle( void );
 
+/**
+ * As xTimerGetTimerDaemonTaskHandle(), but returns the handle of the timer
+ * service task of the given service class.  xTimerGetTimerDaemonTaskHandle()
+ * is equivalent to xTimerGetServiceTaskHandle( tmrSERVICE_CLASS_DEFAULT ).
+ */
+xTaskHandle xTimerGetServiceTaskHandle( unsigned portBASE_TYPE uxServiceClass );
+
+/**
+ * Counters describing the traffic through the timer command path.  Obtained
+ * using vTimerGetCommandStats().
+ */
+typedef struct xTIMER_COMMAND_STATS
+{
+	unsigned long ulCommandsQueued;		/*<< Commands successfully posted to the timer command queue. */
+	unsigned long ulCommandsProcessed;	/*<< Commands taken from the timer command queue by the timer service task. */
+	unsigned long ulCommandsDirect;		/*<< Commands applied directly because they were issued by the timer service task itself. */
+	unsigned long ulCommandsDropped;	/*<< Commands that could not be posted because the timer command queue remained full. */
+} xTimerCommandStats;
+
+/**
+ * void vTimerGetCommandStats( unsigned portBASE_TYPE uxServiceClass, xTimerCommandStats *pxStats );
+ *
+ * Take a snapshot of the command counters of one timer service.  The counters
+ * are free running and wrap on overflow, so command throughput is obtained by
+ * sampling them periodically and taking the difference.
+ *
+ * @param uxServiceClass The service class of the timer service being queried.
+ *
+ * @param pxStats The structure into which the counters are copied.
+ */
+void vTimerGetCommandStats( unsigned portBASE_TYPE uxServiceClass, xTimerCommandStats *pxStats ) PRIVILEGED_FUNCTION;
+
+/*
+ * The number of buckets in each of the histograms held in xTimerServiceStats.
+ * Bucket 0 of the lateness histogram counts callbacks that started in the tick
+ * in which they were due, and bucket n counts callbacks that started between
+ * 2^(n-1) and (2^n)-1 ticks late.  Bucket 0 of the callback cost histogram
+ * counts callbacks that executed in less than 256 cycles, and bucket n counts
+ * callbacks that executed in between 2^(n+7) and (2^(n+8))-1 cycles.  In both
+ * cases the last bucket also counts everything that is off the end of the
+ * histogram.
+ */
+#define tmrSTATS_HISTOGRAM_BUCKETS			16
+
+/**
+ * Statistics gathered for an individual timer when configGENERATE_TIMER_STATS
+ * is set to 1.  Lateness is measured from the tick at which the timer was due
+ * to expire to the start of its callback function.  Obtained using
+ * xTimerGetTimerStats().
+ */
+typedef struct xTIMER_STATS
+{
+	unsigned long ulExpiries;					/*<< The number of times the callback function has been called. */
+	portTickType xMaxLatenessTicks;				/*<< The greatest lateness, in ticks. */
+	unsigned long ulTotalLatenessTicks;			/*<< The sum of the lateness of every expiry, in ticks. */
+	unsigned long ulMaxLatenessCycles;			/*<< The greatest lateness, in processor cycles. */
+	unsigned long ulMaxCallbackCycles;			/*<< The longest execution time of the callback function, in processor cycles. */
+	unsigned long long ullTotalCallbackCycles;	/*<< The sum of the execution time of every call to the callback function, in processor cycles. */
+} xTimerStats;
+
+/**
+ * Statistics gathered for the timer service as a whole when
+ * configGENERATE_TIMER_STATS is set to 1.  Obtained using
+ * vTimerGetServiceStats().
+ */
+typedef struct xTIMER_SERVICE_STATS
+{
+	xTimerCommandStats xCommands;				/*<< As returned by vTimerGetCommandStats(). */
+	unsigned long ulCommandQueueHighWaterMark;	/*<< The greatest number of commands that have been waiting in the timer command queue at any one time. */
+	unsigned long ulMaxCommandWaitCycles;		/*<< The longest time a command spent in the timer command queue, in processor cycles. */
+	unsigned long long ullTotalCommandWaitCycles;/*<< The sum of the time every command spent in the timer command queue, in processor cycles. */
+	unsigned long ulExpiries;					/*<< The number of timer callback functions that have been called. */
+	unsigned long ulLatenessHistogram[ tmrSTATS_HISTOGRAM_BUCKETS ];		/*<< Distribution of callback lateness, in ticks. */
+	unsigned long ulCallbackCostHistogram[ tmrSTATS_HISTOGRAM_BUCKETS ];	/*<< Distribution of callback execution time, in processor cycles. */
+} xTimerServiceStats;
+
+/**
+ * portBASE_TYPE xTimerGetTimerStats( xTimerHandle xTimer, xTimerStats *pxStats );
+ *
+ * Take a snapshot of the statistics gathered for an individual timer.  Only
+ * available when configGENERATE_TIMER_STATS is set to 1 in FreeRTOSConfig.h.
+ *
+ * Statistics are gathered by the timer service task, so the snapshot will not
+ * include a callback that is executing at the time of the call.
+ *
+ * @param xTimer The timer being queried.
+ *
+ * @param pxStats The structure into which the statistics are copied.
+ *
+ * @return pdPASS if the statistics were copied.
+ */
+portBASE_TYPE xTimerGetTimerStats( xTimerHandle xTimer, xTimerStats *pxStats ) PRIVILEGED_FUNCTION;
+
+/**
+ * void vTimerGetServiceStats( unsigned portBASE_TYPE uxServiceClass, xTimerServiceStats *pxStats );
+ *
+ * Take a snapshot of the statistics gathered for one timer service as a
+ * whole, including the counters returned by vTimerGetCommandStats().  Only
+ * available when configGENERATE_TIMER_STATS is set to 1 in FreeRTOSConfig.h.
+ *
+ * @param uxServiceClass The service class of the timer service being queried.
+ *
+ * @param pxStats The structure into which the statistics are copied.
+ */
+void vTimerGetServiceStats( unsigned portBASE_TYPE uxServiceClass, xTimerServiceStats *pxStats ) PRIVILEGED_FUNCTION;
+
 /**
  * portBASE_TYPE xTimerStart( xTimerHandle xTimer, portTickType xBlockTime );
  *
@@ -294,7 +437,16 @@ xTaskHandle xTimerGetTimerDaemonTaskHandle( void );
  * though a queue called the timer command queue.  The timer command queue is
  * private to the kernel itself and is not directly accessible to application
  * code.  The length of the timer command queue is set by the
- * configTIMER_QUEUE_LENGTH configuration constant.
+ * configTIMER_QUEUE_LENGTH configuration constant, which must be a power of 2.
+ *
+ * Posting to the timer command queue masks interrupts only for as long as it
+ * takes to copy in one command, so any number of tasks and interrupts can post
+ * commands to it without holding one another up.  Commands issued from the timer
+ * service task itself (in practice, from within a timer callback function) do
+ * not go through the queue at all - the start, reset, stop and change period
+ * commands are applied to the list of active timers directly, and so take
+ * effect ahead of any commands that are still waiting in the queue.  Deleting
+ * a timer is always deferred through the queue.
  *
  * xTimerStart() starts a timer that was previously created using the
  * xTimerCreate() API function.  If the timer had already been started and was
@@ -928,6 +1080,7 @@ xTaskHandle xTimerGetTimerDaemonTaskHandle( void );
  * for use by the kernel only.
  */
 portBASE_TYPE xTimerCreateTimerTask( void ) PRIVILEGED_FUNCTION;
+xTimerHandle xTimerGenericCreate( const signed char *pcTimerName, portTickType xTimerPeriodInTicks, unsigned portBASE_TYPE uxAutoReload, void * pvTimerID, tmrTIMER_CALLBACK pxCallbackFunction, unsigned portBASE_TYPE uxServiceClass ) PRIVILEGED_FUNCTION;
 portBASE_TYPE xTimerGenericCommand( xTimerHandle xTimer, portBASE_TYPE xCommandID, portTickType xOptionalValue, signed portBASE_TYPE *pxHigherPriorityTaskWoken, portTickType xBlockTime ) PRIVILEGED_FUNCTION;
 
 #ifdef __cplusplus
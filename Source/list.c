@@ -56,6 +56,22 @@
 #include "FreeRTOS.h"
 #include "list.h"
 
+#if ( configUSE_LIST_SKIP_INDEX == 1 )
+
+	/* The state of the pseudo random number generator that decides how many
+	levels of the skip index a new item is placed on.  It does not matter if
+	two insertions race on it. */
+	static unsigned long ulSkipRandom = 0x2545f491UL;
+
+	/*
+	 * The number of extra levels, from 0 to configLIST_SKIP_LEVELS - 1, an
+	 * item is placed on.  Each level holds on average a quarter of the items
+	 * of the level below.
+	 */
+	static unsigned portBASE_TYPE prvSkipLevels( void );
+
+#endif
+
 /*-----------------------------------------------------------
  * PUBLIC LIST API documented in list.h
  *----------------------------------------------------------*/
@@ -76,6 +92,21 @@ void vListInitialise( xList *pxList )
 	pxList->xListEnd.pxNext = ( xListItem * ) &( pxList->xListEnd );
 	pxList->xListEnd.pxPrevious = ( xListItem * ) &( pxList->xListEnd );
 
+	#if ( configUSE_LIST_SKIP_INDEX == 1 )
+	{
+	unsigned portBASE_TYPE uxLevel;
+
+		/* The list end is on every level of the skip index. */
+		for( uxLevel = 0U; uxLevel < ( unsigned portBASE_TYPE ) ( configLIST_SKIP_LEVELS - 1 ); uxLevel++ )
+		{
+			pxList->xListEnd.pxSkipNext[ uxLevel ] = ( xListItem * ) &( pxList->xListEnd );
+			pxList->xListEnd.pxSkipPrevious[ uxLevel ] = ( xListItem * ) &( pxList->xListEnd );
+		}
+
+		pxList->xListEnd.uxSkipLevels = ( unsigned portBASE_TYPE ) ( configLIST_SKIP_LEVELS - 1 );
+	}
+	#endif
+
 	pxList->uxNumberOfItems = ( unsigned portBASE_TYPE ) 0U;
 }
 /*-----------------------------------------------------------*/
@@ -84,6 +115,12 @@ void vListInitialiseItem( xListItem *pxItem )
 {
 	/* Make sure the list item is not recorded as being on a list. */
 	pxItem->pvContainer = NULL;
+
+	#if ( configUSE_LIST_SKIP_INDEX == 1 )
+	{
+		pxItem->uxSkipLevels = ( unsigned portBASE_TYPE ) 0U;
+	}
+	#endif
 }
 /*-----------------------------------------------------------*/
 
@@ -103,6 +140,14 @@ volatile xListItem * pxIndex;
 	pxIndex->pxNext = ( volatile xListItem * ) pxNewListItem;
 	pxList->pxIndex = ( volatile xListItem * ) pxNewListItem;
 
+	#if ( configUSE_LIST_SKIP_INDEX == 1 )
+	{
+		/* The position of the item is not determined by its value, so it
+		cannot be part of the skip index. */
+		pxNewListItem->uxSkipLevels = ( unsigned portBASE_TYPE ) 0U;
+	}
+	#endif
+
 	/* Remember which list the item is in. */
 	pxNewListItem->pvContainer = ( void * ) pxList;
 
@@ -114,6 +159,10 @@ void vListInsert( xList *pxList, xListItem *pxNewListItem )
 {
 volatile xListItem *pxIterator;
 portTickType xValueOfInsertion;
+#if ( configUSE_LIST_SKIP_INDEX == 1 )
+	volatile xListItem *pxSkipUpdate[ configLIST_SKIP_LEVELS - 1 ];
+	unsigned portBASE_TYPE uxLevel;
+#endif
 
 	/* Insert the new list item into the list, sorted in ulListItem order. */
 	xValueOfInsertion = pxNewListItem->xItemValue;
@@ -128,6 +177,14 @@ portTickType xValueOfInsertion;
 	if( xValueOfInsertion == portMAX_DELAY )
 	{
 		pxIterator = pxList->xListEnd.pxPrevious;
+
+		#if ( configUSE_LIST_SKIP_INDEX == 1 )
+		{
+			/* Items at the very end are found without a search, so are never
+			placed on the skip index. */
+			pxNewListItem->uxSkipLevels = ( unsigned portBASE_TYPE ) 0U;
+		}
+		#endif
 	}
 	else
 	{
@@ -147,11 +204,50 @@ portTickType xValueOfInsertion;
 		See http://www.freertos.org/FAQHelp.html for more tips.
 		**********************************************************************/
 		
-		for( pxIterator = ( xListItem * ) &( pxList->xListEnd ); pxIterator->pxNext->xItemValue <= xValueOfInsertion; pxIterator = pxIterator->pxNext )
+		pxIterator = ( xListItem * ) &( pxList->xListEnd );
+
+		#if ( configUSE_LIST_SKIP_INDEX == 1 )
+		{
+			/* Descend the skip index from the sparsest level, remembering the
+			last item on each level that the new item will follow.  The list
+			end has the value portMAX_DELAY, so ends the search on every
+			level. */
+			uxLevel = ( unsigned portBASE_TYPE ) ( configLIST_SKIP_LEVELS - 1 );
+			while( uxLevel > 0U )
+			{
+				uxLevel--;
+
+				while( pxIterator->pxSkipNext[ uxLevel ]->xItemValue <= xValueOfInsertion )
+				{
+					pxIterator = pxIterator->pxSkipNext[ uxLevel ];
+				}
+
+				pxSkipUpdate[ uxLevel ] = pxIterator;
+			}
+		}
+		#endif
+
+		for( ; pxIterator->pxNext->xItemValue <= xValueOfInsertion; pxIterator = pxIterator->pxNext )
 		{
 			/* There is nothing to do here, we are just iterating to the
 			wanted insertion position. */
 		}
+
+		#if ( configUSE_LIST_SKIP_INDEX == 1 )
+		{
+			/* Link the new item into a random number of levels of the index,
+			after the items found on the way down. */
+			pxNewListItem->uxSkipLevels = prvSkipLevels();
+
+			for( uxLevel = 0U; uxLevel < pxNewListItem->uxSkipLevels; uxLevel++ )
+			{
+				pxNewListItem->pxSkipNext[ uxLevel ] = pxSkipUpdate[ uxLevel ]->pxSkipNext[ uxLevel ];
+				pxNewListItem->pxSkipPrevious[ uxLevel ] = pxSkipUpdate[ uxLevel ];
+				pxSkipUpdate[ uxLevel ]->pxSkipNext[ uxLevel ]->pxSkipPrevious[ uxLevel ] = ( volatile xListItem * ) pxNewListItem;
+				pxSkipUpdate[ uxLevel ]->pxSkipNext[ uxLevel ] = ( volatile xListItem * ) pxNewListItem;
+			}
+		}
+		#endif
 	}
 
 	pxNewListItem->pxNext = pxIterator->pxNext;
@@ -173,6 +269,20 @@ xList * pxList;
 
 	pxItemToRemove->pxNext->pxPrevious = pxItemToRemove->pxPrevious;
 	pxItemToRemove->pxPrevious->pxNext = pxItemToRemove->pxNext;
+
+	#if ( configUSE_LIST_SKIP_INDEX == 1 )
+	{
+	unsigned portBASE_TYPE uxLevel;
+
+		for( uxLevel = 0U; uxLevel < pxItemToRemove->uxSkipLevels; uxLevel++ )
+		{
+			pxItemToRemove->pxSkipNext[ uxLevel ]->pxSkipPrevious[ uxLevel ] = pxItemToRemove->pxSkipPrevious[ uxLevel ];
+			pxItemToRemove->pxSkipPrevious[ uxLevel ]->pxSkipNext[ uxLevel ] = pxItemToRemove->pxSkipNext[ uxLevel ];
+		}
+
+		pxItemToRemove->uxSkipLevels = ( unsigned portBASE_TYPE ) 0U;
+	}
+	#endif
 	
 	/* The list item knows which list it is in.  Obtain the list from the list
 	item. */
@@ -189,3 +299,29 @@ xList * pxList;
 }
 /*-----------------------------------------------------------*/
 
+
+#if ( configUSE_LIST_SKIP_INDEX == 1 )
+
+	static unsigned portBASE_TYPE prvSkipLevels( void )
+	{
+	unsigned long ulRandom;
+	unsigned portBASE_TYPE uxLevels = 0U;
+
+		/* xorshift32. */
+		ulRandom = ulSkipRandom;
+		ulRandom ^= ulRandom << 13;
+		ulRandom ^= ulRandom >> 17;
+		ulRandom ^= ulRandom << 5;
+		ulSkipRandom = ulRandom;
+
+		/* Each pair of clear low bits promotes the item one more level. */
+		while( ( ( ulRandom & 0x03UL ) == 0UL ) && ( uxLevels < ( unsigned portBASE_TYPE ) ( configLIST_SKIP_LEVELS - 1 ) ) )
+		{
+			uxLevels++;
+			ulRandom >>= 2;
+		}
+
+		return uxLevels;
+	}
+
+#endif
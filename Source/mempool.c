@@ -0,0 +1,425 @@
+/*
+    FreeRTOS V7.1.0 - Copyright (C) 2011 Real Time Engineers Ltd.
+
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS tutorial books are available in pdf and paperback.        *
+     *    Complete, revised, and edited pdf reference manuals are also       *
+     *    available.                                                         *
+     *                                                                       *
+     *    Purchasing FreeRTOS documentation will not only help you, by       *
+     *    ensuring you get running as quickly as possible and with an        *
+     *    in-depth knowledge of how to use FreeRTOS, it will also help       *
+     *    the FreeRTOS project to continue with its mission of providing     *
+     *    professional grade, cross platform, de facto standard solutions    *
+     *    for microcontrollers - completely free of charge!                  *
+     *                                                                       *
+     *    >>> See http://www.FreeRTOS.org/Documentation for details. <<<     *
+     *                                                                       *
+     *    Thank you for using FreeRTOS, and thank you for your support!      *
+     *                                                                       *
+    ***************************************************************************
+
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation AND MODIFIED BY the FreeRTOS exception.
+    >>>NOTE<<< The modification to the GPL is included to allow you to
+    distribute a combined work that includes FreeRTOS without being obliged to
+    provide the source code for proprietary components outside of the FreeRTOS
+    kernel.  FreeRTOS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details. You should have received a copy of the GNU General Public
+    License and the FreeRTOS license exception along with FreeRTOS; if not it
+    can be viewed here: http://www.freertos.org/a00114.html and also obtained
+    by writing to Richard Barry, contact details for whom are available on the
+    FreeRTOS WEB site.
+
+    1 tab == 4 spaces!
+
+    http://www.FreeRTOS.org - Documentation, latest information, license and
+    contact details.
+
+    http://www.SafeRTOS.com - A version that is certified for use in safety
+    critical systems.
+
+    http://www.OpenRTOS.com - Commercial support, development, porting,
+    licensing and training services.
+*/
+
+#include <stdlib.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "mempool.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* Misc definitions. */
+#define poolNO_DELAY		( portTickType ) 0U
+
+/* A free block holds a pointer to the next free block in its first bytes. */
+typedef struct POOL_FREE_BLOCK
+{
+	struct POOL_FREE_BLOCK *pxNextFreeBlock;
+} xPoolFreeBlock;
+
+/* The definition of the pools themselves. */
+typedef struct poolPoolControl
+{
+	xPoolFreeBlock			*pxFreeList;		/*<< The first free block, or NULL if the pool is empty. */
+	unsigned char			*pucStorageStart;	/*<< The first block.  Used to validate the blocks passed to vMemoryPoolFree(). */
+	unsigned char			*pucStorageEnd;		/*<< One past the last block. */
+	size_t					xBlockStride;		/*<< The size of each block, rounded up to a multiple of portBYTE_ALIGNMENT. */
+	unsigned portBASE_TYPE	uxBlockCount;		/*<< The number of blocks in the pool. */
+	unsigned portBASE_TYPE	uxBlocksFree;		/*<< The number of blocks on the free list. */
+	unsigned portBASE_TYPE	uxMinimumEverBlocksFree;
+	unsigned portBASE_TYPE	uxWaitingTasks;		/*<< The number of tasks blocked in pvMemoryPoolAlloc(). */
+	xQueueHandle			xBlockFreed;		/*<< A queue that holds no data, written to when a block is freed while a task is waiting for one. */
+	unsigned long			ulAllocations;
+	unsigned long			ulFrees;
+	unsigned long			ulFailures;
+	unsigned long			ulWaits;
+} xMEMORY_POOL;
+
+/* The control structure of a pool created by xMemoryPoolCreate() is followed
+by the blocks, so its size is rounded up to keep the blocks aligned. */
+#define poolCONTROL_SIZE	( ( sizeof( xMEMORY_POOL ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+
+/*
+ * Initialise the control structure of a pool and thread all of its blocks
+ * onto the free list.  Returns NULL if the wake up queue could not be created.
+ */
+static xMEMORY_POOL *prvInitialisePool( xMEMORY_POOL *pxPool, size_t xBlockSize, unsigned portBASE_TYPE uxBlockCount, unsigned char *pucStorage ) PRIVILEGED_FUNCTION;
+
+/*
+ * Remove the block at the head of the free list and update the statistics.
+ * Must be called from within a critical section.  Returns NULL if the pool is
+ * empty.
+ */
+static void *prvTakeBlock( xMEMORY_POOL *pxPool ) PRIVILEGED_FUNCTION;
+
+/*
+ * Push a block onto the free list and update the statistics.  Must be called
+ * from within a critical section.  Returns pdTRUE if a task is waiting for a
+ * block and so needs to be woken.
+ */
+static portBASE_TYPE prvReturnBlock( xMEMORY_POOL *pxPool, void *pv ) PRIVILEGED_FUNCTION;
+
+/*-----------------------------------------------------------*/
+
+xMemoryPoolHandle xMemoryPoolCreate( size_t xBlockSize, unsigned portBASE_TYPE uxBlockCount )
+{
+xMEMORY_POOL *pxPool = NULL;
+
+	configASSERT( ( xBlockSize > 0 ) );
+	configASSERT( ( uxBlockCount > 0 ) );
+
+	if( ( xBlockSize > 0 ) && ( uxBlockCount > 0 ) )
+	{
+		/* Allocate the control structure and the blocks together. */
+		pxPool = ( xMEMORY_POOL * ) pvPortMalloc( poolCONTROL_SIZE + poolSTORAGE_SIZE( xBlockSize, uxBlockCount ) );
+
+		if( pxPool != NULL )
+		{
+			if( prvInitialisePool( pxPool, xBlockSize, uxBlockCount, ( ( unsigned char * ) pxPool ) + poolCONTROL_SIZE ) == NULL )
+			{
+				vPortFree( pxPool );
+				pxPool = NULL;
+			}
+		}
+	}
+
+	return ( xMemoryPoolHandle ) pxPool;
+}
+/*-----------------------------------------------------------*/
+
+xMemoryPoolHandle xMemoryPoolCreateStatic( size_t xBlockSize, unsigned portBASE_TYPE uxBlockCount, void *pvStorage )
+{
+xMEMORY_POOL *pxPool = NULL;
+
+	configASSERT( ( xBlockSize > 0 ) );
+	configASSERT( ( uxBlockCount > 0 ) );
+	configASSERT( ( pvStorage != NULL ) );
+	configASSERT( ( ( ( unsigned long ) pvStorage ) & portBYTE_ALIGNMENT_MASK ) == 0 );
+
+	if( ( xBlockSize > 0 ) && ( uxBlockCount > 0 ) && ( pvStorage != NULL ) )
+	{
+		pxPool = ( xMEMORY_POOL * ) pvPortMalloc( sizeof( xMEMORY_POOL ) );
+
+		if( pxPool != NULL )
+		{
+			if( prvInitialisePool( pxPool, xBlockSize, uxBlockCount, ( unsigned char * ) pvStorage ) == NULL )
+			{
+				vPortFree( pxPool );
+				pxPool = NULL;
+			}
+		}
+	}
+
+	return ( xMemoryPoolHandle ) pxPool;
+}
+/*-----------------------------------------------------------*/
+
+void vMemoryPoolDelete( xMemoryPoolHandle xPool )
+{
+xMEMORY_POOL *pxPool = ( xMEMORY_POOL * ) xPool;
+
+	configASSERT( ( pxPool->uxBlocksFree == pxPool->uxBlockCount ) );
+	configASSERT( ( pxPool->uxWaitingTasks == 0U ) );
+
+	vQueueDelete( pxPool->xBlockFreed );
+
+	/* If the pool was created by xMemoryPoolCreate() then this also frees the
+	blocks. */
+	vPortFree( pxPool );
+}
+/*-----------------------------------------------------------*/
+
+void *pvMemoryPoolAlloc( xMemoryPoolHandle xPool, portTickType xTicksToWait )
+{
+xMEMORY_POOL *pxPool = ( xMEMORY_POOL * ) xPool;
+void *pvReturn;
+xTimeOutType xTimeOut;
+portBASE_TYPE xHasWaited = pdFALSE;
+
+	if( xTicksToWait != poolNO_DELAY )
+	{
+		vTaskSetTimeOutState( &xTimeOut );
+	}
+
+	for( ;; )
+	{
+		taskENTER_CRITICAL();
+		{
+			pvReturn = prvTakeBlock( pxPool );
+
+			if( pvReturn == NULL )
+			{
+				if( xTicksToWait != poolNO_DELAY )
+				{
+					/* Register as a waiter before leaving the critical section,
+					so a block freed before this task blocks still posts to the
+					wake up queue. */
+					pxPool->uxWaitingTasks++;
+
+					if( xHasWaited == pdFALSE )
+					{
+						pxPool->ulWaits++;
+						xHasWaited = pdTRUE;
+					}
+				}
+				else
+				{
+					pxPool->ulFailures++;
+				}
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		if( ( pvReturn != NULL ) || ( xTicksToWait == poolNO_DELAY ) )
+		{
+			break;
+		}
+
+		( void ) xQueueReceive( pxPool->xBlockFreed, NULL, xTicksToWait );
+
+		taskENTER_CRITICAL();
+		{
+			pxPool->uxWaitingTasks--;
+		}
+		taskEXIT_CRITICAL();
+
+		/* Another task may have taken the freed block first, in which case
+		wait for whatever remains of the block time.  Once the block time has
+		expired the pool is tried one last time. */
+		if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+		{
+			xTicksToWait = poolNO_DELAY;
+		}
+	}
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void *pvMemoryPoolAllocFromISR( xMemoryPoolHandle xPool )
+{
+xMEMORY_POOL *pxPool = ( xMEMORY_POOL * ) xPool;
+void *pvReturn;
+unsigned portBASE_TYPE uxSavedInterruptStatus;
+
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		pvReturn = prvTakeBlock( pxPool );
+
+		if( pvReturn == NULL )
+		{
+			pxPool->ulFailures++;
+		}
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vMemoryPoolFree( xMemoryPoolHandle xPool, void *pv )
+{
+xMEMORY_POOL *pxPool = ( xMEMORY_POOL * ) xPool;
+portBASE_TYPE xWakeWaiter;
+
+	if( pv != NULL )
+	{
+		taskENTER_CRITICAL();
+		{
+			xWakeWaiter = prvReturnBlock( pxPool, pv );
+		}
+		taskEXIT_CRITICAL();
+
+		if( xWakeWaiter != pdFALSE )
+		{
+			/* The queue is as long as the pool, so will only be full if every
+			block has been freed while tasks were waiting, in which case the
+			waiting tasks will already be woken. */
+			( void ) xQueueSendToBack( pxPool->xBlockFreed, NULL, poolNO_DELAY );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vMemoryPoolFreeFromISR( xMemoryPoolHandle xPool, void *pv, signed portBASE_TYPE *pxHigherPriorityTaskWoken )
+{
+xMEMORY_POOL *pxPool = ( xMEMORY_POOL * ) xPool;
+portBASE_TYPE xWakeWaiter;
+unsigned portBASE_TYPE uxSavedInterruptStatus;
+
+	if( pv != NULL )
+	{
+		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		{
+			xWakeWaiter = prvReturnBlock( pxPool, pv );
+		}
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+		if( xWakeWaiter != pdFALSE )
+		{
+			( void ) xQueueSendToBackFromISR( pxPool->xBlockFreed, NULL, pxHigherPriorityTaskWoken );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vMemoryPoolGetStats( xMemoryPoolHandle xPool, xMemoryPoolStats *pxStats )
+{
+xMEMORY_POOL *pxPool = ( xMEMORY_POOL * ) xPool;
+
+	taskENTER_CRITICAL();
+	{
+		pxStats->xBlockSize = pxPool->xBlockStride;
+		pxStats->uxBlockCount = pxPool->uxBlockCount;
+		pxStats->uxBlocksFree = pxPool->uxBlocksFree;
+		pxStats->uxMinimumEverBlocksFree = pxPool->uxMinimumEverBlocksFree;
+		pxStats->ulAllocations = pxPool->ulAllocations;
+		pxStats->ulFrees = pxPool->ulFrees;
+		pxStats->ulFailures = pxPool->ulFailures;
+		pxStats->ulWaits = pxPool->ulWaits;
+	}
+	taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+static xMEMORY_POOL *prvInitialisePool( xMEMORY_POOL *pxPool, size_t xBlockSize, unsigned portBASE_TYPE uxBlockCount, unsigned char *pucStorage )
+{
+unsigned portBASE_TYPE ux;
+xPoolFreeBlock *pxBlock;
+
+	pxPool->xBlockStride = poolBLOCK_STRIDE( xBlockSize );
+	pxPool->uxBlockCount = uxBlockCount;
+	pxPool->uxBlocksFree = uxBlockCount;
+	pxPool->uxMinimumEverBlocksFree = uxBlockCount;
+	pxPool->uxWaitingTasks = 0U;
+	pxPool->pucStorageStart = pucStorage;
+	pxPool->pucStorageEnd = pucStorage + ( pxPool->xBlockStride * ( size_t ) uxBlockCount );
+	pxPool->ulAllocations = 0UL;
+	pxPool->ulFrees = 0UL;
+	pxPool->ulFailures = 0UL;
+	pxPool->ulWaits = 0UL;
+
+	/* Thread the blocks onto the free list in address order. */
+	pxPool->pxFreeList = ( xPoolFreeBlock * ) pucStorage;
+	for( ux = 0U; ux < uxBlockCount; ux++ )
+	{
+		pxBlock = ( xPoolFreeBlock * ) ( pucStorage + ( pxPool->xBlockStride * ( size_t ) ux ) );
+
+		if( ux == ( uxBlockCount - 1U ) )
+		{
+			pxBlock->pxNextFreeBlock = NULL;
+		}
+		else
+		{
+			pxBlock->pxNextFreeBlock = ( xPoolFreeBlock * ) ( ( ( unsigned char * ) pxBlock ) + pxPool->xBlockStride );
+		}
+	}
+
+	/* The queue holds no data.  It is only used to block tasks until a block
+	is freed. */
+	pxPool->xBlockFreed = xQueueCreate( uxBlockCount, ( unsigned portBASE_TYPE ) 0 );
+
+	if( pxPool->xBlockFreed == NULL )
+	{
+		pxPool = NULL;
+	}
+
+	return pxPool;
+}
+/*-----------------------------------------------------------*/
+
+static void *prvTakeBlock( xMEMORY_POOL *pxPool )
+{
+xPoolFreeBlock *pxBlock;
+
+	pxBlock = pxPool->pxFreeList;
+
+	if( pxBlock != NULL )
+	{
+		pxPool->pxFreeList = pxBlock->pxNextFreeBlock;
+		pxPool->uxBlocksFree--;
+		pxPool->ulAllocations++;
+
+		if( pxPool->uxBlocksFree < pxPool->uxMinimumEverBlocksFree )
+		{
+			pxPool->uxMinimumEverBlocksFree = pxPool->uxBlocksFree;
+		}
+	}
+
+	return ( void * ) pxBlock;
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvReturnBlock( xMEMORY_POOL *pxPool, void *pv )
+{
+xPoolFreeBlock *pxBlock = ( xPoolFreeBlock * ) pv;
+
+	/* The block must have come from this pool. */
+	configASSERT( ( ( unsigned char * ) pv >= pxPool->pucStorageStart ) && ( ( unsigned char * ) pv < pxPool->pucStorageEnd ) );
+	configASSERT( ( ( size_t ) ( ( unsigned char * ) pv - pxPool->pucStorageStart ) % pxPool->xBlockStride ) == 0 );
+	configASSERT( ( pxPool->uxBlocksFree < pxPool->uxBlockCount ) );
+
+	pxBlock->pxNextFreeBlock = pxPool->pxFreeList;
+	pxPool->pxFreeList = pxBlock;
+	pxPool->uxBlocksFree++;
+	pxPool->ulFrees++;
+
+	return ( pxPool->uxWaitingTasks > 0U ) ? pdTRUE : pdFALSE;
+}
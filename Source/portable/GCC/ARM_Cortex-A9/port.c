@@ -109,6 +109,16 @@ static portSTACK_TYPE *puxSVCStackPointer = &(puxSVCStack[ portSVC_STACK_SIZE -
 /* Page table */
 static unsigned long PageTable[4096] __attribute__((aligned (16384)));
 
+/* The number of 1M sections at the top of the 64M of RAM that are mapped as
+normal non-cacheable memory, for use as the DMA heap region.  Must match
+DMA_HEAP_SIZE in the linker script. */
+#define portUNCACHED_RAM_SECTIONS	( 4 )
+
+/* The cycle counter value when the most recent tick interrupt was taken, and
+the number of cycles between the two most recent tick interrupts. */
+volatile unsigned long ulPortTickCycleCount = 0UL;
+volatile unsigned long ulPortCyclesPerTick = 0UL;
+
 /*
  * Setup the timer to generate the tick interrupts.
  */
@@ -268,9 +278,15 @@ void vPortEndScheduler( void )
 
 void vPortSysTickHandler( void *pvParameter )
 {
+unsigned long ulCycles = portGET_CYCLE_COUNT();
+
 	/* Clear the Interrupt. */
 	*(portSYSTICK_INTERRUPT_STATUS) = 0x01UL;
 
+	/* Timestamp the tick. */
+	ulPortCyclesPerTick = ulCycles - ulPortTickCycleCount;
+	ulPortTickCycleCount = ulCycles;
+
 	vTaskIncrementTick();
 
 #if configUSE_PREEMPTION == 1
@@ -300,24 +316,11 @@ void vPortInstallInterruptHandler( void (*vHandler)(void *), void *pvParameter,
 {
 unsigned long ulBank32 = 4 * ( ulVector / 32 );
 unsigned long ulOffset32 = ulVector % 32;
-unsigned long ulBank4 = 4 * ( ulVector / 4 );
-unsigned long ulOffset4 = ulVector % 4;
 unsigned long ulBank16 = 4 * ( ulVector / 16 );
 unsigned long ulOffset16 = ulVector % 16;
-/* unsigned long puxGICAddress = 0; */
-unsigned long puxGICDistributorAddress = 0;
-
-	/* Select which GIC to use. */
-	if ( ulVector < 32 )
-	{
-		/* puxGICAddress = portGIC_PRIVATE_BASE; */
-		puxGICDistributorAddress = portGIC_DISTRIBUTOR_BASE;
-	}
-
-	else
-	{
-		/* Shouldn't get here. */
-	}
+/* The distributor is shared, and holds the configuration of the private
+(SGI and PPI) interrupts as well as the shared peripheral interrupts. */
+unsigned long puxGICDistributorAddress = portGIC_DISTRIBUTOR_BASE;
 
 	/* Record the Handler. */
 	if (ulVector < ulMaxVectorId )
@@ -325,37 +328,34 @@ unsigned long puxGICDistributorAddress = 0;
 		pxInterruptHandlers[ ulVector ].vHandler = vHandler;
 		pxInterruptHandlers[ ulVector ].pvParameter = pvParameter;
 
-		/* Now calculate all of the offsets for the specific GIC. */
-		ulBank32 = 4 * ( ulVector / 32 );
-		ulOffset32 = ulVector % 32;
-		ulBank4 = 4 * ( ulVector / 4 );
-		ulOffset4 = ulVector % 4;
-		ulBank16 = 4 * ( ulVector / 16 );
-		ulOffset16 = ulVector % 16;
-
-		/* Is it Edge Triggered?. */
+		/* Edge or level triggered.  Read only for the SGIs. */
 		if ( 0 != ucEdgeTriggered )
 		{
-			portGIC_SET( (portGIC_ICDICR_BASE(puxGICDistributorAddress + ulBank16) ), ( portGIC_READ(puxGICDistributorAddress + ulBank16) | ( 0x02 << ( ulOffset16 * 2 ) ) ) );
+			portGIC_SET( portGIC_ICDICR_BASE(puxGICDistributorAddress) + ulBank16, ( 0x02UL << ( ulOffset16 * 2 ) ) );
+		}
+		else
+		{
+			portGIC_CLEAR( portGIC_ICDICR_BASE(puxGICDistributorAddress) + ulBank16, ( 0x02UL << ( ulOffset16 * 2 ) ) );
 		}
 
-		/* Set the Priority. */
-		portGIC_WRITE( portGIC_ICDIPR_BASE(puxGICDistributorAddress) + ulBank4, ( ( (unsigned long)ucPriority ) << ( ulOffset4 * 8 ) ) );
+		/* Set the Priority and the targeted Processors.  Both registers are
+		byte accessible, one byte per interrupt. */
+		*( ( volatile unsigned char * ) ( portGIC_ICDIPR_BASE(puxGICDistributorAddress) + ulVector ) ) = ucPriority;
+		*( ( volatile unsigned char * ) ( portGIC_ICDIPTR_BASE(puxGICDistributorAddress) + ulVector ) ) = ucProcessorTargets;
 
-		/* Set the targeted Processors. */
-		portGIC_WRITE( portGIC_ICDIPTR_BASE(puxGICDistributorAddress + ulBank4), ( ( (unsigned long)ucProcessorTargets ) << ( ulOffset4 * 8 ) ) );
+		/* The set-enable, clear-enable and clear-pending registers are written
+		with a one for each interrupt affected, so need no read back. */
+		portGIC_WRITE( portGIC_ICDICPR_BASE(puxGICDistributorAddress) + ulBank32, ( 1UL << ulOffset32 ) );
 
-		/* Enable the Interrupt. */
 		if ( NULL != vHandler )
 		{
-			portGIC_SET( portGIC_ICDICPR_BASE(puxGICDistributorAddress + ulBank32), ( portGIC_READ( portGIC_ICDICPR_BASE(puxGICDistributorAddress + ulBank32) ) | ( 1 << ulOffset32 ) ) );
-			portGIC_SET( portGIC_ICDISER_BASE(puxGICDistributorAddress + ulBank32), ( portGIC_READ( portGIC_ICDISER_BASE(puxGICDistributorAddress + ulBank32) ) | ( 1 << ulOffset32 ) ) );
+			/* Enable the Interrupt. */
+			portGIC_WRITE( portGIC_ICDISER_BASE(puxGICDistributorAddress) + ulBank32, ( 1UL << ulOffset32 ) );
 		}
 		else
 		{
 			/* Or disable when passed a NULL handler. */
-			portGIC_CLEAR( portGIC_ICDICPR_BASE(puxGICDistributorAddress + ulBank32), ( portGIC_READ( portGIC_ICDICPR_BASE(puxGICDistributorAddress + ulBank32) ) | ( 1 << ulOffset32 ) ) );
-			portGIC_CLEAR( portGIC_ICDISER_BASE(puxGICDistributorAddress + ulBank32), ( portGIC_READ( portGIC_ICDISER_BASE(puxGICDistributorAddress + ulBank32) ) | ( 1 << ulOffset32 ) ) );
+			portGIC_WRITE( portGIC_ICDICER_BASE(puxGICDistributorAddress) + ulBank32, ( 1UL << ulOffset32 ) );
 		}
 	}
 }
@@ -404,6 +404,22 @@ void vPortUnknownInterruptHandler( void *pvParameter )
 }
 /*----------------------------------------------------------------------------*/
 
+void vPortCleanDCacheRange( const void *pvAddress, unsigned long ulLength )
+{
+unsigned long ulLine = ( ( unsigned long ) pvAddress ) & ~( portCACHE_LINE_SIZE - 1UL );
+unsigned long ulEnd = ( ( unsigned long ) pvAddress ) + ulLength;
+
+	/* Clean each line by MVA to the point of coherency. */
+	for( ; ulLine < ulEnd; ulLine += portCACHE_LINE_SIZE )
+	{
+		__asm volatile ( " mcr p15, 0, %[line], c7, c10, 1	\n" : : [line] "r" (ulLine) : "memory" );
+	}
+
+	/* Make sure the writes have completed before a DMA master is started. */
+	__asm volatile ( " dsb	\n" : : : "memory" );
+}
+/*----------------------------------------------------------------------------*/
+
 
 static unsigned long ReadSCTLR()
 {
@@ -507,7 +523,15 @@ extern unsigned long _ebss;
 	// Set up page table.
 	for(i=0;i<64;i++)
 	{
-		PageTable[i]=(i<<20)|0x05de6;
+		if(i<(64-portUNCACHED_RAM_SECTIONS))
+		{
+			PageTable[i]=(i<<20)|0x05de6;
+		}
+		else
+		{
+			// Normal memory, outer and inner non-cacheable (TEX=001, C=0, B=0).
+			PageTable[i]=(i<<20)|0x01de2;
+		}
 	}
 
 	for(i=64;i<4096;i++)
@@ -535,6 +559,14 @@ extern unsigned long _ebss;
 	// Enable L1 I & D caches.
 	WriteSCTLR(ReadSCTLR()|(1<<2)|(1<<12));
 
+	// Reset and enable the PMU cycle counter (PMCR.E, PMCR.C, PMCNTENSET.C).
+	__asm volatile (
+			" mcr	p15, 0, %[pmcr], c9, c12, 0		\n"
+			" mcr	p15, 0, %[cntens], c9, c12, 1	\n"
+			: : [pmcr] "r" ((1<<2)|(1<<0)),
+				[cntens] "r" (1UL<<31)
+				:  );
+
 	main();
 }
 /*----------------------------------------------------------------------------*/
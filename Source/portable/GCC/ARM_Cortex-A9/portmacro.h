@@ -136,13 +136,104 @@ static inline unsigned long portCORE_ID(void)
 	return val&3;
 }
 
+/*-----------------------------------------------------------*/
+
+/* Atomic operations.  These are built on LDREX/STREX so they can be used from
+tasks and interrupts alike without masking interrupts. */
+#define portMEMORY_BARRIER()			__asm__ __volatile__ ( "dmb" ::: "memory" )
+
+static inline unsigned long ulPortAtomicAdd( volatile unsigned long *pulTarget, unsigned long ulDelta )
+{
+unsigned long ulResult, ulFailed;
+
+	__asm__ __volatile__ (
+		"1:	ldrex	%0, [%2]		\n"
+		"	add		%0, %0, %3		\n"
+		"	strex	%1, %0, [%2]	\n"
+		"	teq		%1, #0			\n"
+		"	bne		1b				\n"
+		: "=&r" ( ulResult ), "=&r" ( ulFailed )
+		: "r" ( pulTarget ), "r" ( ulDelta )
+		: "cc", "memory" );
+
+	return ulResult;
+}
+
+static inline long xPortAtomicCompareAndSwap( volatile unsigned long *pulTarget, unsigned long ulExpected, unsigned long ulDesired )
+{
+unsigned long ulOriginal, ulFailed;
+
+	do
+	{
+		__asm__ __volatile__ (
+			"	ldrex	%0, [%2]		\n"
+			"	mov		%1, #0			\n"
+			"	teq		%0, %3			\n"
+			"	strexeq	%1, %4, [%2]	\n"
+			: "=&r" ( ulOriginal ), "=&r" ( ulFailed )
+			: "r" ( pulTarget ), "r" ( ulExpected ), "r" ( ulDesired )
+			: "cc", "memory" );
+	} while( ulFailed != 0UL );
+
+	if( ulOriginal != ulExpected )
+	{
+		__asm__ __volatile__ ( "clrex" ::: "memory" );
+	}
+
+	return ( ulOriginal == ulExpected );
+}
+
+/* Returns the new value of *pulTarget. */
+#define portATOMIC_ADD( pulTarget, ulDelta )						ulPortAtomicAdd( ( pulTarget ), ( ulDelta ) )
+/* Returns non-zero if *pulTarget held ulExpected and was replaced by ulDesired. */
+#define portATOMIC_COMPARE_AND_SWAP( pulTarget, ulExpected, ulDesired )	xPortAtomicCompareAndSwap( ( pulTarget ), ( ulExpected ), ( ulDesired ) )
+
+/*-----------------------------------------------------------*/
+
+/* Cycle counter.  The PMU cycle counter is enabled by _init(), and its value
+is sampled on every tick interrupt. */
+static inline unsigned long ulPortGetCycleCount( void )
+{
+unsigned long ulCycles;
+
+	__asm__ __volatile__ ( "mrc p15, 0, %0, c9, c13, 0" : "=r" ( ulCycles ) );
+	return ulCycles;
+}
+
+extern volatile unsigned long ulPortTickCycleCount;
+extern volatile unsigned long ulPortCyclesPerTick;
+#define portGET_CYCLE_COUNT()			ulPortGetCycleCount()
+#define portGET_TICK_CYCLE_COUNT()		( ulPortTickCycleCount )
+#define portGET_CYCLES_PER_TICK()		( ulPortCyclesPerTick )
+
+/*-----------------------------------------------------------*/
+
+/* Count the leading zero bits of a 32 bit value using the CLZ instruction.
+Returns 32 if the value is zero. */
+static inline unsigned long ulPortCountLeadingZeros( unsigned long ulValue )
+{
+unsigned long ulZeros;
+
+	__asm__ __volatile__ ( "clz %0, %1" : "=r" ( ulZeros ) : "r" ( ulValue ) );
+	return ulZeros;
+}
+
+#define portCOUNT_LEADING_ZEROS( ulValue )	ulPortCountLeadingZeros( ulValue )
+
+/* Data cache maintenance for buffers shared with DMA masters.  Cleaning writes
+any dirty lines covering the range back to memory, so it must be done before a
+DMA master reads a buffer the CPU wrote through the cache. */
+#define portCACHE_LINE_SIZE					( 32UL )
+extern void vPortCleanDCacheRange( const void *pvAddress, unsigned long ulLength );
+#define portCLEAN_DCACHE_RANGE( pvAddress, ulLength )	vPortCleanDCacheRange( ( pvAddress ), ( ulLength ) )
+
 
 /* Peripheral Base. */
 #define portPERIPHBASE							( 0x1F000000 )		/* Realview-PBX-A9 GIC Memory Base Address */
 #define portGIC_PRIVATE_BASE					( portPERIPHBASE + 0x100UL )
 #define portGIC_DISTRIBUTOR_BASE				( portPERIPHBASE + 0x1000UL )
 #define portEXCEPTION_VECTORS_BASE				( portCORE_ID()*0x1000000 )
-#define portMAX_VECTORS							( 32UL )
+#define portMAX_VECTORS							( 96UL )		/* 32 private interrupts and 64 shared peripheral interrupts. */
 
 
 /* Snoop Control Unit Processor Registers. */
@@ -147,6 +147,56 @@ size_t xPortGetFreeHeapSize( void )
 {
 	return ( configTOTAL_HEAP_SIZE - xNextFreeByte );
 }
+/*-----------------------------------------------------------*/
+
+void *pvPortMallocAlignedAttr( size_t xWantedSize, size_t xAlignment, unsigned long ulAttributes )
+{
+void *pvReturn = NULL;
+size_t xGap;
+
+	/* There is only one class of memory. */
+	( void ) ulAttributes;
+
+	/* The alignment must be a power of two. */
+	configASSERT( ( xAlignment & ( xAlignment - 1 ) ) == 0 );
+	if( xAlignment < ( size_t ) portBYTE_ALIGNMENT )
+	{
+		xAlignment = ( size_t ) portBYTE_ALIGNMENT;
+	}
+
+	/* The end of the block is aligned too, so the block does not share a
+	cache line with the next allocation. */
+	xWantedSize = ( xWantedSize + xAlignment - 1 ) & ~( xAlignment - 1 );
+
+	vTaskSuspendAll();
+	{
+		/* Memory is never freed, so the bytes skipped to reach the alignment
+		are simply lost. */
+		xGap = ( ( size_t ) 0 - ( size_t ) &( xHeap.ucHeap[ xNextFreeByte ] ) ) & ( xAlignment - 1 );
+
+		/* Check there is enough room left for the allocation. */
+		if( ( xWantedSize > 0 ) && ( xGap < configTOTAL_HEAP_SIZE ) &&
+			( ( xNextFreeByte + xGap + xWantedSize ) < configTOTAL_HEAP_SIZE ) &&
+			( ( xNextFreeByte + xGap + xWantedSize ) > xNextFreeByte ) )/* Check for overflow. */
+		{
+			pvReturn = &( xHeap.ucHeap[ xNextFreeByte + xGap ] );
+			xNextFreeByte += xGap + xWantedSize;
+		}
+	}
+	xTaskResumeAll();
+
+	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
+	{
+		if( pvReturn == NULL )
+		{
+			extern void vApplicationMallocFailedHook( void );
+			vApplicationMallocFailedHook();
+		}
+	}
+	#endif
+
+	return pvReturn;
+}
 
 
 
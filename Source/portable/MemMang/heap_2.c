@@ -151,11 +151,49 @@ xBlockLink *pxFirstFreeBlock;														\
 }
 /*-----------------------------------------------------------*/
 
+/*
+ * Allocate a block whose memory starts at a multiple of xAlignment.
+ */
+static void *prvAllocate( size_t xWantedSize, size_t xAlignment );
+
+/*
+ * The number of bytes that have to be skipped at the start of pxBlock for the
+ * memory returned to the application to be aligned to xAlignment.  This is
+ * either zero or large enough for the skipped bytes to be a free block.
+ */
+static size_t prvAlignmentGap( xBlockLink *pxBlock, size_t xAlignment );
+
+/*-----------------------------------------------------------*/
+
 void *pvPortMalloc( size_t xWantedSize )
+{
+	return prvAllocate( xWantedSize, portBYTE_ALIGNMENT );
+}
+/*-----------------------------------------------------------*/
+
+void *pvPortMallocAlignedAttr( size_t xWantedSize, size_t xAlignment, unsigned long ulAttributes )
+{
+	/* There is only one class of memory. */
+	( void ) ulAttributes;
+
+	return prvAllocate( xWantedSize, xAlignment );
+}
+/*-----------------------------------------------------------*/
+
+static void *prvAllocate( size_t xWantedSize, size_t xAlignment )
 {
 xBlockLink *pxBlock, *pxPreviousBlock, *pxNewBlockLink;
 static portBASE_TYPE xHeapHasBeenInitialised = pdFALSE;
 void *pvReturn = NULL;
+size_t xGap = ( size_t ) 0;
+
+	/* The alignment must be a power of two.  Blocks are always aligned to
+	portBYTE_ALIGNMENT anyway. */
+	configASSERT( ( xAlignment & ( xAlignment - 1 ) ) == 0 );
+	if( xAlignment < ( size_t ) portBYTE_ALIGNMENT )
+	{
+		xAlignment = ( size_t ) portBYTE_ALIGNMENT;
+	}
 
 	vTaskSuspendAll();
 	{
@@ -169,8 +207,12 @@ void *pvReturn = NULL;
 
 		/* The wanted size is increased so it can contain a xBlockLink
 		structure in addition to the requested amount of bytes. */
-		if( xWantedSize > 0 )
+		if( ( xWantedSize > 0 ) && ( xAlignment < configTOTAL_HEAP_SIZE ) )
 		{
+			/* A block with a larger alignment also ends on that alignment, so
+			the header of the following block does not share a cache line with
+			it. */
+			xWantedSize = ( xWantedSize + xAlignment - 1 ) & ~( xAlignment - 1 );
 			xWantedSize += heapSTRUCT_SIZE;
 
 			/* Ensure that blocks are always aligned to the required number of bytes. */
@@ -184,11 +226,18 @@ void *pvReturn = NULL;
 		if( ( xWantedSize > 0 ) && ( xWantedSize < configTOTAL_HEAP_SIZE ) )
 		{
 			/* Blocks are stored in byte order - traverse the list from the start
-			(smallest) block until one of adequate size is found. */
+			(smallest) block until one of adequate size is found, counting any
+			bytes that have to be skipped to align it. */
 			pxPreviousBlock = &xStart;
 			pxBlock = xStart.pxNextFreeBlock;
-			while( ( pxBlock->xBlockSize < xWantedSize ) && ( pxBlock->pxNextFreeBlock ) )
+			while( pxBlock->pxNextFreeBlock )
 			{
+				xGap = prvAlignmentGap( pxBlock, xAlignment );
+				if( pxBlock->xBlockSize >= ( xWantedSize + xGap ) )
+				{
+					break;
+				}
+
 				pxPreviousBlock = pxBlock;
 				pxBlock = pxBlock->pxNextFreeBlock;
 			}
@@ -196,14 +245,24 @@ void *pvReturn = NULL;
 			/* If we found the end marker then a block of adequate size was not found. */
 			if( pxBlock != &xEnd )
 			{
-				/* Return the memory space - jumping over the xBlockLink structure
-				at its start. */
-				pvReturn = ( void * ) ( ( ( unsigned char * ) pxPreviousBlock->pxNextFreeBlock ) + heapSTRUCT_SIZE );
-
 				/* This block is being returned for use so must be taken our of the
 				list of free blocks. */
 				pxPreviousBlock->pxNextFreeBlock = pxBlock->pxNextFreeBlock;
 
+				if( xGap > ( size_t ) 0 )
+				{
+					/* The skipped bytes become a free block of their own. */
+					pxNewBlockLink = ( void * ) ( ( ( unsigned char * ) pxBlock ) + xGap );
+					pxNewBlockLink->xBlockSize = pxBlock->xBlockSize - xGap;
+					pxBlock->xBlockSize = xGap;
+					prvInsertBlockIntoFreeList( ( pxBlock ) );
+					pxBlock = pxNewBlockLink;
+				}
+
+				/* Return the memory space - jumping over the xBlockLink structure
+				at its start. */
+				pvReturn = ( void * ) ( ( ( unsigned char * ) pxBlock ) + heapSTRUCT_SIZE );
+
 				/* If the block is larger than required it can be split into two. */
 				if( ( pxBlock->xBlockSize - xWantedSize ) > heapMINIMUM_BLOCK_SIZE )
 				{
@@ -241,6 +300,23 @@ void *pvReturn = NULL;
 }
 /*-----------------------------------------------------------*/
 
+static size_t prvAlignmentGap( xBlockLink *pxBlock, size_t xAlignment )
+{
+size_t xGap;
+
+	xGap = ( ( size_t ) 0 - ( ( size_t ) pxBlock + heapSTRUCT_SIZE ) ) & ( xAlignment - 1 );
+
+	/* Too few bytes to form a free block are skipped by moving on to the next
+	aligned address. */
+	while( ( xGap > ( size_t ) 0 ) && ( xGap < heapMINIMUM_BLOCK_SIZE ) )
+	{
+		xGap += xAlignment;
+	}
+
+	return xGap;
+}
+/*-----------------------------------------------------------*/
+
 void vPortFree( void *pv )
 {
 unsigned char *puc = ( unsigned char * ) pv;
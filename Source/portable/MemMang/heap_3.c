@@ -59,11 +59,18 @@
  * This file can only be used if the linker is configured to to generate
  * a heap memory area.
  *
+ * When configUSE_NEWLIB_REENTRANT is set to 1 this file also provides the
+ * lock hooks that newlib calls around its malloc() and environment, backed by a
+ * recursive kernel mutex.  malloc() is then safe to call from any task without
+ * suspending the scheduler, and a task that is waiting for the heap only
+ * blocks the tasks that also want it.
+ *
  * See heap_2.c and heap_1.c for alternative implementations, and the memory
  * management pages of http://www.FreeRTOS.org for more information.
  */
 
 #include <stdlib.h>
+#include <malloc.h>
 
 /* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
 all the API functions to use the MPU wrappers.  That should only be done when
@@ -73,19 +80,62 @@ task.h is included from an application file. */
 #include "FreeRTOS.h"
 #include "task.h"
 
+#if ( configUSE_NEWLIB_REENTRANT == 1 )
+	#include "semphr.h"
+	#include <reent.h>
+#endif
+
 #undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
 
+#if ( configUSE_NEWLIB_REENTRANT == 1 )
+
+	#if ( configUSE_RECURSIVE_MUTEXES != 1 ) || ( INCLUDE_xTaskGetSchedulerState != 1 )
+		#error configUSE_RECURSIVE_MUTEXES and INCLUDE_xTaskGetSchedulerState must both be set to 1 to use heap_3.c with configUSE_NEWLIB_REENTRANT.
+	#endif
+
+	/* Serialises newlib's malloc() and environment.  newlib takes the locks
+	recursively - setenv() calls malloc() with the environment locked, for
+	example - so a single recursive mutex is used for both, which also means
+	the two can never be taken in opposite orders. */
+	static xSemaphoreHandle xLibcMutex = NULL;
+
+	/* The number of times xLibcMutex has been taken, and how many of those had
+	to wait for another task to give it.  Both are only changed with the mutex
+	held.  See vPortGetLibcLockStats(). */
+	static unsigned long ulLibcLocks = 0UL;
+	static unsigned long ulLibcLockWaits = 0UL;
+
+	/*
+	 * Take and give xLibcMutex.  Before the scheduler starts no other task can
+	 * run, so there is nothing to lock against.  While the scheduler is
+	 * suspended the calling task cannot block, so the mutex must then be free
+	 * or already held by the calling task.
+	 */
+	static void prvLibcLock( void );
+	static void prvLibcUnlock( void );
+
+#endif
+
 /*-----------------------------------------------------------*/
 
 void *pvPortMalloc( size_t xWantedSize )
 {
 void *pvReturn;
 
-	vTaskSuspendAll();
+	#if ( configUSE_NEWLIB_REENTRANT == 1 )
 	{
+		/* malloc() locks the heap itself. */
 		pvReturn = malloc( xWantedSize );
 	}
-	xTaskResumeAll();
+	#else
+	{
+		vTaskSuspendAll();
+		{
+			pvReturn = malloc( xWantedSize );
+		}
+		xTaskResumeAll();
+	}
+	#endif
 
 	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
 	{
@@ -101,17 +151,176 @@ void *pvReturn;
 }
 /*-----------------------------------------------------------*/
 
+void *pvPortMallocAlignedAttr( size_t xWantedSize, size_t xAlignment, unsigned long ulAttributes )
+{
+void *pvReturn;
+
+	/* There is only one class of memory. */
+	( void ) ulAttributes;
+
+	/* The alignment must be a power of two. */
+	configASSERT( ( xAlignment & ( xAlignment - 1 ) ) == 0 );
+	if( xAlignment < ( size_t ) portBYTE_ALIGNMENT )
+	{
+		xAlignment = ( size_t ) portBYTE_ALIGNMENT;
+	}
+
+	/* The end of the block is aligned too, so the block does not share a
+	cache line with the next allocation. */
+	xWantedSize = ( xWantedSize + xAlignment - 1 ) & ~( xAlignment - 1 );
+
+	#if ( configUSE_NEWLIB_REENTRANT == 1 )
+	{
+		pvReturn = memalign( xAlignment, xWantedSize );
+	}
+	#else
+	{
+		vTaskSuspendAll();
+		{
+			pvReturn = memalign( xAlignment, xWantedSize );
+		}
+		xTaskResumeAll();
+	}
+	#endif
+
+	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
+	{
+		if( pvReturn == NULL )
+		{
+			extern void vApplicationMallocFailedHook( void );
+			vApplicationMallocFailedHook();
+		}
+	}
+	#endif
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
 void vPortFree( void *pv )
 {
 	if( pv )
 	{
-		vTaskSuspendAll();
+		#if ( configUSE_NEWLIB_REENTRANT == 1 )
 		{
 			free( pv );
 		}
-		xTaskResumeAll();
+		#else
+		{
+			vTaskSuspendAll();
+			{
+				free( pv );
+			}
+			xTaskResumeAll();
+		}
+		#endif
 	}
 }
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_NEWLIB_REENTRANT == 1 )
+
+	void __malloc_lock( struct _reent *pxReent )
+	{
+		( void ) pxReent;
+		prvLibcLock();
+	}
+	/*-----------------------------------------------------------*/
+
+	void __malloc_unlock( struct _reent *pxReent )
+	{
+		( void ) pxReent;
+		prvLibcUnlock();
+	}
+	/*-----------------------------------------------------------*/
+
+	void __env_lock( struct _reent *pxReent )
+	{
+		( void ) pxReent;
+		prvLibcLock();
+	}
+	/*-----------------------------------------------------------*/
+
+	void __env_unlock( struct _reent *pxReent )
+	{
+		( void ) pxReent;
+		prvLibcUnlock();
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvLibcLock( void )
+	{
+	portBASE_TYPE xSchedulerState = xTaskGetSchedulerState();
+	portBASE_TYPE xTaken;
+
+		if( xSchedulerState == taskSCHEDULER_RUNNING )
+		{
+			if( xLibcMutex == NULL )
+			{
+				/* Creating the mutex calls malloc(), which calls back into
+				this function with the scheduler suspended and the mutex not
+				yet created, so with nothing to take. */
+				vTaskSuspendAll();
+				{
+					if( xLibcMutex == NULL )
+					{
+						xLibcMutex = xSemaphoreCreateRecursiveMutex();
+					}
+				}
+				xTaskResumeAll();
+
+				configASSERT( xLibcMutex );
+			}
+
+			if( xLibcMutex != NULL )
+			{
+				if( xSemaphoreTakeRecursive( xLibcMutex, ( portTickType ) 0 ) == pdFAIL )
+				{
+					( void ) xSemaphoreTakeRecursive( xLibcMutex, portMAX_DELAY );
+					ulLibcLockWaits++;
+				}
+				ulLibcLocks++;
+			}
+		}
+		else if( ( xSchedulerState == taskSCHEDULER_SUSPENDED ) && ( xLibcMutex != NULL ) )
+		{
+			/* Taking the mutex without blocking succeeds if it is free or
+			already held by this task.  If another task holds it then that
+			task was preempted inside newlib, and entering newlib now would
+			corrupt its state. */
+			xTaken = xSemaphoreTakeRecursive( xLibcMutex, ( portTickType ) 0 );
+			configASSERT( xTaken );
+
+			if( xTaken != pdFAIL )
+			{
+				ulLibcLocks++;
+			}
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvLibcUnlock( void )
+	{
+		/* Also called with the scheduler suspended, to give back a mutex taken
+		either before or after it was suspended. */
+		if( ( xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED ) && ( xLibcMutex != NULL ) )
+		{
+			( void ) xSemaphoreGiveRecursive( xLibcMutex );
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	void vPortGetLibcLockStats( unsigned long *pulLocks, unsigned long *pulWaits )
+	{
+		taskENTER_CRITICAL();
+		{
+			*pulLocks = ulLibcLocks;
+			*pulWaits = ulLibcLockWaits;
+		}
+		taskEXIT_CRITICAL();
+	}
+
+#endif /* configUSE_NEWLIB_REENTRANT */
 
 
 
@@ -0,0 +1,483 @@
+/*
+    FreeRTOS V7.1.0 - Copyright (C) 2011 Real Time Engineers Ltd.
+	
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS tutorial books are available in pdf and paperback.        *
+     *    Complete, revised, and edited pdf reference manuals are also       *
+     *    available.                                                         *
+     *                                                                       *
+     *    Purchasing FreeRTOS documentation will not only help you, by       *
+     *    ensuring you get running as quickly as possible and with an        *
+     *    in-depth knowledge of how to use FreeRTOS, it will also help       *
+     *    the FreeRTOS project to continue with its mission of providing     *
+     *    professional grade, cross platform, de facto standard solutions    *
+     *    for microcontrollers - completely free of charge!                  *
+     *                                                                       *
+     *    >>> See http://www.FreeRTOS.org/Documentation for details. <<<     *
+     *                                                                       *
+     *    Thank you for using FreeRTOS, and thank you for your support!      *
+     *                                                                       *
+    ***************************************************************************
+
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation AND MODIFIED BY the FreeRTOS exception.
+    >>>NOTE<<< The modification to the GPL is included to allow you to
+    distribute a combined work that includes FreeRTOS without being obliged to
+    provide the source code for proprietary components outside of the FreeRTOS
+    kernel.  FreeRTOS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details. You should have received a copy of the GNU General Public
+    License and the FreeRTOS license exception along with FreeRTOS; if not it
+    can be viewed here: http://www.freertos.org/a00114.html and also obtained
+    by writing to Richard Barry, contact details for whom are available on the
+    FreeRTOS WEB site.
+
+    1 tab == 4 spaces!
+
+    http://www.FreeRTOS.org - Documentation, latest information, license and
+    contact details.
+
+    http://www.SafeRTOS.com - A version that is certified for use in safety
+    critical systems.
+
+    http://www.OpenRTOS.com - Commercial support, development, porting,
+    licensing and training services.
+*/
+
+/*
+ * A sample implementation of pvPortMalloc() and vPortFree() that keeps the
+ * free blocks in address order and combines (coalesces) adjacent free blocks
+ * into a single larger block when memory is freed.  This limits the
+ * fragmentation that builds up under heap_2.c when blocks of many different
+ * sizes are allocated and freed over a long period.
+ *
+ * See heap_1.c, heap_2.c and heap_3.c for alternative implementations, and the
+ * memory management pages of http://www.FreeRTOS.org for more information.
+ */
+#include <stdlib.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* Allocate the memory for the heap.  The struct is used to force byte
+alignment without using any non-portable code. */
+static union xRTOS_HEAP
+{
+	#if portBYTE_ALIGNMENT == 8
+		volatile portDOUBLE dDummy;
+	#else
+		volatile unsigned long ulDummy;
+	#endif
+	unsigned char ucHeap[ configTOTAL_HEAP_SIZE ];
+} xHeap;
+
+/* Define the linked list structure.  This is used to link free blocks in order
+of their memory address. */
+typedef struct A_BLOCK_LINK
+{
+	struct A_BLOCK_LINK *pxNextFreeBlock;	/*<< The next free block in the list. */
+	size_t xBlockSize;						/*<< The size of the free block. */
+} xBlockLink;
+
+
+static const unsigned short  heapSTRUCT_SIZE	= ( sizeof( xBlockLink ) + portBYTE_ALIGNMENT - ( sizeof( xBlockLink ) % portBYTE_ALIGNMENT ) );
+#define heapMINIMUM_BLOCK_SIZE	( ( size_t ) ( heapSTRUCT_SIZE * 2 ) )
+
+/* The top bit of the xBlockSize member of an xBlockLink is set while the block
+belongs to the application, and clear while the block is free.  This allows
+vPortFree() to catch blocks that are freed twice, or pointers that were never
+returned by pvPortMalloc(), and limits the size of a single block to half the
+address space. */
+#define heapBLOCK_ALLOCATED_BIT	( ( size_t ) 1 << ( ( sizeof( size_t ) * 8 ) - 1 ) )
+
+/* The heap is used from the first aligned address within xHeap to the end of
+xHeap, less the space taken by the end marker. */
+#define heapADJUSTED_HEAP_SIZE	( configTOTAL_HEAP_SIZE - heapSTRUCT_SIZE )
+
+/* xStart marks the start of the list of free blocks.  pxEnd marks the end of
+the list, and sits in the last bytes of the heap itself so it has a higher
+address than any free block. */
+static xBlockLink xStart, *pxEnd = NULL;
+
+/* Keeps track of the number of free bytes remaining, and the lowest number of
+free bytes there have ever been, but says nothing about fragmentation. */
+static size_t xFreeBytesRemaining = ( size_t ) 0;
+static size_t xMinimumEverFreeBytesRemaining = ( size_t ) 0;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Called the first time pvPortMalloc() is called to create the single free
+ * block that initially spans the whole heap.
+ */
+static void prvHeapInit( void );
+
+/*
+ * Insert a block into the list of free blocks - which is ordered by the
+ * address of the block.  If the block is contiguous with the free block that
+ * precedes it, or the free block that follows it, or both, then the blocks are
+ * merged into one.
+ */
+static void prvInsertBlockIntoFreeList( xBlockLink *pxBlockToInsert );
+
+/*
+ * Allocate a block whose memory starts at a multiple of xAlignment.
+ */
+static void *prvAllocate( size_t xWantedSize, size_t xAlignment );
+
+/*
+ * The number of bytes that have to be skipped at the start of pxBlock for the
+ * memory returned to the application to be aligned to xAlignment.  This is
+ * either zero or large enough for the skipped bytes to be a free block.
+ */
+static size_t prvAlignmentGap( xBlockLink *pxBlock, size_t xAlignment );
+
+/*-----------------------------------------------------------*/
+
+void *pvPortMalloc( size_t xWantedSize )
+{
+	return prvAllocate( xWantedSize, portBYTE_ALIGNMENT );
+}
+/*-----------------------------------------------------------*/
+
+void *pvPortMallocAlignedAttr( size_t xWantedSize, size_t xAlignment, unsigned long ulAttributes )
+{
+	/* There is only one class of memory. */
+	( void ) ulAttributes;
+
+	return prvAllocate( xWantedSize, xAlignment );
+}
+/*-----------------------------------------------------------*/
+
+static void *prvAllocate( size_t xWantedSize, size_t xAlignment )
+{
+xBlockLink *pxBlock, *pxPreviousBlock, *pxNewBlockLink;
+void *pvReturn = NULL;
+size_t xGap = ( size_t ) 0;
+
+	/* The alignment must be a power of two.  Blocks are always aligned to
+	portBYTE_ALIGNMENT anyway. */
+	configASSERT( ( xAlignment & ( xAlignment - 1 ) ) == 0 );
+	if( xAlignment < ( size_t ) portBYTE_ALIGNMENT )
+	{
+		xAlignment = ( size_t ) portBYTE_ALIGNMENT;
+	}
+
+	vTaskSuspendAll();
+	{
+		/* If this is the first call to malloc then the heap will require
+		initialisation to setup the list of free blocks. */
+		if( pxEnd == NULL )
+		{
+			prvHeapInit();
+		}
+
+		/* The wanted size is increased so it can contain a xBlockLink
+		structure in addition to the requested amount of bytes. */
+		if( ( xWantedSize > 0 ) && ( ( xWantedSize & heapBLOCK_ALLOCATED_BIT ) == 0 ) && ( xAlignment < configTOTAL_HEAP_SIZE ) )
+		{
+			/* A block with a larger alignment also ends on that alignment, so
+			the header of the following block does not share a cache line with
+			it. */
+			xWantedSize = ( xWantedSize + xAlignment - 1 ) & ~( xAlignment - 1 );
+			xWantedSize += heapSTRUCT_SIZE;
+
+			/* Ensure that blocks are always aligned to the required number of bytes. */
+			if( xWantedSize & portBYTE_ALIGNMENT_MASK )
+			{
+				/* Byte alignment required. */
+				xWantedSize += ( portBYTE_ALIGNMENT - ( xWantedSize & portBYTE_ALIGNMENT_MASK ) );
+			}
+		}
+		else
+		{
+			xWantedSize = 0;
+		}
+
+		if( ( xWantedSize > 0 ) && ( xWantedSize <= xFreeBytesRemaining ) )
+		{
+			/* Blocks are stored in address order - traverse the list from the
+			start (lowest address) block until the first one of adequate size
+			is found, counting any bytes that have to be skipped to align it. */
+			pxPreviousBlock = &xStart;
+			pxBlock = xStart.pxNextFreeBlock;
+			for( ;; )
+			{
+				if( pxBlock->pxNextFreeBlock == NULL )
+				{
+					break;
+				}
+
+				xGap = prvAlignmentGap( pxBlock, xAlignment );
+				if( pxBlock->xBlockSize >= ( xWantedSize + xGap ) )
+				{
+					break;
+				}
+
+				pxPreviousBlock = pxBlock;
+				pxBlock = pxBlock->pxNextFreeBlock;
+			}
+
+			/* If we found the end marker then a block of adequate size was not found. */
+			if( pxBlock != pxEnd )
+			{
+				/* This block is being returned for use so must be taken out of
+				the list of free blocks. */
+				pxPreviousBlock->pxNextFreeBlock = pxBlock->pxNextFreeBlock;
+
+				if( xGap > ( size_t ) 0 )
+				{
+					/* The skipped bytes become a free block of their own.  It
+					cannot be contiguous with another free block, as the block
+					it was split from was not. */
+					pxNewBlockLink = ( void * ) ( ( ( unsigned char * ) pxBlock ) + xGap );
+					pxNewBlockLink->xBlockSize = pxBlock->xBlockSize - xGap;
+					pxBlock->xBlockSize = xGap;
+					prvInsertBlockIntoFreeList( pxBlock );
+					pxBlock = pxNewBlockLink;
+				}
+
+				/* Return the memory space - jumping over the xBlockLink structure
+				at its start. */
+				pvReturn = ( void * ) ( ( ( unsigned char * ) pxBlock ) + heapSTRUCT_SIZE );
+
+				/* If the block is larger than required it can be split into two. */
+				if( ( pxBlock->xBlockSize - xWantedSize ) > heapMINIMUM_BLOCK_SIZE )
+				{
+					/* This block is to be split into two.  Create a new block
+					following the number of bytes requested. The void cast is
+					used to prevent byte alignment warnings from the compiler. */
+					pxNewBlockLink = ( void * ) ( ( ( unsigned char * ) pxBlock ) + xWantedSize );
+
+					/* Calculate the sizes of two blocks split from the single
+					block. */
+					pxNewBlockLink->xBlockSize = pxBlock->xBlockSize - xWantedSize;
+					pxBlock->xBlockSize = xWantedSize;
+
+					/* Insert the new block into the list of free blocks.  It
+					cannot be contiguous with another free block, as the block
+					it was split from was not. */
+					prvInsertBlockIntoFreeList( pxNewBlockLink );
+				}
+
+				xFreeBytesRemaining -= pxBlock->xBlockSize;
+
+				if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+				{
+					xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+				}
+
+				/* The block now belongs to the application. */
+				pxBlock->xBlockSize |= heapBLOCK_ALLOCATED_BIT;
+				pxBlock->pxNextFreeBlock = NULL;
+			}
+		}
+	}
+	xTaskResumeAll();
+
+	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
+	{
+		if( pvReturn == NULL )
+		{
+			extern void vApplicationMallocFailedHook( void );
+			vApplicationMallocFailedHook();
+		}
+	}
+	#endif
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvAlignmentGap( xBlockLink *pxBlock, size_t xAlignment )
+{
+size_t xGap;
+
+	xGap = ( ( size_t ) 0 - ( ( size_t ) pxBlock + heapSTRUCT_SIZE ) ) & ( xAlignment - 1 );
+
+	/* Too few bytes to form a free block are skipped by moving on to the next
+	aligned address. */
+	while( ( xGap > ( size_t ) 0 ) && ( xGap < heapMINIMUM_BLOCK_SIZE ) )
+	{
+		xGap += xAlignment;
+	}
+
+	return xGap;
+}
+/*-----------------------------------------------------------*/
+
+void vPortFree( void *pv )
+{
+unsigned char *puc = ( unsigned char * ) pv;
+xBlockLink *pxLink;
+
+	if( pv )
+	{
+		/* The memory being freed will have an xBlockLink structure immediately
+		before it. */
+		puc -= heapSTRUCT_SIZE;
+
+		/* This casting is to keep the compiler from issuing warnings. */
+		pxLink = ( void * ) puc;
+
+		/* Check the block is actually allocated. */
+		configASSERT( ( pxLink->xBlockSize & heapBLOCK_ALLOCATED_BIT ) != 0 );
+		configASSERT( pxLink->pxNextFreeBlock == NULL );
+
+		if( ( pxLink->xBlockSize & heapBLOCK_ALLOCATED_BIT ) != 0 )
+		{
+			/* The block is being returned to the heap - it is no longer
+			allocated. */
+			pxLink->xBlockSize &= ~heapBLOCK_ALLOCATED_BIT;
+
+			vTaskSuspendAll();
+			{
+				/* Add this block to the list of free blocks. */
+				xFreeBytesRemaining += pxLink->xBlockSize;
+				prvInsertBlockIntoFreeList( pxLink );
+			}
+			xTaskResumeAll();
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeHeapSize( void )
+{
+	return xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+	return xMinimumEverFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetLargestFreeBlockSize( void )
+{
+xBlockLink *pxBlock;
+size_t xLargest = ( size_t ) 0;
+
+	vTaskSuspendAll();
+	{
+		if( pxEnd == NULL )
+		{
+			prvHeapInit();
+		}
+
+		for( pxBlock = xStart.pxNextFreeBlock; pxBlock != pxEnd; pxBlock = pxBlock->pxNextFreeBlock )
+		{
+			if( pxBlock->xBlockSize > xLargest )
+			{
+				xLargest = pxBlock->xBlockSize;
+			}
+		}
+	}
+	xTaskResumeAll();
+
+	/* Report the number of bytes the application could actually obtain from
+	the block. */
+	if( xLargest > ( size_t ) heapSTRUCT_SIZE )
+	{
+		xLargest -= heapSTRUCT_SIZE;
+	}
+	else
+	{
+		xLargest = ( size_t ) 0;
+	}
+
+	return xLargest;
+}
+/*-----------------------------------------------------------*/
+
+void vPortInitialiseBlocks( void )
+{
+	/* This just exists to keep the linker quiet. */
+}
+/*-----------------------------------------------------------*/
+
+static void prvHeapInit( void )
+{
+xBlockLink *pxFirstFreeBlock;
+
+	/* xStart is used to hold a pointer to the first item in the list of free
+	blocks.  The void cast is used to prevent compiler warnings. */
+	xStart.pxNextFreeBlock = ( void * ) xHeap.ucHeap;
+	xStart.xBlockSize = ( size_t ) 0;
+
+	/* pxEnd is used to mark the end of the list of free blocks and is placed
+	at the end of the heap space. */
+	pxEnd = ( void * ) ( xHeap.ucHeap + heapADJUSTED_HEAP_SIZE );
+	pxEnd->xBlockSize = ( size_t ) 0;
+	pxEnd->pxNextFreeBlock = NULL;
+
+	/* To start with there is a single free block that is sized to take up the
+	entire heap space, minus the space taken by pxEnd. */
+	pxFirstFreeBlock = ( void * ) xHeap.ucHeap;
+	pxFirstFreeBlock->xBlockSize = heapADJUSTED_HEAP_SIZE;
+	pxFirstFreeBlock->pxNextFreeBlock = pxEnd;
+
+	xFreeBytesRemaining = pxFirstFreeBlock->xBlockSize;
+	xMinimumEverFreeBytesRemaining = pxFirstFreeBlock->xBlockSize;
+}
+/*-----------------------------------------------------------*/
+
+static void prvInsertBlockIntoFreeList( xBlockLink *pxBlockToInsert )
+{
+xBlockLink *pxIterator;
+unsigned char *puc;
+
+	/* Iterate through the list until a block is found that has a higher
+	address than the block being inserted. */
+	for( pxIterator = &xStart; pxIterator->pxNextFreeBlock < pxBlockToInsert; pxIterator = pxIterator->pxNextFreeBlock )
+	{
+		/* There is nothing to do here, just iterate to the right position. */
+	}
+
+	/* Do the block being inserted, and the block it is being inserted after,
+	make a contiguous block of memory? */
+	puc = ( unsigned char * ) pxIterator;
+	if( ( puc + pxIterator->xBlockSize ) == ( unsigned char * ) pxBlockToInsert )
+	{
+		pxIterator->xBlockSize += pxBlockToInsert->xBlockSize;
+		pxBlockToInsert = pxIterator;
+	}
+
+	/* Do the block being inserted, and the block it is being inserted before,
+	make a contiguous block of memory?  pxEnd is never merged. */
+	puc = ( unsigned char * ) pxBlockToInsert;
+	if( ( ( puc + pxBlockToInsert->xBlockSize ) == ( unsigned char * ) pxIterator->pxNextFreeBlock ) && ( pxIterator->pxNextFreeBlock != pxEnd ) )
+	{
+		/* Form one big block from the two blocks. */
+		pxBlockToInsert->xBlockSize += pxIterator->pxNextFreeBlock->xBlockSize;
+		pxBlockToInsert->pxNextFreeBlock = pxIterator->pxNextFreeBlock->pxNextFreeBlock;
+	}
+	else
+	{
+		pxBlockToInsert->pxNextFreeBlock = pxIterator->pxNextFreeBlock;
+	}
+
+	/* If the block being inserted plugged a gap, so was merged with the block
+	before and the block after, then its pxNextFreeBlock pointer will have
+	already been set, and should not be set here as that would make it point
+	to itself. */
+	if( pxIterator != pxBlockToInsert )
+	{
+		pxIterator->pxNextFreeBlock = pxBlockToInsert;
+	}
+}
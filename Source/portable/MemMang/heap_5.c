@@ -0,0 +1,1473 @@
+/*
+    FreeRTOS V7.1.0 - Copyright (C) 2011 Real Time Engineers Ltd.
+	
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS tutorial books are available in pdf and paperback.        *
+     *    Complete, revised, and edited pdf reference manuals are also       *
+     *    available.                                                         *
+     *                                                                       *
+     *    Purchasing FreeRTOS documentation will not only help you, by       *
+     *    ensuring you get running as quickly as possible and with an        *
+     *    in-depth knowledge of how to use FreeRTOS, it will also help       *
+     *    the FreeRTOS project to continue with its mission of providing     *
+     *    professional grade, cross platform, de facto standard solutions    *
+     *    for microcontrollers - completely free of charge!                  *
+     *                                                                       *
+     *    >>> See http://www.FreeRTOS.org/Documentation for details. <<<     *
+     *                                                                       *
+     *    Thank you for using FreeRTOS, and thank you for your support!      *
+     *                                                                       *
+    ***************************************************************************
+
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation AND MODIFIED BY the FreeRTOS exception.
+    >>>NOTE<<< The modification to the GPL is included to allow you to
+    distribute a combined work that includes FreeRTOS without being obliged to
+    provide the source code for proprietary components outside of the FreeRTOS
+    kernel.  FreeRTOS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details. You should have received a copy of the GNU General Public
+    License and the FreeRTOS license exception along with FreeRTOS; if not it
+    can be viewed here: http://www.freertos.org/a00114.html and also obtained
+    by writing to Richard Barry, contact details for whom are available on the
+    FreeRTOS WEB site.
+
+    1 tab == 4 spaces!
+
+    http://www.FreeRTOS.org - Documentation, latest information, license and
+    contact details.
+
+    http://www.SafeRTOS.com - A version that is certified for use in safety
+    critical systems.
+
+    http://www.OpenRTOS.com - Commercial support, development, porting,
+    licensing and training services.
+*/
+
+/*
+ * A sample implementation of pvPortMalloc() and vPortFree() that uses a Two
+ * Level Segregated Fit (TLSF) allocator.  Free blocks are held in a two
+ * dimensional array of lists.  The first level divides block sizes into powers
+ * of two, and the second level divides each power of two range into
+ * heapSL_INDEX_COUNT equal steps.  A bitmap records which lists are not empty,
+ * so a list containing a block of adequate size is found with a couple of
+ * count leading zeros instructions rather than by walking a list.  Adjacent
+ * free blocks are always coalesced as soon as a block is freed.
+ *
+ * Both pvPortMalloc() and vPortFree() execute in a bounded time regardless of
+ * the number of blocks in the heap, so this is the implementation to use when
+ * the worst case allocation time matters.
+ *
+ * Because every operation is short and bounded, the heap is protected by
+ * masking interrupts up to configMAX_SYSCALL_INTERRUPT_PRIORITY rather than by
+ * suspending the scheduler.  Allocating therefore never pays for a call to
+ * xTaskResumeAll(), and interrupts that are allowed to use the FreeRTOS API
+ * can allocate with pvPortMallocFromISR() and free with vPortFreeFromISR().
+ *
+ * The heap is not a static array.  Instead the application passes a table of
+ * RAM regions to vPortDefineHeapRegions() before the first allocation is made.
+ * Each region has its own set of free lists, and is tagged with attributes so
+ * pvPortMallocAttr() can allocate from, for example, memory that is safe to
+ * use for DMA.  The regions are not cleared, so they can be placed outside of
+ * the zero initialised bss section.
+ *
+ * When configUSE_HEAP_SLABS is set to 1 allocations of up to 512 bytes made by
+ * pvPortMalloc() and pvPortMallocFromISR() are served from slabs instead.  A
+ * zone of configHEAP_SLAB_ZONE_SIZE bytes is taken from the heap when the
+ * regions are defined and divided into 4K pages, each of which holds objects
+ * of a single size class.  Slab objects have no header, objects of the same
+ * size are kept together, and allocating or freeing one only pushes or pops a
+ * free list.  When the heap is instrumented each object is preceded by the
+ * same record of its owner and caller that a block keeps in its header.  If
+ * the zone runs out of pages the allocation falls through to the TLSF
+ * allocator.
+ *
+ * When configUSE_HEAP_INSTRUMENTATION is set to 1 each block also records the
+ * task that allocated it and the address from which pvPortMalloc() was called.
+ * The bytes and blocks held by each task are then accounted in its TCB, and
+ * vPortGetHeapStats() and uxPortGetHeapAllocations() can be used to find
+ * where the heap is going and which allocations have leaked.  The blocks of
+ * each task are linked together through their headers, so finding or
+ * releasing them takes time proportional to their number rather than to the
+ * size of the heap.  Slab objects are accounted in the same way.
+ *
+ * See heap_1.c, heap_2.c, heap_3.c and heap_4.c for alternative
+ * implementations, and the memory management pages of http://www.FreeRTOS.org
+ * for more information.
+ */
+#include <stdlib.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* The address from which pvPortMalloc() was called is only recorded when the
+heap is instrumented. */
+#if ( configUSE_HEAP_INSTRUMENTATION == 1 )
+	#define heapCALLER_ADDRESS()	__builtin_return_address( 0 )
+#else
+	#define heapCALLER_ADDRESS()	NULL
+#endif
+
+/* The heap is locked by masking the interrupts that can call the API, which
+makes it safe to use from those interrupts as well as from tasks. */
+#define heapLOCK( uxSavedMask )		( uxSavedMask ) = portSET_INTERRUPT_MASK_FROM_ISR()
+#define heapUNLOCK( uxSavedMask )	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedMask )
+
+/* vPortHeapOwnerDeleted() moves the blocks of a deleted task this many at a
+time, unmasking interrupts in between. */
+#define heapOWNER_CHUNK				16U
+
+/* Use the count leading zeros instruction if the port provides one. */
+#ifndef portCOUNT_LEADING_ZEROS
+	#define portCOUNT_LEADING_ZEROS( ulValue )	( ( ( ulValue ) == 0UL ) ? 32UL : ( unsigned long ) __builtin_clz( ulValue ) )
+#endif
+
+#if portBYTE_ALIGNMENT == 8
+	#define heapALIGNMENT_LOG2		3
+#elif portBYTE_ALIGNMENT == 4
+	#define heapALIGNMENT_LOG2		2
+#else
+	#error heap_5.c requires portBYTE_ALIGNMENT to be 4 or 8.
+#endif
+
+/* The number of second level lists per first level list, as a power of 2. */
+#define heapSL_INDEX_COUNT_LOG2		4
+#define heapSL_INDEX_COUNT			( 1UL << heapSL_INDEX_COUNT_LOG2 )
+
+/* Blocks smaller than heapSMALL_BLOCK_SIZE all map to first level list 0, which
+is divided linearly into steps of portBYTE_ALIGNMENT.  Larger blocks map to
+first level list n where 2^(n+heapFL_INDEX_SHIFT-1) <= size < 2^(n+heapFL_INDEX_SHIFT). */
+#define heapFL_INDEX_SHIFT			( heapSL_INDEX_COUNT_LOG2 + heapALIGNMENT_LOG2 )
+#define heapSMALL_BLOCK_SIZE		( ( size_t ) 1 << heapFL_INDEX_SHIFT )
+
+/* Blocks must be smaller than 2^heapFL_INDEX_MAX bytes. */
+#define heapFL_INDEX_MAX			30
+#define heapFL_INDEX_COUNT			( heapFL_INDEX_MAX - heapFL_INDEX_SHIFT + 1 )
+#define heapMAXIMUM_BLOCK_SIZE		( ( size_t ) 1 << heapFL_INDEX_MAX )
+
+#if ( configUSE_HEAP_INSTRUMENTATION == 1 )
+
+	/* Who allocated a block.  The records of the blocks charged to a task are
+	linked into a list whose head is kept in its TCB, and those charged to
+	nobody into pxUnownedRecords. */
+	typedef struct HEAP_RECORD
+	{
+		void *pvOwner;						/*<< The task that allocated the block, or NULL if the block is not charged to a task. */
+		void *pvCaller;						/*<< The address from which the block was allocated. */
+		struct HEAP_RECORD *pxNextRecord;	/*<< The next block charged to the same owner. */
+		struct HEAP_RECORD *pxPrevRecord;	/*<< The previous block charged to the same owner, or NULL if this is the first. */
+	} xHeapRecord;
+
+#endif
+
+/* The header at the start of every block.  pxPrevPhysBlock and xSize are
+always valid.  pxNextFreeBlock and pxPrevFreeBlock occupy the first bytes of
+the memory returned to the application, so are only valid while the block is
+free. */
+typedef struct TLSF_BLOCK
+{
+	struct TLSF_BLOCK *pxPrevPhysBlock;	/*<< The block that immediately precedes this block in memory, or NULL if this is the first block. */
+	size_t xSize;						/*<< The size of the block, including this header.  Bit 0 is set while the block is free. */
+
+	#if ( configUSE_HEAP_INSTRUMENTATION == 1 )
+		xHeapRecord xRecord;			/*<< Who allocated the block, while it is allocated. */
+	#endif
+
+	struct TLSF_BLOCK *pxNextFreeBlock;	/*<< The next block in the same free list. */
+	struct TLSF_BLOCK *pxPrevFreeBlock;	/*<< The previous block in the same free list. */
+} xTLSFBlock;
+
+/* The free lists and the bitmaps that record which of them are not empty. */
+typedef struct TLSF_CONTROL
+{
+	unsigned long ulFirstLevelBitmap;
+	unsigned long ulSecondLevelBitmap[ heapFL_INDEX_COUNT ];
+	xTLSFBlock *pxFreeLists[ heapFL_INDEX_COUNT ][ heapSL_INDEX_COUNT ];
+} xTLSFControl;
+
+#define heapBLOCK_FREE_BIT			( ( size_t ) 1 )
+#define heapBLOCK_SIZE( pxBlock )	( ( pxBlock )->xSize & ~heapBLOCK_FREE_BIT )
+#define heapBLOCK_IS_FREE( pxBlock )	( ( ( pxBlock )->xSize & heapBLOCK_FREE_BIT ) != 0 )
+#define heapNEXT_PHYS_BLOCK( pxBlock )	( ( xTLSFBlock * ) ( ( ( unsigned char * ) ( pxBlock ) ) + heapBLOCK_SIZE( pxBlock ) ) )
+
+/* The part of the header that is present while the block is allocated, and
+the smallest block that can hold the whole header once it is free. */
+#define heapBLOCK_HEADER_SIZE		( ( ( size_t ) &( ( ( xTLSFBlock * ) 0 )->pxNextFreeBlock ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+#define heapMINIMUM_BLOCK_SIZE		( ( sizeof( xTLSFBlock ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+
+/* The block whose header holds the record pxRecord. */
+#define heapBLOCK_OF_RECORD( pxRecord )	( ( xTLSFBlock * ) ( ( ( unsigned char * ) ( pxRecord ) ) - ( size_t ) &( ( ( xTLSFBlock * ) 0 )->xRecord ) ) )
+
+/* A region of the heap, as passed to vPortDefineHeapRegions(). */
+typedef struct TLSF_REGION
+{
+	xTLSFControl xControl;				/*<< The free lists of the region. */
+	unsigned char *pucStart;			/*<< The first and one past the last byte of the region, used to find the region a freed block belongs to. */
+	unsigned char *pucEnd;
+	xTLSFBlock *pxFirstBlock;			/*<< The block at the lowest address in the region, from which the region can be walked. */
+	unsigned long ulAttributes;			/*<< The portHEAP_ATTR_ bits of the region. */
+} xTLSFRegion;
+
+static xTLSFRegion xRegions[ configHEAP_MAX_REGIONS ];
+static unsigned portBASE_TYPE uxRegionCount = 0U;
+
+/* Keeps track of the number of free bytes remaining, and the lowest number of
+free bytes there have ever been. */
+static size_t xFreeBytesRemaining = ( size_t ) 0;
+static size_t xMinimumEverFreeBytesRemaining = ( size_t ) 0;
+
+#if ( configUSE_HEAP_SLABS == 1 )
+
+	/* The slab zone is divided into pages of heapSLAB_PAGE_SIZE bytes, each of
+	which holds objects of a single size class. */
+	#define heapSLAB_PAGE_SIZE_LOG2		12
+	#define heapSLAB_PAGE_SIZE			( ( size_t ) 1 << heapSLAB_PAGE_SIZE_LOG2 )
+	#define heapSLAB_PAGE_COUNT			( configHEAP_SLAB_ZONE_SIZE / heapSLAB_PAGE_SIZE )
+	#define heapSLAB_ZONE_SIZE			( heapSLAB_PAGE_COUNT * heapSLAB_PAGE_SIZE )
+
+	/* The size classes.  Every size is a multiple of 8, so the objects are
+	aligned to portBYTE_ALIGNMENT. */
+	#define heapSLAB_CLASS_COUNT		12
+	#define heapSLAB_MAXIMUM_SIZE		( ( size_t ) 512 )
+	static const unsigned short usSlabClassSizes[ heapSLAB_CLASS_COUNT ] = { 8, 16, 24, 32, 48, 64, 96, 128, 192, 256, 384, 512 };
+
+	/* When the heap is instrumented each object is preceded by a record of
+	who allocated it, so slab objects are charged and listed like blocks. */
+	#if ( configUSE_HEAP_INSTRUMENTATION == 1 )
+		#define heapSLAB_RECORD_SIZE	( ( sizeof( xHeapRecord ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+	#else
+		#define heapSLAB_RECORD_SIZE	( ( size_t ) 0 )
+	#endif
+
+	/* A free slot holds a pointer to the next free slot in the same page. */
+	typedef struct SLAB_OBJECT
+	{
+		struct SLAB_OBJECT *pxNextFreeObject;
+	} xSlabObject;
+
+	/* Describes a page of the zone.  The descriptors are kept apart from the
+	pages so the whole of every page holds objects. */
+	typedef struct SLAB_PAGE
+	{
+		xSlabObject *pxFreeObjects;		/*<< Objects that have been freed back to the page. */
+		struct SLAB_PAGE *pxNextPage;	/*<< The next page in the partial list of the class, or in the list of free pages. */
+		struct SLAB_PAGE *pxPrevPage;	/*<< The previous page in the partial list of the class. */
+		unsigned short usInUse;			/*<< The number of objects allocated from the page. */
+		unsigned short usCarved;		/*<< Objects above this index have never been allocated, so are not on pxFreeObjects. */
+		unsigned char ucClass;			/*<< The size class of the objects in the page. */
+	} xSlabPage;
+
+	/* A size class, and the pages that hold its objects. */
+	typedef struct SLAB_CLASS
+	{
+		xSlabPage *pxPartialPages;		/*<< The pages of the class that have at least one free object.  Full pages are not on any list. */
+		unsigned short usObjectSize;
+		unsigned short usSlotSize;		/*<< The object and its record, if there is one. */
+		unsigned short usObjectsPerPage;
+		unsigned portBASE_TYPE uxPages;
+		unsigned long ulObjectsInUse;
+		unsigned long ulAllocations;
+		unsigned long ulFallbacks;		/*<< Allocations passed to the TLSF allocator because there was no free page. */
+	} xSlabClass;
+
+	static xSlabClass xSlabClasses[ heapSLAB_CLASS_COUNT ];
+	static xSlabPage xSlabPages[ heapSLAB_PAGE_COUNT ];
+	static xSlabPage *pxFreeSlabPages = NULL;
+
+	/* The zone.  Both are NULL if the zone could not be allocated, in which
+	case every allocation is made by the TLSF allocator. */
+	static unsigned char *pucSlabZoneStart = NULL;
+	static unsigned char *pucSlabZoneEnd = NULL;
+
+	/* The size class used for a request of n bytes is ucSlabClassOfSize[ ( n + 7 ) / 8 ]. */
+	static unsigned char ucSlabClassOfSize[ ( heapSLAB_MAXIMUM_SIZE >> 3 ) + 1 ];
+
+#endif
+
+#if ( configUSE_HEAP_INSTRUMENTATION == 1 )
+
+	/* Counts returned by vPortGetHeapStats(). */
+	static unsigned long ulAllocations = 0UL;
+	static unsigned long ulFrees = 0UL;
+	static unsigned long ulFailures = 0UL;
+	static unsigned long ulOutstandingBySize[ portHEAP_HISTOGRAM_BUCKETS ];
+	static unsigned long ulAllocationsBySize[ portHEAP_HISTOGRAM_BUCKETS ];
+
+	/* The blocks that are not charged to any task. */
+	static xHeapRecord *pxUnownedRecords = NULL;
+
+#endif
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Allocate a block whose memory starts at a multiple of xAlignment from the
+ * first region that has all of the attribute bits in ulAttributes set.
+ * xFromISR is pdTRUE if called from an interrupt, in which case the block is
+ * not charged to the interrupted task and the malloc failed hook is not
+ * called.
+ */
+static void *prvAllocate( size_t xWantedSize, size_t xAlignment, unsigned long ulAttributes, void *pvCaller, portBASE_TYPE xFromISR );
+
+/*
+ * Move the start of the free block pxBlock up so the memory it returns to the
+ * application is aligned to xAlignment, turning the skipped bytes into a free
+ * block of their own.  Returns the block that is left.
+ */
+static xTLSFBlock *prvAlignBlock( xTLSFControl *pxControl, xTLSFBlock *pxBlock, size_t xAlignment );
+
+/*
+ * Find the region that contains pv.
+ */
+static xTLSFRegion *prvFindRegion( void *pv );
+
+/*
+ * Turn the memory between pucStart and pucStart + xLength into a single free
+ * block, followed by a zero sized allocated block that marks the end of the
+ * memory, and make it the memory of pxRegion.  Returns the number of free
+ * bytes added.
+ */
+static size_t prvAddMemory( xTLSFRegion *pxRegion, unsigned char *pucStart, size_t xLength );
+
+/*
+ * The size of the largest free block in any region.  Must be called with the
+ * heap locked.
+ */
+static size_t prvLargestFreeBlock( void );
+
+#if ( configUSE_HEAP_SLABS == 1 )
+
+	/*
+	 * Allocate the slab zone from the heap and put all of its pages on the
+	 * list of free pages.
+	 */
+	static void prvSlabInit( void );
+
+	/*
+	 * Allocate an object of at least xSize bytes, where xSize is not zero
+	 * and not larger than heapSLAB_MAXIMUM_SIZE.  Returns NULL if a new page
+	 * was needed and the zone had none left.  Must be called with the heap
+	 * locked.  The object is recorded as having been allocated from pvCaller
+	 * and, unless xFromISR is set, is charged to the calling task.
+	 */
+	static void *prvSlabAllocate( size_t xSize, void *pvCaller, portBASE_TYPE xFromISR );
+
+	/*
+	 * Return an object to its page.  Must be called with the heap locked.
+	 */
+	static void prvSlabFree( void *pv );
+
+	/*
+	 * Add a page to, and remove a page from, a doubly linked page list.
+	 */
+	static void prvSlabListInsert( xSlabPage **ppxList, xSlabPage *pxPage );
+	static void prvSlabListRemove( xSlabPage **ppxList, xSlabPage *pxPage );
+
+#endif
+
+#if ( configUSE_HEAP_INSTRUMENTATION == 1 )
+
+	/*
+	 * The size histogram bucket into which a block of xBlockSize bytes falls.
+	 */
+	static unsigned portBASE_TYPE prvHistogramBucket( size_t xBlockSize );
+
+	/*
+	 * The head of the list of the blocks charged to pvOwner.
+	 */
+	static xHeapRecord **prvRecordList( void *pvOwner );
+
+	/*
+	 * Fill in the record of a block that has just been allocated and add it
+	 * to the list of its owner, and take it off that list again when the
+	 * block is freed.  Must be called with the heap locked.
+	 */
+	static void prvRecordInsert( xHeapRecord *pxRecord, void *pvOwner, void *pvCaller );
+	static void prvRecordRemove( xHeapRecord *pxRecord );
+
+#endif
+
+/*
+ * Find the first and second level list indexes of the free list into which a
+ * block of xSize bytes is inserted.
+ */
+static void prvMappingInsert( size_t xSize, unsigned long *pulFirstLevel, unsigned long *pulSecondLevel );
+
+/*
+ * Find the first non-empty free list that is guaranteed to only contain blocks
+ * of at least xSize bytes, and remove the block at its head.  Returns NULL if
+ * there is no such list.
+ */
+static xTLSFBlock *prvTakeSuitableBlock( xTLSFControl *pxControl, size_t xSize );
+
+/*
+ * Insert a free block into, and remove a free block from, the appropriate
+ * free list, keeping the bitmaps up to date.
+ */
+static void prvInsertFreeBlock( xTLSFControl *pxControl, xTLSFBlock *pxBlock );
+static void prvRemoveFreeBlock( xTLSFControl *pxControl, xTLSFBlock *pxBlock );
+
+/*
+ * If pxBlock is larger than xSize by enough to hold a block of its own, split
+ * the remainder off into a new free block.
+ */
+static void prvSplitBlock( xTLSFControl *pxControl, xTLSFBlock *pxBlock, size_t xSize );
+
+/*
+ * Return a block to the heap, merging it with the blocks either side of it
+ * if they are free.
+ */
+static void prvReleaseBlock( xTLSFControl *pxControl, xTLSFBlock *pxBlock );
+
+/* Index of the most and least significant set bits of a non-zero value. */
+#define heapFLS( ulValue )	( 31UL - portCOUNT_LEADING_ZEROS( ulValue ) )
+#define heapFFS( ulValue )	heapFLS( ( ulValue ) & ( ~( ulValue ) + 1UL ) )
+
+/*-----------------------------------------------------------*/
+
+void *pvPortMalloc( size_t xWantedSize )
+{
+	return prvAllocate( xWantedSize, portBYTE_ALIGNMENT, 0UL, heapCALLER_ADDRESS(), pdFALSE );
+}
+/*-----------------------------------------------------------*/
+
+void *pvPortMallocAttr( size_t xWantedSize, unsigned long ulAttributes )
+{
+	return prvAllocate( xWantedSize, portBYTE_ALIGNMENT, ulAttributes, heapCALLER_ADDRESS(), pdFALSE );
+}
+/*-----------------------------------------------------------*/
+
+void *pvPortMallocAlignedAttr( size_t xWantedSize, size_t xAlignment, unsigned long ulAttributes )
+{
+	return prvAllocate( xWantedSize, xAlignment, ulAttributes, heapCALLER_ADDRESS(), pdFALSE );
+}
+/*-----------------------------------------------------------*/
+
+void *pvPortMallocFromISR( size_t xWantedSize )
+{
+	return prvAllocate( xWantedSize, portBYTE_ALIGNMENT, 0UL, heapCALLER_ADDRESS(), pdTRUE );
+}
+/*-----------------------------------------------------------*/
+
+void *pvPortMallocAttrFromISR( size_t xWantedSize, unsigned long ulAttributes )
+{
+	return prvAllocate( xWantedSize, portBYTE_ALIGNMENT, ulAttributes, heapCALLER_ADDRESS(), pdTRUE );
+}
+/*-----------------------------------------------------------*/
+
+void vPortDefineHeapRegions( const xHeapRegion * const pxHeapRegions )
+{
+const xHeapRegion *pxHeapRegion;
+xTLSFRegion *pxRegion;
+unsigned portBASE_TYPE uxSavedMask;
+
+	/* Can only call once! */
+	configASSERT( uxRegionCount == 0U );
+
+	heapLOCK( uxSavedMask );
+	{
+		for( pxHeapRegion = pxHeapRegions; ( pxHeapRegion->xSizeInBytes > 0 ) && ( uxRegionCount < ( unsigned portBASE_TYPE ) configHEAP_MAX_REGIONS ); pxHeapRegion++ )
+		{
+			pxRegion = &( xRegions[ uxRegionCount ] );
+			pxRegion->ulAttributes = pxHeapRegion->ulAttributes;
+
+			xFreeBytesRemaining += prvAddMemory( pxRegion, pxHeapRegion->pucStartAddress, pxHeapRegion->xSizeInBytes );
+			uxRegionCount++;
+		}
+
+		xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+	}
+	heapUNLOCK( uxSavedMask );
+
+	/* Check the table was terminated within configHEAP_MAX_REGIONS entries. */
+	configASSERT( pxHeapRegion->xSizeInBytes == 0 );
+	configASSERT( uxRegionCount > 0U );
+
+	#if ( configUSE_HEAP_SLABS == 1 )
+	{
+		prvSlabInit();
+	}
+	#endif
+}
+/*-----------------------------------------------------------*/
+
+static void *prvAllocate( size_t xWantedSize, size_t xAlignment, unsigned long ulAttributes, void *pvCaller, portBASE_TYPE xFromISR )
+{
+xTLSFBlock *pxBlock = NULL;
+void *pvReturn = NULL;
+size_t xBlockSize, xSearchSize = 0;
+unsigned portBASE_TYPE uxRegion, uxSavedMask;
+xTLSFRegion *pxRegion = NULL;
+
+	/* The alignment must be a power of two.  Blocks are always aligned to
+	portBYTE_ALIGNMENT anyway. */
+	configASSERT( ( xAlignment & ( xAlignment - 1 ) ) == 0 );
+	if( xAlignment < ( size_t ) portBYTE_ALIGNMENT )
+	{
+		xAlignment = ( size_t ) portBYTE_ALIGNMENT;
+	}
+
+	/* The wanted size is increased so it can contain the block header in
+	addition to the requested amount of bytes, and is then rounded up to keep
+	the following block aligned. */
+	if( ( xWantedSize > 0 ) && ( xWantedSize < ( heapMAXIMUM_BLOCK_SIZE >> 1 ) ) && ( xAlignment < ( heapMAXIMUM_BLOCK_SIZE >> 2 ) ) )
+	{
+		/* A block with a larger alignment also ends on that alignment, so the
+		header of the following block does not share a cache line with it. */
+		xWantedSize = ( xWantedSize + xAlignment - 1 ) & ~( xAlignment - 1 );
+		xBlockSize = ( xWantedSize + heapBLOCK_HEADER_SIZE + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+
+		if( xBlockSize < heapMINIMUM_BLOCK_SIZE )
+		{
+			xBlockSize = heapMINIMUM_BLOCK_SIZE;
+		}
+
+		/* An aligned block is cut from a free block that is large enough to
+		also hold whatever has to be skipped to reach the alignment, which is
+		itself at least a minimum sized block so it can be freed again. */
+		xSearchSize = xBlockSize;
+		if( xAlignment > ( size_t ) portBYTE_ALIGNMENT )
+		{
+			xSearchSize += xAlignment + heapMINIMUM_BLOCK_SIZE;
+		}
+	}
+	else
+	{
+		xBlockSize = 0;
+	}
+
+	heapLOCK( uxSavedMask );
+	{
+		/* vPortDefineHeapRegions() must be called before the first
+		allocation. */
+		configASSERT( uxRegionCount > 0U );
+
+		#if ( configUSE_HEAP_SLABS == 1 )
+		{
+			/* Small allocations that need no particular memory or alignment
+			are made from the slabs when there is room. */
+			if( ( xWantedSize > 0 ) && ( xWantedSize <= heapSLAB_MAXIMUM_SIZE ) && ( xAlignment == ( size_t ) portBYTE_ALIGNMENT ) && ( ulAttributes == 0UL ) && ( pucSlabZoneStart != NULL ) )
+			{
+				pvReturn = prvSlabAllocate( xWantedSize, pvCaller, xFromISR );
+			}
+		}
+		#endif
+
+		if( ( pvReturn == NULL ) && ( xBlockSize > 0 ) && ( xSearchSize <= xFreeBytesRemaining ) )
+		{
+			/* There are at most configHEAP_MAX_REGIONS regions to try. */
+			for( uxRegion = 0U; ( uxRegion < uxRegionCount ) && ( pxBlock == NULL ); uxRegion++ )
+			{
+				pxRegion = &( xRegions[ uxRegion ] );
+
+				if( ( pxRegion->ulAttributes & ulAttributes ) == ulAttributes )
+				{
+					pxBlock = prvTakeSuitableBlock( &( pxRegion->xControl ), xSearchSize );
+				}
+			}
+
+			if( pxBlock != NULL )
+			{
+				if( xAlignment > ( size_t ) portBYTE_ALIGNMENT )
+				{
+					pxBlock = prvAlignBlock( &( pxRegion->xControl ), pxBlock, xAlignment );
+				}
+
+				/* Give any excess back to the heap, then mark the block as
+				allocated. */
+				prvSplitBlock( &( pxRegion->xControl ), pxBlock, xBlockSize );
+				pxBlock->xSize &= ~heapBLOCK_FREE_BIT;
+
+				xFreeBytesRemaining -= heapBLOCK_SIZE( pxBlock );
+				if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+				{
+					xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+				}
+
+				pvReturn = ( void * ) ( ( ( unsigned char * ) pxBlock ) + heapBLOCK_HEADER_SIZE );
+
+				#if ( configUSE_HEAP_INSTRUMENTATION == 1 )
+				{
+					/* Charge the block to the calling task.  A block
+					allocated by an interrupt is not charged to anybody. */
+					prvRecordInsert( &( pxBlock->xRecord ), ( xFromISR == pdFALSE ) ? pvTaskHeapCharge( heapBLOCK_SIZE( pxBlock ) ) : NULL, pvCaller );
+
+					ulAllocations++;
+					ulAllocationsBySize[ prvHistogramBucket( heapBLOCK_SIZE( pxBlock ) ) ]++;
+					ulOutstandingBySize[ prvHistogramBucket( heapBLOCK_SIZE( pxBlock ) ) ]++;
+				}
+				#endif
+			}
+		}
+
+		#if ( configUSE_HEAP_INSTRUMENTATION == 1 )
+		{
+			if( pvReturn == NULL )
+			{
+				ulFailures++;
+			}
+		}
+		#endif
+	}
+	heapUNLOCK( uxSavedMask );
+
+	( void ) pvCaller;
+
+	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
+	{
+		if( ( pvReturn == NULL ) && ( xFromISR == pdFALSE ) )
+		{
+			extern void vApplicationMallocFailedHook( void );
+			vApplicationMallocFailedHook();
+		}
+	}
+	#endif
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortFree( void *pv )
+{
+xTLSFBlock *pxBlock;
+xTLSFRegion *pxRegion;
+unsigned portBASE_TYPE uxSavedMask;
+
+	#if ( configUSE_HEAP_SLABS == 1 )
+	{
+		/* Slab objects are recognised by their address, as they have no
+		block header. */
+		if( ( ( unsigned char * ) pv >= pucSlabZoneStart ) && ( ( unsigned char * ) pv < pucSlabZoneEnd ) )
+		{
+			heapLOCK( uxSavedMask );
+			{
+				prvSlabFree( pv );
+			}
+			heapUNLOCK( uxSavedMask );
+
+			pv = NULL;
+		}
+	}
+	#endif
+
+	if( pv )
+	{
+		/* The memory being freed will have a block header immediately before
+		it. */
+		pxBlock = ( xTLSFBlock * ) ( ( ( unsigned char * ) pv ) - heapBLOCK_HEADER_SIZE );
+
+		/* Check the block is actually allocated. */
+		configASSERT( !heapBLOCK_IS_FREE( pxBlock ) );
+
+		heapLOCK( uxSavedMask );
+		{
+			pxRegion = prvFindRegion( pv );
+
+			if( pxRegion != NULL )
+			{
+				#if ( configUSE_HEAP_INSTRUMENTATION == 1 )
+				{
+					vTaskHeapRelease( pxBlock->xRecord.pvOwner, heapBLOCK_SIZE( pxBlock ) );
+					prvRecordRemove( &( pxBlock->xRecord ) );
+					ulFrees++;
+					ulOutstandingBySize[ prvHistogramBucket( heapBLOCK_SIZE( pxBlock ) ) ]--;
+				}
+				#endif
+
+				xFreeBytesRemaining += heapBLOCK_SIZE( pxBlock );
+				prvReleaseBlock( &( pxRegion->xControl ), pxBlock );
+			}
+		}
+		heapUNLOCK( uxSavedMask );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortFreeFromISR( void *pv )
+{
+	/* vPortFree() only ever masks interrupts, so is already safe to call from
+	an interrupt. */
+	vPortFree( pv );
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeHeapSize( void )
+{
+	return xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+	return xMinimumEverFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetLargestFreeBlockSize( void )
+{
+size_t xLargest;
+unsigned portBASE_TYPE uxSavedMask;
+
+	heapLOCK( uxSavedMask );
+	{
+		xLargest = prvLargestFreeBlock();
+	}
+	heapUNLOCK( uxSavedMask );
+
+	return xLargest;
+}
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_HEAP_INSTRUMENTATION == 1 )
+
+	void vPortGetHeapStats( xHeapStats *pxStats )
+	{
+	unsigned portBASE_TYPE uxBucket, uxSavedMask;
+
+		heapLOCK( uxSavedMask );
+		{
+			pxStats->xFreeBytes = xFreeBytesRemaining;
+			pxStats->xMinimumEverFreeBytes = xMinimumEverFreeBytesRemaining;
+			pxStats->xLargestFreeBlock = prvLargestFreeBlock();
+			pxStats->ulAllocations = ulAllocations;
+			pxStats->ulFrees = ulFrees;
+			pxStats->ulFailures = ulFailures;
+
+			for( uxBucket = 0U; uxBucket < ( unsigned portBASE_TYPE ) portHEAP_HISTOGRAM_BUCKETS; uxBucket++ )
+			{
+				pxStats->ulOutstandingBySize[ uxBucket ] = ulOutstandingBySize[ uxBucket ];
+				pxStats->ulAllocationsBySize[ uxBucket ] = ulAllocationsBySize[ uxBucket ];
+			}
+		}
+		heapUNLOCK( uxSavedMask );
+
+		/* The fragmentation index is the percentage of the free memory that
+		cannot be obtained in a single allocation.  0 means all the free memory
+		is in one block. */
+		if( pxStats->xFreeBytes >= ( size_t ) 100 )
+		{
+			pxStats->uxFragmentationIndex = ( unsigned portBASE_TYPE ) ( 100U - ( pxStats->xLargestFreeBlock / ( pxStats->xFreeBytes / ( size_t ) 100 ) ) );
+
+			if( pxStats->uxFragmentationIndex > 100U )
+			{
+				pxStats->uxFragmentationIndex = 0U;
+			}
+		}
+		else
+		{
+			pxStats->uxFragmentationIndex = 0U;
+		}
+	}
+
+#endif /* configUSE_HEAP_INSTRUMENTATION */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_HEAP_INSTRUMENTATION == 1 )
+
+	unsigned portBASE_TYPE uxPortGetHeapAllocations( void *pvOwner, xHeapAllocationRecord *pxRecords, unsigned portBASE_TYPE uxMaxRecords )
+	{
+	unsigned portBASE_TYPE uxCount = 0U, uxSavedMask;
+	xHeapRecord *pxRecord;
+	xTLSFBlock *pxBlock;
+	#if ( configUSE_HEAP_SLABS == 1 )
+		size_t xPage;
+	#endif
+
+		/* Only the blocks of pvOwner are visited, so interrupts are masked for
+		a time proportional to the number of blocks it holds. */
+		heapLOCK( uxSavedMask );
+		{
+			for( pxRecord = *prvRecordList( pvOwner ); pxRecord != NULL; pxRecord = pxRecord->pxNextRecord )
+			{
+				if( uxCount < uxMaxRecords )
+				{
+					#if ( configUSE_HEAP_SLABS == 1 )
+					if( ( ( unsigned char * ) pxRecord >= pucSlabZoneStart ) && ( ( unsigned char * ) pxRecord < pucSlabZoneEnd ) )
+					{
+						/* The record of a slab object immediately precedes
+						it, and the page it is in gives its size. */
+						xPage = ( size_t ) ( ( unsigned char * ) pxRecord - pucSlabZoneStart ) >> heapSLAB_PAGE_SIZE_LOG2;
+						pxRecords[ uxCount ].pvAddress = ( void * ) ( ( ( unsigned char * ) pxRecord ) + heapSLAB_RECORD_SIZE );
+						pxRecords[ uxCount ].xSize = ( size_t ) xSlabClasses[ xSlabPages[ xPage ].ucClass ].usObjectSize;
+					}
+					else
+					#endif
+					{
+						pxBlock = heapBLOCK_OF_RECORD( pxRecord );
+						pxRecords[ uxCount ].pvAddress = ( void * ) ( ( ( unsigned char * ) pxBlock ) + heapBLOCK_HEADER_SIZE );
+						pxRecords[ uxCount ].xSize = heapBLOCK_SIZE( pxBlock ) - heapBLOCK_HEADER_SIZE;
+					}
+
+					pxRecords[ uxCount ].pvCaller = pxRecord->pvCaller;
+				}
+
+				uxCount++;
+			}
+		}
+		heapUNLOCK( uxSavedMask );
+
+		return uxCount;
+	}
+
+#endif /* configUSE_HEAP_INSTRUMENTATION */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_HEAP_INSTRUMENTATION == 1 )
+
+	void vPortHeapOwnerDeleted( void *pvOwner )
+	{
+	xHeapRecord **ppxList, *pxRecord;
+	unsigned portBASE_TYPE uxMoved, uxSavedMask;
+	portBASE_TYPE xMore = pdTRUE;
+
+		configASSERT( pvOwner != NULL );
+		ppxList = prvRecordList( pvOwner );
+
+		/* Blocks the task did not free are no longer charged to anybody, but
+		keep their caller address so they still show up as leaks.  They are
+		moved heapOWNER_CHUNK at a time so that a task holding many blocks
+		does not keep interrupts masked for long.  An interrupt that frees one
+		of them in between takes it off whichever list it is on. */
+		while( xMore != pdFALSE )
+		{
+			heapLOCK( uxSavedMask );
+			{
+				for( uxMoved = 0U; ( uxMoved < heapOWNER_CHUNK ) && ( *ppxList != NULL ); uxMoved++ )
+				{
+					pxRecord = *ppxList;
+					prvRecordRemove( pxRecord );
+					prvRecordInsert( pxRecord, NULL, pxRecord->pvCaller );
+				}
+
+				xMore = ( *ppxList != NULL ) ? pdTRUE : pdFALSE;
+			}
+			heapUNLOCK( uxSavedMask );
+		}
+	}
+
+#endif /* configUSE_HEAP_INSTRUMENTATION */
+/*-----------------------------------------------------------*/
+
+void vPortInitialiseBlocks( void )
+{
+	/* This just exists to keep the linker quiet. */
+}
+/*-----------------------------------------------------------*/
+
+static xTLSFRegion *prvFindRegion( void *pv )
+{
+unsigned portBASE_TYPE uxRegion;
+xTLSFRegion *pxRegion = NULL;
+
+	for( uxRegion = 0U; uxRegion < uxRegionCount; uxRegion++ )
+	{
+		if( ( ( unsigned char * ) pv >= xRegions[ uxRegion ].pucStart ) && ( ( unsigned char * ) pv < xRegions[ uxRegion ].pucEnd ) )
+		{
+			pxRegion = &( xRegions[ uxRegion ] );
+			break;
+		}
+	}
+
+	/* The pointer was not obtained from the heap. */
+	configASSERT( pxRegion != NULL );
+
+	return pxRegion;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvLargestFreeBlock( void )
+{
+unsigned long ulFirstLevel, ulSecondLevel;
+xTLSFBlock *pxBlock;
+xTLSFControl *pxControl;
+size_t xLargest = ( size_t ) 0;
+unsigned portBASE_TYPE uxRegion;
+
+	for( uxRegion = 0U; uxRegion < uxRegionCount; uxRegion++ )
+	{
+		pxControl = &( xRegions[ uxRegion ].xControl );
+
+		/* The largest block is in the highest non-empty list, but that list
+		also holds smaller blocks, so has to be searched. */
+		if( pxControl->ulFirstLevelBitmap != 0UL )
+		{
+			ulFirstLevel = heapFLS( pxControl->ulFirstLevelBitmap );
+			ulSecondLevel = heapFLS( pxControl->ulSecondLevelBitmap[ ulFirstLevel ] );
+
+			for( pxBlock = pxControl->pxFreeLists[ ulFirstLevel ][ ulSecondLevel ]; pxBlock != NULL; pxBlock = pxBlock->pxNextFreeBlock )
+			{
+				if( heapBLOCK_SIZE( pxBlock ) > xLargest )
+				{
+					xLargest = heapBLOCK_SIZE( pxBlock );
+				}
+			}
+		}
+	}
+
+	/* Report the number of bytes the application could actually obtain from
+	the block. */
+	if( xLargest > heapBLOCK_HEADER_SIZE )
+	{
+		xLargest -= heapBLOCK_HEADER_SIZE;
+	}
+
+	return xLargest;
+}
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_HEAP_INSTRUMENTATION == 1 )
+
+	static unsigned portBASE_TYPE prvHistogramBucket( size_t xBlockSize )
+	{
+	unsigned long ulBucket;
+
+		/* Bucket 0 holds blocks of less than 32 bytes, bucket n blocks of
+		2^(n+4) to (2^(n+5))-1 bytes. */
+		ulBucket = heapFLS( ( unsigned long ) xBlockSize );
+		ulBucket = ( ulBucket > 4UL ) ? ( ulBucket - 4UL ) : 0UL;
+
+		if( ulBucket >= ( unsigned long ) portHEAP_HISTOGRAM_BUCKETS )
+		{
+			ulBucket = ( unsigned long ) portHEAP_HISTOGRAM_BUCKETS - 1UL;
+		}
+
+		return ( unsigned portBASE_TYPE ) ulBucket;
+	}
+	/*-----------------------------------------------------------*/
+
+	static xHeapRecord **prvRecordList( void *pvOwner )
+	{
+		if( pvOwner == NULL )
+		{
+			return &pxUnownedRecords;
+		}
+
+		return ( xHeapRecord ** ) ppvTaskHeapRecords( pvOwner );
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvRecordInsert( xHeapRecord *pxRecord, void *pvOwner, void *pvCaller )
+	{
+	xHeapRecord **ppxList = prvRecordList( pvOwner );
+
+		pxRecord->pvOwner = pvOwner;
+		pxRecord->pvCaller = pvCaller;
+		pxRecord->pxPrevRecord = NULL;
+		pxRecord->pxNextRecord = *ppxList;
+
+		if( *ppxList != NULL )
+		{
+			( *ppxList )->pxPrevRecord = pxRecord;
+		}
+
+		*ppxList = pxRecord;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvRecordRemove( xHeapRecord *pxRecord )
+	{
+		if( pxRecord->pxPrevRecord != NULL )
+		{
+			pxRecord->pxPrevRecord->pxNextRecord = pxRecord->pxNextRecord;
+		}
+		else
+		{
+			*prvRecordList( pxRecord->pvOwner ) = pxRecord->pxNextRecord;
+		}
+
+		if( pxRecord->pxNextRecord != NULL )
+		{
+			pxRecord->pxNextRecord->pxPrevRecord = pxRecord->pxPrevRecord;
+		}
+	}
+
+#endif /* configUSE_HEAP_INSTRUMENTATION */
+/*-----------------------------------------------------------*/
+
+static size_t prvAddMemory( xTLSFRegion *pxRegion, unsigned char *pucStart, size_t xLength )
+{
+xTLSFBlock *pxFirstBlock, *pxEndBlock;
+unsigned long ulAddress, ulEnd;
+
+	/* Align both ends of the memory. */
+	ulAddress = ( ( unsigned long ) pucStart + portBYTE_ALIGNMENT_MASK ) & ~( ( unsigned long ) portBYTE_ALIGNMENT_MASK );
+	ulEnd = ( ( unsigned long ) pucStart + xLength ) & ~( ( unsigned long ) portBYTE_ALIGNMENT_MASK );
+
+	configASSERT( ( ulEnd - ulAddress ) >= ( heapMINIMUM_BLOCK_SIZE + heapBLOCK_HEADER_SIZE ) );
+	configASSERT( ( ulEnd - ulAddress ) < heapMAXIMUM_BLOCK_SIZE );
+
+	/* The end marker is a zero sized block that is never free, so is never
+	merged with the block before it. */
+	pxEndBlock = ( xTLSFBlock * ) ( ulEnd - heapBLOCK_HEADER_SIZE );
+	pxFirstBlock = ( xTLSFBlock * ) ulAddress;
+
+	pxFirstBlock->pxPrevPhysBlock = NULL;
+	pxFirstBlock->xSize = ( ( size_t ) ( ( unsigned char * ) pxEndBlock - ( unsigned char * ) pxFirstBlock ) ) | heapBLOCK_FREE_BIT;
+	pxEndBlock->pxPrevPhysBlock = pxFirstBlock;
+	pxEndBlock->xSize = ( size_t ) 0;
+
+	pxRegion->pucStart = pucStart;
+	pxRegion->pucEnd = pucStart + xLength;
+	pxRegion->pxFirstBlock = pxFirstBlock;
+
+	prvInsertFreeBlock( &( pxRegion->xControl ), pxFirstBlock );
+
+	return heapBLOCK_SIZE( pxFirstBlock );
+}
+/*-----------------------------------------------------------*/
+
+static void prvMappingInsert( size_t xSize, unsigned long *pulFirstLevel, unsigned long *pulSecondLevel )
+{
+unsigned long ulFirstLevel, ulSecondLevel;
+
+	if( xSize < heapSMALL_BLOCK_SIZE )
+	{
+		/* Small blocks are stored in the first list, divided linearly. */
+		ulFirstLevel = 0UL;
+		ulSecondLevel = ( unsigned long ) xSize >> heapALIGNMENT_LOG2;
+	}
+	else
+	{
+		ulFirstLevel = heapFLS( ( unsigned long ) xSize );
+		ulSecondLevel = ( ( unsigned long ) xSize >> ( ulFirstLevel - heapSL_INDEX_COUNT_LOG2 ) ) ^ heapSL_INDEX_COUNT;
+		ulFirstLevel -= ( heapFL_INDEX_SHIFT - 1UL );
+	}
+
+	*pulFirstLevel = ulFirstLevel;
+	*pulSecondLevel = ulSecondLevel;
+}
+/*-----------------------------------------------------------*/
+
+static xTLSFBlock *prvTakeSuitableBlock( xTLSFControl *pxControl, size_t xSize )
+{
+unsigned long ulFirstLevel, ulSecondLevel, ulBitmap;
+xTLSFBlock *pxBlock = NULL;
+
+	/* Round the size up to the start of the next list, so that every block
+	in the list that is found is large enough.  Small blocks are already
+	rounded to the step of the first list. */
+	if( xSize >= heapSMALL_BLOCK_SIZE )
+	{
+		xSize += ( ( size_t ) 1 << ( heapFLS( ( unsigned long ) xSize ) - heapSL_INDEX_COUNT_LOG2 ) ) - ( size_t ) 1;
+	}
+
+	prvMappingInsert( xSize, &ulFirstLevel, &ulSecondLevel );
+
+	if( ulFirstLevel < ( unsigned long ) heapFL_INDEX_COUNT )
+	{
+		/* Look for a non-empty list in the same first level list first. */
+		ulBitmap = pxControl->ulSecondLevelBitmap[ ulFirstLevel ] & ( ~0UL << ulSecondLevel );
+
+		if( ulBitmap == 0UL )
+		{
+			/* There is no block big enough in this first level list, so use
+			the smallest block from the next non-empty first level list. */
+			if( ( ulFirstLevel + 1UL ) < ( unsigned long ) heapFL_INDEX_COUNT )
+			{
+				ulBitmap = pxControl->ulFirstLevelBitmap & ( ~0UL << ( ulFirstLevel + 1UL ) );
+			}
+
+			if( ulBitmap != 0UL )
+			{
+				ulFirstLevel = heapFFS( ulBitmap );
+				ulBitmap = pxControl->ulSecondLevelBitmap[ ulFirstLevel ];
+			}
+		}
+
+		if( ulBitmap != 0UL )
+		{
+			ulSecondLevel = heapFFS( ulBitmap );
+			pxBlock = pxControl->pxFreeLists[ ulFirstLevel ][ ulSecondLevel ];
+			prvRemoveFreeBlock( pxControl, pxBlock );
+		}
+	}
+
+	return pxBlock;
+}
+/*-----------------------------------------------------------*/
+
+static void prvInsertFreeBlock( xTLSFControl *pxControl, xTLSFBlock *pxBlock )
+{
+unsigned long ulFirstLevel, ulSecondLevel;
+xTLSFBlock *pxHead;
+
+	prvMappingInsert( heapBLOCK_SIZE( pxBlock ), &ulFirstLevel, &ulSecondLevel );
+
+	pxHead = pxControl->pxFreeLists[ ulFirstLevel ][ ulSecondLevel ];
+	pxBlock->pxNextFreeBlock = pxHead;
+	pxBlock->pxPrevFreeBlock = NULL;
+	if( pxHead != NULL )
+	{
+		pxHead->pxPrevFreeBlock = pxBlock;
+	}
+	pxControl->pxFreeLists[ ulFirstLevel ][ ulSecondLevel ] = pxBlock;
+
+	pxControl->ulFirstLevelBitmap |= ( 1UL << ulFirstLevel );
+	pxControl->ulSecondLevelBitmap[ ulFirstLevel ] |= ( 1UL << ulSecondLevel );
+}
+/*-----------------------------------------------------------*/
+
+static void prvRemoveFreeBlock( xTLSFControl *pxControl, xTLSFBlock *pxBlock )
+{
+unsigned long ulFirstLevel, ulSecondLevel;
+
+	prvMappingInsert( heapBLOCK_SIZE( pxBlock ), &ulFirstLevel, &ulSecondLevel );
+
+	if( pxBlock->pxNextFreeBlock != NULL )
+	{
+		pxBlock->pxNextFreeBlock->pxPrevFreeBlock = pxBlock->pxPrevFreeBlock;
+	}
+
+	if( pxBlock->pxPrevFreeBlock != NULL )
+	{
+		pxBlock->pxPrevFreeBlock->pxNextFreeBlock = pxBlock->pxNextFreeBlock;
+	}
+	else
+	{
+		/* The block was at the head of its list.  If the list is now empty
+		then clear its bits in the bitmaps. */
+		pxControl->pxFreeLists[ ulFirstLevel ][ ulSecondLevel ] = pxBlock->pxNextFreeBlock;
+
+		if( pxBlock->pxNextFreeBlock == NULL )
+		{
+			pxControl->ulSecondLevelBitmap[ ulFirstLevel ] &= ~( 1UL << ulSecondLevel );
+
+			if( pxControl->ulSecondLevelBitmap[ ulFirstLevel ] == 0UL )
+			{
+				pxControl->ulFirstLevelBitmap &= ~( 1UL << ulFirstLevel );
+			}
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvSplitBlock( xTLSFControl *pxControl, xTLSFBlock *pxBlock, size_t xSize )
+{
+xTLSFBlock *pxRemainder;
+size_t xRemainingSize;
+
+	xRemainingSize = heapBLOCK_SIZE( pxBlock ) - xSize;
+
+	if( xRemainingSize >= heapMINIMUM_BLOCK_SIZE )
+	{
+		/* The remainder cannot be merged with the block after it, as two free
+		blocks are never adjacent. */
+		pxRemainder = ( xTLSFBlock * ) ( ( ( unsigned char * ) pxBlock ) + xSize );
+		pxRemainder->pxPrevPhysBlock = pxBlock;
+		pxRemainder->xSize = xRemainingSize | heapBLOCK_FREE_BIT;
+		heapNEXT_PHYS_BLOCK( pxRemainder )->pxPrevPhysBlock = pxRemainder;
+
+		pxBlock->xSize = xSize | ( pxBlock->xSize & heapBLOCK_FREE_BIT );
+
+		prvInsertFreeBlock( pxControl, pxRemainder );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static xTLSFBlock *prvAlignBlock( xTLSFControl *pxControl, xTLSFBlock *pxBlock, size_t xAlignment )
+{
+xTLSFBlock *pxAlignedBlock;
+unsigned long ulMemory, ulAlignedMemory;
+
+	ulMemory = ( unsigned long ) pxBlock + heapBLOCK_HEADER_SIZE;
+	ulAlignedMemory = ( ulMemory + ( unsigned long ) xAlignment - 1UL ) & ~( ( unsigned long ) xAlignment - 1UL );
+
+	if( ulAlignedMemory != ulMemory )
+	{
+		/* The skipped bytes must form a block that can be put on a free list,
+		otherwise they would be lost until the aligned block is freed. */
+		while( ( ulAlignedMemory - ulMemory ) < heapMINIMUM_BLOCK_SIZE )
+		{
+			ulAlignedMemory += ( unsigned long ) xAlignment;
+		}
+
+		pxAlignedBlock = ( xTLSFBlock * ) ( ulAlignedMemory - heapBLOCK_HEADER_SIZE );
+		pxAlignedBlock->pxPrevPhysBlock = pxBlock;
+		pxAlignedBlock->xSize = ( heapBLOCK_SIZE( pxBlock ) - ( size_t ) ( ulAlignedMemory - ulMemory ) ) | heapBLOCK_FREE_BIT;
+		heapNEXT_PHYS_BLOCK( pxAlignedBlock )->pxPrevPhysBlock = pxAlignedBlock;
+
+		/* The block before pxBlock cannot be free, as two free blocks are
+		never adjacent, so the skipped bytes just go back on a free list. */
+		pxBlock->xSize = ( size_t ) ( ulAlignedMemory - ulMemory ) | heapBLOCK_FREE_BIT;
+		prvInsertFreeBlock( pxControl, pxBlock );
+
+		pxBlock = pxAlignedBlock;
+	}
+
+	return pxBlock;
+}
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_HEAP_SLABS == 1 )
+
+	unsigned portBASE_TYPE uxPortGetSlabStats( xHeapSlabStats *pxStats, unsigned portBASE_TYPE uxMaxClasses )
+	{
+	unsigned portBASE_TYPE uxClass, uxSavedMask;
+	xSlabClass *pxClass;
+
+		heapLOCK( uxSavedMask );
+		{
+			for( uxClass = 0U; ( uxClass < ( unsigned portBASE_TYPE ) heapSLAB_CLASS_COUNT ) && ( uxClass < uxMaxClasses ); uxClass++ )
+			{
+				pxClass = &( xSlabClasses[ uxClass ] );
+
+				pxStats[ uxClass ].xObjectSize = ( size_t ) pxClass->usObjectSize;
+				pxStats[ uxClass ].uxPages = pxClass->uxPages;
+				pxStats[ uxClass ].ulObjectsInUse = pxClass->ulObjectsInUse;
+				pxStats[ uxClass ].ulObjectsFree = ( ( unsigned long ) pxClass->uxPages * ( unsigned long ) pxClass->usObjectsPerPage ) - pxClass->ulObjectsInUse;
+				pxStats[ uxClass ].ulAllocations = pxClass->ulAllocations;
+				pxStats[ uxClass ].ulFallbacks = pxClass->ulFallbacks;
+			}
+		}
+		heapUNLOCK( uxSavedMask );
+
+		return uxClass;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvSlabInit( void )
+	{
+	unsigned portBASE_TYPE uxPage, uxClass;
+	size_t xSize;
+
+		for( uxClass = 0U; uxClass < ( unsigned portBASE_TYPE ) heapSLAB_CLASS_COUNT; uxClass++ )
+		{
+			xSlabClasses[ uxClass ].pxPartialPages = NULL;
+			xSlabClasses[ uxClass ].usObjectSize = usSlabClassSizes[ uxClass ];
+			xSlabClasses[ uxClass ].usSlotSize = ( unsigned short ) ( ( size_t ) usSlabClassSizes[ uxClass ] + heapSLAB_RECORD_SIZE );
+			xSlabClasses[ uxClass ].usObjectsPerPage = ( unsigned short ) ( heapSLAB_PAGE_SIZE / ( size_t ) xSlabClasses[ uxClass ].usSlotSize );
+		}
+
+		/* Map each multiple of 8 bytes to the smallest class that will hold
+		it. */
+		uxClass = 0U;
+		for( xSize = 0; xSize <= ( heapSLAB_MAXIMUM_SIZE >> 3 ); xSize++ )
+		{
+			while( ( size_t ) usSlabClassSizes[ uxClass ] < ( xSize << 3 ) )
+			{
+				uxClass++;
+			}
+
+			ucSlabClassOfSize[ xSize ] = ( unsigned char ) uxClass;
+		}
+
+		/* The zone is an ordinary allocation.  The pages are aligned to their
+		size so each page starts on a cache line. */
+		pucSlabZoneStart = ( unsigned char * ) prvAllocate( heapSLAB_ZONE_SIZE, heapSLAB_PAGE_SIZE, 0UL, NULL, pdFALSE );
+		configASSERT( pucSlabZoneStart != NULL );
+
+		if( pucSlabZoneStart != NULL )
+		{
+			pucSlabZoneEnd = pucSlabZoneStart + heapSLAB_ZONE_SIZE;
+
+			for( uxPage = 0U; uxPage < ( unsigned portBASE_TYPE ) heapSLAB_PAGE_COUNT; uxPage++ )
+			{
+				xSlabPages[ uxPage ].pxNextPage = pxFreeSlabPages;
+				pxFreeSlabPages = &( xSlabPages[ uxPage ] );
+			}
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static void *prvSlabAllocate( size_t xSize, void *pvCaller, portBASE_TYPE xFromISR )
+	{
+	xSlabClass *pxClass;
+	xSlabPage *pxPage;
+	xSlabObject *pxObject = NULL;
+
+		pxClass = &( xSlabClasses[ ucSlabClassOfSize[ ( xSize + ( size_t ) 7 ) >> 3 ] ] );
+		pxPage = pxClass->pxPartialPages;
+
+		if( pxPage == NULL )
+		{
+			/* Every page of the class is full, so take a free page. */
+			pxPage = pxFreeSlabPages;
+
+			if( pxPage != NULL )
+			{
+				pxFreeSlabPages = pxPage->pxNextPage;
+
+				pxPage->pxFreeObjects = NULL;
+				pxPage->usInUse = 0U;
+				pxPage->usCarved = 0U;
+				pxPage->ucClass = ( unsigned char ) ( pxClass - xSlabClasses );
+				prvSlabListInsert( &( pxClass->pxPartialPages ), pxPage );
+				( pxClass->uxPages )++;
+			}
+			else
+			{
+				( pxClass->ulFallbacks )++;
+			}
+		}
+
+		if( pxPage != NULL )
+		{
+			/* Reuse a freed object if there is one, otherwise carve the next
+			object that has never been used.  Carving lazily means a new page
+			does not have to be threaded onto a free list first. */
+			if( pxPage->pxFreeObjects != NULL )
+			{
+				pxObject = pxPage->pxFreeObjects;
+				pxPage->pxFreeObjects = pxObject->pxNextFreeObject;
+			}
+			else
+			{
+				pxObject = ( xSlabObject * ) ( pucSlabZoneStart + ( ( size_t ) ( pxPage - xSlabPages ) << heapSLAB_PAGE_SIZE_LOG2 ) + ( ( size_t ) pxPage->usCarved * ( size_t ) pxClass->usSlotSize ) );
+				( pxPage->usCarved )++;
+			}
+
+			( pxPage->usInUse )++;
+			if( pxPage->usInUse == pxClass->usObjectsPerPage )
+			{
+				prvSlabListRemove( &( pxClass->pxPartialPages ), pxPage );
+			}
+
+			( pxClass->ulObjectsInUse )++;
+			( pxClass->ulAllocations )++;
+
+			#if ( configUSE_HEAP_INSTRUMENTATION == 1 )
+			{
+				/* The record takes the place of the free list link, so the
+				object itself starts after it. */
+				prvRecordInsert( ( xHeapRecord * ) pxObject, ( xFromISR == pdFALSE ) ? pvTaskHeapCharge( ( size_t ) pxClass->usSlotSize ) : NULL, pvCaller );
+
+				ulAllocations++;
+				ulAllocationsBySize[ prvHistogramBucket( ( size_t ) pxClass->usSlotSize ) ]++;
+				ulOutstandingBySize[ prvHistogramBucket( ( size_t ) pxClass->usSlotSize ) ]++;
+			}
+			#endif
+
+			pxObject = ( xSlabObject * ) ( ( ( unsigned char * ) pxObject ) + heapSLAB_RECORD_SIZE );
+		}
+
+		( void ) pvCaller;
+		( void ) xFromISR;
+
+		return ( void * ) pxObject;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvSlabFree( void *pv )
+	{
+	xSlabPage *pxPage;
+	xSlabClass *pxClass;
+	xSlabObject *pxObject = ( xSlabObject * ) ( ( ( unsigned char * ) pv ) - heapSLAB_RECORD_SIZE );
+	size_t xOffset;
+
+		xOffset = ( size_t ) ( ( unsigned char * ) pxObject - pucSlabZoneStart );
+		pxPage = &( xSlabPages[ xOffset >> heapSLAB_PAGE_SIZE_LOG2 ] );
+		pxClass = &( xSlabClasses[ pxPage->ucClass ] );
+
+		/* Check the object is actually allocated. */
+		configASSERT( pxPage->usInUse > 0U );
+		configASSERT( ( ( xOffset & ( heapSLAB_PAGE_SIZE - 1 ) ) % ( size_t ) pxClass->usSlotSize ) == 0 );
+
+		#if ( configUSE_HEAP_INSTRUMENTATION == 1 )
+		{
+			vTaskHeapRelease( ( ( xHeapRecord * ) pxObject )->pvOwner, ( size_t ) pxClass->usSlotSize );
+			prvRecordRemove( ( xHeapRecord * ) pxObject );
+			ulFrees++;
+			ulOutstandingBySize[ prvHistogramBucket( ( size_t ) pxClass->usSlotSize ) ]--;
+		}
+		#endif
+
+		/* A full page is not on the partial list, and is about to have a
+		free object. */
+		if( pxPage->usInUse == pxClass->usObjectsPerPage )
+		{
+			prvSlabListInsert( &( pxClass->pxPartialPages ), pxPage );
+		}
+
+		pxObject->pxNextFreeObject = pxPage->pxFreeObjects;
+		pxPage->pxFreeObjects = pxObject;
+		( pxPage->usInUse )--;
+		( pxClass->ulObjectsInUse )--;
+
+		/* An empty page goes back to the zone, so it can be used by any
+		class. */
+		if( pxPage->usInUse == 0U )
+		{
+			prvSlabListRemove( &( pxClass->pxPartialPages ), pxPage );
+			pxPage->pxNextPage = pxFreeSlabPages;
+			pxFreeSlabPages = pxPage;
+			( pxClass->uxPages )--;
+		}
+
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvSlabListInsert( xSlabPage **ppxList, xSlabPage *pxPage )
+	{
+		pxPage->pxPrevPage = NULL;
+		pxPage->pxNextPage = *ppxList;
+
+		if( *ppxList != NULL )
+		{
+			( *ppxList )->pxPrevPage = pxPage;
+		}
+
+		*ppxList = pxPage;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvSlabListRemove( xSlabPage **ppxList, xSlabPage *pxPage )
+	{
+		if( pxPage->pxPrevPage != NULL )
+		{
+			pxPage->pxPrevPage->pxNextPage = pxPage->pxNextPage;
+		}
+		else
+		{
+			*ppxList = pxPage->pxNextPage;
+		}
+
+		if( pxPage->pxNextPage != NULL )
+		{
+			pxPage->pxNextPage->pxPrevPage = pxPage->pxPrevPage;
+		}
+	}
+
+#endif /* configUSE_HEAP_SLABS */
+/*-----------------------------------------------------------*/
+
+static void prvReleaseBlock( xTLSFControl *pxControl, xTLSFBlock *pxBlock )
+{
+xTLSFBlock *pxNeighbour;
+
+	pxBlock->xSize |= heapBLOCK_FREE_BIT;
+
+	/* Merge with the block before, if it is free. */
+	pxNeighbour = pxBlock->pxPrevPhysBlock;
+	if( ( pxNeighbour != NULL ) && heapBLOCK_IS_FREE( pxNeighbour ) )
+	{
+		prvRemoveFreeBlock( pxControl, pxNeighbour );
+		pxNeighbour->xSize += heapBLOCK_SIZE( pxBlock );
+		pxBlock = pxNeighbour;
+	}
+
+	/* Merge with the block after, if it is free.  The end marker is never
+	free. */
+	pxNeighbour = heapNEXT_PHYS_BLOCK( pxBlock );
+	if( heapBLOCK_IS_FREE( pxNeighbour ) )
+	{
+		prvRemoveFreeBlock( pxControl, pxNeighbour );
+		pxBlock->xSize += heapBLOCK_SIZE( pxNeighbour );
+	}
+
+	heapNEXT_PHYS_BLOCK( pxBlock )->pxPrevPhysBlock = pxBlock;
+	prvInsertFreeBlock( pxControl, pxBlock );
+}
@@ -66,6 +66,14 @@ task.h is included from an application file. */
 #include "timers.h"
 #include "StackMacros.h"
 
+#if ( configUSE_TASK_ARENAS == 1 )
+	#include "arena.h"
+#endif
+
+#if ( configUSE_NEWLIB_REENTRANT == 1 )
+	#include <reent.h>
+#endif
+
 #undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
 
 /*
@@ -116,6 +124,23 @@ typedef struct tskTaskControlBlock
 		unsigned long ulRunTimeCounter;		/*< Used for calculating how much CPU time each task is utilising. */
 	#endif
 
+	#if ( configUSE_HEAP_INSTRUMENTATION == 1 )
+		size_t xHeapBytes;					/*< The heap bytes allocated by the task and not yet freed. */
+		unsigned portBASE_TYPE uxHeapBlocks;/*< The heap blocks allocated by the task and not yet freed. */
+		void *pvHeapRecords;				/*< The first of those blocks, as linked together by the allocator. */
+	#endif
+
+	#if ( configUSE_TASK_ARENAS == 1 )
+		xArenaHandle xArena;				/*< The arena that is deleted along with the task, or NULL. */
+	#endif
+
+	#if ( configUSE_NEWLIB_REENTRANT == 1 )
+		/* The newlib state of the task - errno, the stdio streams, the strtok
+		pointer and so on.  newlib's _impure_ptr is pointed at the structure of
+		the task that is running. */
+		struct _reent xNewLib_reent;
+	#endif
+
 } tskTCB;
 
 
@@ -1081,6 +1106,14 @@ portBASE_TYPE xReturn;
 		xSchedulerRunning = pdTRUE;
 		xTickCount = ( portTickType ) 0U;
 
+		#if ( configUSE_NEWLIB_REENTRANT == 1 )
+		{
+			/* The first task is started without a call to
+			vTaskSwitchContext(), so switch its newlib state in here. */
+			_impure_ptr = &( pxCurrentTCB->xNewLib_reent );
+		}
+		#endif
+
 		/* If configGENERATE_RUN_TIME_STATS is defined then the following
 		macro must be defined to configure the timer/counter used to generate
 		the run time counter time base. */
@@ -1623,6 +1656,13 @@ void vTaskSwitchContext( void )
 		/* listGET_OWNER_OF_NEXT_ENTRY walks through the list, so the tasks of the
 		same priority get an equal share of the processor time. */
 		listGET_OWNER_OF_NEXT_ENTRY( pxCurrentTCB, &( pxReadyTasksLists[ uxTopReadyPriority ] ) );
+
+		#if ( configUSE_NEWLIB_REENTRANT == 1 )
+		{
+			/* Point newlib at the state of the task being switched in. */
+			_impure_ptr = &( pxCurrentTCB->xNewLib_reent );
+		}
+		#endif
 	
 		traceTASK_SWITCHED_IN();
 	}
@@ -1987,6 +2027,26 @@ static void prvInitialiseTCBVariables( tskTCB *pxTCB, const signed char * const
 	}
 	#endif
 
+	#if ( configUSE_HEAP_INSTRUMENTATION == 1 )
+	{
+		pxTCB->xHeapBytes = ( size_t ) 0;
+		pxTCB->uxHeapBlocks = ( unsigned portBASE_TYPE ) 0U;
+		pxTCB->pvHeapRecords = NULL;
+	}
+	#endif
+
+	#if ( configUSE_TASK_ARENAS == 1 )
+	{
+		pxTCB->xArena = NULL;
+	}
+	#endif
+
+	#if ( configUSE_NEWLIB_REENTRANT == 1 )
+	{
+		_REENT_INIT_PTR( ( &( pxTCB->xNewLib_reent ) ) );
+	}
+	#endif
+
 	#if ( portUSING_MPU_WRAPPERS == 1 )
 	{
 		vPortStoreTaskMPUSettings( &( pxTCB->xMPUSettings ), xRegions, pxTCB->pxStack, usStackDepth );
@@ -2118,7 +2178,7 @@ tskTCB *pxNewTCB;
 
 	/* Allocate space for the TCB.  Where the memory comes from depends on
 	the implementation of the port malloc function. */
-	pxNewTCB = ( tskTCB * ) pvPortMalloc( sizeof( tskTCB ) );
+	pxNewTCB = ( tskTCB * ) pvPortMallocAlignedAttr( sizeof( tskTCB ), configTCB_ALIGNMENT, 0UL );
 
 	if( pxNewTCB != NULL )
 	{
@@ -2295,6 +2355,101 @@ tskTCB *pxNewTCB;
 #endif
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_HEAP_INSTRUMENTATION == 1 )
+
+	void vTaskGetHeapUsage( xTaskHandle xTask, size_t *pxBytes, unsigned portBASE_TYPE *puxBlocks )
+	{
+	tskTCB *pxTCB;
+
+		pxTCB = prvGetTCBFromHandle( xTask );
+
+		/* The counts are updated with the heap locked, which may be by
+		masking interrupts, so read them in a critical section. */
+		taskENTER_CRITICAL();
+		{
+			*pxBytes = pxTCB->xHeapBytes;
+			*puxBlocks = pxTCB->uxHeapBlocks;
+		}
+		taskEXIT_CRITICAL();
+	}
+	/*-----------------------------------------------------------*/
+
+	void *pvTaskHeapCharge( size_t xBytes )
+	{
+	tskTCB *pxTCB = NULL;
+
+		/* Before the scheduler starts pxCurrentTCB is just the highest priority
+		task created so far, so does not own the memory. */
+		if( xSchedulerRunning != pdFALSE )
+		{
+			pxTCB = pxCurrentTCB;
+			pxTCB->xHeapBytes += xBytes;
+			( pxTCB->uxHeapBlocks )++;
+		}
+
+		return ( void * ) pxTCB;
+	}
+	/*-----------------------------------------------------------*/
+
+	void vTaskHeapRelease( void *pvOwner, size_t xBytes )
+	{
+	tskTCB *pxTCB = ( tskTCB * ) pvOwner;
+
+		if( pxTCB != NULL )
+		{
+			pxTCB->xHeapBytes -= xBytes;
+			( pxTCB->uxHeapBlocks )--;
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	void **ppvTaskHeapRecords( void *pvOwner )
+	{
+		return &( ( ( tskTCB * ) pvOwner )->pvHeapRecords );
+	}
+
+#endif /* configUSE_HEAP_INSTRUMENTATION */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_ARENAS == 1 )
+
+	void vTaskSetArena( xTaskHandle xTask, void *pvArena )
+	{
+	tskTCB *pxTCB;
+
+		pxTCB = prvGetTCBFromHandle( xTask );
+
+		taskENTER_CRITICAL();
+		{
+			pxTCB->xArena = ( xArenaHandle ) pvArena;
+		}
+		taskEXIT_CRITICAL();
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_ARENAS == 1 )
+
+	void *pvTaskGetArena( xTaskHandle xTask )
+	{
+	tskTCB *pxTCB;
+	void *pvReturn;
+
+		pxTCB = prvGetTCBFromHandle( xTask );
+
+		taskENTER_CRITICAL();
+		{
+			pvReturn = ( void * ) pxTCB->xArena;
+		}
+		taskEXIT_CRITICAL();
+
+		return pvReturn;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
 #if ( INCLUDE_vTaskDelete == 1 )
 
 	static void prvDeleteTCB( tskTCB *pxTCB )
@@ -2303,6 +2458,31 @@ tskTCB *pxNewTCB;
 		above the vPortFree() calls. */
 		portCLEAN_UP_TCB( pxTCB );
 
+		#if ( configUSE_NEWLIB_REENTRANT == 1 )
+		{
+			/* Free the buffers newlib allocated for the task. */
+			_reclaim_reent( &( pxTCB->xNewLib_reent ) );
+		}
+		#endif
+
+		#if ( configUSE_TASK_ARENAS == 1 )
+		{
+			/* Release everything the task allocated from its arena. */
+			if( pxTCB->xArena != NULL )
+			{
+				vArenaDelete( pxTCB->xArena );
+			}
+		}
+		#endif
+
+		#if ( configUSE_HEAP_INSTRUMENTATION == 1 )
+		{
+			/* Stop charging the blocks the task did not free to the TCB that is
+			about to be freed. */
+			vPortHeapOwnerDeleted( ( void * ) pxTCB );
+		}
+		#endif
+
 		/* Free up the memory allocated by the scheduler for the task.  It is up to
 		the task to free any memory allocated at the application level. */
 		vPortFreeAligned( pxTCB->pxStack );
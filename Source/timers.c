@@ -56,6 +56,8 @@ all the API functions to use the MPU wrappers.  That should only be done when
 task.h is included from an application file. */
 #define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
 
+#include <string.h>
+
 #include "FreeRTOS.h"
 #include "task.h"
 #include "queue.h"
@@ -72,6 +74,13 @@ configUSE_TIMERS is set to 1 in FreeRTOSConfig.h. */
 /* Misc definitions. */
 #define tmrNO_DELAY		( portTickType ) 0U
 
+/* The timer command queue is a ring indexed by free running counters, which
+relies on its length being a power of 2. */
+#if ( ( configTIMER_QUEUE_LENGTH & ( configTIMER_QUEUE_LENGTH - 1 ) ) != 0 )
+	#error configTIMER_QUEUE_LENGTH must be a power of 2.
+#endif
+#define tmrCOMMAND_RING_INDEX_MASK	( ( unsigned long ) configTIMER_QUEUE_LENGTH - 1UL )
+
 /* The definition of the timers themselves. */
 typedef struct tmrTimerControl
 {
@@ -81,6 +90,11 @@ typedef struct tmrTimerControl
 	unsigned portBASE_TYPE	uxAutoReload;		/*<< Set to pdTRUE if the timer should be automatically restarted once expired.  Set to pdFALSE if the timer is, in effect, a one shot timer. */
 	void 					*pvTimerID;			/*<< An ID to identify the timer.  This allows the timer to be identified when the same callback is used for multiple timers. */
 	tmrTIMER_CALLBACK		pxCallbackFunction;	/*<< The function that will be called when the timer expires. */
+	struct tmrTimerService	*pxService;			/*<< The timer service that runs the timer, selected when the timer is created. */
+
+	#if ( configGENERATE_TIMER_STATS == 1 )
+		xTimerStats			xStats;				/*<< Lateness and callback cost statistics, see xTimerGetTimerStats(). */
+	#endif
 } xTIMER;
 
 /* The definition of messages that can be sent and received on the timer
@@ -90,25 +104,85 @@ typedef struct tmrTimerQueueMessage
 	portBASE_TYPE			xMessageID;			/*<< The command being sent to the timer service task. */
 	portTickType			xMessageValue;		/*<< An optional value used by a subset of commands, for example, when changing the period of a timer. */
 	xTIMER *				pxTimer;			/*<< The timer to which the command will be applied. */
-} xTIMER_MESSAGE;
 
+	#if ( configGENERATE_TIMER_STATS == 1 )
+		unsigned long		ulSendCycleCount;	/*<< The cycle count at which the command was placed in the timer command ring. */
+	#endif
+} xTIMER_MESSAGE;
 
-/* The list in which active timers are stored.  Timers are referenced in expire
-time order, with the nearest expiry time at the front of the list.  Only the
-timer service task is allowed to access xActiveTimerList. */
-PRIVILEGED_DATA static xList xActiveTimerList1;
-PRIVILEGED_DATA static xList xActiveTimerList2;
-PRIVILEGED_DATA static xList *pxCurrentTimerList;
-PRIVILEGED_DATA static xList *pxOverflowTimerList;
+/* A slot in the timer command ring.  ulSequence records who owns the slot.  A
+writer may claim the slot for write index n when ulSequence equals n, and the
+timer service task may read the slot for read index n once the writer has
+set ulSequence to n + 1. */
+typedef struct tmrTimerCommandSlot
+{
+	volatile unsigned long	ulSequence;
+	xTIMER_MESSAGE			xMessage;
+} xTIMER_COMMAND_SLOT;
 
-/* A queue that is used to send commands to the timer service task. */
-PRIVILEGED_DATA static xQueueHandle xTimerQueue = NULL;
 
-#if ( INCLUDE_xTimerGetTimerDaemonTaskHandle == 1 )
+/* The state of one timer service.  Each service has its own task, running at
+its own priority, and its own command ring and active timer lists, so the
+callbacks of timers bound to one service are never held up by the callbacks of
+timers bound to another. */
+typedef struct tmrTimerService
+{
+	/* The lists in which active timers are stored.  Timers are referenced in
+	expire time order, with the nearest expiry time at the front of the list.
+	Only the timer service task is allowed to access the active lists. */
+	xList						xActiveTimerList1;
+	xList						xActiveTimerList2;
+	xList						*pxCurrentTimerList;
+	xList						*pxOverflowTimerList;
+
+	/* The ring through which commands are sent to the timer service task.  Any
+	number of tasks and interrupts can write to the ring, each masking
+	interrupts only for as long as it takes to copy in one command.  Only the
+	timer service task reads from it. */
+	xTIMER_COMMAND_SLOT			xCommandRing[ configTIMER_QUEUE_LENGTH ];
+	volatile unsigned long		ulCommandWriteIndex;
+	volatile unsigned long		ulCommandReadIndex;
+
+	/* The number of tasks blocked waiting for space in the ring, and a queue
+	that holds no data, written to when a command is read from the ring while
+	any are waiting. */
+	volatile unsigned portBASE_TYPE	uxSpaceWaiters;
+	xQueueHandle				xSpaceQueue;
+
+	/* A queue of length one that holds no data.  It is written to after a
+	command has been placed in the ring, and is what the timer service task
+	blocks on while it waits for commands to arrive. */
+	xQueueHandle				xTimerQueue;
+
+	/* The tick count the last time the timer lists were sampled by
+	prvSampleTimeNow(). */
+	portTickType				xLastTime;
 	
-	PRIVILEGED_DATA static xTaskHandle xTimerTaskHandle = NULL;
+	/* The handle of the timer service task.  This is used to recognise
+	commands that are issued by the timer service task itself. */
+	xTaskHandle					xTaskHandle;
 	
-#endif
+	/* Counts of the commands that have passed through the command ring or been
+	applied directly.  See vTimerGetCommandStats(). */
+	volatile xTimerCommandStats	xCommandStats;
+
+	#if ( configGENERATE_TIMER_STATS == 1 )
+		/* Statistics gathered by the timer service task, other than the
+		command counts held in xCommandStats and the high water mark of the
+		command ring, which are written by the senders of commands.  See
+		vTimerGetServiceStats(). */
+		xTimerServiceStats		xServiceStats;
+		volatile unsigned long	ulCommandRingHighWaterMark;
+	#endif
+} xTIMER_SERVICE;
+
+/* The timer services, indexed by service class.  Service class 0 is the
+default service used by xTimerCreate().  Being static, every member starts
+zeroed. */
+PRIVILEGED_DATA static xTIMER_SERVICE xTimerServices[ configTIMER_SERVICE_COUNT ];
+
+/* The priority of each timer service task, indexed by service class. */
+static const unsigned portBASE_TYPE uxTimerServicePriorities[ configTIMER_SERVICE_COUNT ] = configTIMER_SERVICE_PRIORITIES;
 
 /*-----------------------------------------------------------*/
 
@@ -121,15 +195,68 @@ static void prvCheckForValidListAndQueue( void ) PRIVILEGED_FUNCTION;
 /*
  * The timer service task (daemon).  Timer functionality is controlled by this
  * task.  Other tasks communicate with the timer service task using the
- * xTimerQueue queue.
+ * timer command ring.  One instance of the task is created for each timer
+ * service, with pvParameters pointing to the xTIMER_SERVICE it runs.
  */
 static void prvTimerTask( void *pvParameters ) PRIVILEGED_FUNCTION;
 
 /*
- * Called by the timer service task to interpret and process a command it
- * received on the timer queue.
+ * Called by the timer service task to interpret and process the commands it
+ * received through the timer command ring.
+ */
+static void	prvProcessReceivedCommands( xTIMER_SERVICE *pxService ) PRIVILEGED_FUNCTION;
+
+/*
+ * Apply a single command to the list of active timers.  Returns pdTRUE if the
+ * command was a start command for a timer whose expiry time had already passed
+ * by the time the command was processed, in which case the caller is
+ * responsible for processing the expired timer.
  */
-static void	prvProcessReceivedCommands( void ) PRIVILEGED_FUNCTION;
+static portBASE_TYPE prvProcessCommand( const xTIMER_MESSAGE *pxMessage, portTickType xTimeNow ) PRIVILEGED_FUNCTION;
+
+/*
+ * Apply a command without going through the timer command ring, if that is
+ * possible.  It is only possible when the calling task is the timer service
+ * task.  Returns pdTRUE if the command was applied.
+ */
+static portBASE_TYPE prvProcessCommandDirectly( const xTIMER_MESSAGE *pxMessage ) PRIVILEGED_FUNCTION;
+
+/*
+ * Place a command into the timer command ring and wake the timer service task.
+ * If the ring is full then the calling task is held in the Blocked state for a
+ * maximum of xBlockTime ticks, waiting for space to become available.
+ */
+static portBASE_TYPE prvSendCommandToTimerTask( const xTIMER_MESSAGE *pxMessage, signed portBASE_TYPE *pxHigherPriorityTaskWoken, portTickType xBlockTime ) PRIVILEGED_FUNCTION;
+
+/*
+ * Used by the timer service task to restart an auto reload timer that could
+ * not be inserted into an active list where it was at the time.
+ */
+static portBASE_TYPE prvSendStartCommandToTimerTask( xTIMER *pxTimer, portTickType xCommandTime ) PRIVILEGED_FUNCTION;
+
+/*
+ * Write to, and read from, the timer command ring.  Both return pdFAIL if the
+ * ring was full or empty respectively.
+ */
+static portBASE_TYPE prvWriteCommandToRing( xTIMER_SERVICE *pxService, const xTIMER_MESSAGE *pxMessage ) PRIVILEGED_FUNCTION;
+static portBASE_TYPE prvReadCommandFromRing( xTIMER_SERVICE *pxService, xTIMER_MESSAGE *pxMessage ) PRIVILEGED_FUNCTION;
+
+/*
+ * Call the callback function of a timer that was due to expire at xDueTime,
+ * gathering lateness and execution time statistics if
+ * configGENERATE_TIMER_STATS is set to 1.
+ */
+static void prvExecuteCallback( xTIMER *pxTimer, portTickType xDueTime ) PRIVILEGED_FUNCTION;
+
+#if ( configGENERATE_TIMER_STATS == 1 )
+
+	/*
+	 * Return the histogram bucket into which ulValue falls - in effect the
+	 * number of significant bits in ulValue.
+	 */
+	static unsigned portBASE_TYPE prvHistogramBucket( unsigned long ulValue ) PRIVILEGED_FUNCTION;
+
+#endif
 
 /*
  * Insert the timer into either xActiveTimerList1, or xActiveTimerList2,
@@ -141,19 +268,19 @@ static portBASE_TYPE prvInsertTimerInActiveList( xTIMER *pxTimer, portTickType x
  * An active timer has reached its expire time.  Reload the timer if it is an
  * auto reload timer, then call its callback.
  */
-static void prvProcessExpiredTimer( portTickType xNextExpireTime, portTickType xTimeNow ) PRIVILEGED_FUNCTION;
+static void prvProcessExpiredTimer( xTIMER_SERVICE *pxService, portTickType xNextExpireTime, portTickType xTimeNow ) PRIVILEGED_FUNCTION;
 
 /*
  * The tick count has overflowed.  Switch the timer lists after ensuring the
  * current timer list does not still reference some timers.
  */
-static void prvSwitchTimerLists( portTickType xLastTime ) PRIVILEGED_FUNCTION;
+static void prvSwitchTimerLists( xTIMER_SERVICE *pxService, portTickType xLastTime ) PRIVILEGED_FUNCTION;
 
 /*
  * Obtain the current tick count, setting *pxTimerListsWereSwitched to pdTRUE
  * if a tick count overflow occurred since prvSampleTimeNow() was last called.
  */
-static portTickType prvSampleTimeNow( portBASE_TYPE *pxTimerListsWereSwitched ) PRIVILEGED_FUNCTION;
+static portTickType prvSampleTimeNow( xTIMER_SERVICE *pxService, portBASE_TYPE *pxTimerListsWereSwitched ) PRIVILEGED_FUNCTION;
 
 /*
  * If the timer list contains any active timers then return the expire time of
@@ -161,40 +288,50 @@ static portTickType prvSampleTimeNow( portBASE_TYPE *pxTimerListsWereSwitched )
  * timer list does not contain any timers then return 0 and set *pxListWasEmpty
  * to pdTRUE.
  */
-static portTickType prvGetNextExpireTime( portBASE_TYPE *pxListWasEmpty ) PRIVILEGED_FUNCTION;
+static portTickType prvGetNextExpireTime( xTIMER_SERVICE *pxService, portBASE_TYPE *pxListWasEmpty ) PRIVILEGED_FUNCTION;
 
 /*
  * If a timer has expired, process it.  Otherwise, block the timer service task
  * until either a timer does expire or a command is received.
  */
-static void prvProcessTimerOrBlockTask( portTickType xNextExpireTime, portBASE_TYPE xListWasEmpty ) PRIVILEGED_FUNCTION;
+static void prvProcessTimerOrBlockTask( xTIMER_SERVICE *pxService, portTickType xNextExpireTime, portBASE_TYPE xListWasEmpty ) PRIVILEGED_FUNCTION;
 
 /*-----------------------------------------------------------*/
 
 portBASE_TYPE xTimerCreateTimerTask( void )
 {
-portBASE_TYPE xReturn = pdFAIL;
+portBASE_TYPE xReturn = pdPASS;
+unsigned portBASE_TYPE uxService;
+xTIMER_SERVICE *pxService;
+signed char cTaskName[ sizeof( "Tmr Svc" ) + 2 ] = "Tmr Svc";
 
 	/* This function is called when the scheduler is started if
 	configUSE_TIMERS is set to 1.  Check that the infrastructure used by the
-	timer service task has been created/initialised.  If timers have already
+	timer service tasks has been created/initialised.  If timers have already
 	been created then the initialisation will already have been performed. */
 	prvCheckForValidListAndQueue();
 
-	if( xTimerQueue != NULL )
+	for( uxService = 0U; ( uxService < ( unsigned portBASE_TYPE ) configTIMER_SERVICE_COUNT ) && ( xReturn != pdFAIL ); uxService++ )
 	{
-		#if ( INCLUDE_xTimerGetTimerDaemonTaskHandle == 1 )
-		{
-			/* Create the timer task, storing its handle in xTimerTaskHandle so
-			it can be returned by the xTimerGetTimerDaemonTaskHandle() function. */
-			xReturn = xTaskCreate( prvTimerTask, ( const signed char * ) "Tmr Svc", ( unsigned short ) configTIMER_TASK_STACK_DEPTH, NULL, ( unsigned portBASE_TYPE ) configTIMER_TASK_PRIORITY, &xTimerTaskHandle );	
-		}
-		#else
+		pxService = &( xTimerServices[ uxService ] );
+		xReturn = pdFAIL;
+
+		if( pxService->xTimerQueue != NULL )
 		{
-			/* Create the timer task without storing its handle. */
-			xReturn = xTaskCreate( prvTimerTask, ( const signed char * ) "Tmr Svc", ( unsigned short ) configTIMER_TASK_STACK_DEPTH, NULL, ( unsigned portBASE_TYPE ) configTIMER_TASK_PRIORITY, NULL);
+			/* The first service task is called "Tmr Svc" as before, the others
+			have their service class appended to the name. */
+			if( uxService > 0U )
+			{
+				cTaskName[ sizeof( "Tmr Svc" ) - 1 ] = ( signed char ) ( '0' + ( uxService % 10U ) );
+				cTaskName[ sizeof( "Tmr Svc" ) ] = ( signed char ) 0x00;
+			}
+
+			/* Create the timer task, storing its handle in the service so
+			commands issued from the timer task itself can be recognised, and
+			so it can be returned by xTimerGetServiceTaskHandle().  The task
+			name is copied by xTaskCreate(). */
+			xReturn = xTaskCreate( prvTimerTask, cTaskName, ( unsigned short ) configTIMER_TASK_STACK_DEPTH, ( void * ) pxService, uxTimerServicePriorities[ uxService ], &( pxService->xTaskHandle ) );
 		}
-		#endif
 	}
 
 	configASSERT( xReturn );
@@ -202,15 +339,16 @@ portBASE_TYPE xReturn = pdFAIL;
 }
 /*-----------------------------------------------------------*/
 
-xTimerHandle xTimerCreate( const signed char *pcTimerName, portTickType xTimerPeriodInTicks, unsigned portBASE_TYPE uxAutoReload, void *pvTimerID, tmrTIMER_CALLBACK pxCallbackFunction )
+xTimerHandle xTimerGenericCreate( const signed char *pcTimerName, portTickType xTimerPeriodInTicks, unsigned portBASE_TYPE uxAutoReload, void *pvTimerID, tmrTIMER_CALLBACK pxCallbackFunction, unsigned portBASE_TYPE uxServiceClass )
 {
 xTIMER *pxNewTimer;
 
 	/* Allocate the timer structure. */
-	if( xTimerPeriodInTicks == ( portTickType ) 0U )
+	if( ( xTimerPeriodInTicks == ( portTickType ) 0U ) || ( uxServiceClass >= ( unsigned portBASE_TYPE ) configTIMER_SERVICE_COUNT ) )
 	{
 		pxNewTimer = NULL;
 		configASSERT( ( xTimerPeriodInTicks > 0 ) );
+		configASSERT( ( uxServiceClass < ( unsigned portBASE_TYPE ) configTIMER_SERVICE_COUNT ) );
 	}
 	else
 	{
@@ -227,7 +365,14 @@ xTIMER *pxNewTimer;
 			pxNewTimer->uxAutoReload = uxAutoReload;
 			pxNewTimer->pvTimerID = pvTimerID;
 			pxNewTimer->pxCallbackFunction = pxCallbackFunction;
+			pxNewTimer->pxService = &( xTimerServices[ uxServiceClass ] );
 			vListInitialiseItem( &( pxNewTimer->xTimerListItem ) );
+
+			#if ( configGENERATE_TIMER_STATS == 1 )
+			{
+				memset( ( void * ) &( pxNewTimer->xStats ), 0x00, sizeof( xTimerStats ) );
+			}
+			#endif
 			
 			traceTIMER_CREATE( pxNewTimer );
 		}
@@ -248,7 +393,7 @@ xTIMER_MESSAGE xMessage;
 
 	/* Send a message to the timer service task to perform a particular action
 	on a particular timer definition. */
-	if( xTimerQueue != NULL )
+	if( ( ( xTIMER * ) xTimer )->pxService->xTimerQueue != NULL )
 	{
 		/* Send a command to the timer service task to start the xTimer timer. */
 		xMessage.xMessageID = xCommandID;
@@ -259,16 +404,25 @@ xTIMER_MESSAGE xMessage;
 		{
 			if( xTaskGetSchedulerState() == taskSCHEDULER_RUNNING )
 			{
-				xReturn = xQueueSendToBack( xTimerQueue, &xMessage, xBlockTime );
+				/* There is no need to go through the command ring if this is
+				the timer service task itself. */
+				if( prvProcessCommandDirectly( &xMessage ) != pdFALSE )
+				{
+					xReturn = pdPASS;
+				}
+				else
+				{
+					xReturn = prvSendCommandToTimerTask( &xMessage, NULL, xBlockTime );
+				}
 			}
 			else
 			{
-				xReturn = xQueueSendToBack( xTimerQueue, &xMessage, tmrNO_DELAY );
+				xReturn = prvSendCommandToTimerTask( &xMessage, NULL, tmrNO_DELAY );
 			}
 		}
 		else
 		{
-			xReturn = xQueueSendToBackFromISR( xTimerQueue, &xMessage, pxHigherPriorityTaskWoken );
+			xReturn = prvSendCommandToTimerTask( &xMessage, pxHigherPriorityTaskWoken, tmrNO_DELAY );
 		}
 		
 		traceTIMER_COMMAND_SEND( xTimer, xCommandID, xOptionalValue, xReturn );
@@ -282,23 +436,317 @@ xTIMER_MESSAGE xMessage;
 
 	xTaskHandle xTimerGetTimerDaemonTaskHandle( void )
 	{
-		/* If xTimerGetTimerDaemonTaskHandle() is called before the scheduler has been
-		started, then xTimerTaskHandle will be NULL. */
-		configASSERT( ( xTimerTaskHandle != NULL ) );
-		return xTimerTaskHandle;
+		return xTimerGetServiceTaskHandle( tmrSERVICE_CLASS_DEFAULT );
+	}
+	/*-----------------------------------------------------------*/
+
+	xTaskHandle xTimerGetServiceTaskHandle( unsigned portBASE_TYPE uxServiceClass )
+	{
+		configASSERT( ( uxServiceClass < ( unsigned portBASE_TYPE ) configTIMER_SERVICE_COUNT ) );
+
+		/* If xTimerGetServiceTaskHandle() is called before the scheduler has been
+		started, then the handle will be NULL. */
+		configASSERT( ( xTimerServices[ uxServiceClass ].xTaskHandle != NULL ) );
+		return xTimerServices[ uxServiceClass ].xTaskHandle;
 	}
 	
 #endif
 /*-----------------------------------------------------------*/
 
-static void prvProcessExpiredTimer( portTickType xNextExpireTime, portTickType xTimeNow )
+void vTimerGetCommandStats( unsigned portBASE_TYPE uxServiceClass, xTimerCommandStats *pxStats )
+{
+xTIMER_SERVICE *pxService;
+
+	configASSERT( ( uxServiceClass < ( unsigned portBASE_TYPE ) configTIMER_SERVICE_COUNT ) );
+	pxService = &( xTimerServices[ uxServiceClass ] );
+
+	/* The counters are updated from interrupts as well as tasks. */
+	taskENTER_CRITICAL();
+	{
+		pxStats->ulCommandsQueued = pxService->xCommandStats.ulCommandsQueued;
+		pxStats->ulCommandsProcessed = pxService->xCommandStats.ulCommandsProcessed;
+		pxStats->ulCommandsDirect = pxService->xCommandStats.ulCommandsDirect;
+		pxStats->ulCommandsDropped = pxService->xCommandStats.ulCommandsDropped;
+	}
+	taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+#if ( configGENERATE_TIMER_STATS == 1 )
+
+	portBASE_TYPE xTimerGetTimerStats( xTimerHandle xTimer, xTimerStats *pxStats )
+	{
+	xTIMER *pxTimer = ( xTIMER * ) xTimer;
+
+		taskENTER_CRITICAL();
+		{
+			*pxStats = pxTimer->xStats;
+		}
+		taskEXIT_CRITICAL();
+
+		return pdPASS;
+	}
+
+#endif /* configGENERATE_TIMER_STATS */
+/*-----------------------------------------------------------*/
+
+#if ( configGENERATE_TIMER_STATS == 1 )
+
+	void vTimerGetServiceStats( unsigned portBASE_TYPE uxServiceClass, xTimerServiceStats *pxStats )
+	{
+	xTIMER_SERVICE *pxService;
+
+		configASSERT( ( uxServiceClass < ( unsigned portBASE_TYPE ) configTIMER_SERVICE_COUNT ) );
+		pxService = &( xTimerServices[ uxServiceClass ] );
+
+		taskENTER_CRITICAL();
+		{
+			*pxStats = pxService->xServiceStats;
+			pxStats->xCommands.ulCommandsQueued = pxService->xCommandStats.ulCommandsQueued;
+			pxStats->xCommands.ulCommandsProcessed = pxService->xCommandStats.ulCommandsProcessed;
+			pxStats->xCommands.ulCommandsDirect = pxService->xCommandStats.ulCommandsDirect;
+			pxStats->xCommands.ulCommandsDropped = pxService->xCommandStats.ulCommandsDropped;
+			pxStats->ulCommandQueueHighWaterMark = pxService->ulCommandRingHighWaterMark;
+		}
+		taskEXIT_CRITICAL();
+	}
+
+#endif /* configGENERATE_TIMER_STATS */
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvWriteCommandToRing( xTIMER_SERVICE *pxService, const xTIMER_MESSAGE *pxMessage )
+{
+xTIMER_COMMAND_SLOT *pxSlot;
+unsigned long ulWriteIndex;
+portBASE_TYPE xReturn = pdFAIL;
+unsigned portBASE_TYPE uxSavedInterruptStatus;
+
+	/* The slot is claimed, filled and published to the timer service task
+	with interrupts masked.  A writer preempted after claiming a slot but
+	before publishing it would otherwise hold up the timer service task, and
+	every command written after it, until the writer ran again, however low
+	its priority. */
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		ulWriteIndex = pxService->ulCommandWriteIndex;
+		pxSlot = &( pxService->xCommandRing[ ulWriteIndex & tmrCOMMAND_RING_INDEX_MASK ] );
+
+		/* If the slot still holds a command the timer service task has not yet
+		read then the ring is full. */
+		if( pxSlot->ulSequence == ulWriteIndex )
+		{
+			pxService->ulCommandWriteIndex = ulWriteIndex + 1UL;
+			pxSlot->xMessage = *pxMessage;
+
+			#if ( configGENERATE_TIMER_STATS == 1 )
+			{
+			unsigned long ulWaiting;
+
+				pxSlot->xMessage.ulSendCycleCount = portGET_CYCLE_COUNT();
+
+				/* Commands written but not yet read, including this one. */
+				ulWaiting = ( ulWriteIndex + 1UL ) - pxService->ulCommandReadIndex;
+				if( ulWaiting > pxService->ulCommandRingHighWaterMark )
+				{
+					pxService->ulCommandRingHighWaterMark = ulWaiting;
+				}
+			}
+			#endif
+
+			portMEMORY_BARRIER();
+			pxSlot->ulSequence = ulWriteIndex + 1UL;
+			xReturn = pdPASS;
+		}
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvReadCommandFromRing( xTIMER_SERVICE *pxService, xTIMER_MESSAGE *pxMessage )
+{
+xTIMER_COMMAND_SLOT *pxSlot;
+
+	pxSlot = &( pxService->xCommandRing[ pxService->ulCommandReadIndex & tmrCOMMAND_RING_INDEX_MASK ] );
+
+	/* Commands are read strictly in the order in which they were written.  A
+	slot is claimed and filled in one masked section, so the next slot is
+	either ready to read or the ring is empty. */
+	if( pxSlot->ulSequence != ( pxService->ulCommandReadIndex + 1UL ) )
+	{
+		return pdFAIL;
+	}
+
+	portMEMORY_BARRIER();
+	*pxMessage = pxSlot->xMessage;
+	portMEMORY_BARRIER();
+
+	/* Hand the slot back to the writers for use on the next lap of the ring. */
+	pxSlot->ulSequence = pxService->ulCommandReadIndex + ( unsigned long ) configTIMER_QUEUE_LENGTH;
+	pxService->ulCommandReadIndex++;
+
+	return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvSendCommandToTimerTask( const xTIMER_MESSAGE *pxMessage, signed portBASE_TYPE *pxHigherPriorityTaskWoken, portTickType xBlockTime )
+{
+portBASE_TYPE xReturn;
+xTimeOutType xTimeOut;
+xTIMER_SERVICE * const pxService = pxMessage->pxTimer->pxService;
+
+	if( xBlockTime != tmrNO_DELAY )
+	{
+		vTaskSetTimeOutState( &xTimeOut );
+	}
+
+	for( ;; )
+	{
+		if( xBlockTime == tmrNO_DELAY )
+		{
+			xReturn = prvWriteCommandToRing( pxService, pxMessage );
+		}
+		else
+		{
+			taskENTER_CRITICAL();
+			{
+				xReturn = prvWriteCommandToRing( pxService, pxMessage );
+
+				if( xReturn == pdFAIL )
+				{
+					/* Register as a waiter before leaving the critical section,
+					so a command read before this task blocks still posts to
+					the space queue. */
+					pxService->uxSpaceWaiters++;
+				}
+			}
+			taskEXIT_CRITICAL();
+		}
+
+		if( xReturn != pdFAIL )
+		{
+			( void ) portATOMIC_ADD( &( pxService->xCommandStats.ulCommandsQueued ), 1UL );
+
+			/* Wake the timer service task.  If the wake up queue is already
+			full then the task has been woken already and has yet to empty the
+			ring, so failing to write to the queue is not an error. */
+			if( pxHigherPriorityTaskWoken == NULL )
+			{
+				( void ) xQueueSendToBack( pxService->xTimerQueue, NULL, tmrNO_DELAY );
+			}
+			else
+			{
+				( void ) xQueueSendToBackFromISR( pxService->xTimerQueue, NULL, pxHigherPriorityTaskWoken );
+			}
+			break;
+		}
+
+		if( xBlockTime == tmrNO_DELAY )
+		{
+			( void ) portATOMIC_ADD( &( pxService->xCommandStats.ulCommandsDropped ), 1UL );
+			break;
+		}
+
+		/* The ring is full.  Wait for the timer service task to read from it,
+		then try again.  Another writer may take the freed slot first, in which
+		case wait for whatever remains of the block time.  Once the block time
+		has expired the ring is tried one last time. */
+		( void ) xQueueReceive( pxService->xSpaceQueue, NULL, xBlockTime );
+
+		taskENTER_CRITICAL();
+		{
+			pxService->uxSpaceWaiters--;
+		}
+		taskEXIT_CRITICAL();
+
+		if( xTaskCheckForTimeOut( &xTimeOut, &xBlockTime ) != pdFALSE )
+		{
+			xBlockTime = tmrNO_DELAY;
+		}
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvSendStartCommandToTimerTask( xTIMER *pxTimer, portTickType xCommandTime )
+{
+xTIMER_MESSAGE xMessage;
+
+	xMessage.xMessageID = tmrCOMMAND_START;
+	xMessage.xMessageValue = xCommandTime;
+	xMessage.pxTimer = pxTimer;
+
+	/* The timer service task must never block on its own command ring. */
+	return prvSendCommandToTimerTask( &xMessage, NULL, tmrNO_DELAY );
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvProcessCommandDirectly( const xTIMER_MESSAGE *pxMessage )
+{
+portBASE_TYPE xReturn = pdFALSE;
+
+	#if ( ( INCLUDE_xTaskGetCurrentTaskHandle == 1 ) || ( configUSE_MUTEXES == 1 ) )
+	{
+	portTickType xTimeNow;
+	portBASE_TYPE xResult;
+	xTIMER_SERVICE * const pxService = pxMessage->pxTimer->pxService;
+
+		/* Deleting a timer from within its own callback must be deferred until
+		the callback has returned, so delete commands always use the ring. */
+		if( ( pxMessage->xMessageID != tmrCOMMAND_DELETE ) && ( xTaskGetCurrentTaskHandle() == pxService->xTaskHandle ) )
+		{
+			xTimeNow = xTaskGetTickCount();
+
+			/* If the tick count has overflowed since the timer lists were last
+			sampled then the lists must be switched before any timer can be
+			inserted.  That is left to the main loop of the timer service task,
+			so the command is sent through the ring as normal.  This also covers
+			commands issued by callbacks called from prvSwitchTimerLists(), as
+			xLastTime is not updated until the switch is complete. */
+			if( xTimeNow >= pxService->xLastTime )
+			{
+				traceTIMER_COMMAND_RECEIVED( pxMessage->pxTimer, pxMessage->xMessageID, pxMessage->xMessageValue );
+
+				if( prvProcessCommand( pxMessage, xTimeNow ) != pdFALSE )
+				{
+					/* The timer has already expired.  Rather than call its
+					callback from within the callback that is executing now, send
+					the start command through the ring so the timer is processed
+					from the main loop of the timer service task. */
+					xResult = prvSendStartCommandToTimerTask( pxMessage->pxTimer, pxMessage->xMessageValue );
+					configASSERT( xResult );
+					( void ) xResult;
+				}
+				else
+				{
+					/* Re-sent commands are counted as queued instead. */
+					pxService->xCommandStats.ulCommandsDirect++;
+				}
+
+				xReturn = pdTRUE;
+			}
+		}
+	}
+	#else
+	{
+		( void ) pxMessage;
+	}
+	#endif
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvProcessExpiredTimer( xTIMER_SERVICE *pxService, portTickType xNextExpireTime, portTickType xTimeNow )
 {
 xTIMER *pxTimer;
 portBASE_TYPE xResult;
 
 	/* Remove the timer from the list of active timers.  A check has already
 	been performed to ensure the list is not empty. */
-	pxTimer = ( xTIMER * ) listGET_OWNER_OF_HEAD_ENTRY( pxCurrentTimerList );
+	pxTimer = ( xTIMER * ) listGET_OWNER_OF_HEAD_ENTRY( pxService->pxCurrentTimerList );
 	vListRemove( &( pxTimer->xTimerListItem ) );
 	traceTIMER_EXPIRED( pxTimer );
 
@@ -316,42 +764,117 @@ portBASE_TYPE xResult;
 		{
 			/* The timer expired before it was added to the active timer
 			list.  Reload it now.  */
-			xResult = xTimerGenericCommand( pxTimer, tmrCOMMAND_START, xNextExpireTime, NULL, tmrNO_DELAY );
+			xResult = prvSendStartCommandToTimerTask( pxTimer, xNextExpireTime );
 			configASSERT( xResult );
 			( void ) xResult;
 		}
 	}
 
 	/* Call the timer callback. */
-	pxTimer->pxCallbackFunction( ( xTimerHandle ) pxTimer );
+	prvExecuteCallback( pxTimer, xNextExpireTime );
+}
+/*-----------------------------------------------------------*/
+
+static void prvExecuteCallback( xTIMER *pxTimer, portTickType xDueTime )
+{
+	#if ( configGENERATE_TIMER_STATS == 1 )
+	{
+	portTickType xLatenessTicks;
+	unsigned long ulStartCycles, ulLatenessCycles, ulCallbackCycles;
+	xTimerStats *pxStats = &( pxTimer->xStats );
+	xTIMER_SERVICE * const pxService = pxTimer->pxService;
+
+		/* The tick count and the cycle count at which the tick was taken must
+		be read together.  Lateness in cycles is the time since the most
+		recent tick plus the length of each tick since the timer was due. */
+		taskENTER_CRITICAL();
+		{
+			ulStartCycles = portGET_CYCLE_COUNT();
+			xLatenessTicks = xTaskGetTickCount() - xDueTime;
+			ulLatenessCycles = ( ulStartCycles - portGET_TICK_CYCLE_COUNT() ) + ( ( unsigned long ) xLatenessTicks * portGET_CYCLES_PER_TICK() );
+		}
+		taskEXIT_CRITICAL();
+
+		pxTimer->pxCallbackFunction( ( xTimerHandle ) pxTimer );
+
+		ulCallbackCycles = portGET_CYCLE_COUNT() - ulStartCycles;
+
+		/* Timer delete commands are never processed from within a callback,
+		so pxTimer is still valid. */
+		taskENTER_CRITICAL();
+		{
+			pxStats->ulExpiries++;
+			pxStats->ulTotalLatenessTicks += ( unsigned long ) xLatenessTicks;
+			if( xLatenessTicks > pxStats->xMaxLatenessTicks )
+			{
+				pxStats->xMaxLatenessTicks = xLatenessTicks;
+			}
+			if( ulLatenessCycles > pxStats->ulMaxLatenessCycles )
+			{
+				pxStats->ulMaxLatenessCycles = ulLatenessCycles;
+			}
+			if( ulCallbackCycles > pxStats->ulMaxCallbackCycles )
+			{
+				pxStats->ulMaxCallbackCycles = ulCallbackCycles;
+			}
+			pxStats->ullTotalCallbackCycles += ulCallbackCycles;
+
+			pxService->xServiceStats.ulExpiries++;
+			pxService->xServiceStats.ulLatenessHistogram[ prvHistogramBucket( ( unsigned long ) xLatenessTicks ) ]++;
+			pxService->xServiceStats.ulCallbackCostHistogram[ prvHistogramBucket( ulCallbackCycles >> 8UL ) ]++;
+		}
+		taskEXIT_CRITICAL();
+	}
+	#else
+	{
+		( void ) xDueTime;
+		pxTimer->pxCallbackFunction( ( xTimerHandle ) pxTimer );
+	}
+	#endif
 }
 /*-----------------------------------------------------------*/
 
+#if ( configGENERATE_TIMER_STATS == 1 )
+
+	static unsigned portBASE_TYPE prvHistogramBucket( unsigned long ulValue )
+	{
+	unsigned portBASE_TYPE uxBucket = 0U;
+
+		while( ( ulValue != 0UL ) && ( uxBucket < ( unsigned portBASE_TYPE ) ( tmrSTATS_HISTOGRAM_BUCKETS - 1 ) ) )
+		{
+			ulValue >>= 1UL;
+			uxBucket++;
+		}
+
+		return uxBucket;
+	}
+
+#endif /* configGENERATE_TIMER_STATS */
+/*-----------------------------------------------------------*/
+
 static void prvTimerTask( void *pvParameters )
 {
 portTickType xNextExpireTime;
 portBASE_TYPE xListWasEmpty;
-
-	/* Just to avoid compiler warnings. */
-	( void ) pvParameters;
+xTIMER_SERVICE * const pxService = ( xTIMER_SERVICE * ) pvParameters;
 
 	for( ;; )
 	{
 		/* Query the timers list to see if it contains any timers, and if so,
 		obtain the time at which the next timer will expire. */
-		xNextExpireTime = prvGetNextExpireTime( &xListWasEmpty );
+		xNextExpireTime = prvGetNextExpireTime( pxService, &xListWasEmpty );
 
 		/* If a timer has expired, process it.  Otherwise, block this task
 		until either a timer does expire, or a command is received. */
-		prvProcessTimerOrBlockTask( xNextExpireTime, xListWasEmpty );
+		prvProcessTimerOrBlockTask( pxService, xNextExpireTime, xListWasEmpty );
 		
 		/* Empty the command queue. */
-		prvProcessReceivedCommands();		
+		prvProcessReceivedCommands( pxService );		
 	}
 }
 /*-----------------------------------------------------------*/
 
-static void prvProcessTimerOrBlockTask( portTickType xNextExpireTime, portBASE_TYPE xListWasEmpty )
+static void prvProcessTimerOrBlockTask( xTIMER_SERVICE *pxService, portTickType xNextExpireTime, portBASE_TYPE xListWasEmpty )
 {
 portTickType xTimeNow;
 portBASE_TYPE xTimerListsWereSwitched;
@@ -363,14 +886,14 @@ portBASE_TYPE xTimerListsWereSwitched;
 		then don't process this timer as any timers that remained in the list
 		when the lists were switched will have been processed within the
 		prvSampelTimeNow() function. */
-		xTimeNow = prvSampleTimeNow( &xTimerListsWereSwitched );
+		xTimeNow = prvSampleTimeNow( pxService, &xTimerListsWereSwitched );
 		if( xTimerListsWereSwitched == pdFALSE )
 		{
 			/* The tick count has not overflowed, has the timer expired? */
 			if( ( xListWasEmpty == pdFALSE ) && ( xNextExpireTime <= xTimeNow ) )
 			{
 				xTaskResumeAll();
-				prvProcessExpiredTimer( xNextExpireTime, xTimeNow );
+				prvProcessExpiredTimer( pxService, xNextExpireTime, xTimeNow );
 			}
 			else
 			{
@@ -380,7 +903,7 @@ portBASE_TYPE xTimerListsWereSwitched;
 				received - whichever comes first.  The following line cannot
 				be reached unless xNextExpireTime > xTimeNow, except in the
 				case when the current timer list is empty. */
-				vQueueWaitForMessageRestricted( xTimerQueue, ( xNextExpireTime - xTimeNow ) );
+				vQueueWaitForMessageRestricted( pxService->xTimerQueue, ( xNextExpireTime - xTimeNow ) );
 
 				if( xTaskResumeAll() == pdFALSE )
 				{
@@ -400,7 +923,7 @@ portBASE_TYPE xTimerListsWereSwitched;
 }
 /*-----------------------------------------------------------*/
 
-static portTickType prvGetNextExpireTime( portBASE_TYPE *pxListWasEmpty )
+static portTickType prvGetNextExpireTime( xTIMER_SERVICE *pxService, portBASE_TYPE *pxListWasEmpty )
 {
 portTickType xNextExpireTime;
 
@@ -411,10 +934,10 @@ portTickType xNextExpireTime;
 	this task to unblock when the tick count overflows, at which point the
 	timer lists will be switched and the next expiry time can be
 	re-assessed.  */
-	*pxListWasEmpty = listLIST_IS_EMPTY( pxCurrentTimerList );
+	*pxListWasEmpty = listLIST_IS_EMPTY( pxService->pxCurrentTimerList );
 	if( *pxListWasEmpty == pdFALSE )
 	{
-		xNextExpireTime = listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxCurrentTimerList );
+		xNextExpireTime = listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxService->pxCurrentTimerList );
 	}
 	else
 	{
@@ -426,16 +949,15 @@ portTickType xNextExpireTime;
 }
 /*-----------------------------------------------------------*/
 
-static portTickType prvSampleTimeNow( portBASE_TYPE *pxTimerListsWereSwitched )
+static portTickType prvSampleTimeNow( xTIMER_SERVICE *pxService, portBASE_TYPE *pxTimerListsWereSwitched )
 {
 portTickType xTimeNow;
-static portTickType xLastTime = ( portTickType ) 0U;
 
 	xTimeNow = xTaskGetTickCount();
 	
-	if( xTimeNow < xLastTime )
+	if( xTimeNow < pxService->xLastTime )
 	{
-		prvSwitchTimerLists( xLastTime );
+		prvSwitchTimerLists( pxService, pxService->xLastTime );
 		*pxTimerListsWereSwitched = pdTRUE;
 	}
 	else
@@ -443,7 +965,7 @@ static portTickType xLastTime = ( portTickType ) 0U;
 		*pxTimerListsWereSwitched = pdFALSE;
 	}
 	
-	xLastTime = xTimeNow;
+	pxService->xLastTime = xTimeNow;
 	
 	return xTimeNow;
 }
@@ -452,6 +974,7 @@ static portTickType xLastTime = ( portTickType ) 0U;
 static portBASE_TYPE prvInsertTimerInActiveList( xTIMER *pxTimer, portTickType xNextExpiryTime, portTickType xTimeNow, portTickType xCommandTime )
 {
 portBASE_TYPE xProcessTimerNow = pdFALSE;
+xTIMER_SERVICE * const pxService = pxTimer->pxService;
 
 	listSET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ), xNextExpiryTime );
 	listSET_LIST_ITEM_OWNER( &( pxTimer->xTimerListItem ), pxTimer );
@@ -468,7 +991,7 @@ portBASE_TYPE xProcessTimerNow = pdFALSE;
 		}
 		else
 		{
-			vListInsert( pxOverflowTimerList, &( pxTimer->xTimerListItem ) );
+			vListInsert( pxService->pxOverflowTimerList, &( pxTimer->xTimerListItem ) );
 		}
 	}
 	else
@@ -482,7 +1005,7 @@ portBASE_TYPE xProcessTimerNow = pdFALSE;
 		}
 		else
 		{
-			vListInsert( pxCurrentTimerList, &( pxTimer->xTimerListItem ) );
+			vListInsert( pxService->pxCurrentTimerList, &( pxTimer->xTimerListItem ) );
 		}
 	}
 
@@ -490,7 +1013,59 @@ portBASE_TYPE xProcessTimerNow = pdFALSE;
 }
 /*-----------------------------------------------------------*/
 
-static void	prvProcessReceivedCommands( void )
+static portBASE_TYPE prvProcessCommand( const xTIMER_MESSAGE *pxMessage, portTickType xTimeNow )
+{
+xTIMER *pxTimer;
+portBASE_TYPE xTimerExpired = pdFALSE;
+
+	pxTimer = pxMessage->pxTimer;
+
+	/* Is the timer already in a list of active timers?  When the command
+	is trmCOMMAND_PROCESS_TIMER_OVERFLOW, the timer will be NULL as the
+	command is to the task rather than to an individual timer. */
+	if( pxTimer != NULL )
+	{
+		if( listIS_CONTAINED_WITHIN( NULL, &( pxTimer->xTimerListItem ) ) == pdFALSE )
+		{
+			/* The timer is in a list, remove it. */
+			vListRemove( &( pxTimer->xTimerListItem ) );
+		}
+	}
+
+	switch( pxMessage->xMessageID )
+	{
+		case tmrCOMMAND_START :
+			/* Start or restart a timer. */
+			xTimerExpired = prvInsertTimerInActiveList( pxTimer,  pxMessage->xMessageValue + pxTimer->xTimerPeriodInTicks, xTimeNow, pxMessage->xMessageValue );
+			break;
+
+		case tmrCOMMAND_STOP :
+			/* The timer has already been removed from the active list.
+			There is nothing to do here. */
+			break;
+
+		case tmrCOMMAND_CHANGE_PERIOD :
+			pxTimer->xTimerPeriodInTicks = pxMessage->xMessageValue;
+			configASSERT( ( pxTimer->xTimerPeriodInTicks > 0 ) );
+			prvInsertTimerInActiveList( pxTimer, ( xTimeNow + pxTimer->xTimerPeriodInTicks ), xTimeNow, xTimeNow );
+			break;
+
+		case tmrCOMMAND_DELETE :
+			/* The timer has already been removed from the active list,
+			just free up the memory. */
+			vPortFree( pxTimer );
+			break;
+
+		default	:
+			/* Don't expect to get here. */
+			break;
+	}
+
+	return xTimerExpired;
+}
+/*-----------------------------------------------------------*/
+
+static void	prvProcessReceivedCommands( xTIMER_SERVICE *pxService )
 {
 xTIMER_MESSAGE xMessage;
 xTIMER *pxTimer;
@@ -499,71 +1074,62 @@ portTickType xTimeNow;
 
 	/* In this case the xTimerListsWereSwitched parameter is not used, but it
 	must be present in the function call. */
-	xTimeNow = prvSampleTimeNow( &xTimerListsWereSwitched );
+	xTimeNow = prvSampleTimeNow( pxService, &xTimerListsWereSwitched );
 
-	while( xQueueReceive( xTimerQueue, &xMessage, tmrNO_DELAY ) != pdFAIL )
+	/* Consume the wake up before emptying the ring, so a command that is
+	written to the ring after the ring has been found to be empty wakes this
+	task again. */
+	( void ) xQueueReceive( pxService->xTimerQueue, NULL, tmrNO_DELAY );
+
+	while( prvReadCommandFromRing( pxService, &xMessage ) != pdFAIL )
 	{
+		pxService->xCommandStats.ulCommandsProcessed++;
+
+		/* The space queue is as long as the ring, so will only be full if
+		every slot has been read while tasks were waiting, in which case the
+		waiting tasks will already be woken. */
+		if( pxService->uxSpaceWaiters > 0U )
+		{
+			( void ) xQueueSendToBack( pxService->xSpaceQueue, NULL, tmrNO_DELAY );
+		}
 		pxTimer = xMessage.pxTimer;
 
-		/* Is the timer already in a list of active timers?  When the command
-		is trmCOMMAND_PROCESS_TIMER_OVERFLOW, the timer will be NULL as the
-		command is to the task rather than to an individual timer. */
-		if( pxTimer != NULL )
+		#if ( configGENERATE_TIMER_STATS == 1 )
 		{
-			if( listIS_CONTAINED_WITHIN( NULL, &( pxTimer->xTimerListItem ) ) == pdFALSE )
+		unsigned long ulWaitCycles = portGET_CYCLE_COUNT() - xMessage.ulSendCycleCount;
+
+			taskENTER_CRITICAL();
 			{
-				/* The timer is in a list, remove it. */
-				vListRemove( &( pxTimer->xTimerListItem ) );
+				if( ulWaitCycles > pxService->xServiceStats.ulMaxCommandWaitCycles )
+				{
+					pxService->xServiceStats.ulMaxCommandWaitCycles = ulWaitCycles;
+				}
+				pxService->xServiceStats.ullTotalCommandWaitCycles += ulWaitCycles;
 			}
+			taskEXIT_CRITICAL();
 		}
+		#endif
 
 		traceTIMER_COMMAND_RECEIVED( pxTimer, xMessage.xMessageID, xMessage.xMessageValue );
 		
-		switch( xMessage.xMessageID )
+		if( prvProcessCommand( &xMessage, xTimeNow ) != pdFALSE )
 		{
-			case tmrCOMMAND_START :	
-				/* Start or restart a timer. */
-				if( prvInsertTimerInActiveList( pxTimer,  xMessage.xMessageValue + pxTimer->xTimerPeriodInTicks, xTimeNow, xMessage.xMessageValue ) == pdTRUE )
-				{
-					/* The timer expired before it was added to the active timer
-					list.  Process it now. */
-					pxTimer->pxCallbackFunction( ( xTimerHandle ) pxTimer );
-
-					if( pxTimer->uxAutoReload == ( unsigned portBASE_TYPE ) pdTRUE )
-					{
-						xResult = xTimerGenericCommand( pxTimer, tmrCOMMAND_START, xMessage.xMessageValue + pxTimer->xTimerPeriodInTicks, NULL, tmrNO_DELAY );
-						configASSERT( xResult );
-						( void ) xResult;
-					}
-				}
-				break;
-
-			case tmrCOMMAND_STOP :	
-				/* The timer has already been removed from the active list.
-				There is nothing to do here. */
-				break;
-
-			case tmrCOMMAND_CHANGE_PERIOD :
-				pxTimer->xTimerPeriodInTicks = xMessage.xMessageValue;
-				configASSERT( ( pxTimer->xTimerPeriodInTicks > 0 ) );
-				prvInsertTimerInActiveList( pxTimer, ( xTimeNow + pxTimer->xTimerPeriodInTicks ), xTimeNow, xTimeNow );
-				break;
-
-			case tmrCOMMAND_DELETE :
-				/* The timer has already been removed from the active list,
-				just free up the memory. */
-				vPortFree( pxTimer );
-				break;
-
-			default	:			
-				/* Don't expect to get here. */
-				break;
+			/* The timer expired before it was added to the active timer
+			list.  Process it now. */
+			prvExecuteCallback( pxTimer, xMessage.xMessageValue + pxTimer->xTimerPeriodInTicks );
+
+			if( pxTimer->uxAutoReload == ( unsigned portBASE_TYPE ) pdTRUE )
+			{
+				xResult = prvSendStartCommandToTimerTask( pxTimer, xMessage.xMessageValue + pxTimer->xTimerPeriodInTicks );
+				configASSERT( xResult );
+				( void ) xResult;
+			}
 		}
 	}
 }
 /*-----------------------------------------------------------*/
 
-static void prvSwitchTimerLists( portTickType xLastTime )
+static void prvSwitchTimerLists( xTIMER_SERVICE *pxService, portTickType xLastTime )
 {
 portTickType xNextExpireTime, xReloadTime;
 xList *pxTemp;
@@ -577,18 +1143,18 @@ portBASE_TYPE xResult;
 	If there are any timers still referenced from the current timer list
 	then they must have expired and should be processed before the lists
 	are switched. */
-	while( listLIST_IS_EMPTY( pxCurrentTimerList ) == pdFALSE )
+	while( listLIST_IS_EMPTY( pxService->pxCurrentTimerList ) == pdFALSE )
 	{
-		xNextExpireTime = listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxCurrentTimerList );
+		xNextExpireTime = listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxService->pxCurrentTimerList );
 
 		/* Remove the timer from the list. */
-		pxTimer = ( xTIMER * ) listGET_OWNER_OF_HEAD_ENTRY( pxCurrentTimerList );
+		pxTimer = ( xTIMER * ) listGET_OWNER_OF_HEAD_ENTRY( pxService->pxCurrentTimerList );
 		vListRemove( &( pxTimer->xTimerListItem ) );
 
 		/* Execute its callback, then send a command to restart the timer if
 		it is an auto-reload timer.  It cannot be restarted here as the lists
 		have not yet been switched. */
-		pxTimer->pxCallbackFunction( ( xTimerHandle ) pxTimer );
+		prvExecuteCallback( pxTimer, xNextExpireTime );
 
 		if( pxTimer->uxAutoReload == ( unsigned portBASE_TYPE ) pdTRUE )
 		{
@@ -603,37 +1169,55 @@ portBASE_TYPE xResult;
 			{
 				listSET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ), xReloadTime );
 				listSET_LIST_ITEM_OWNER( &( pxTimer->xTimerListItem ), pxTimer );
-				vListInsert( pxCurrentTimerList, &( pxTimer->xTimerListItem ) );
+				vListInsert( pxService->pxCurrentTimerList, &( pxTimer->xTimerListItem ) );
 			}
 			else
 			{
-				xResult = xTimerGenericCommand( pxTimer, tmrCOMMAND_START, xNextExpireTime, NULL, tmrNO_DELAY );
+				xResult = prvSendStartCommandToTimerTask( pxTimer, xNextExpireTime );
 				configASSERT( xResult );
 				( void ) xResult;
 			}
 		}
 	}
 
-	pxTemp = pxCurrentTimerList;
-	pxCurrentTimerList = pxOverflowTimerList;
-	pxOverflowTimerList = pxTemp;
+	pxTemp = pxService->pxCurrentTimerList;
+	pxService->pxCurrentTimerList = pxService->pxOverflowTimerList;
+	pxService->pxOverflowTimerList = pxTemp;
 }
 /*-----------------------------------------------------------*/
 
 static void prvCheckForValidListAndQueue( void )
 {
-	/* Check that the list from which active timers are referenced, and the
-	queue used to communicate with the timer service, have been
-	initialised. */
+unsigned long ulSlot;
+unsigned portBASE_TYPE uxService;
+xTIMER_SERVICE *pxService;
+
+	/* Check that the lists from which active timers are referenced, and the
+	queues used to communicate with the timer services, have been
+	initialised.  All the services are initialised together, so only the
+	queue of the first need be checked. */
 	taskENTER_CRITICAL();
 	{
-		if( xTimerQueue == NULL )
+		if( xTimerServices[ 0 ].xTimerQueue == NULL )
 		{
-			vListInitialise( &xActiveTimerList1 );
-			vListInitialise( &xActiveTimerList2 );
-			pxCurrentTimerList = &xActiveTimerList1;
-			pxOverflowTimerList = &xActiveTimerList2;
-			xTimerQueue = xQueueCreate( ( unsigned portBASE_TYPE ) configTIMER_QUEUE_LENGTH, sizeof( xTIMER_MESSAGE ) );
+			for( uxService = 0U; uxService < ( unsigned portBASE_TYPE ) configTIMER_SERVICE_COUNT; uxService++ )
+			{
+				pxService = &( xTimerServices[ uxService ] );
+
+				vListInitialise( &( pxService->xActiveTimerList1 ) );
+				vListInitialise( &( pxService->xActiveTimerList2 ) );
+				pxService->pxCurrentTimerList = &( pxService->xActiveTimerList1 );
+				pxService->pxOverflowTimerList = &( pxService->xActiveTimerList2 );
+
+				/* Slot n of the ring is ready to be written with command n. */
+				for( ulSlot = 0UL; ulSlot < ( unsigned long ) configTIMER_QUEUE_LENGTH; ulSlot++ )
+				{
+					pxService->xCommandRing[ ulSlot ].ulSequence = ulSlot;
+				}
+
+				pxService->xTimerQueue = xQueueCreate( ( unsigned portBASE_TYPE ) 1, ( unsigned portBASE_TYPE ) 0 );
+				pxService->xSpaceQueue = xQueueCreate( ( unsigned portBASE_TYPE ) configTIMER_QUEUE_LENGTH, ( unsigned portBASE_TYPE ) 0 );
+			}
 		}
 	}
 	taskEXIT_CRITICAL();